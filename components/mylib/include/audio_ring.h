@@ -0,0 +1,95 @@
+// include/audio_ring.h
+#ifndef AUDIO_RING_H
+#define AUDIO_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "esp_err.h"
+
+/**
+ * @brief Ring buffer SPSC (um produtor, um consumidor) de frames int32 do I2S.
+ *        O produtor escreve direto do DMA; o consumidor lê janelas sobrepostas
+ *        por views somente-leitura, sem cópia.
+ */
+typedef struct {
+    int32_t *frames;                // Armazenamento (capacity frames)
+    size_t capacity;                // Capacidade em frames (potência de 2)
+    size_t mask;                    // capacity - 1
+    _Atomic uint32_t write_pos;     // Total de frames escritos (monotônico, só o produtor altera)
+    _Atomic uint32_t read_pos;      // Total de frames consumidos (monotônico, só o consumidor altera)
+} audio_ring_t;
+
+/**
+ * @brief View somente-leitura de uma janela do ring (até dois trechos contíguos
+ *        quando a janela cruza o fim do armazenamento).
+ */
+typedef struct {
+    const int32_t *first;           // Primeiro trecho
+    size_t first_len;               // Frames no primeiro trecho
+    const int32_t *second;          // Segundo trecho (NULL se a janela não cruza o fim)
+    size_t second_len;              // Frames no segundo trecho
+} audio_ring_view_t;
+
+/**
+ * @brief Aloca o armazenamento do ring.
+ *
+ * @param ring     Ponteiro para o ring.
+ * @param capacity Capacidade em frames (potência de 2).
+ * @param caps     Capacidades de memória (ex.: MALLOC_CAP_SPIRAM).
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t audio_ring_init(audio_ring_t *ring, size_t capacity, uint32_t caps);
+
+/**
+ * @brief (Produtor) Obtém o maior trecho contíguo livre para escrita.
+ *
+ * @param ring Ponteiro para o ring.
+ * @param dst  Recebe o ponteiro para o início do trecho.
+ * @return size_t Frames disponíveis no trecho (0 se o ring estiver cheio).
+ */
+size_t audio_ring_write_acquire(audio_ring_t *ring, int32_t **dst);
+
+/**
+ * @brief (Produtor) Publica frames escritos no trecho obtido por audio_ring_write_acquire.
+ *
+ * @param ring   Ponteiro para o ring.
+ * @param frames Número de frames escritos.
+ */
+void audio_ring_write_commit(audio_ring_t *ring, size_t frames);
+
+/**
+ * @brief Frames disponíveis para leitura.
+ *
+ * @param ring Ponteiro para o ring.
+ * @return size_t Frames escritos e ainda não consumidos.
+ */
+size_t audio_ring_available(audio_ring_t *ring);
+
+/**
+ * @brief (Consumidor) Obtém uma view das próximas length frames sem consumi-las.
+ *
+ * @param ring   Ponteiro para o ring.
+ * @param length Tamanho da janela em frames.
+ * @param view   View de saída.
+ * @return true se havia frames suficientes, false caso contrário.
+ */
+bool audio_ring_peek(audio_ring_t *ring, size_t length, audio_ring_view_t *view);
+
+/**
+ * @brief (Consumidor) Libera frames lidos (avança a janela pelo hop).
+ *
+ * @param ring   Ponteiro para o ring.
+ * @param frames Número de frames a consumir.
+ */
+void audio_ring_consume(audio_ring_t *ring, size_t frames);
+
+/**
+ * @brief Libera o armazenamento do ring.
+ *
+ * @param ring Ponteiro para o ring.
+ */
+void audio_ring_deinit(audio_ring_t *ring);
+
+#endif // AUDIO_RING_H
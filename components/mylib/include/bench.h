@@ -0,0 +1,185 @@
+// include/bench.h
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define BENCH_NAME_LEN      (32)       // Tamanho máximo do nome de um kernel (com '\0')
+#define BENCH_MAX_RESULTS   (192)      // Capacidade sugerida para o vetor de resultados da suíte
+#define BENCH_MAX_REPS      (101)      // Limite de repetições por caso (amostras para mediana/p99)
+
+/**
+ * @brief Resultado de um caso (kernel x tamanho).
+ */
+typedef struct {
+    char name[BENCH_NAME_LEN];      // Nome do kernel (ex.: "rfft")
+    size_t n;                       // Tamanho do problema (amostras)
+    size_t reps;                    // Repetições medidas
+    double median_ns;               // Mediana por chamada
+    double p99_ns;                  // Percentil 99 por chamada
+    double ns_per_sample;           // median_ns / n
+    uint64_t median_cycles;         // Mediana em ciclos de CPU (0 quando o backend não conta ciclos)
+} bench_result_t;
+
+/**
+ * @brief Exatidão e custo de um motor de pitch no corpus sintético de notas.
+ */
+typedef struct {
+    char name[BENCH_NAME_LEN];      // Motor (ex.: "yin", "hps")
+    size_t notes;                   // Janelas avaliadas
+    size_t detected;                // Janelas com pitch
+    size_t gross;                   // Detectadas com |erro| > 50 cents (oitava, nota vizinha)
+    double mean_abs_cents;          // Média de |erro| das detectadas sem erro grosseiro
+    double p95_abs_cents;           // Percentil 95 de |erro| (idem)
+    double mean_us;                 // Tempo médio por janela (só o motor; a FFT já existe no pipeline)
+} bench_pitch_result_t;
+
+#define BENCH_PITCH_ENGINES (5)        // Motores avaliados por bench_pitch_corpus
+
+/**
+ * @brief Caminho completo (FFT + YIN + get_note) contra o banco do afinador numa sequência de cordas.
+ */
+typedef struct {
+    char name[BENCH_NAME_LEN];      // Caminho ("fft_yin", "tuner")
+    size_t hop;                     // Avanço entre janelas (amostras a SAMPLE_RATE)
+    size_t windows;                 // Janelas avaliadas
+    size_t stable;                  // Janelas inteiras dentro de uma corda
+    size_t correct;                 // Janelas estáveis com a corda certa
+    double mean_abs_cents;          // Média de |erro| das corretas
+    double mean_us;                 // Tempo médio por janela
+    double cpu_pct;                 // mean_us em relação à duração do hop (%)
+    double latency_ms;              // Da troca de corda ao fim da primeira janela correta (+ processamento)
+    size_t missed;                  // Trocas de corda sem nenhuma janela correta
+} bench_tuner_result_t;
+
+#define BENCH_TUNER_PATHS (2)          // Caminhos avaliados por bench_tuner_compare
+
+/**
+ * @brief Parâmetros de medição.
+ */
+typedef struct {
+    size_t warmup;                  // Chamadas descartadas antes de medir
+    size_t min_reps;                // Repetições mínimas (mesmo acima do orçamento)
+    size_t max_reps;                // Repetições máximas (<= BENCH_MAX_REPS)
+    int64_t budget_us;              // Orçamento de tempo por caso
+    size_t min_n;                   // Menor tamanho da varredura (potência de 2)
+    size_t max_n;                   // Maior tamanho da varredura (potência de 2)
+} bench_config_t;
+
+#define BENCH_CONFIG_DEFAULT() {        \
+    .warmup = 3,                        \
+    .min_reps = 5,                      \
+    .max_reps = 51,                     \
+    .budget_us = 200000,                \
+    .min_n = 256,                       \
+    .max_n = 8192,                      \
+}
+
+/**
+ * @brief Kernel medido (e preparação fora da medição).
+ */
+typedef void (*bench_fn_t)(void *ctx);
+
+/**
+ * @brief Mede um kernel: warmup, repetições até o orçamento, mediana e p99.
+ *
+ * @param name   Nome do kernel.
+ * @param n      Tamanho do problema (para ns/amostra).
+ * @param setup  Preparação antes de cada chamada, não cronometrada (pode ser NULL).
+ * @param fn     Kernel cronometrado.
+ * @param ctx    Contexto repassado a setup e fn.
+ * @param cfg    Parâmetros de medição.
+ * @param out    Resultado.
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t bench_measure(const char *name, size_t n, bench_fn_t setup, bench_fn_t fn, void *ctx,
+                        const bench_config_t *cfg, bench_result_t *out);
+
+/**
+ * @brief Executa a suíte de kernels de DSP na varredura de tamanhos de cfg.
+ *
+ * @param cfg         Parâmetros de medição e varredura.
+ * @param results     Vetor de saída.
+ * @param max_results Capacidade de results.
+ * @return size_t     Número de resultados preenchidos.
+ */
+size_t bench_run_suite(const bench_config_t *cfg, bench_result_t *results, size_t max_results);
+
+/**
+ * @brief Avalia os motores de pitch (YIN FFT, YIN direto, HPS, HPS + YIN com faixa limitada)
+ *        num corpus sintético: notas de E1 a C7 com desafinação, 8 harmônicos de fase
+ *        aleatória e ruído a 30 dB, em janelas Hann de n amostras a SAMPLE_RATE.
+ *
+ * @param n           Janela (potência de 2).
+ * @param results     Vetor de saída.
+ * @param max_results Capacidade de results (BENCH_PITCH_ENGINES).
+ * @return size_t     Número de resultados preenchidos.
+ */
+size_t bench_pitch_corpus(size_t n, bench_pitch_result_t *results, size_t max_results);
+
+/**
+ * @brief Imprime a tabela de bench_pitch_corpus.
+ *
+ * @param out     Destino.
+ * @param results Resultados.
+ * @param count   Número de resultados.
+ */
+void bench_pitch_print(FILE *out, const bench_pitch_result_t *results, size_t count);
+
+/**
+ * @brief Compara, a cada hop, o caminho completo (rfft de FBUF_SIZE + magnitude + decimação +
+ *        YIN + get_note) com o afinador (decimação + banco de Goertzel de TUNER_INSTRUMENT) numa
+ *        sequência sintética de cordas dedilhadas e desafinadas, em janelas Hann de BUFFER_SIZE.
+ *
+ * @param hop         Avanço entre janelas (amostras a SAMPLE_RATE, 1..BUFFER_SIZE).
+ * @param results     Vetor de saída.
+ * @param max_results Capacidade de results (BENCH_TUNER_PATHS).
+ * @return size_t     Número de resultados preenchidos.
+ */
+size_t bench_tuner_compare(size_t hop, bench_tuner_result_t *results, size_t max_results);
+
+/**
+ * @brief Imprime a tabela de bench_tuner_compare.
+ *
+ * @param out     Destino.
+ * @param results Resultados.
+ * @param count   Número de resultados.
+ */
+void bench_tuner_print(FILE *out, const bench_tuner_result_t *results, size_t count);
+
+/**
+ * @brief Escreve os resultados em JSON.
+ *
+ * @param out     Destino (ex.: stdout no alvo, arquivo no host).
+ * @param results Resultados.
+ * @param count   Número de resultados.
+ */
+void bench_write_json(FILE *out, const bench_result_t *results, size_t count);
+
+/**
+ * @brief Lê resultados de um JSON produzido por bench_write_json (ex.: baseline salvo).
+ *
+ * @param json        Texto JSON terminado em '\0'.
+ * @param results     Vetor de saída.
+ * @param max_results Capacidade de results.
+ * @return size_t     Número de resultados lidos.
+ */
+size_t bench_parse_json(const char *json, bench_result_t *results, size_t max_results);
+
+/**
+ * @brief Compara resultados com um baseline (mesmo nome e tamanho, pela mediana).
+ *
+ * @param current     Resultados atuais.
+ * @param n_current   Número de resultados atuais.
+ * @param baseline    Resultados de referência.
+ * @param n_baseline  Número de resultados de referência.
+ * @param threshold   Piora relativa tolerada (ex.: 0.10 = 10%).
+ * @return int        Número de regressões acima do threshold.
+ */
+int bench_compare(const bench_result_t *current, size_t n_current,
+                  const bench_result_t *baseline, size_t n_baseline, float threshold);
+
+#endif // BENCH_H
@@ -0,0 +1,81 @@
+// include/decimator.h
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <stddef.h>
+#include "esp_err.h"
+#include "def.h"
+
+/**
+ * @brief Estágio half-band (decimação por 2, forma polifásica).
+ *        Comprimento L = 4M - 1: centro 0.5, taps pares nulos, M taps simétricos não nulos.
+ */
+typedef struct {
+    float *coefs;                   // M coeficientes não nulos de um lado (g_1..g_M)
+    size_t half_taps;               // M
+    size_t taps;                    // L = 4M - 1
+    float *work;                    // Histórico (L - 1) + bloco de entrada
+    size_t max_block;               // Maior bloco de entrada aceito
+} halfband_t;
+
+/**
+ * @brief Cascata de estágios half-band (fator 2^num_stages).
+ */
+typedef struct {
+    halfband_t stages[DECIM_MAX_STAGES];
+    size_t num_stages;
+    size_t factor;                  // Fator total de decimação
+    float input_rate;               // Taxa de entrada em Hz
+    float output_rate;              // Taxa de saída em Hz
+    float *scratch;                 // Saída intermediária entre estágios
+} decimator_t;
+
+/**
+ * @brief Projeta a cascata half-band (Kaiser), cada estágio com o menor comprimento que
+ *        atenua em atten_db o que dobraria sobre [0, passband_hz] na taxa final.
+ *
+ * @param d           Ponteiro para o decimador.
+ * @param factor      Fator de decimação (potência de 2, até 2^DECIM_MAX_STAGES; 1 = cópia).
+ * @param input_rate  Taxa de entrada em Hz.
+ * @param passband_hz Maior frequência preservada (< taxa de saída / 2).
+ * @param atten_db    Atenuação mínima do aliasing em dB.
+ * @param max_block   Maior bloco passado a decimator_process (múltiplo de factor).
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t decimator_init(decimator_t *d, size_t factor, float input_rate, float passband_hz,
+                         float atten_db, size_t max_block);
+
+/**
+ * @brief Decima um bloco (stream contínuo: o histórico dos FIR é mantido entre chamadas).
+ *
+ * @param d      Ponteiro para o decimador.
+ * @param in     Entrada (length amostras, múltiplo de factor, até max_block).
+ * @param length Número de amostras de entrada.
+ * @param out    Saída (length / factor amostras; pode ser igual a in).
+ * @return size_t Número de amostras de saída (0 em erro).
+ */
+size_t decimator_process(decimator_t *d, const float *in, size_t length, float *out);
+
+/**
+ * @brief Zera o histórico (descontinuidade no stream).
+ *
+ * @param d Ponteiro para o decimador.
+ */
+void decimator_reset(decimator_t *d);
+
+/**
+ * @brief Atraso de grupo total em amostras de entrada.
+ *
+ * @param d Ponteiro para o decimador.
+ * @return float Atraso em amostras na taxa de entrada.
+ */
+float decimator_delay(const decimator_t *d);
+
+/**
+ * @brief Libera os buffers do decimador.
+ *
+ * @param d Ponteiro para o decimador.
+ */
+void decimator_deinit(decimator_t *d);
+
+#endif // DECIMATOR_H
@@ -26,10 +26,20 @@
 
 #define TESTE 0 
 
+// Saída do pipeline (estágio emit): 0 texto FUND_FREQ/NOTE, 1 texto com samples e magnitude,
+// 2 frames binários com CRC (telemetry.h; decodificar no PC com host/tools/telem_cli)
 #define PROCESSING 0
+#define TELEMETRY_VECTORS (TELEM_FLAG_SPECTRUM)   // Vetores nos frames binários (| TELEM_FLAG_SAMPLES, | TELEM_FLAG_HALF)
 
 #define NUM_WAVES 3
 
+// Executar a suíte de benchmarks (bench.c) no boot e imprimir o JSON em vez do pipeline
+#define RUN_BENCHMARK 0
+
+// Trace por estágio do pipeline (trace.c): 0 remove toda a instrumentação
+#define TRACE_ENABLED 1
+#define TRACE_CAPACITY (1024)          // Eventos no ring de trace (potência de 2)
+
 // Ativar verificação (definir como 1 para ativar, 0 para desativar)
 #define ENABLE_VERIFICATION 0
 
@@ -43,6 +53,48 @@
 #define SAMPLE_RATE     (48000)        // Taxa de amostragem em Hz (16kHz ou 48kHz são comuns para INMP441)
 #define BUFFER_SIZE     (1 << 12)         // Tamanho do buffer de áudio para leitura e processamento
 #define FBUF_SIZE       (BUFFER_SIZE/2)              // Tamanho do buffer de fft para processamento
+#define RFFT_BINS       (FBUF_SIZE/2 + 1)            // Bins não redundantes da rfft de FBUF_SIZE amostras
+#define FFT_PLAN_CACHE_SIZE   (8)                    // Número de planos de FFT (tamanhos distintos) em cache
+#define FFT_PLAN_INTERNAL_MAX (4096)                 // Planos até este tamanho ficam na RAM interna
+#define FFT_INTERLEAVED_MAX   (8192)                 // Maior FFT intercalada suportada pelo backend esp-dsp
+#define WINDOW_CACHE_SIZE     (8)                    // Número de tabelas de janela (tipo, tamanho) em cache
+#define WINDOW_INTERNAL_MAX   (4096)                 // Tabelas de janela até este tamanho ficam na RAM interna
+#define WINDOW_KAISER_BETA    (8.6f)                 // Beta da janela Kaiser (lóbulos laterais ~ -90 dB)
+
+// Backend dos kernels de DSP: C portátil (host e alvo) ou esp-dsp (assembly do ESP32-S3)
+#define DSP_BACKEND_PORTABLE  0
+#define DSP_BACKEND_ESP_DSP   1
+#ifndef DSP_BACKEND
+#ifdef ESP_PLATFORM
+#define DSP_BACKEND DSP_BACKEND_ESP_DSP
+#else
+#define DSP_BACKEND DSP_BACKEND_PORTABLE
+#endif
+#endif
+
+// Caminho numérico do pipeline: float ou ponto fixo (janela/biquad Q31, FFT Q15 em bloco, YIN inteiro)
+#define DSP_PATH_FLOAT        0
+#define DSP_PATH_FIXED        1
+#ifndef DSP_PATH
+#define DSP_PATH DSP_PATH_FLOAT
+#endif
+
+// Configurações do pipeline (profundidade das filas e dos pools de blocos)
+#define AUDIO_RING_FRAMES   (1 << 15)  // Frames int32 no ring captura -> condicionamento (potência de 2, 128 KB)
+#define ANALYSIS_HOP        (BUFFER_SIZE / 2) // Avanço da janela de análise (frames); < BUFFER_SIZE => janelas sobrepostas
+#define ANALYSIS_MAX_LAG    (4)        // Hops de atraso tolerados antes de a análise pular para a janela mais recente
+#define MIC_READ_FRAMES     (256)      // Frames por leitura do I2S na captura contínua (~5,3 ms a 48 kHz)
+#define I2S_READ_CHUNK      (256)      // Frames por leitura em i2s_read_samples (buffer estático)
+#define RESULT_QUEUE_DEPTH  (8)        // Frames em trânsito no grafo de estágios (condicionamento -> emissão)
+#define POOL_TASK_SLACK     (2)        // Frames extras: um sendo produzido e um sendo consumido
+#define STAGE_GRAPH_MAX_STAGES (8)     // Estágios por grafo (máscaras de entrada em 32 bits)
+
+// Gate de energia (gate.c): janelas silenciosas não passam por band-pass, FFT, YIN nem nota
+#define GATE_ENABLED        1          // 0: toda janela é analisada
+#define GATE_OPEN_DBFS      (-60.0f)   // RMS (sem DC) que abre o gate
+#define GATE_CLOSE_DBFS     (-66.0f)   // RMS abaixo do qual o gate começa a fechar (histerese)
+#define GATE_PEAK_DBFS      (-30.0f)   // Pico que abre o gate mesmo com RMS baixo (ataque curto)
+#define GATE_HOLD_FRAMES    (4)        // Janelas abaixo de GATE_CLOSE_DBFS antes de fechar (~4 hops)
 
 // Definições de LED e Temporizador
 #define LED_GPIO        GPIO_NUM_9     // Pino do LED indicador
@@ -60,6 +112,11 @@
 // Exemplo: Configurações para Filtros
 #define LOW_FREQ 27.5f          // Frequência de corte inferior do filtro passa-banda em Hz
 #define HIGH_FREQ 4186.0f       // Frequência de corte superior do filtro passa-banda em Hz
+#define FILTER_SOS_MAX_SECTIONS (8)      // Seções de 2ª ordem por cascata (sos_filter_t)
+#define FILTER_BANDPASS_ORDER   (2)      // Ordem do protótipo Butterworth do passa-banda de entrada (filtro de ordem 2N)
+#define FILTER_HUM_HZ           (0.0f)   // Notch anti-zumbido da rede (50 ou 60 Hz); 0 desativa
+#define FILTER_HUM_HARMONICS    (3)      // Harmônicos da rede com notch (f, 2f, 3f...)
+#define FILTER_HUM_Q            (30.0f)  // Q dos notches (largura de banda ~ f / Q)
 
 
 // Definições para Algoritmo YIN
@@ -68,6 +125,50 @@
 #define YIN_MIN_LAG 40                    // Lag mínimo para detecção de pitch
 #define YIN_MAX_LAG 1000                  // Lag máximo para detecção de pitch
 #define YIN_ENABLE_INTERPOLATE 1          // Habilitar interpolação parabólica (1: habilitado, 0: desabilitado)
+#define YIN_DIFF_METHOD YIN_DIFF_FFT      // Backend de d(tau): YIN_DIFF_DIRECT (laço direto) ou YIN_DIFF_FFT (autocorrelação)
+#define YIN_STREAM_HOP 256                // Salto (amostras) do YIN em modo streaming
+#define YIN_STREAM_RESYNC_HOPS 64         // Saltos entre recálculos completos de d(tau) no modo streaming
+#define YIN_HIERARCHICAL 0                // 1: busca coarse-to-fine do lag em yin_detect_pitch (yin_set_hierarchical)
+#define YIN_COARSE_FACTOR 4               // Decimação da busca grossa
+#define YIN_COARSE_CANDIDATES 3           // Vales da busca grossa refinados na resolução cheia
+#define YIN_REFINE_RADIUS 4               // Lags avaliados de cada lado de cada candidato
+#define YIN_COARSE_SLACK 0.1f             // Folga do threshold na busca grossa (o vale grosso é mais raso)
+#define YIN_EARLY_EXIT 0                  // 1: d(tau) e d'(tau) na mesma passada, parando no primeiro mínimo (ignorado com YIN_HIERARCHICAL 1)
+#define YIN_TRACKING 0                    // 1: após uma nota confiante, só os lags a ±YIN_TRACK_SEMITONES do período anterior (yin_set_tracking)
+#define YIN_TRACK_SEMITONES 2.0f          // Meia largura da janela de rastreamento (semitons, < 6)
+#define YIN_TRACK_MIN_CONFIDENCE 0.9f     // Confiança mínima da busca completa para travar
+#define YIN_TRACK_ONSET_RATIO 4.0f        // Energia da janela acima deste múltiplo da anterior (+6 dB) é ataque: destrava
+#define YIN_PARALLEL_WORKERS 2            // Partes do laço direto de d(tau) (Q15, YIN_DIFF_DIRECT, rastreamento; não o backend FFT). 2: estágio pitch + worker no outro núcleo; 1 desativa
+#define PAR_MAX_WORKERS 4                 // Máximo de partes por executor paralelo
+#define PAR_WORKER_STACK (1 << 12)        // Stack das tasks worker
+#define PAR_WORKER_PRIORITY 4             // Prioridade das tasks worker (a mesma dos estágios de análise)
+#define YIN_DECIMATION 4                  // Decimação half-band antes do YIN no caminho em float (potência de 2; 1 desativa). A FFT segue na taxa cheia
+#define YIN_SAMPLE_RATE (SAMPLE_RATE / YIN_DECIMATION)   // Taxa vista pelo YIN
+#define YIN_BUFFER_SIZE (BUFFER_SIZE / YIN_DECIMATION)   // Janela do YIN (mesma duração de BUFFER_SIZE)
+#define DECIM_MAX_STAGES 4                // Estágios half-band por decimador (fator até 16)
+#define DECIM_ATTEN_DB 70.0f              // Atenuação mínima do aliasing sobre [0, HIGH_FREQ]
+
+// Motor de pitch do estágio pitch
+#define PITCH_ENGINE_YIN     0            // Só o detector no tempo (PITCH_DETECTOR, em paralelo com a FFT)
+#define PITCH_ENGINE_HPS     1            // Só HPS sobre as magnitudes do estágio spectrum (fft.c)
+#define PITCH_ENGINE_HPS_YIN 2            // HPS como pré-estimador: limita o maior lag do detector no tempo
+#define PITCH_ENGINE_TUNER   3            // Afinador: banco de Goertzel só nas cordas de TUNER_INSTRUMENT (tuner_bank.c), sem YIN
+#define PITCH_ENGINE PITCH_ENGINE_YIN
+#define PITCH_DETECTOR 0                  // Detector inicial no tempo (pitch_engine.h): 0 = YIN, 1 = MPM; 'p' no console alterna
+#define MPM_K 0.93f                       // MPM: primeiro pico-chave da NSDF acima de MPM_K x o maior
+#define MPM_MIN_CLARITY 0.5f              // MPM: NSDF mínima no pico escolhido (abaixo: sem pitch)
+#define MPM_MAX_PEAKS 32                  // MPM: picos-chave considerados por janela
+#define HPS_HARMONICS 5                   // Espectros decimados no produto
+#define HPS_GRID 4                        // Candidatos por bin (os harmônicos são interpolados)
+#define HPS_OCTAVE_RATIO 0.2f             // Suboitava aceita se o produto dela passa de RATIO^H do pico
+#define HPS_PRE_MARGIN 2.2f               // PITCH_ENGINE_HPS_YIN: YIN busca até HPS_PRE_MARGIN períodos estimados
+#define TUNER_INSTRUMENT "guitar"         // PITCH_ENGINE_TUNER: afinação alvo (guitar, bass, ukulele, violin, cavaquinho)
+#define TUNER_HARMONICS 3                 // Harmônicos por corda no escore e no refinamento
+#define TUNER_RANGE_CENTS 100.0f          // Desvio máximo em relação à corda (acima: sem nota)
+#define TUNER_MIN_CONFIDENCE 0.2f         // Fração mínima da energia da janela nos harmônicos da corda
+#define TUNER_REFINE_ITERS 2              // Recentralizações da interpolação na fundamental
+#define TUNER_MAX_STRINGS 8               // Cordas por instrumento
+#define TUNER_MAX_HARMONICS 8             // Harmônicos por corda
 
 // Definições de Botões para Controle do Sistema
 #define BTN_OFF       GPIO_NUM_16       // Botão para desligar o sistema
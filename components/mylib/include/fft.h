@@ -3,6 +3,46 @@
 #define FFT_H
 
 #include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief Plano de FFT: tabelas pré-computadas para um tamanho fixo.
+ */
+typedef struct {
+    size_t n;               // Tamanho da FFT (potência de 2)
+    float *cos_table;       // cos(2*pi*k/n), k < n/2
+    float *sin_table;       // sin(2*pi*k/n), k < n/2
+    uint16_t *bitrev;       // Índice bit-reverso de cada posição
+} fft_plan_t;
+
+/**
+ * @brief Cria um plano de FFT com tabelas de twiddle e de bit-reversal.
+ * @param n Tamanho (potência de 2, até 65536)
+ * @return Plano alocado ou NULL em erro.
+ */
+fft_plan_t *fft_plan_create(size_t n);
+
+/**
+ * @brief Libera um plano criado com fft_plan_create (não usar em planos do cache).
+ * @param plan Plano a liberar.
+ */
+void fft_plan_destroy(fft_plan_t *plan);
+
+/**
+ * @brief Retorna o plano em cache para o tamanho n, criando-o na primeira chamada.
+ * @param n Tamanho (potência de 2)
+ * @return Plano em cache, ou NULL se não foi possível criar/armazenar.
+ */
+const fft_plan_t *fft_plan_get(size_t n);
+
+/**
+ * @brief Executa FFT in-place (real + imag) usando as tabelas do plano.
+ * @param plan Plano criado para o tamanho dos buffers
+ * @param real Array de floats com parte real
+ * @param imag Array de floats com parte imaginária
+ */
+void fft_execute(const fft_plan_t *plan, float *real, float *imag);
 
 /**
  * @brief Executa FFT (Transformada Rápida de Fourier) in-place (real + imag).
@@ -12,6 +52,30 @@
  */
 void fft(float *real, float *imag, size_t n);
 
+/**
+ * @brief Inicializa o backend da FFT intercalada (tabelas do esp-dsp no alvo).
+ * @param max_n Maior tamanho que será usado com fft_interleaved (potência de 2)
+ * @return 0 em sucesso, -1 em erro.
+ */
+int fft_interleaved_init(size_t max_n);
+
+/**
+ * @brief FFT radix-4 portátil in-place sobre complexos intercalados
+ *        [re0, im0, re1, im1, ...] (layout dos buffers dsps_fft2r/4r do esp-dsp).
+ *        Para log2(n) ímpar, um estágio radix-2 precede os estágios radix-4.
+ * @param plan Plano criado para o tamanho n
+ * @param data Buffer com 2*n floats intercalados
+ */
+void fft_radix4_execute(const fft_plan_t *plan, float *data);
+
+/**
+ * @brief FFT in-place sobre complexos intercalados usando o backend de DSP_BACKEND
+ *        (esp-dsp no alvo, radix-4 portátil no host).
+ * @param data Buffer com 2*n floats intercalados
+ * @param n    Tamanho (potência de 2)
+ */
+void fft_interleaved(float *data, size_t n);
+
 /**
  * @brief Calcula a magnitude do espectro
  * @param real      Buffer de partes reais.
@@ -30,4 +94,83 @@ void calculate_magnitude(const float *real, const float *imag, float *magnitude,
  * @return 0 em sucesso, -1 em erro.
  */
 float frequency(const float *magnitude, float *frequency, size_t length, int sample_rate);
+
+/**
+ * @brief FFT de entrada real (FFT complexa de n/2 pontos + separação).
+ * @param input Buffer com n amostras reais.
+ * @param real  Buffer de saída com n/2+1 partes reais.
+ * @param imag  Buffer de saída com n/2+1 partes imaginárias.
+ * @param n     Tamanho da transformada (potência de 2, >= 2)
+ */
+void rfft(const float *input, float *real, float *imag, size_t n);
+
+/**
+ * @brief Calcula a magnitude do espectro no layout da rfft (n/2+1 bins).
+ * @param real      Buffer de partes reais (n/2+1).
+ * @param imag      Buffer de partes imaginárias (n/2+1).
+ * @param magnitude Buffer de saída para as n/2+1 magnitudes.
+ * @param n         Tamanho da transformada real.
+ */
+void calculate_magnitude_rfft(const float *real, const float *imag, float *magnitude, size_t n);
+
+/**
+ * @brief Calcula as frequências dos n/2+1 bins produzidos pela rfft.
+ * @param magnitude    Array com magnitudes da rfft.
+ * @param frequency    Buffer onde serão armazenadas as n/2+1 frequências.
+ * @param n            Tamanho da transformada real.
+ * @param sample_rate  Taxa de amostragem em Hz.
+ * @return 0 em sucesso, -1 em erro.
+ */
+float frequency_rfft(const float *magnitude, float *frequency, size_t n, int sample_rate);
+
+/**
+ * @brief Estimador Harmonic Product Spectrum sobre as magnitudes da rfft.
+ *        O produto dos espectros decimados por 1..harmonics é feito como soma de logs.
+ */
+typedef struct {
+    size_t fft_size;        // n da rfft que gera as magnitudes
+    float sample_rate;      // Hz
+    size_t bins;            // n/2 + 1
+    size_t harmonics;       // Espectros no produto (1: pico simples)
+    size_t k_min, k_max;    // Faixa de busca da fundamental (bins)
+    size_t candidates;      // Candidatos na grade de 1/HPS_GRID bin entre k_min e k_max
+    float *log_mag;         // Scratch: log das magnitudes até harmonics * k_max + 1
+    float *hps;             // Scratch: soma dos logs por candidato
+    float salience;         // Energia nos harmônicos / energia na faixa, da última estimativa
+} hps_t;
+
+/**
+ * @brief Prepara o estimador HPS.
+ *
+ * @param hps         Ponteiro para o estimador.
+ * @param fft_size    Tamanho da rfft (as magnitudes têm fft_size/2 + 1 bins).
+ * @param sample_rate Taxa de amostragem em Hz.
+ * @param harmonics   Espectros no produto (>= 1).
+ * @param f_min       Menor fundamental buscada (Hz).
+ * @param f_max       Maior fundamental buscada (Hz; limitada para o último harmônico caber no espectro).
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t hps_init(hps_t *hps, size_t fft_size, float sample_rate, size_t harmonics, float f_min, float f_max);
+
+/**
+ * @brief Estima a fundamental: produto dos espectros decimados, pico, correção de oitava
+ *        e interpolação parabólica dos picos dos harmônicos.
+ *
+ * @param hps       Ponteiro para o estimador.
+ * @param magnitude fft_size/2 + 1 magnitudes (ex.: calculate_magnitude_rfft).
+ * @param frequency Frequência estimada em Hz (-1 sem pitch).
+ * @return int      0 se uma frequência foi estimada, -1 caso contrário.
+ */
+int hps_detect(hps_t *hps, const float *magnitude, float *frequency);
+
+/**
+ * @brief Confiança da última estimativa (fração da energia da faixa nos harmônicos, 0..1).
+ */
+float hps_confidence(const hps_t *hps);
+
+/**
+ * @brief Libera o scratch do estimador.
+ */
+void hps_deinit(hps_t *hps);
+
 #endif // FFT_H
@@ -3,6 +3,8 @@
 #define FILTERS_H
 
 #include <stddef.h>
+#include "esp_err.h"
+#include "def.h"
 
 /**
  * @brief Estrutura para armazenar estado de um filtro BiQuad
@@ -42,4 +44,123 @@ void bandpass_init(biquad_t *filter, float sampleRate, float fLow, float fHigh);
  */
 void biquad_process(biquad_t *filter, const float *in, float *out, size_t length);
 
+/**
+ * @brief Cascata de seções de 2ª ordem (SOS). Cada seção é um biquad_t, cujo layout
+ *        {b0, b1, b2, a1, a2, z1, z2} coincide com os vetores coef[5] e w[2] do dsps_biquad_f32.
+ */
+typedef struct {
+    biquad_t sections[FILTER_SOS_MAX_SECTIONS];
+    size_t num_sections;
+} sos_filter_t;
+
+/**
+ * @brief Tipo de resposta dos projetos de SOS.
+ */
+typedef enum {
+    SOS_LOWPASS = 0,
+    SOS_HIGHPASS,
+    SOS_BANDPASS,                   // Protótipo de ordem N gera um passa-banda de ordem 2N (N seções)
+} sos_band_t;
+
+/**
+ * @brief Projeta um Butterworth (bilinear com pré-distorção) como cascata de SOS.
+ *
+ * @param f           Ponteiro para a cascata (substituída).
+ * @param band        Passa-baixa, passa-alta ou passa-banda.
+ * @param order       Ordem do protótipo (1..FILTER_SOS_MAX_SECTIONS, até 2x para LP/HP).
+ * @param sample_rate Taxa de amostragem em Hz.
+ * @param f1          Corte (LP/HP) ou borda inferior (BP) em Hz.
+ * @param f2          Borda superior (BP) em Hz; ignorado para LP/HP.
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t sos_design_butterworth(sos_filter_t *f, sos_band_t band, int order,
+                                 float sample_rate, float f1, float f2);
+
+/**
+ * @brief Projeta um Chebyshev tipo I (ripple na banda passante) como cascata de SOS.
+ *
+ * @param f           Ponteiro para a cascata (substituída).
+ * @param band        Passa-baixa, passa-alta ou passa-banda.
+ * @param order       Ordem do protótipo.
+ * @param ripple_db   Ripple máximo na banda passante em dB (> 0).
+ * @param sample_rate Taxa de amostragem em Hz.
+ * @param f1          Borda da banda passante (LP/HP) ou borda inferior (BP) em Hz.
+ * @param f2          Borda superior (BP) em Hz; ignorado para LP/HP.
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t sos_design_chebyshev1(sos_filter_t *f, sos_band_t band, int order, float ripple_db,
+                                float sample_rate, float f1, float f2);
+
+/**
+ * @brief Preset: bloqueador de DC de 1ª ordem, y[n] = x[n] - x[n-1] + R*y[n-1].
+ *
+ * @param f           Ponteiro para a cascata (substituída).
+ * @param sample_rate Taxa de amostragem em Hz.
+ * @param cutoff      Frequência de -3 dB em Hz (ex.: 10 Hz).
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t sos_dc_blocker(sos_filter_t *f, float sample_rate, float cutoff);
+
+/**
+ * @brief Preset: notches anti-zumbido na frequência da rede e harmônicos.
+ *
+ * @param f           Ponteiro para a cascata (substituída).
+ * @param sample_rate Taxa de amostragem em Hz.
+ * @param mains_hz    Frequência da rede (50 ou 60 Hz).
+ * @param harmonics   Número de notches (f, 2f, ...), até FILTER_SOS_MAX_SECTIONS.
+ * @param q           Fator Q de cada notch.
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t sos_hum_notch(sos_filter_t *f, float sample_rate, float mains_hz, int harmonics, float q);
+
+/**
+ * @brief Concatena as seções de src ao fim de dst (ex.: passa-banda + notch).
+ *
+ * @param dst Cascata de destino.
+ * @param src Cascata de origem.
+ * @return esp_err_t ESP_OK em sucesso, ESP_ERR_INVALID_SIZE se exceder FILTER_SOS_MAX_SECTIONS.
+ */
+esp_err_t sos_append(sos_filter_t *dst, const sos_filter_t *src);
+
+/**
+ * @brief Filtro de entrada do pipeline: passa-banda Butterworth [f_low, f_high] de ordem
+ *        2*FILTER_BANDPASS_ORDER e, com FILTER_HUM_HZ > 0, os notches da rede.
+ *
+ * @param f           Ponteiro para a cascata.
+ * @param sample_rate Taxa de amostragem em Hz.
+ * @param f_low       Borda inferior em Hz.
+ * @param f_high      Borda superior em Hz.
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t sos_input_filter_init(sos_filter_t *f, float sample_rate, float f_low, float f_high);
+
+/**
+ * @brief Zera os estados de todas as seções.
+ *
+ * @param f Ponteiro para a cascata.
+ */
+void sos_reset(sos_filter_t *f);
+
+/**
+ * @brief Aplica a cascata a um bloco (in-place permitido). Portátil: seções processadas
+ *        aos pares com defasagem de uma amostra, para as duas recorrências se sobreporem;
+ *        esp-dsp: dsps_biquad_f32 por seção.
+ *
+ * @param f      Ponteiro para a cascata.
+ * @param in     Buffer de entrada.
+ * @param out    Buffer de saída.
+ * @param length Número de amostras.
+ */
+void sos_process(sos_filter_t *f, const float *in, float *out, size_t length);
+
+/**
+ * @brief Módulo da resposta em frequência da cascata.
+ *
+ * @param f           Ponteiro para a cascata.
+ * @param freq        Frequência em Hz.
+ * @param sample_rate Taxa de amostragem em Hz.
+ * @return float      |H(e^jw)|.
+ */
+float sos_magnitude(const sos_filter_t *f, float freq, float sample_rate);
+
 #endif // FILTERS_H
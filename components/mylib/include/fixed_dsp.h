@@ -0,0 +1,190 @@
+// include/fixed_dsp.h
+#ifndef FIXED_DSP_H
+#define FIXED_DSP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "filters.h"
+#include "gate.h"
+
+/**
+ * @brief Tipos de ponto fixo: Q15 (int16, [-1, 1)) e Q31 (int32, [-1, 1)).
+ */
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+#define FX_Q30_ONE          (1 << 30)  // 1.0 em Q30 (coeficientes de biquad: faixa [-2, 2))
+
+/**
+ * @brief Converte float em [-1, 1) para Q31 (com saturação).
+ */
+static inline q31_t fx_float_to_q31(float x) {
+    if (x >= 1.0f)  return INT32_MAX;
+    if (x < -1.0f)  return INT32_MIN;
+    return (q31_t)(x * 2147483648.0f);
+}
+
+/**
+ * @brief Converte Q31 para float.
+ */
+static inline float fx_q31_to_float(q31_t x) {
+    return (float)x * (1.0f / 2147483648.0f);
+}
+
+/**
+ * @brief Janela em Q15 pré-computada para um comprimento fixo.
+ */
+typedef struct {
+    q15_t *table;                   // Coeficientes da janela em Q15
+    size_t length;                  // Comprimento da janela
+    int window_type;                // window_type_t
+} fx_window_t;
+
+/**
+ * @brief Biquad em ponto fixo (forma direta I), coeficientes em Q30 e estados em Q31.
+ */
+typedef struct {
+    q31_t b0, b1, b2;               // Coeficientes do numerador (Q30)
+    q31_t a1, a2;                   // Coeficientes do denominador (Q30)
+    q31_t x1, x2;                   // Entradas anteriores (Q31)
+    q31_t y1, y2;                   // Saídas anteriores (Q31)
+} biquad_q31_t;
+
+/**
+ * @brief Cascata de biquads Q31 (convertida de um sos_filter_t).
+ */
+typedef struct {
+    biquad_q31_t sections[FILTER_SOS_MAX_SECTIONS];
+    size_t num_sections;
+} sos_q31_t;
+
+/**
+ * @brief Tabelas da FFT em ponto flutuante de bloco (Q15, dados intercalados re/im).
+ */
+typedef struct {
+    size_t n;                       // Tamanho da FFT (potência de 2)
+    q15_t *twiddle;                 // n/2 pares (cos, -sin) em Q15
+    const uint16_t *bitrev;         // Tabela de bit-reversal (do plano em cache de fft.c)
+} fx_fft_t;
+
+/**
+ * @brief Converte frames brutos do INMP441 (24 bits alinhados à esquerda) para Q31.
+ *        O formato já é Q31: apenas zera os 8 bits menos significativos.
+ *
+ * @param raw    Frames int32 como vindos do DMA.
+ * @param out    Saída em Q31 (pode ser igual a raw).
+ * @param length Número de frames.
+ * @param level  Acumula soma, quadrados e pico (em unidades de fundo de escala) para o gate
+ *               de energia, ou NULL.
+ */
+void fx_i2s_to_q31(const int32_t *raw, q31_t *out, size_t length, audio_level_t *level);
+
+/**
+ * @brief Reduz Q31 para Q15 normalizando o bloco (usa toda a faixa dinâmica do Q15).
+ *
+ * @param in     Buffer em Q31.
+ * @param out    Buffer em Q15.
+ * @param length Número de amostras.
+ * @return int   Expoente do bloco: valor real = out / 2^15 * 2^expoente.
+ */
+int fx_q31_to_q15_block(const q31_t *in, q15_t *out, size_t length);
+
+/**
+ * @brief Pré-computa uma janela em Q15.
+ *
+ * @param w           Ponteiro para a janela.
+ * @param length      Comprimento da janela.
+ * @param window_type Tipo de janela (window_type_t).
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t fx_window_init(fx_window_t *w, size_t length, int window_type);
+
+/**
+ * @brief Aplica a janela Q15 a um buffer Q31 (in-place).
+ *
+ * @param w      Janela pré-computada.
+ * @param buffer Buffer Q31 com w->length amostras.
+ */
+void fx_window_apply_q31(const fx_window_t *w, q31_t *buffer);
+
+/**
+ * @brief Libera a tabela da janela.
+ *
+ * @param w Ponteiro para a janela.
+ */
+void fx_window_deinit(fx_window_t *w);
+
+/**
+ * @brief Converte um biquad em float (coeficientes já projetados) para Q31 e zera os estados.
+ *
+ * @param dst Biquad em ponto fixo.
+ * @param src Biquad em float (ex.: de bandpass_init).
+ */
+void biquad_q31_from_float(biquad_q31_t *dst, const biquad_t *src);
+
+/**
+ * @brief Aplica o biquad Q31 (acumulador de 64 bits, saída saturada).
+ *
+ * @param f      Ponteiro para o biquad.
+ * @param in     Buffer de entrada Q31.
+ * @param out    Buffer de saída Q31 (pode ser igual a in).
+ * @param length Número de amostras.
+ */
+void biquad_q31_process(biquad_q31_t *f, const q31_t *in, q31_t *out, size_t length);
+
+/**
+ * @brief Converte uma cascata SOS em float para Q31 e zera os estados.
+ *
+ * @param dst Cascata em ponto fixo.
+ * @param src Cascata em float (ex.: de sos_input_filter_init).
+ */
+void sos_q31_from_float(sos_q31_t *dst, const sos_filter_t *src);
+
+/**
+ * @brief Aplica a cascata Q31, seção por seção (in-place permitido).
+ *
+ * @param f      Ponteiro para a cascata.
+ * @param in     Buffer de entrada Q31.
+ * @param out    Buffer de saída Q31.
+ * @param length Número de amostras.
+ */
+void sos_q31_process(sos_q31_t *f, const q31_t *in, q31_t *out, size_t length);
+
+/**
+ * @brief Prepara as tabelas Q15 da FFT de tamanho n.
+ *
+ * @param fft Ponteiro para a estrutura da FFT.
+ * @param n   Tamanho (potência de 2, até 32768).
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t fx_fft_init(fx_fft_t *fft, size_t n);
+
+/**
+ * @brief FFT complexa in-place em ponto flutuante de bloco: a cada estágio o bloco
+ *        é escalado por 2^-s apenas quando necessário para evitar overflow.
+ *
+ * @param fft      Tabelas da FFT.
+ * @param data     2*n valores Q15 intercalados (re, im).
+ * @param exponent Entrada: expoente atual do bloco; saída: expoente após a FFT.
+ */
+void fx_fft_q15(const fx_fft_t *fft, q15_t *data, int *exponent);
+
+/**
+ * @brief Magnitude normalizada (como calculate_magnitude_rfft) dos bins 0..n/2.
+ *
+ * @param data      Saída de fx_fft_q15 (intercalada).
+ * @param exponent  Expoente do bloco.
+ * @param magnitude Saída com n/2 + 1 magnitudes.
+ * @param n         Tamanho da FFT.
+ */
+void fx_magnitude_q15(const q15_t *data, int exponent, float *magnitude, size_t n);
+
+/**
+ * @brief Libera as tabelas da FFT.
+ *
+ * @param fft Ponteiro para a estrutura da FFT.
+ */
+void fx_fft_deinit(fx_fft_t *fft);
+
+#endif // FIXED_DSP_H
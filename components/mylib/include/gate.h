@@ -0,0 +1,103 @@
+// include/gate.h
+#ifndef GATE_H
+#define GATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * @brief Nível de um bloco, acumulado na própria conversão das amostras do I2S
+ *        (window_and_convert / fx_i2s_to_q31): a média sai da soma, então o RMS ignora o DC.
+ */
+typedef struct {
+    float sum;                      // Soma das amostras
+    float sum_sq;                   // Soma dos quadrados
+    float peak;                     // Maior |x| (com o DC)
+    size_t count;                   // Amostras acumuladas
+} audio_level_t;
+
+/**
+ * @brief Gate de energia com histerese: abre com o RMS (sem DC) acima de open_dbfs ou com um
+ *        pico acima de peak_dbfs, e só fecha após hold_frames janelas seguidas abaixo de close_dbfs.
+ */
+typedef struct {
+    float open_dbfs;                // Abre com RMS >= open_dbfs
+    float close_dbfs;               // Fecha com RMS < close_dbfs (< open_dbfs)
+    float peak_dbfs;                // Pico que abre mesmo com RMS baixo (ataques curtos)
+    uint32_t hold_frames;           // Janelas abaixo do fechamento antes de fechar
+    bool open;
+    uint32_t below;                 // Janelas seguidas abaixo do fechamento
+    float last_rms_dbfs;            // Nível da última janela
+    uint32_t frames;                // Janelas avaliadas
+    uint32_t skipped;               // Janelas com o gate fechado (sem FFT/YIN)
+    uint32_t opens;                 // Aberturas
+} energy_gate_t;
+
+/**
+ * @brief Estatísticas do gate.
+ */
+typedef struct {
+    uint32_t frames;                // Janelas avaliadas
+    uint32_t skipped;               // Janelas descartadas como silêncio
+    uint32_t opens;                 // Aberturas (silêncio -> som)
+    float skip_ratio;               // skipped / frames
+    float last_rms_dbfs;            // Nível da última janela
+} energy_gate_stats_t;
+
+/**
+ * @brief Zera o acumulador de nível.
+ */
+void audio_level_reset(audio_level_t *level);
+
+/**
+ * @brief Acumula amostras já em float (fontes que não passam pela conversão do I2S, ex.: WAV no host).
+ */
+void audio_level_accumulate(audio_level_t *level, const float *x, size_t length);
+
+/**
+ * @brief RMS do bloco em dBFS, sem o DC (-200 para bloco vazio ou silêncio digital).
+ */
+float audio_level_rms_dbfs(const audio_level_t *level);
+
+/**
+ * @brief Pico do bloco em dBFS (-200 para bloco vazio ou silêncio digital).
+ */
+float audio_level_peak_dbfs(const audio_level_t *level);
+
+/**
+ * @brief Inicializa o gate (fechado).
+ *
+ * @param gate        Ponteiro para o gate.
+ * @param open_dbfs   RMS de abertura em dBFS.
+ * @param close_dbfs  RMS de fechamento em dBFS (<= open_dbfs).
+ * @param peak_dbfs   Pico que também abre o gate, em dBFS.
+ * @param hold_frames Janelas abaixo de close_dbfs antes de fechar.
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t energy_gate_init(energy_gate_t *gate, float open_dbfs, float close_dbfs, float peak_dbfs, uint32_t hold_frames);
+
+/**
+ * @brief Avalia uma janela.
+ *
+ * @param gate   Ponteiro para o gate.
+ * @param level  Nível acumulado na conversão da janela.
+ * @return bool  true se a janela segue para a análise, false se é silêncio.
+ */
+bool energy_gate_process(energy_gate_t *gate, const audio_level_t *level);
+
+/**
+ * @brief Lê as estatísticas do gate.
+ *
+ * @param gate  Ponteiro para o gate.
+ * @param stats Estrutura de saída.
+ */
+void energy_gate_get_stats(const energy_gate_t *gate, energy_gate_stats_t *stats);
+
+/**
+ * @brief Zera os contadores (o estado aberto/fechado é mantido).
+ */
+void energy_gate_reset_stats(energy_gate_t *gate);
+
+#endif // GATE_H
@@ -3,6 +3,7 @@
 #define MIC_H
 
 #include "def.h"
+#include "audio_ring.h"
 
 /**
  * @brief Inicializa o I2S para ler dados do INMP441.
@@ -18,6 +19,31 @@ esp_err_t i2s_init(void);
  */
 size_t i2s_read_samples(float *buffer, size_t length);
 
+/**
+ * @brief Lê frames do I2S diretamente para o ring (sem cópia nem conversão).
+ * @param ring    Ring de destino (lado produtor)
+ * @param frames  Número máximo de frames a ler
+ * @param timeout Timeout de cada leitura do canal
+ * @return Número de frames escritos (menor que frames se o ring encher).
+ */
+size_t i2s_read_to_ring(audio_ring_t *ring, size_t frames, TickType_t timeout);
+
+/**
+ * @brief Lê e descarta frames do I2S, mantendo o DMA drenado quando não há onde guardá-los.
+ * @param length  Número de frames a descartar
+ * @param timeout Timeout de cada leitura do canal
+ * @return Número de frames descartados.
+ */
+size_t i2s_discard_samples(size_t length, TickType_t timeout);
+
+/**
+ * @brief Converte frames brutos (24 bits em slot de 32) para float normalizado.
+ * @param raw    Frames int32 como vindos do DMA
+ * @param out    Buffer de saída em [-1, +1]
+ * @param length Número de frames
+ */
+void i2s_convert_samples(const int32_t *raw, float *out, size_t length);
+
 /**
  * @brief Libera os recursos alocados para o canal I2S.
  */
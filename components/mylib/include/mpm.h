@@ -0,0 +1,90 @@
+// include/mpm.h
+#ifndef MPM_H
+#define MPM_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "def.h"
+#include "fixed_dsp.h"
+
+/**
+ * @brief McLeod Pitch Method: NSDF n(tau) = 2 r(tau) / m(tau), com r(tau) por FFT
+ *        (mesma autocorrelação do backend YIN_DIFF_FFT) e m(tau) por somas prefixas de x^2.
+ *        O período é o primeiro pico-chave acima de k x o maior pico-chave.
+ */
+typedef struct {
+    size_t buffer_size;             // Amostras por janela
+    float sample_rate;              // Hz
+    float k;                        // Fração do maior pico-chave aceita (MPM_K)
+    float min_clarity;              // NSDF mínima no pico escolhido
+    size_t tau_min, tau_max;        // Faixa de busca atual (mpm_set_search_range)
+    size_t tau_min_limit;           // Faixa de mpm_init
+    size_t tau_max_limit;
+    size_t fft_size;                // Potência de 2 >= buffer_size + tau_max + 1
+    float *fft_real;                // Scratch da autocorrelação (próprio ou compartilhado)
+    float *fft_imag;
+    bool fft_shared;                // Scratch externo: não liberado por mpm_deinit
+    float *nsdf;                    // n(tau) para tau em [0, tau_max_limit + 1]
+    float *energy;                  // Somas prefixas de x^2 (buffer_size + 1)
+    float clarity;                  // n(tau) no pico aceito na última janela (0: sem pitch)
+} mpm_t;
+
+/**
+ * @brief Tamanho da FFT da autocorrelação para buffer_size amostras a sample_rate
+ *        (o mesmo do YIN com YIN_DIFF_FFT, para os dois dividirem o scratch).
+ */
+size_t mpm_fft_size(size_t buffer_size, float sample_rate);
+
+/**
+ * @brief Inicializa o MPM.
+ *
+ * @param mpm          Ponteiro para o estado.
+ * @param buffer_size  Amostras por janela.
+ * @param sample_rate  Taxa de amostragem em Hz.
+ * @param k            Fração do maior pico-chave aceita (0..1).
+ * @param min_clarity  NSDF mínima no pico escolhido (0..1).
+ * @param fft_real     Scratch externo (mpm_fft_size floats) ou NULL para alocar um próprio.
+ * @param fft_imag     Idem, parte imaginária.
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t mpm_init(mpm_t *mpm, size_t buffer_size, float sample_rate, float k, float min_clarity,
+                   float *fft_real, float *fft_imag);
+
+/**
+ * @brief Detecta a fundamental de uma janela.
+ *
+ * @param mpm          Ponteiro para o estado.
+ * @param buffer       buffer_size amostras.
+ * @param frequency    Frequência detectada em Hz (-1 sem pitch).
+ * @return int         0 se uma frequência foi detectada, -1 caso contrário.
+ */
+int mpm_detect_pitch(mpm_t *mpm, const float *buffer, float *frequency);
+
+/**
+ * @brief mpm_detect_pitch sobre amostras Q15 (convertidas direto no scratch da FFT).
+ */
+int mpm_detect_pitch_q15(mpm_t *mpm, const q15_t *buffer, float *frequency);
+
+/**
+ * @brief Restringe a faixa de busca a [f_min, f_max] (dentro da faixa de mpm_init);
+ *        valores <= 0 restauram o limite correspondente.
+ */
+esp_err_t mpm_set_search_range(mpm_t *mpm, float f_min, float f_max);
+
+/**
+ * @brief Volta à faixa completa e descarta a última estimativa.
+ */
+void mpm_reset(mpm_t *mpm);
+
+/**
+ * @brief Confiança da última estimativa (clarity: NSDF no pico, 0..1).
+ */
+float mpm_confidence(const mpm_t *mpm);
+
+/**
+ * @brief Libera os buffers (o scratch externo não é liberado).
+ */
+void mpm_deinit(mpm_t *mpm);
+
+#endif // MPM_H
@@ -0,0 +1,73 @@
+// include/parallel.h
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "esp_err.h"
+#include "def.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <pthread.h>
+#endif
+
+/**
+ * @brief Job particionado: cada parte (0..num_parts-1) roda uma vez, em paralelo.
+ *        A parte 0 roda na task chamadora.
+ */
+typedef void (*par_job_fn_t)(void *ctx, size_t part, size_t num_parts);
+
+/**
+ * @brief Executor fork-join com workers persistentes.
+ *        No alvo: tasks FreeRTOS fixadas nos outros núcleos, disparo e join por notificação.
+ *        No host: pthreads com mutex/condição.
+ */
+typedef struct {
+    size_t num_workers;             // Partes por job (inclui a task chamadora)
+    par_job_fn_t fn;                // Job corrente
+    void *ctx;
+    _Atomic size_t pending;         // Partes ainda em execução nos workers
+    _Atomic bool stop;              // Pedido de encerramento dos workers
+#ifdef ESP_PLATFORM
+    TaskHandle_t caller;            // Task que aguarda o join
+    TaskHandle_t tasks[PAR_MAX_WORKERS - 1];
+#else
+    pthread_t threads[PAR_MAX_WORKERS - 1];
+    pthread_mutex_t lock;
+    pthread_cond_t start_cv;        // Novo job (ou stop)
+    pthread_cond_t done_cv;         // pending chegou a zero
+    unsigned generation;            // Incrementado a cada job
+#endif
+} par_executor_t;
+
+/**
+ * @brief Cria os workers (num_workers - 1; com 1 o job roda inteiro na chamadora).
+ *
+ * @param ex          Ponteiro para o executor.
+ * @param num_workers Partes por job (1..PAR_MAX_WORKERS).
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t par_executor_init(par_executor_t *ex, size_t num_workers);
+
+/**
+ * @brief Executa fn em num_workers partes e retorna quando todas terminarem.
+ *        Não reentrante: um job por vez por executor.
+ *
+ * @param ex  Ponteiro para o executor (NULL: roda a parte única na chamadora).
+ * @param fn  Job.
+ * @param ctx Contexto repassado a cada parte.
+ */
+void par_executor_run(par_executor_t *ex, par_job_fn_t fn, void *ctx);
+
+/**
+ * @brief Encerra os workers e libera o executor.
+ *
+ * @param ex Ponteiro para o executor.
+ */
+void par_executor_deinit(par_executor_t *ex);
+
+#endif // PARALLEL_H
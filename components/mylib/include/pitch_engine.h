@@ -0,0 +1,156 @@
+// include/pitch_engine.h
+#ifndef PITCH_ENGINE_H
+#define PITCH_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "def.h"
+#include "yin.h"
+#include "mpm.h"
+
+/**
+ * @brief Detectores de pitch no domínio do tempo (PITCH_DETECTOR em def.h).
+ */
+typedef enum {
+    PITCH_DETECTOR_YIN = 0,
+    PITCH_DETECTOR_MPM,
+    PITCH_DETECTOR_COUNT
+} pitch_detector_t;
+
+/**
+ * @brief Parâmetros comuns aos motores (cada motor usa os seus).
+ */
+typedef struct {
+    size_t buffer_size;             // Amostras por janela
+    float sample_rate;              // Hz
+    float yin_threshold;            // YIN: threshold fixo
+    yin_threshold_mode_t yin_mode;  // YIN: fixo ou adaptativo
+    float yin_adaptive_min;         // YIN: faixa e passo do threshold adaptativo
+    float yin_adaptive_max;
+    float yin_adaptive_step;
+    yin_diff_method_t yin_diff;     // YIN: YIN_DIFF_FFT usa o scratch compartilhado
+    float mpm_k;                    // MPM: fração do maior pico-chave
+    float mpm_min_clarity;          // MPM: NSDF mínima no pico
+} pitch_engine_config_t;
+
+/**
+ * @brief Configuração padrão a partir de def.h.
+ */
+#define PITCH_ENGINE_CONFIG_DEFAULT(n, rate) {   \
+    .buffer_size = (n),                          \
+    .sample_rate = (rate),                       \
+    .yin_threshold = YIN_THRESHOLD,              \
+    .yin_mode = YIN_THRESHOLD_FIXED,             \
+    .yin_adaptive_min = 0.02f,                   \
+    .yin_adaptive_max = 0.1f,                    \
+    .yin_adaptive_step = 0.01f,                  \
+    .yin_diff = YIN_DIFF_METHOD,                 \
+    .mpm_k = MPM_K,                              \
+    .mpm_min_clarity = MPM_MIN_CLARITY,          \
+}
+
+/**
+ * @brief Scratch da autocorrelação por FFT, dividido pelos motores (só um roda por vez).
+ */
+typedef struct {
+    size_t fft_size;
+    float *real;
+    float *imag;
+} pitch_scratch_t;
+
+/**
+ * @brief Interface de um motor de pitch sobre uma janela de amostras.
+ */
+typedef struct {
+    const char *name;
+    esp_err_t (*init)(void *state, const pitch_engine_config_t *cfg, pitch_scratch_t *scratch);
+    int (*process_frame)(void *state, const float *frame, float *frequency);        // 0 com pitch, -1 sem
+    int (*process_frame_q15)(void *state, const q15_t *frame, float *frequency);
+    void (*reset)(void *state);                                                     // Entre notas/fontes
+    float (*get_confidence)(const void *state);                                     // Última janela, 0..1
+    esp_err_t (*set_search_range)(void *state, float f_min, float f_max);           // Hz; <= 0 restaura
+    void (*deinit)(void *state);
+} pitch_engine_ops_t;
+
+/**
+ * @brief Conjunto de motores inicializados juntos, com troca em tempo de execução.
+ *        A troca pedida por pitch_engine_select (qualquer task) vale a partir da próxima
+ *        janela processada, sem alocação.
+ */
+typedef struct {
+    pitch_scratch_t scratch;
+    Yin yin;
+    mpm_t mpm;
+    void *states[PITCH_DETECTOR_COUNT];
+    volatile pitch_detector_t requested;
+    pitch_detector_t active;
+    uint32_t switches;              // Trocas aplicadas
+} pitch_engine_t;
+
+/**
+ * @brief Interface de um detector (NULL se id inválido).
+ */
+const pitch_engine_ops_t *pitch_engine_ops(pitch_detector_t id);
+
+/**
+ * @brief Inicializa todos os motores sobre um scratch de autocorrelação compartilhado.
+ *
+ * @param pe       Ponteiro para o conjunto.
+ * @param cfg      Parâmetros (PITCH_ENGINE_CONFIG_DEFAULT).
+ * @param initial  Detector ativo no início.
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t pitch_engine_init(pitch_engine_t *pe, const pitch_engine_config_t *cfg, pitch_detector_t initial);
+
+/**
+ * @brief Pede a troca do detector ativo (aplicada na próxima janela, com reset do novo motor).
+ */
+esp_err_t pitch_engine_select(pitch_engine_t *pe, pitch_detector_t id);
+
+/**
+ * @brief Detector ativo.
+ */
+pitch_detector_t pitch_engine_active(const pitch_engine_t *pe);
+
+/**
+ * @brief Nome do detector ativo.
+ */
+const char *pitch_engine_name(const pitch_engine_t *pe);
+
+/**
+ * @brief Detecta a fundamental de uma janela com o detector ativo.
+ *
+ * @param pe        Ponteiro para o conjunto.
+ * @param frame     buffer_size amostras.
+ * @param frequency Frequência em Hz (-1 sem pitch).
+ * @return int      0 se uma frequência foi detectada, -1 caso contrário.
+ */
+int pitch_engine_process(pitch_engine_t *pe, const float *frame, float *frequency);
+
+/**
+ * @brief pitch_engine_process sobre amostras Q15.
+ */
+int pitch_engine_process_q15(pitch_engine_t *pe, const q15_t *frame, float *frequency);
+
+/**
+ * @brief Confiança da última janela do detector ativo (0..1).
+ */
+float pitch_engine_confidence(const pitch_engine_t *pe);
+
+/**
+ * @brief Restringe a faixa de busca do detector ativo (ex.: pré-estimativa do HPS).
+ */
+esp_err_t pitch_engine_set_search_range(pitch_engine_t *pe, float f_min, float f_max);
+
+/**
+ * @brief Reset do detector ativo.
+ */
+void pitch_engine_reset(pitch_engine_t *pe);
+
+/**
+ * @brief Libera os motores e o scratch.
+ */
+void pitch_engine_deinit(pitch_engine_t *pe);
+
+#endif // PITCH_ENGINE_H
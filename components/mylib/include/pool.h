@@ -0,0 +1,98 @@
+// include/pool.h
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "esp_err.h"
+
+/**
+ * @brief Índice de um bloco do pool (é o que trafega pelas filas).
+ */
+typedef uint16_t pool_index_t;
+
+#define POOL_INVALID_INDEX ((pool_index_t)0xFFFF)   // Pool esgotado / índice inválido
+#define POOL_MAX_CAPACITY  (0xFFFE)                 // Capacidade máxima de um pool
+
+/**
+ * @brief Estatísticas de um pool de blocos.
+ */
+typedef struct {
+    uint32_t capacity;      // Número total de blocos
+    uint32_t in_use;        // Blocos atualmente emprestados
+    uint32_t high_water;    // Máximo de blocos emprestados simultaneamente
+    uint32_t exhausted;     // Tentativas de aquisição com o pool vazio
+    uint32_t acquired;      // Total de aquisições bem-sucedidas
+} block_pool_stats_t;
+
+/**
+ * @brief Pool de blocos de tamanho fixo, pré-alocados em um único slab,
+ *        com free-list lock-free (pilha de Treiber com tag contra ABA).
+ */
+typedef struct {
+    const char *name;                 // Nome para logs
+    uint8_t *slab;                    // Memória contígua dos blocos
+    size_t block_size;                // Tamanho de cada bloco (alinhado a 8 bytes)
+    uint16_t capacity;                // Número de blocos
+    _Atomic uint16_t *next;           // Encadeamento da free-list
+    _Atomic uint32_t head;            // Topo da free-list: [tag:16 | índice:16]
+    _Atomic uint32_t in_use;          // Blocos emprestados
+    _Atomic uint32_t high_water;      // Pico de blocos emprestados
+    _Atomic uint32_t exhausted;       // Aquisições que falharam
+    _Atomic uint32_t acquired;        // Aquisições bem-sucedidas
+} block_pool_t;
+
+/**
+ * @brief Pré-aloca o slab do pool (chamar apenas na inicialização).
+ *
+ * @param pool       Ponteiro para o pool.
+ * @param name       Nome do pool para logs.
+ * @param block_size Tamanho de cada bloco em bytes.
+ * @param capacity   Número de blocos.
+ * @param caps       Capacidades de memória (ex.: MALLOC_CAP_SPIRAM).
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t block_pool_init(block_pool_t *pool, const char *name, size_t block_size, size_t capacity, uint32_t caps);
+
+/**
+ * @brief Retira um bloco livre do pool (lock-free, não bloqueia).
+ *
+ * @param pool Ponteiro para o pool.
+ * @return pool_index_t Índice do bloco, ou POOL_INVALID_INDEX se o pool estiver vazio.
+ */
+pool_index_t block_pool_acquire(block_pool_t *pool);
+
+/**
+ * @brief Devolve um bloco ao pool.
+ *
+ * @param pool Ponteiro para o pool.
+ * @param idx  Índice obtido por block_pool_acquire.
+ */
+void block_pool_release(block_pool_t *pool, pool_index_t idx);
+
+/**
+ * @brief Retorna o endereço do bloco de índice idx.
+ *
+ * @param pool Ponteiro para o pool.
+ * @param idx  Índice do bloco.
+ * @return void* Ponteiro para o bloco, ou NULL se o índice for inválido.
+ */
+void *block_pool_get(const block_pool_t *pool, pool_index_t idx);
+
+/**
+ * @brief Lê as estatísticas do pool.
+ *
+ * @param pool  Ponteiro para o pool.
+ * @param stats Estrutura de saída.
+ */
+void block_pool_get_stats(block_pool_t *pool, block_pool_stats_t *stats);
+
+/**
+ * @brief Libera o slab do pool.
+ *
+ * @param pool Ponteiro para o pool.
+ */
+void block_pool_deinit(block_pool_t *pool);
+
+#endif // POOL_H
@@ -0,0 +1,183 @@
+// include/stage_graph.h
+#ifndef STAGE_GRAPH_H
+#define STAGE_GRAPH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "esp_err.h"
+#include "def.h"
+#include "pool.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/queue.h"
+#else
+#include <pthread.h>
+#endif
+
+#define STAGE_NO_AFFINITY   (-1)        // Estágio sem núcleo fixo
+#define STAGE_INPUT(id)     (1u << (id)) // Bit do estágio id na máscara de entradas
+
+/**
+ * @brief Corpo de um estágio, chamado uma vez por frame.
+ *        Fonte com dependentes: preenche o frame recém-retirado do pool e retorna true para
+ *        entregá-lo ao grafo (false devolve o frame). Fonte sem dependentes: roda em laço com
+ *        frame NULL (ex.: captura para o ring). Demais estágios: o retorno é ignorado.
+ *
+ * @param ctx      Contexto do estágio.
+ * @param frame    Bloco do frame (NULL em fonte sem dependentes).
+ * @param frame_id Sequência do frame (correlaciona os eventos de trace).
+ */
+typedef bool (*stage_fn_t)(void *ctx, void *frame, uint32_t frame_id);
+
+/**
+ * @brief Espera opcional de uma fonte pela entrada externa (ex.: janela no ring), antes de
+ *        retirar o frame do pool. Fica fora do tempo ocupado do estágio.
+ *
+ * @param ctx Contexto do estágio.
+ * @return bool true quando há entrada; false para tentar de novo (o stop é verificado entre tentativas).
+ */
+typedef bool (*stage_wait_fn_t)(void *ctx);
+
+/**
+ * @brief Declaração de um estágio. As entradas só podem citar estágios declarados antes,
+ *        o que garante um grafo acíclico.
+ */
+typedef struct {
+    const char *name;
+    stage_fn_t fn;
+    void *ctx;
+    stage_wait_fn_t wait;           // Só fontes (pode ser NULL)
+    uint32_t inputs;                // Máscara de ids dos estágios de entrada (0: fonte)
+    int core;                       // Núcleo da task, ou STAGE_NO_AFFINITY
+    UBaseType_t priority;
+    uint32_t stack;
+} stage_desc_t;
+
+/**
+ * @brief Estatísticas de um estágio desde o último stage_graph_reset_stats.
+ */
+typedef struct {
+    uint32_t frames;                // Chamadas de fn
+    uint32_t queue_depth;           // Frames aguardando na fila de entrada agora
+    uint32_t queue_high_water;      // Pico da fila de entrada
+    uint32_t starved;               // Fontes: esperas por frame livre no pool
+    uint64_t busy_us;               // Tempo dentro de fn (sem a espera de desc.wait)
+    float utilization;              // busy_us / tempo decorrido (0..1 por núcleo)
+} stage_stats_t;
+
+#ifndef ESP_PLATFORM
+/**
+ * @brief Fila de índices do host (mutex/condição; capacidade fixa).
+ */
+typedef struct {
+    pool_index_t *items;
+    size_t capacity, head, count;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+} stage_queue_t;
+#endif
+
+struct stage_graph;
+
+/**
+ * @brief Estado por estágio (uso interno).
+ */
+typedef struct {
+    stage_desc_t desc;
+    struct stage_graph *graph;
+    uint32_t dependents;            // Estágios que consomem a saída deste
+    uint8_t num_inputs;
+#ifdef ESP_PLATFORM
+    QueueHandle_t queue;            // pool_index_t dos frames prontos para o estágio
+    TaskHandle_t task;
+#else
+    stage_queue_t queue;
+    pthread_t thread;
+#endif
+    _Atomic uint32_t frames;
+    _Atomic uint32_t high_water;
+    _Atomic uint32_t starved;
+    _Atomic uint64_t busy_us;
+} stage_t;
+
+/**
+ * @brief Runtime de grafo de estágios: uma task por estágio, frames de um pool de blocos
+ *        trafegando por índice. Um estágio recebe o frame quando todas as entradas terminaram,
+ *        então estágios independentes (ex.: FFT e YIN) processam o mesmo frame em paralelo
+ *        em núcleos diferentes, e frames consecutivos se sobrepõem em pipeline.
+ */
+typedef struct stage_graph {
+    stage_t stages[STAGE_GRAPH_MAX_STAGES];
+    size_t num_stages;
+    int source;                     // Estágio que produz os frames (-1: nenhum)
+    uint32_t sinks;                 // Estágios sem dependentes que recebem frames
+    block_pool_t frames;
+    _Atomic uint8_t *remaining;     // [frame][estágio]: entradas que faltam terminar
+    _Atomic uint8_t *sinks_left;    // [frame]: sinks que faltam terminar
+    uint32_t *frame_ids;            // [frame]: sequência atribuída pela fonte
+    _Atomic bool running;
+    size_t num_tasks;               // Tasks criadas por stage_graph_start
+    _Atomic size_t alive;           // Tasks ainda em execução
+    _Atomic int64_t stats_start_us;
+} stage_graph_t;
+
+/**
+ * @brief Inicializa um grafo vazio com o pool de frames.
+ *
+ * @param g          Ponteiro para o grafo.
+ * @param frame_size Tamanho de cada frame em bytes.
+ * @param num_frames Frames em trânsito (profundidade do pipeline).
+ * @param caps       Capacidades de memória do pool (ex.: MALLOC_CAP_SPIRAM).
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t stage_graph_init(stage_graph_t *g, size_t frame_size, size_t num_frames, uint32_t caps);
+
+/**
+ * @brief Declara um estágio (antes de stage_graph_start).
+ *
+ * @param g    Ponteiro para o grafo.
+ * @param desc Declaração (copiada).
+ * @return int Id do estágio (bit para as máscaras de entrada), ou -1 em erro.
+ */
+int stage_graph_add(stage_graph_t *g, const stage_desc_t *desc);
+
+/**
+ * @brief Cria as filas e as tasks dos estágios.
+ *
+ * @param g Ponteiro para o grafo.
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t stage_graph_start(stage_graph_t *g);
+
+/**
+ * @brief Handle da task de um estágio (ex.: para xTaskNotifyGive); NULL no host.
+ */
+TaskHandle_t stage_graph_task(const stage_graph_t *g, int stage);
+
+/**
+ * @brief Lê as estatísticas de um estágio.
+ *
+ * @param g     Ponteiro para o grafo.
+ * @param stage Id do estágio.
+ * @param stats Estrutura de saída.
+ */
+void stage_graph_get_stats(stage_graph_t *g, int stage, stage_stats_t *stats);
+
+/**
+ * @brief Zera as estatísticas e reinicia a janela de utilização.
+ */
+void stage_graph_reset_stats(stage_graph_t *g);
+
+/**
+ * @brief Para as tasks (as fontes terminam a chamada em curso) e libera filas e pool.
+ *
+ * @param g Ponteiro para o grafo.
+ */
+void stage_graph_deinit(stage_graph_t *g);
+
+#endif // STAGE_GRAPH_H
@@ -0,0 +1,152 @@
+// include/telemetry.h
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/*
+ * Frame binário (little-endian), escrito de uma vez na UART/USB-CDC:
+ *
+ *   off  tam  campo
+ *    0    2   sync 0xA5 0x5A
+ *    2    1   versão (TELEM_VERSION)
+ *    3    1   flags (TELEM_FLAG_*)
+ *    4    2   bytes de payload (depois do cabeçalho, antes do CRC)
+ *    6    4   sequência
+ *   10    4   timestamp (µs, 32 bits inferiores do esp_timer)
+ *   14    4   fundamental (float32, Hz; -1 sem pitch)
+ *   18    2   cents (int16, centésimos de cent)
+ *   20    1   nota (MIDI; TELEM_NOTE_NONE sem nota)
+ *   21    1   confiança (0..255 -> 0..1)
+ *   22    -   payload: espectro e/ou amostras, cada vetor como
+ *               u16 n + (float32 escala + n x int16)   ou   u16 n + n x float16 (TELEM_FLAG_HALF)
+ *    -    2   CRC-16/CCITT-FALSE de [2, fim do payload)
+ *
+ * O sync e o CRC permitem ressincronizar num stream misturado com logs de texto.
+ */
+#define TELEM_SYNC0         0xA5
+#define TELEM_SYNC1         0x5A
+#define TELEM_VERSION       1
+#define TELEM_HEADER_SIZE   22
+#define TELEM_CRC_SIZE      2
+#define TELEM_NOTE_NONE     0xFF
+#define TELEM_MAX_VECTOR    8192        // Maior vetor aceito pelo decodificador
+
+#define TELEM_FLAG_SPECTRUM (1u << 0)   // Carrega o espectro de magnitude
+#define TELEM_FLAG_SAMPLES  (1u << 1)   // Carrega as amostras no tempo
+#define TELEM_FLAG_HALF     (1u << 2)   // Vetores em float16 (senão int16 com escala por vetor)
+#define TELEM_FLAG_SILENCE  (1u << 3)   // Janela silenciosa (gate de energia fechado): só o cabeçalho
+
+/**
+ * @brief Conteúdo de um frame (entrada do codificador, saída do decodificador).
+ */
+typedef struct {
+    uint8_t flags;                  // TELEM_FLAG_*
+    uint32_t seq;
+    uint32_t timestamp_us;
+    float fundamental;              // Hz (-1: sem pitch)
+    float cents;                    // Desvio em relação à nota
+    uint8_t note;                   // MIDI (TELEM_NOTE_NONE: sem nota)
+    float confidence;               // 0..1
+    float *spectrum;                // Com TELEM_FLAG_SPECTRUM
+    size_t spectrum_len;
+    float *samples;                 // Com TELEM_FLAG_SAMPLES
+    size_t samples_len;
+} telem_frame_t;
+
+/**
+ * @brief Estatísticas do decodificador de stream.
+ */
+typedef struct {
+    uint32_t frames;                // Frames válidos entregues
+    uint32_t crc_errors;            // Frames descartados por CRC ou formato inválido
+    uint32_t bytes_skipped;         // Bytes fora de frames (logs de texto, lixo)
+    uint32_t seq_gaps;              // Frames perdidos segundo a sequência
+} telem_stats_t;
+
+/**
+ * @brief Chamado para cada frame válido; os vetores e raw valem só durante a chamada.
+ *
+ * @param frame   Frame decodificado.
+ * @param raw     Bytes do frame como chegaram (regravação/replay sem recodificar).
+ * @param raw_len Tamanho de raw.
+ * @param user    Repassado de telem_decoder_push.
+ */
+typedef void (*telem_frame_cb_t)(const telem_frame_t *frame, const uint8_t *raw, size_t raw_len, void *user);
+
+/**
+ * @brief Decodificador incremental: aceita pedaços arbitrários do stream.
+ */
+typedef struct {
+    uint8_t *buf;                   // Bytes pendentes (no máximo um frame)
+    size_t len;
+    size_t capacity;
+    float *spectrum;                // Vetores decodificados
+    float *samples;
+    size_t max_vector;
+    bool have_seq;
+    uint32_t last_seq;
+    telem_stats_t stats;
+} telem_decoder_t;
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poli 0x1021), continuando de crc (0xFFFF no início).
+ */
+uint16_t telem_crc16(const uint8_t *data, size_t len, uint16_t crc);
+
+/**
+ * @brief Tamanho em bytes do frame codificado.
+ */
+size_t telem_frame_size(const telem_frame_t *frame);
+
+/**
+ * @brief Codifica um frame.
+ *
+ * @param frame Conteúdo.
+ * @param out   Destino.
+ * @param cap   Capacidade de out.
+ * @return size_t Bytes escritos, ou 0 em erro.
+ */
+size_t telem_encode(const telem_frame_t *frame, uint8_t *out, size_t cap);
+
+/**
+ * @brief Decodifica um frame completo que começa em buf[0] (com sync).
+ *
+ * @param buf      Bytes do frame.
+ * @param len      Bytes disponíveis.
+ * @param frame    Saída; spectrum/samples devem apontar para buffers de max_vector floats.
+ * @param max_vector Capacidade dos vetores de frame.
+ * @return int     Bytes consumidos (> 0), 0 se faltam bytes, -1 se inválido.
+ */
+int telem_decode(const uint8_t *buf, size_t len, telem_frame_t *frame, size_t max_vector);
+
+/**
+ * @brief Aloca o decodificador de stream.
+ *
+ * @param dec        Ponteiro para o decodificador.
+ * @param max_vector Maior vetor aceito (<= TELEM_MAX_VECTOR).
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t telem_decoder_init(telem_decoder_t *dec, size_t max_vector);
+
+/**
+ * @brief Consome bytes do stream e chama cb para cada frame válido.
+ *
+ * @param dec  Ponteiro para o decodificador.
+ * @param data Bytes recebidos.
+ * @param len  Número de bytes.
+ * @param cb   Callback por frame.
+ * @param user Repassado a cb.
+ * @return size_t Frames entregues nesta chamada.
+ */
+size_t telem_decoder_push(telem_decoder_t *dec, const uint8_t *data, size_t len, telem_frame_cb_t cb, void *user);
+
+/**
+ * @brief Libera o decodificador.
+ */
+void telem_decoder_deinit(telem_decoder_t *dec);
+
+#endif // TELEMETRY_H
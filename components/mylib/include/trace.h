@@ -0,0 +1,125 @@
+// include/trace.h
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "def.h"
+
+/**
+ * @brief Estágios instrumentados do pipeline de áudio.
+ */
+typedef enum {
+    TRACE_STAGE_CAPTURE = 0,        // capture: leitura do I2S para o ring
+    TRACE_STAGE_CONVERT,            // condition: view do ring -> float/Q31
+    TRACE_STAGE_WINDOW,             // Janela
+    TRACE_STAGE_BANDPASS,           // Filtro passa-banda
+    TRACE_STAGE_FFT,                // FFT
+    TRACE_STAGE_MAGNITUDE,          // Magnitude do espectro
+    TRACE_STAGE_DECIMATE,           // Decimação antes do YIN
+    TRACE_STAGE_YIN,                // Detecção de pitch
+    TRACE_STAGE_HPS,                // Harmonic Product Spectrum (PITCH_ENGINE_HPS / PITCH_ENGINE_HPS_YIN)
+    TRACE_STAGE_TUNER,              // Banco de Goertzel do afinador (PITCH_ENGINE_TUNER)
+    TRACE_STAGE_NOTE,               // Frequências dos bins e frequência -> nota
+    TRACE_STAGE_EMIT,               // emit: saída pela UART
+    TRACE_STAGE_COUNT
+} trace_stage_t;
+
+/**
+ * @brief Evento de trace (cópia consistente obtida por trace_snapshot).
+ */
+typedef struct {
+    uint32_t start_us;              // Início (esp_timer, 32 bits inferiores)
+    uint32_t dur_us;                // Duração
+    uint32_t frame;                 // Identificador do bloco/janela
+    uint8_t stage;                  // trace_stage_t
+} trace_event_t;
+
+/**
+ * @brief Aloca o ring de eventos (realoca se já inicializado).
+ *
+ * @param capacity Número de eventos (potência de 2).
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t trace_init(size_t capacity);
+
+/**
+ * @brief Habilita/desabilita a gravação (desabilitado, trace_end só retorna).
+ */
+void trace_set_enabled(bool enabled);
+
+/**
+ * @brief Timestamp atual em microssegundos, para passar a trace_end.
+ */
+static inline uint32_t trace_begin(void) {
+    return (uint32_t)esp_timer_get_time();
+}
+
+/**
+ * @brief Grava um evento [start_us, agora) no ring. Lock-free, seguro entre núcleos.
+ *
+ * @param stage    Estágio.
+ * @param frame    Identificador do bloco/janela.
+ * @param start_us Valor retornado por trace_begin.
+ */
+void trace_end(trace_stage_t stage, uint32_t frame, uint32_t start_us);
+
+/**
+ * @brief Copia os eventos válidos mais recentes, do mais antigo ao mais novo.
+ *
+ * @param out     Vetor de saída.
+ * @param max_out Capacidade de out.
+ * @return size_t Número de eventos copiados.
+ */
+size_t trace_snapshot(trace_event_t *out, size_t max_out);
+
+/**
+ * @brief Descarta os eventos gravados.
+ */
+void trace_reset(void);
+
+/**
+ * @brief Nome do estágio (ex.: "fft").
+ */
+const char *trace_stage_name(trace_stage_t stage);
+
+/**
+ * @brief Exporta no formato Chrome trace-event (abrir em chrome://tracing ou Perfetto).
+ *
+ * @param out Destino (ex.: stdout).
+ * @return size_t Número de eventos exportados.
+ */
+size_t trace_export_chrome(FILE *out);
+
+/**
+ * @brief Exporta em CSV: stage;frame;start_us;dur_us.
+ *
+ * @param out Destino (ex.: stdout).
+ * @return size_t Número de eventos exportados.
+ */
+size_t trace_export_csv(FILE *out);
+
+/**
+ * @brief Imprime por estágio: contagem, média, p95 e máximo das durações no ring.
+ *
+ * @param out Destino (ex.: stdout).
+ */
+void trace_print_summary(FILE *out);
+
+/**
+ * @brief Libera o ring de eventos.
+ */
+void trace_deinit(void);
+
+// Instrumentação que some por completo com TRACE_ENABLED 0
+#if TRACE_ENABLED
+#define TRACE_BEGIN()                       trace_begin()
+#define TRACE_END(stage, frame, start)      trace_end((stage), (frame), (start))
+#else
+#define TRACE_BEGIN()                       (0u)
+#define TRACE_END(stage, frame, start)      do { (void)(frame); (void)(start); } while (0)
+#endif
+
+#endif // TRACE_H
@@ -11,6 +11,8 @@ typedef struct {
     char note[8];   // Nome da nota (ex: "A4")
     int octave;     // Oitava da nota
     float frequency; // Frequência mapeada da nota
+    int midi;       // Número MIDI da nota (A4 = 69)
+    float cents;    // Desvio da frequência de entrada em relação à nota (-50..50)
 } note_t;
 
 /**
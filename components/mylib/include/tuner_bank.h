@@ -0,0 +1,84 @@
+// include/tuner_bank.h
+#ifndef TUNER_BANK_H
+#define TUNER_BANK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "def.h"
+#include "tuner.h"
+
+/**
+ * @brief Afinação alvo de um instrumento (notas MIDI das cordas, na ordem das cordas).
+ */
+typedef struct {
+    const char *name;
+    size_t count;
+    int midi[TUNER_MAX_STRINGS];
+} tuner_instrument_t;
+
+/**
+ * @brief Banco de Goertzel do modo afinador: só as cordas do instrumento e seus harmônicos são
+ *        avaliados em cada janela (já com a janela Hann), sem FFT nem busca de lag.
+ *        A corda é a de maior média geométrica da potência nos harmônicos; a frequência sai da
+ *        interpolação de três filtros espaçados de um bin (Hann) em torno da fundamental e,
+ *        depois, do harmônico mais forte.
+ */
+typedef struct {
+    float sample_rate;              // Hz
+    size_t length;                  // Amostras por janela
+    float bin_hz;                   // sample_rate / length (espaçamento dos filtros de interpolação)
+    float range_cents;              // Desvio máximo aceito em relação à corda
+    float min_confidence;           // Fração mínima da energia da janela nos harmônicos da corda
+    size_t count;                   // Cordas
+    int midi[TUNER_MAX_STRINGS];
+    float target_hz[TUNER_MAX_STRINGS];
+    size_t harmonics[TUNER_MAX_STRINGS];                // Harmônicos abaixo de Nyquist por corda
+    float coeff[TUNER_MAX_STRINGS][TUNER_MAX_HARMONICS]; // 2 cos(w) de cada harmônico alvo
+    float power[TUNER_MAX_STRINGS][TUNER_MAX_HARMONICS]; // Potência normalizada da última janela (1 = toda a energia)
+    int string;                     // Corda da última estimativa (-1 sem nota)
+    float confidence;               // Energia nos harmônicos da corda / energia da janela (0..1)
+    size_t filters;                 // Filtros de Goertzel avaliados na última janela
+} tuner_bank_t;
+
+/**
+ * @brief Afinação pelo nome ("guitar", "bass", "ukulele", "violin", "cavaquinho"); NULL se desconhecida.
+ */
+const tuner_instrument_t *tuner_instrument_find(const char *name);
+
+/**
+ * @brief Prepara o banco para as cordas de um instrumento.
+ *
+ * @param tb           Ponteiro para o banco.
+ * @param instrument   Afinação alvo (tuner_instrument_find).
+ * @param length       Amostras por janela.
+ * @param sample_rate  Taxa de amostragem em Hz.
+ * @param harmonics    Harmônicos por corda (1..TUNER_MAX_HARMONICS).
+ * @param range_cents  Desvio máximo aceito em relação à corda (cents).
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t tuner_bank_init(tuner_bank_t *tb, const tuner_instrument_t *instrument, size_t length,
+                          float sample_rate, size_t harmonics, float range_cents);
+
+/**
+ * @brief Estima a corda e a afinação de uma janela.
+ *
+ * @param tb         Ponteiro para o banco.
+ * @param frame      length amostras com a janela Hann já aplicada.
+ * @param frequency  Fundamental em Hz (-1 sem nota).
+ * @param note       Corda alvo (note, octave, frequency, midi) e desvio em cents em relação a ela.
+ * @return int       0 se uma corda foi reconhecida, -1 caso contrário.
+ */
+int tuner_bank_process(tuner_bank_t *tb, const float *frame, float *frequency, note_t *note);
+
+/**
+ * @brief Confiança da última estimativa (0..1).
+ */
+float tuner_bank_confidence(const tuner_bank_t *tb);
+
+/**
+ * @brief Filtros de Goertzel avaliados na última janela (custo, em passadas de length amostras).
+ */
+size_t tuner_bank_filters_evaluated(const tuner_bank_t *tb);
+
+#endif // TUNER_BANK_H
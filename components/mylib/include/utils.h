@@ -4,6 +4,18 @@
 
 #include <stddef.h>
 #include "def.h"
+#include "gate.h"
+
+/**
+ * @brief Tipos de janela (valores aceitos por apply_window e window_get).
+ */
+typedef enum {
+    WINDOW_RECTANGULAR = 0,
+    WINDOW_HANN = 1,
+    WINDOW_HAMMING = 2,
+    WINDOW_BLACKMAN_HARRIS = 3,     // 4 termos, lóbulos laterais ~ -92 dB
+    WINDOW_KAISER = 4,              // Beta = WINDOW_KAISER_BETA
+} window_type_t;
 
 /**
  * @brief Estrutura para armazenar estado de um filtro BiQuad
@@ -54,16 +66,45 @@ void add_noise(float *buffer, size_t size, float amplitude);
 void log_heap_usage(void);
 
 /**
- * @brief Aplica uma janela no buffer de entrada.
+ * @brief Função de Bessel modificada de primeira espécie, ordem zero (janelas Kaiser).
+ *
+ * @param x Argumento.
+ * @return double I0(x).
+ */
+double bessel_i0(double x);
+
+/**
+ * @brief Retorna a tabela em cache da janela (tipo, tamanho), criando-a na primeira chamada.
+ *
+ * @param window_type Tipo de janela (window_type_t).
+ * @param length      Tamanho da janela.
+ * @return const float* Tabela com length coeficientes, ou NULL para retangular/erro.
+ */
+const float *window_get(int window_type, size_t length);
+
+/**
+ * @brief Aplica uma janela no buffer de entrada (tabela do cache de janelas).
  *
  * @param buffer        Buffer de amostras.
  * @param length        Tamanho do buffer.
- * @param window_type   Tipo de janela (0: Retangular, 1: Hann, 2: Hamming).
- * @param hann_table    Tabela da janela Hann pré-computada (para tipos que utilizam).
- * @param hamming_table Tabela da janela Hamming pré-computada (para tipos que utilizam).
+ * @param window_type   Tipo de janela (window_type_t).
  */
 void apply_window(float *buffer, size_t length, int window_type);
 
+/**
+ * @brief Converte frames int32 do I2S (24 bits alinhados à esquerda) para float
+ *        e aplica a janela na mesma passada.
+ *
+ * @param raw    Frames do I2S.
+ * @param window Coeficientes da janela para estes frames (ex.: window_get(...) + offset),
+ *               ou NULL para janela retangular.
+ * @param out    Saída em float, em [-1, 1).
+ * @param length Número de frames.
+ * @param level  Acumula soma, quadrados e pico das amostras antes da janela (gate de energia),
+ *               ou NULL.
+ */
+void window_and_convert(const int32_t *raw, const float *window, float *out, size_t length, audio_level_t *level);
+
 /**
  * @brief Atualiza o filtro de suavização com um novo valor e retorna a média suavizada.
  *
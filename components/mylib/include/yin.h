@@ -4,6 +4,8 @@
 
 #include "def.h"
 #include "utils.h"
+#include "fixed_dsp.h"
+#include "parallel.h"
 #include "esp_err.h"
 
 /**
@@ -14,6 +16,24 @@ typedef enum {
     YIN_THRESHOLD_ADAPTIVE
 } yin_threshold_mode_t;
 
+/**
+ * @brief Backends disponíveis para o cálculo da função de diferença d(tau).
+ */
+typedef enum {
+    YIN_DIFF_DIRECT = 0,                  // Laço direto O(N * tau_max)
+    YIN_DIFF_FFT                          // Energias menos 2x autocorrelação via FFT, O(M log M)
+} yin_diff_method_t;
+
+#define YIN_MAX_CANDIDATES 8              // Limite de candidatos da busca hierárquica
+
+/**
+ * @brief Estratégia de busca do lag em yin_detect_pitch.
+ */
+typedef enum {
+    YIN_SEARCH_EXHAUSTIVE = 0,            // d(tau) em todos os lags de tau_min a tau_max
+    YIN_SEARCH_HIERARCHICAL,              // d(tau) numa cópia decimada, refinamento só perto dos melhores vales
+    YIN_SEARCH_EARLY_EXIT                 // d(tau) e d'(tau) na mesma passada, até o primeiro mínimo abaixo do threshold
+} yin_search_t;
 
 /**
  * @brief Estrutura de configuração e estado para o algoritmo YIN.
@@ -30,8 +50,47 @@ typedef struct {
     float *cumulative_mean_difference;    // Buffer para a função de diferença média cumulativa
     size_t tau_min;                       // Lag mínimo para busca de pitch
     size_t tau_max;                       // Lag máximo para busca de pitch
+    size_t tau_min_limit;                 // Faixa de yin_init (yin_set_search_range só a estreita)
+    size_t tau_max_limit;
+    yin_diff_method_t diff_method;        // Backend da função de diferença
+    size_t fft_size;                      // Tamanho da FFT da autocorrelação (0 no backend direto)
+    float *fft_real;                      // Scratch pré-alocado da FFT (parte real)
+    float *fft_imag;                      // Scratch pré-alocado da FFT (parte imaginária)
+    bool fft_shared;                      // Scratch de yin_set_fft_scratch (não liberado por yin_deinit)
+    yin_search_t search;                  // Estratégia de busca (yin_set_hierarchical)
+    size_t coarse_factor;                 // Decimação da cópia usada na busca grossa
+    size_t coarse_candidates;             // Vales da busca grossa refinados na resolução cheia
+    size_t refine_radius;                 // Lags (resolução cheia) avaliados de cada lado do candidato
+    float *coarse_buf;                    // Scratch: sinal decimado, d(T) e soma cumulativa grossos
+    size_t taus_evaluated;                // Lags avaliados na última janela (todas as estratégias)
+    float aperiodicity;                   // d' no vale aceito na última janela (1: sem pitch)
+    par_executor_t *executor;             // Divide os laços diretos de d(tau) entre núcleos (NULL: serial)
+    bool tracking;                        // Busca restrita em torno do período anterior (yin_set_tracking)
+    float track_ratio;                    // 2^(semitons / 12): janela [T / ratio, T * ratio]
+    float *track_energy;                  // Scratch: somas prefixas de x^2 (buffer_size + 1)
+    bool locked;                          // Travado numa nota: a próxima janela avalia só a vizinhança
+    float track_period;                   // Período (lags) da última detecção travada
+    float track_scale;                    // Média de d por unidade de e1 + e2, medida ao travar
+    size_t track_base;                    // tau_min da busca completa que travou (início da média cumulativa)
+    float track_last_energy;              // Energia da janela anterior (detecção de ataque)
+    uint32_t track_frames;                // Janelas processadas com o rastreamento ativo
+    uint32_t track_tracked;               // Janelas resolvidas só na vizinhança
+    uint32_t track_locks;                 // Travamentos (busca completa confiante)
+    uint32_t track_unlocks;               // Perdas de trava (vale fora da janela, oitava acima ou ataque)
+    uint64_t track_taus;                  // Lags avaliados somados nessas janelas
 } yin_config_t;
 
+/**
+ * @brief Estatísticas do modo de rastreamento (yin_set_tracking).
+ */
+typedef struct {
+    uint32_t frames;                      // Janelas processadas
+    uint32_t tracked;                     // Janelas resolvidas só na vizinhança do período anterior
+    uint32_t locks;                       // Travamentos
+    uint32_t unlocks;                     // Perdas de trava (seguidas de busca completa na mesma janela)
+    float avg_taus;                       // Lags avaliados por janela, em média
+} yin_tracking_stats_t;
+
 /**
  * @brief Estrutura encapsulada para o algoritmo YIN.
  */
@@ -40,6 +99,18 @@ typedef struct {
     yin_threshold_mode_t threshold_mode;  // Modo de threshold (fixo ou adaptativo)
 } Yin;
 
+/**
+ * @brief Estado do modo streaming (janela deslizante) do YIN.
+ */
+typedef struct {
+    Yin yin;                              // Instância YIN (configuração e buffers de diferença)
+    float *window;                        // Últimas buffer_size amostras recebidas
+    size_t hop_size;                      // Amostras por atualização
+    size_t filled;                        // Amostras já acumuladas na janela
+    size_t resync_interval;               // Saltos entre recálculos completos de d(tau) (0: nunca)
+    size_t hops_since_resync;             // Saltos desde o último recálculo completo
+} yin_stream_t;
+
 /**
  * @brief Inicializa a configuração do algoritmo YIN.
  *
@@ -51,9 +122,10 @@ typedef struct {
  * @param adaptive_min Threshold mínimo para adaptativo.
  * @param adaptive_max Threshold máximo para adaptativo.
  * @param adaptive_step Passo de ajuste para adaptativo.
+ * @param diff_method  Backend da função de diferença (YIN_DIFF_DIRECT ou YIN_DIFF_FFT).
  * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
  */
-esp_err_t yin_init(Yin *yin, size_t buffer_size, float sample_rate, float threshold, yin_threshold_mode_t mode, float adaptive_min, float adaptive_max, float adaptive_step);
+esp_err_t yin_init(Yin *yin, size_t buffer_size, float sample_rate, float threshold, yin_threshold_mode_t mode, float adaptive_min, float adaptive_max, float adaptive_step, yin_diff_method_t diff_method);
 
 /**
  * @brief Executa o algoritmo YIN para detectar a frequência fundamental.
@@ -65,6 +137,127 @@ esp_err_t yin_init(Yin *yin, size_t buffer_size, float sample_rate, float thresh
  */
 int yin_detect_pitch(Yin *yin, const float *buffer, float *frequency);
 
+/**
+ * @brief Ativa a busca hierárquica (coarse-to-fine) em yin_detect_pitch: d(T) numa cópia
+ *        decimada por factor encontra os vales, e só as vizinhanças dos candidates mais
+ *        profundos são avaliadas na resolução cheia. factor <= 1 ou candidates == 0 volta
+ *        à busca exaustiva.
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param factor       Decimação da busca grossa.
+ * @param candidates   Número de vales refinados.
+ * @param radius       Lags avaliados de cada lado de cada candidato (>= factor / 2).
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t yin_set_hierarchical(Yin *yin, size_t factor, size_t candidates, size_t radius);
+
+/**
+ * @brief Ativa/desativa a busca com saída antecipada em yin_detect_pitch: d(tau), média
+ *        cumulativa e d'(tau) na mesma passada (laço direto), parando no primeiro mínimo
+ *        local abaixo do threshold. Desativar volta à busca exaustiva.
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param enabled      true para ativar.
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t yin_set_early_exit(Yin *yin, bool enabled);
+
+/**
+ * @brief Divide os laços diretos de d(tau) (backend YIN_DIFF_DIRECT e Q15) entre as partes
+ *        do executor: cada parte avalia os lags tau_min + k, tau_min + k + partes, ...
+ *        O backend FFT e as buscas hierárquica/antecipada seguem seriais.
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param executor     Executor já inicializado (NULL volta ao laço serial).
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t yin_set_executor(Yin *yin, par_executor_t *executor);
+
+/**
+ * @brief Ativa/desativa o rastreamento em yin_detect_pitch/yin_detect_pitch_q15: após uma
+ *        detecção com confiança >= YIN_TRACK_MIN_CONFIDENCE, as próximas janelas avaliam só os
+ *        lags a ±semitones do período anterior (e uma guarda em torno da metade dele, contra o
+ *        salto de oitava acima). Vale fora da janela, guarda abaixo do threshold ou ataque
+ *        (energia > YIN_TRACK_ONSET_RATIO x a anterior) destravam e refazem a busca completa
+ *        na mesma janela. Não vale para yin_stream.
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param enabled      true para ativar (zera as estatísticas).
+ * @param semitones    Meia largura da janela, em semitons (0 < semitones < 6).
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t yin_set_tracking(Yin *yin, bool enabled, float semitones);
+
+/**
+ * @brief Lê as estatísticas do rastreamento.
+ *
+ * @param yin   Ponteiro para a estrutura Yin.
+ * @param stats Estrutura de saída.
+ */
+void yin_get_tracking_stats(const Yin *yin, yin_tracking_stats_t *stats);
+
+/**
+ * @brief Lags avaliados na última chamada de detecção (para medir a economia das buscas).
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @return size_t      Número de lags (resolução cheia e grossa somados na busca hierárquica).
+ */
+size_t yin_taus_evaluated(const Yin *yin);
+
+/**
+ * @brief Restringe a faixa de busca a [f_min, f_max] (dentro da faixa de yin_init) para as
+ *        próximas janelas de yin_detect_pitch/yin_detect_pitch_q15; o custo do laço direto
+ *        cai com o maior lag. Valores <= 0 restauram o limite correspondente.
+ *        Com f_max > 0 a média cumulativa de d' começa no novo tau_min (normalização diferente).
+ *        Não usar com yin_stream (d(tau) incremental).
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param f_min        Menor frequência (Hz) -> maior lag.
+ * @param f_max        Maior frequência (Hz) -> menor lag.
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t yin_set_search_range(Yin *yin, float f_min, float f_max);
+
+/**
+ * @brief Passa o backend para YIN_DIFF_FFT usando um scratch externo (ex.: a autocorrelação
+ *        compartilhada dos motores de pitch). O scratch próprio, se houver, é liberado; o
+ *        externo não é liberado por yin_deinit e não pode ser usado por outro módulo durante
+ *        yin_detect_pitch.
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param real         Scratch da FFT (parte real), fft_size floats.
+ * @param imag         Scratch da FFT (parte imaginária), fft_size floats.
+ * @param fft_size     Potência de 2 >= buffer_size + tau_max + 1.
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t yin_set_fft_scratch(Yin *yin, float *real, float *imag, size_t fft_size);
+
+/**
+ * @brief Volta ao estado de yin_init entre notas/fontes: faixa de busca completa, threshold
+ *        adaptativo no máximo e sem estimativa anterior (destrava o rastreamento).
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ */
+void yin_reset(Yin *yin);
+
+/**
+ * @brief Confiança da última estimativa: 1 - d' no vale aceito (0 sem pitch, ~1 periódico puro).
+ *
+ * @param yin Ponteiro para a estrutura Yin.
+ * @return float Confiança em [0, 1].
+ */
+float yin_confidence(const Yin *yin);
+
+/**
+ * @brief YIN sobre amostras Q15 (função de diferença com acumulador inteiro).
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param buffer       Buffer de entrada em Q15 (buffer_size amostras).
+ * @param frequency    Ponteiro para armazenar a frequência detectada em Hz.
+ * @return int          0 se uma frequência foi detectada, -1 caso contrário.
+ */
+int yin_detect_pitch_q15(Yin *yin, const q15_t *buffer, float *frequency);
+
 /**
  * @brief Libera os recursos alocados pelo algoritmo YIN.
  *
@@ -72,4 +265,45 @@ int yin_detect_pitch(Yin *yin, const float *buffer, float *frequency);
  */
 void yin_deinit(Yin *yin);
 
+/**
+ * @brief Inicializa o modo streaming (janela deslizante) do YIN.
+ *
+ * @param stream       Ponteiro para a estrutura yin_stream_t.
+ * @param window_size  Tamanho da janela de análise (equivalente ao buffer_size do YIN em bloco).
+ * @param hop_size     Número de amostras por atualização (salto).
+ * @param sample_rate  Taxa de amostragem em Hz.
+ * @param threshold    Threshold para detecção de pitch.
+ * @param mode         Modo de threshold (fixo ou adaptativo).
+ * @param adaptive_min Threshold mínimo para adaptativo.
+ * @param adaptive_max Threshold máximo para adaptativo.
+ * @param adaptive_step Passo de ajuste para adaptativo.
+ * @param diff_method  Backend usado nos recálculos completos de d(tau).
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t yin_stream_init(yin_stream_t *stream, size_t window_size, size_t hop_size, float sample_rate, float threshold, yin_threshold_mode_t mode, float adaptive_min, float adaptive_max, float adaptive_step, yin_diff_method_t diff_method);
+
+/**
+ * @brief Insere hop_size novas amostras e atualiza d(tau) incrementalmente.
+ *
+ * @param stream       Ponteiro para a estrutura yin_stream_t.
+ * @param hop          Buffer com hop_size novas amostras.
+ * @param frequency    Ponteiro para armazenar a frequência detectada em Hz.
+ * @return int          0 se uma frequência foi detectada, -1 caso contrário (inclusive enquanto a janela enche).
+ */
+int yin_stream_push(yin_stream_t *stream, const float *hop, float *frequency);
+
+/**
+ * @brief Descarta o histórico da janela deslizante.
+ *
+ * @param stream       Ponteiro para a estrutura yin_stream_t.
+ */
+void yin_stream_reset(yin_stream_t *stream);
+
+/**
+ * @brief Libera os recursos alocados pelo modo streaming do YIN.
+ *
+ * @param stream       Ponteiro para a estrutura yin_stream_t.
+ */
+void yin_stream_deinit(yin_stream_t *stream);
+
 #endif // YIN_H
@@ -0,0 +1,136 @@
+// src/audio_ring.c
+#include "audio_ring.h"
+#include "def.h"
+#include "esp_log.h"
+
+static const char *TAG_RING = "RING";
+
+/**
+ * @brief Aloca o armazenamento do ring.
+ *
+ * @param ring     Ponteiro para o ring.
+ * @param capacity Capacidade em frames (potência de 2).
+ * @param caps     Capacidades de memória (ex.: MALLOC_CAP_SPIRAM).
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t audio_ring_init(audio_ring_t *ring, size_t capacity, uint32_t caps) {
+    if (!ring || capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        ESP_LOGE(TAG_RING, "Parâmetros inválidos passados para audio_ring_init.");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ring->frames = (int32_t *)heap_caps_malloc(capacity * sizeof(int32_t), caps);
+    if (!ring->frames) {
+        ESP_LOGE(TAG_RING, "Falha ao alocar ring de %zu frames.", capacity);
+        return ESP_ERR_NO_MEM;
+    }
+    ring->capacity = capacity;
+    ring->mask = capacity - 1;
+    atomic_init(&ring->write_pos, 0);
+    atomic_init(&ring->read_pos, 0);
+
+    ESP_LOGI(TAG_RING, "Ring de áudio com %zu frames.", capacity);
+    return ESP_OK;
+}
+
+/**
+ * @brief (Produtor) Obtém o maior trecho contíguo livre para escrita.
+ *
+ * @param ring Ponteiro para o ring.
+ * @param dst  Recebe o ponteiro para o início do trecho.
+ * @return size_t Frames disponíveis no trecho (0 se o ring estiver cheio).
+ */
+size_t audio_ring_write_acquire(audio_ring_t *ring, int32_t **dst) {
+    uint32_t w = atomic_load_explicit(&ring->write_pos, memory_order_relaxed);
+    uint32_t r = atomic_load_explicit(&ring->read_pos, memory_order_acquire);
+    size_t free_frames = ring->capacity - (size_t)(w - r);
+    size_t offset = w & ring->mask;
+    size_t contiguous = ring->capacity - offset;
+
+    *dst = &ring->frames[offset];
+    return (free_frames < contiguous) ? free_frames : contiguous;
+}
+
+/**
+ * @brief (Produtor) Publica frames escritos no trecho obtido por audio_ring_write_acquire.
+ *
+ * @param ring   Ponteiro para o ring.
+ * @param frames Número de frames escritos.
+ */
+void audio_ring_write_commit(audio_ring_t *ring, size_t frames) {
+    uint32_t w = atomic_load_explicit(&ring->write_pos, memory_order_relaxed);
+    atomic_store_explicit(&ring->write_pos, w + (uint32_t)frames, memory_order_release);
+}
+
+/**
+ * @brief Frames disponíveis para leitura.
+ *
+ * @param ring Ponteiro para o ring.
+ * @return size_t Frames escritos e ainda não consumidos.
+ */
+size_t audio_ring_available(audio_ring_t *ring) {
+    uint32_t w = atomic_load_explicit(&ring->write_pos, memory_order_acquire);
+    uint32_t r = atomic_load_explicit(&ring->read_pos, memory_order_relaxed);
+    return (size_t)(w - r);
+}
+
+/**
+ * @brief (Consumidor) Obtém uma view das próximas length frames sem consumi-las.
+ *
+ * @param ring   Ponteiro para o ring.
+ * @param length Tamanho da janela em frames.
+ * @param view   View de saída.
+ * @return true se havia frames suficientes, false caso contrário.
+ */
+bool audio_ring_peek(audio_ring_t *ring, size_t length, audio_ring_view_t *view) {
+    if (!ring || !view || length > ring->capacity) {
+        return false;
+    }
+    if (audio_ring_available(ring) < length) {
+        return false;
+    }
+
+    uint32_t r = atomic_load_explicit(&ring->read_pos, memory_order_relaxed);
+    size_t offset = r & ring->mask;
+    size_t contiguous = ring->capacity - offset;
+
+    view->first = &ring->frames[offset];
+    if (length <= contiguous) {
+        view->first_len = length;
+        view->second = NULL;
+        view->second_len = 0;
+    } else {
+        view->first_len = contiguous;
+        view->second = ring->frames;
+        view->second_len = length - contiguous;
+    }
+    return true;
+}
+
+/**
+ * @brief (Consumidor) Libera frames lidos (avança a janela pelo hop).
+ *
+ * @param ring   Ponteiro para o ring.
+ * @param frames Número de frames a consumir.
+ */
+void audio_ring_consume(audio_ring_t *ring, size_t frames) {
+    size_t available = audio_ring_available(ring);
+    if (frames > available) {
+        frames = available;
+    }
+    uint32_t r = atomic_load_explicit(&ring->read_pos, memory_order_relaxed);
+    atomic_store_explicit(&ring->read_pos, r + (uint32_t)frames, memory_order_release);
+}
+
+/**
+ * @brief Libera o armazenamento do ring.
+ *
+ * @param ring Ponteiro para o ring.
+ */
+void audio_ring_deinit(audio_ring_t *ring) {
+    if (ring && ring->frames) {
+        heap_caps_free(ring->frames);
+        ring->frames = NULL;
+        ring->capacity = 0;
+    }
+}
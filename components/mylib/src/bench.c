@@ -0,0 +1,896 @@
+// src/bench.c
+#include "bench.h"
+#include "def.h"
+#include "fft.h"
+#include "utils.h"
+#include "filters.h"
+#include "yin.h"
+#include "mpm.h"
+#include "pitch_engine.h"
+#include "decimator.h"
+#include "parallel.h"
+#include "tuner.h"
+#include "tuner_bank.h"
+#include "fixed_dsp.h"
+#include "esp_log.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+#endif
+
+static const char *TAG_BENCH = "BENCH";
+
+/* ----------------------------------------------------------------
+ *  Backend de tempo: contador de ciclos no alvo, clock_gettime no host
+ * ---------------------------------------------------------------- */
+#ifdef ESP_PLATFORM
+#define BENCH_BACKEND   "cycles"
+#define BENCH_CPU_MHZ   CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+
+static inline uint32_t bench_ticks(void) {
+    return (uint32_t)esp_cpu_get_cycle_count();
+}
+
+static inline double ticks_to_ns(uint64_t ticks) {
+    return (double)ticks * 1000.0 / (double)BENCH_CPU_MHZ;
+}
+#else
+#define BENCH_BACKEND   "clock_gettime"
+#define BENCH_CPU_MHZ   0
+
+static inline uint64_t bench_ticks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline double ticks_to_ns(uint64_t ticks) {
+    return (double)ticks;
+}
+#endif
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Mede um kernel: warmup, repetições até o orçamento, mediana e p99.
+ *
+ * @param name   Nome do kernel.
+ * @param n      Tamanho do problema (para ns/amostra).
+ * @param setup  Preparação antes de cada chamada, não cronometrada (pode ser NULL).
+ * @param fn     Kernel cronometrado.
+ * @param ctx    Contexto repassado a setup e fn.
+ * @param cfg    Parâmetros de medição.
+ * @param out    Resultado.
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t bench_measure(const char *name, size_t n, bench_fn_t setup, bench_fn_t fn, void *ctx,
+                        const bench_config_t *cfg, bench_result_t *out) {
+    if (!name || !fn || !cfg || !out || n == 0 || cfg->min_reps == 0) {
+        ESP_LOGE(TAG_BENCH, "Parâmetros inválidos passados para bench_measure.");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint64_t samples[BENCH_MAX_REPS];
+    size_t max_reps = cfg->max_reps < BENCH_MAX_REPS ? cfg->max_reps : BENCH_MAX_REPS;
+    size_t min_reps = cfg->min_reps < max_reps ? cfg->min_reps : max_reps;
+
+    for (size_t i = 0; i < cfg->warmup; i++) {
+        if (setup) setup(ctx);
+        fn(ctx);
+    }
+
+    size_t reps = 0;
+    int64_t start_us = esp_timer_get_time();
+    while (reps < max_reps) {
+        if (setup) setup(ctx);
+        uint64_t t0 = bench_ticks();
+        fn(ctx);
+        uint64_t t1 = bench_ticks();
+#ifdef ESP_PLATFORM
+        samples[reps++] = (uint32_t)((uint32_t)t1 - (uint32_t)t0); // Contador de 32 bits
+#else
+        samples[reps++] = t1 - t0;
+#endif
+        if (reps >= min_reps && esp_timer_get_time() - start_us > cfg->budget_us) {
+            break;
+        }
+    }
+
+    qsort(samples, reps, sizeof(samples[0]), cmp_u64);
+    uint64_t median = samples[reps / 2];
+    size_t p99_idx = (reps * 99 + 99) / 100 - 1; // ceil(0.99 * reps) - 1
+    uint64_t p99 = samples[p99_idx < reps ? p99_idx : reps - 1];
+
+    snprintf(out->name, sizeof(out->name), "%s", name);
+    out->n = n;
+    out->reps = reps;
+    out->median_ns = ticks_to_ns(median);
+    out->p99_ns = ticks_to_ns(p99);
+    out->ns_per_sample = out->median_ns / (double)n;
+    out->median_cycles = BENCH_CPU_MHZ ? median : 0;
+    return ESP_OK;
+}
+
+/* ----------------------------------------------------------------
+ *  Suíte de kernels
+ * ---------------------------------------------------------------- */
+typedef struct {
+    size_t n;
+    float *sig;                     // Sinal de teste (não modificado)
+    float *a, *b, *out;             // Operandos positivos dos *_vect
+    float *real, *imag, *mag;       // FFT complexa / magnitude
+    float *inter;                   // FFT intercalada (2n)
+    float *freqs;                   // Frequências para get_note
+    float *spec;                    // Magnitudes da rfft de sig (entrada do HPS)
+    float acc;                      // Sumidouro de resultados escalares
+    biquad_t biquad;
+    sos_filter_t sos;
+    Yin yin;
+    Yin yin_dec;                    // YIN na taxa decimada (n / YIN_DECIMATION amostras)
+    Yin yin_hier;                   // YIN com busca hierárquica
+    Yin yin_early;                  // YIN com saída antecipada
+    Yin yin_direct;                 // YIN direto serial (referência de yin_parallel)
+    Yin yin_par;                    // YIN direto dividido pelo executor
+    Yin yin_range;                  // YIN direto com o maior lag limitado pelo HPS
+    hps_t hps;
+    mpm_t mpm;
+    par_executor_t executor;        // YIN_PARALLEL_WORKERS partes
+    decimator_t dec;
+    note_t note;
+    q31_t *q31;
+    q15_t *q15;                     // 2n (FFT intercalada Q15)
+    biquad_q31_t biquad_q31;
+    fx_fft_t fx_fft;
+} bench_ctx_t;
+
+// Preparações (não cronometradas)
+static void setup_complex(void *p) {
+    bench_ctx_t *c = p;
+    memcpy(c->real, c->sig, c->n * sizeof(float));
+    memset(c->imag, 0, c->n * sizeof(float));
+}
+static void setup_inter(void *p) {
+    bench_ctx_t *c = p;
+    for (size_t i = 0; i < c->n; i++) {
+        c->inter[2 * i] = c->sig[i];
+        c->inter[2 * i + 1] = 0.0f;
+    }
+}
+static void setup_copy(void *p) {
+    bench_ctx_t *c = p;
+    memcpy(c->out, c->sig, c->n * sizeof(float));
+}
+static void setup_q15_inter(void *p) {
+    bench_ctx_t *c = p;
+    for (size_t i = 0; i < c->n; i++) {
+        c->q15[2 * i] = (q15_t)(c->sig[i] * 16384.0f);
+        c->q15[2 * i + 1] = 0;
+    }
+}
+
+// Kernels
+static void k_fft(void *p)          { bench_ctx_t *c = p; fft(c->real, c->imag, c->n); }
+static void k_fft_execute(void *p)  { bench_ctx_t *c = p; fft_execute(fft_plan_get(c->n), c->real, c->imag); }
+static void k_fft_inter(void *p)    { bench_ctx_t *c = p; fft_interleaved(c->inter, c->n); }
+static void k_rfft(void *p)         { bench_ctx_t *c = p; rfft(c->sig, c->real, c->imag, c->n); }
+static void k_magnitude(void *p)    { bench_ctx_t *c = p; calculate_magnitude(c->real, c->imag, c->mag, c->n); }
+static void k_biquad(void *p)       { bench_ctx_t *c = p; biquad_process(&c->biquad, c->sig, c->out, c->n); }
+static void k_sos(void *p)          { bench_ctx_t *c = p; sos_process(&c->sos, c->sig, c->out, c->n); }
+static void k_window(void *p)       { bench_ctx_t *c = p; apply_window(c->out, c->n, WINDOW_HANN); }
+static void k_window_convert(void *p) {
+    bench_ctx_t *c = p;
+    window_and_convert(c->q31, window_get(WINDOW_HANN, c->n), c->out, c->n, NULL);
+}
+static void k_yin(void *p)          { bench_ctx_t *c = p; float f; yin_detect_pitch(&c->yin, c->sig, &f); c->acc += f; }
+static void k_yin_hier(void *p)     { bench_ctx_t *c = p; float f; yin_detect_pitch(&c->yin_hier, c->sig, &f); c->acc += f; }
+static void k_yin_early(void *p)    { bench_ctx_t *c = p; float f; yin_detect_pitch(&c->yin_early, c->sig, &f); c->acc += f; }
+static void k_yin_direct(void *p)   { bench_ctx_t *c = p; float f; yin_detect_pitch(&c->yin_direct, c->sig, &f); c->acc += f; }
+static void k_yin_par(void *p)      { bench_ctx_t *c = p; float f; yin_detect_pitch(&c->yin_par, c->sig, &f); c->acc += f; }
+static void k_hps(void *p)          { bench_ctx_t *c = p; float f; hps_detect(&c->hps, c->spec, &f); c->acc += f; }
+static void k_mpm(void *p)          { bench_ctx_t *c = p; float f; mpm_detect_pitch(&c->mpm, c->sig, &f); c->acc += f; }
+static void k_yin_hps(void *p) {
+    bench_ctx_t *c = p;
+    float f;
+    if (hps_detect(&c->hps, c->spec, &f) == 0) {
+        yin_set_search_range(&c->yin_range, f / HPS_PRE_MARGIN, 0.0f);
+    }
+    yin_detect_pitch(&c->yin_range, c->sig, &f);
+    c->acc += f;
+}
+static void k_decimate(void *p) {
+    bench_ctx_t *c = p;
+    decimator_reset(&c->dec);
+    decimator_process(&c->dec, c->sig, c->n, c->out);
+}
+static void k_yin_decimated(void *p) {
+    bench_ctx_t *c = p;
+    float f;
+    k_decimate(p);
+    yin_detect_pitch(&c->yin_dec, c->out, &f);
+    c->acc += f;
+}
+static void k_get_note(void *p) {
+    bench_ctx_t *c = p;
+    for (size_t i = 0; i < c->n; i++) {
+        get_note(c->freqs[i], &c->note);
+    }
+}
+static void k_sub(void *p)          { bench_ctx_t *c = p; sub_vect(c->a, c->b, c->out, c->n); }
+static void k_add(void *p)          { bench_ctx_t *c = p; add_vect(c->a, c->b, c->out, c->n); }
+static void k_mult(void *p)         { bench_ctx_t *c = p; mult_vect(c->a, c->b, c->out, c->n); }
+static void k_div(void *p)          { bench_ctx_t *c = p; div_vect(c->a, c->b, c->out, c->n); }
+static void k_sum(void *p)          { bench_ctx_t *c = p; c->acc += sum_vect(c->a, c->n); }
+static void k_sqrt(void *p)         { bench_ctx_t *c = p; sqrt_vect(c->a, c->out, c->n); }
+static void k_cos(void *p)          { bench_ctx_t *c = p; cos_vect(c->a, c->out, c->n); }
+static void k_sin(void *p)          { bench_ctx_t *c = p; sin_vect(c->a, c->out, c->n); }
+static void k_log2f(void *p)        { bench_ctx_t *c = p; log2f_vect(c->a, c->out, c->n); }
+static void k_biquad_q31(void *p)   { bench_ctx_t *c = p; biquad_q31_process(&c->biquad_q31, c->q31, c->q31, c->n); }
+static void k_fft_q15(void *p)      { bench_ctx_t *c = p; int e = 0; fx_fft_q15(&c->fx_fft, c->q15, &e); }
+
+typedef struct {
+    const char *name;
+    bench_fn_t setup;
+    bench_fn_t fn;
+} bench_case_t;
+
+static const bench_case_t s_cases[] = {
+    {"fft",                 setup_complex,   k_fft},
+    {"fft_execute",         setup_complex,   k_fft_execute},
+    {"fft_interleaved",     setup_inter,     k_fft_inter},
+    {"rfft",                NULL,            k_rfft},
+    {"calculate_magnitude", NULL,            k_magnitude},
+    {"biquad_process",      NULL,            k_biquad},
+    {"sos_process",         NULL,            k_sos},
+    {"apply_window",        setup_copy,      k_window},
+    {"window_and_convert",  NULL,            k_window_convert},
+    {"yin_detect_pitch",    NULL,            k_yin},
+    {"yin_hierarchical",    NULL,            k_yin_hier},
+    {"yin_early_exit",      NULL,            k_yin_early},
+    {"yin_direct",          NULL,            k_yin_direct},
+    {"yin_parallel",        NULL,            k_yin_par},
+    {"hps_detect",          NULL,            k_hps},
+    {"yin_hps_range",       NULL,            k_yin_hps},
+    {"mpm_detect_pitch",    NULL,            k_mpm},
+    {"decimator_process",   NULL,            k_decimate},
+    {"yin_decimated",       NULL,            k_yin_decimated},
+    {"get_note",            NULL,            k_get_note},
+    {"sub_vect",            NULL,            k_sub},
+    {"add_vect",            NULL,            k_add},
+    {"mult_vect",           NULL,            k_mult},
+    {"div_vect",            NULL,            k_div},
+    {"sum_vect",            NULL,            k_sum},
+    {"sqrt_vect",           NULL,            k_sqrt},
+    {"cos_vect",            NULL,            k_cos},
+    {"sin_vect",            NULL,            k_sin},
+    {"log2f_vect",          NULL,            k_log2f},
+    {"biquad_q31_process",  NULL,            k_biquad_q31},
+    {"fx_fft_q15",          setup_q15_inter, k_fft_q15},
+};
+
+static void ctx_free(bench_ctx_t *c) {
+    float *fbufs[] = {c->sig, c->a, c->b, c->out, c->real, c->imag, c->mag, c->inter, c->freqs, c->spec};
+    for (size_t i = 0; i < sizeof(fbufs) / sizeof(fbufs[0]); i++) {
+        if (fbufs[i]) heap_caps_free(fbufs[i]);
+    }
+    if (c->q31) heap_caps_free(c->q31);
+    if (c->q15) heap_caps_free(c->q15);
+}
+
+/**
+ * @brief Executa a suíte de kernels de DSP na varredura de tamanhos de cfg.
+ *
+ * @param cfg         Parâmetros de medição e varredura.
+ * @param results     Vetor de saída.
+ * @param max_results Capacidade de results.
+ * @return size_t     Número de resultados preenchidos.
+ */
+size_t bench_run_suite(const bench_config_t *cfg, bench_result_t *results, size_t max_results) {
+    if (!cfg || !results || cfg->min_n < 2 || cfg->max_n < cfg->min_n ||
+        (cfg->min_n & (cfg->min_n - 1)) != 0 || (cfg->max_n & (cfg->max_n - 1)) != 0) {
+        ESP_LOGE(TAG_BENCH, "Parâmetros inválidos passados para bench_run_suite.");
+        return 0;
+    }
+
+    size_t max_n = cfg->max_n;
+    uint32_t caps = MALLOC_CAP_8BIT;
+    bench_ctx_t c = {0};
+    c.sig   = heap_caps_malloc(max_n * sizeof(float), caps);
+    c.a     = heap_caps_malloc(max_n * sizeof(float), caps);
+    c.b     = heap_caps_malloc(max_n * sizeof(float), caps);
+    c.out   = heap_caps_malloc(max_n * sizeof(float), caps);
+    c.real  = heap_caps_malloc(max_n * sizeof(float), caps);
+    c.imag  = heap_caps_malloc(max_n * sizeof(float), caps);
+    c.mag   = heap_caps_malloc(max_n * sizeof(float), caps);
+    c.inter = heap_caps_malloc(2 * max_n * sizeof(float), caps);
+    c.freqs = heap_caps_malloc(max_n * sizeof(float), caps);
+    c.spec  = heap_caps_malloc((max_n / 2 + 1) * sizeof(float), caps);
+    c.q31   = heap_caps_malloc(max_n * sizeof(q31_t), caps);
+    c.q15   = heap_caps_malloc(2 * max_n * sizeof(q15_t), caps);
+    if (!c.sig || !c.a || !c.b || !c.out || !c.real || !c.imag || !c.mag || !c.inter || !c.freqs || !c.spec || !c.q31 || !c.q15) {
+        ESP_LOGE(TAG_BENCH, "Falha ao alocar buffers da suíte (max_n=%zu).", max_n);
+        ctx_free(&c);
+        return 0;
+    }
+
+    // Entradas determinísticas: 220 Hz + harmônico, operandos positivos para div/sqrt/log2f
+    for (size_t i = 0; i < max_n; i++) {
+        float t = (float)i / SAMPLE_RATE;
+        c.sig[i] = 0.5f * sinf(2.0f * (float)M_PI * 220.0f * t) + 0.2f * sinf(2.0f * (float)M_PI * 440.0f * t);
+        c.a[i] = 1.0f + 0.5f * sinf(0.01f * (float)i);
+        c.b[i] = 1.5f + 0.5f * cosf(0.013f * (float)i);
+        c.freqs[i] = 30.0f + (float)(i % 400) * 10.0f;
+        c.q31[i] = fx_float_to_q31(c.sig[i]);
+    }
+    bandpass_init(&c.biquad, SAMPLE_RATE, LOW_FREQ, HIGH_FREQ);
+    sos_input_filter_init(&c.sos, SAMPLE_RATE, LOW_FREQ, HIGH_FREQ);
+    biquad_q31_from_float(&c.biquad_q31, &c.biquad);
+    fft_interleaved_init(max_n);
+
+    // Sem workers, yin_parallel mede o mesmo laço serial de yin_direct
+    if (par_executor_init(&c.executor, YIN_PARALLEL_WORKERS) != ESP_OK) {
+        ESP_LOGW(TAG_BENCH, "Executor paralelo indisponível; yin_parallel roda serial.");
+    }
+
+    // Logs por chamada (ex.: "FFT concluída") distorceriam as medições
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    size_t count = 0;
+    for (size_t n = cfg->min_n; n <= max_n; n <<= 1) {
+        c.n = n;
+        if (yin_init(&c.yin, n, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_METHOD) != ESP_OK ||
+            yin_init(&c.yin_dec, n / YIN_DECIMATION, YIN_SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f,
+                     YIN_DIFF_METHOD) != ESP_OK ||
+            yin_init(&c.yin_hier, n, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f,
+                     YIN_DIFF_METHOD) != ESP_OK ||
+            yin_init(&c.yin_early, n, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f,
+                     YIN_DIFF_DIRECT) != ESP_OK ||
+            yin_set_early_exit(&c.yin_early, true) != ESP_OK ||
+            yin_init(&c.yin_direct, n, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f,
+                     YIN_DIFF_DIRECT) != ESP_OK ||
+            yin_init(&c.yin_par, n, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f,
+                     YIN_DIFF_DIRECT) != ESP_OK ||
+            yin_set_executor(&c.yin_par, &c.executor) != ESP_OK ||
+            yin_init(&c.yin_range, n, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f,
+                     YIN_DIFF_DIRECT) != ESP_OK ||
+            hps_init(&c.hps, n, SAMPLE_RATE, HPS_HARMONICS, LOW_FREQ, HIGH_FREQ) != ESP_OK ||
+            mpm_init(&c.mpm, n, SAMPLE_RATE, MPM_K, MPM_MIN_CLARITY, NULL, NULL) != ESP_OK ||
+            decimator_init(&c.dec, YIN_DECIMATION, SAMPLE_RATE, HIGH_FREQ, DECIM_ATTEN_DB, n) != ESP_OK ||
+            fx_fft_init(&c.fx_fft, n) != ESP_OK) {
+            ESP_LOGE(TAG_BENCH, "Falha ao preparar YIN/HPS/MPM/decimador/FFT Q15 para n=%zu.", n);
+            yin_deinit(&c.yin);
+            yin_deinit(&c.yin_dec);
+            yin_deinit(&c.yin_hier);
+            yin_deinit(&c.yin_early);
+            yin_deinit(&c.yin_direct);
+            yin_deinit(&c.yin_par);
+            yin_deinit(&c.yin_range);
+            hps_deinit(&c.hps);
+            mpm_deinit(&c.mpm);
+            decimator_deinit(&c.dec);
+            break;
+        }
+        // Tamanhos pequenos demais para a busca grossa seguem exaustivos
+        yin_set_hierarchical(&c.yin_hier, YIN_COARSE_FACTOR, YIN_COARSE_CANDIDATES, YIN_REFINE_RADIUS);
+        rfft(c.sig, c.real, c.imag, n);
+        calculate_magnitude_rfft(c.real, c.imag, c.spec, n);
+
+        for (size_t k = 0; k < sizeof(s_cases) / sizeof(s_cases[0]) && count < max_results; k++) {
+            if (bench_measure(s_cases[k].name, n, s_cases[k].setup, s_cases[k].fn, &c, cfg, &results[count]) == ESP_OK) {
+                count++;
+            }
+        }
+
+        yin_deinit(&c.yin);
+        yin_deinit(&c.yin_dec);
+        yin_deinit(&c.yin_hier);
+        yin_deinit(&c.yin_early);
+        yin_deinit(&c.yin_direct);
+        yin_deinit(&c.yin_par);
+        yin_deinit(&c.yin_range);
+        hps_deinit(&c.hps);
+        mpm_deinit(&c.mpm);
+        decimator_deinit(&c.dec);
+        fx_fft_deinit(&c.fx_fft);
+    }
+
+    esp_log_level_set("*", ESP_LOG_INFO);
+    par_executor_deinit(&c.executor);
+    ctx_free(&c);
+    return count;
+}
+
+/* ----------------------------------------------------------------
+ *  Corpus de notas: exatidão e custo dos motores de pitch
+ * ---------------------------------------------------------------- */
+#define CORPUS_MIDI_LO      28          // E1 (41,2 Hz)
+#define CORPUS_MIDI_HI      96          // C7 (2093 Hz)
+#define CORPUS_HARMONICS    8
+#define CORPUS_NOISE        0.048f      // Ruído uniforme ~30 dB abaixo do sinal
+
+static const float s_corpus_detune[] = {-37.0f, 0.0f, 23.0f};
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Acumula uma janela: erro em cents e tempo.
+ */
+static void corpus_score(bench_pitch_result_t *r, double *errors, float f_est, float f_true, uint64_t ticks) {
+    r->notes++;
+    r->mean_us += ticks_to_ns(ticks) / 1000.0;
+    if (f_est <= 0.0f) {
+        return;
+    }
+    r->detected++;
+    double cents = fabs(1200.0 * log2((double)f_est / (double)f_true));
+    if (cents > 50.0) {
+        r->gross++;
+        return;
+    }
+    errors[r->detected - r->gross - 1] = cents;
+}
+
+/**
+ * @brief Avalia os motores de pitch (YIN FFT, YIN direto, HPS, HPS + YIN com faixa limitada)
+ *        num corpus sintético: notas de E1 a C7 com desafinação, 8 harmônicos de fase
+ *        aleatória e ruído a 30 dB, em janelas Hann de n amostras a SAMPLE_RATE.
+ *
+ * @param n           Janela (potência de 2).
+ * @param results     Vetor de saída.
+ * @param max_results Capacidade de results (BENCH_PITCH_ENGINES).
+ * @return size_t     Número de resultados preenchidos.
+ */
+size_t bench_pitch_corpus(size_t n, bench_pitch_result_t *results, size_t max_results) {
+    if (!results || max_results < BENCH_PITCH_ENGINES || n < 1024 || (n & (n - 1)) != 0) {
+        ESP_LOGE(TAG_BENCH, "Parâmetros inválidos passados para bench_pitch_corpus.");
+        return 0;
+    }
+
+    const size_t num_detune = sizeof(s_corpus_detune) / sizeof(s_corpus_detune[0]);
+    const size_t total = (CORPUS_MIDI_HI - CORPUS_MIDI_LO + 1) * num_detune;
+    float *sig = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    float *real = heap_caps_malloc((n / 2 + 1) * sizeof(float), MALLOC_CAP_8BIT);
+    float *imag = heap_caps_malloc((n / 2 + 1) * sizeof(float), MALLOC_CAP_8BIT);
+    float *mag = heap_caps_malloc((n / 2 + 1) * sizeof(float), MALLOC_CAP_8BIT);
+    double *errors = heap_caps_malloc(BENCH_PITCH_ENGINES * total * sizeof(double), MALLOC_CAP_8BIT);
+    const float *hann = window_get(WINDOW_HANN, n);
+    Yin yin_fft = {0}, yin_direct = {0}, yin_range = {0};
+    hps_t hps = {0};
+    pitch_engine_t engines = {0};   // MPM pela interface de motores (scratch compartilhado com o YIN)
+    pitch_engine_config_t engine_cfg = PITCH_ENGINE_CONFIG_DEFAULT(n, SAMPLE_RATE);
+    size_t count = 0;
+
+    if (!sig || !real || !imag || !mag || !errors || !hann ||
+        yin_init(&yin_fft, n, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_FFT) != ESP_OK ||
+        yin_init(&yin_direct, n, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) != ESP_OK ||
+        yin_init(&yin_range, n, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) != ESP_OK ||
+        hps_init(&hps, n, SAMPLE_RATE, HPS_HARMONICS, LOW_FREQ, HIGH_FREQ) != ESP_OK ||
+        pitch_engine_init(&engines, &engine_cfg, PITCH_DETECTOR_MPM) != ESP_OK) {
+        ESP_LOGE(TAG_BENCH, "Falha ao preparar o corpus de pitch (n=%zu).", n);
+        goto cleanup;
+    }
+
+    static const char *names[BENCH_PITCH_ENGINES] = {"yin_fft", "yin_direct", "hps", "hps_yin_direct", "mpm"};
+    memset(results, 0, BENCH_PITCH_ENGINES * sizeof(*results));
+    for (size_t e = 0; e < BENCH_PITCH_ENGINES; e++) {
+        snprintf(results[e].name, sizeof(results[e].name), "%s", names[e]);
+    }
+
+    esp_log_level_set("*", ESP_LOG_WARN);
+    uint32_t seed = 12345u;
+    for (int midi = CORPUS_MIDI_LO; midi <= CORPUS_MIDI_HI; midi++) {
+        for (size_t d = 0; d < num_detune; d++) {
+            float f0 = A4_FREQUENCY * powf(2.0f, ((float)(midi - 69) + s_corpus_detune[d] / 100.0f) / 12.0f);
+
+            // Harmônicos 1/h com fase aleatória (até Nyquist) + ruído uniforme, janela Hann
+            float phase[CORPUS_HARMONICS];
+            for (size_t h = 0; h < CORPUS_HARMONICS; h++) {
+                seed = seed * 1664525u + 1013904223u;
+                phase[h] = 2.0f * (float)M_PI * (float)(seed >> 8) / 16777216.0f;
+            }
+            for (size_t i = 0; i < n; i++) {
+                float t = (float)i / SAMPLE_RATE, x = 0.0f;
+                for (size_t h = 1; h <= CORPUS_HARMONICS && (float)h * f0 < 0.5f * SAMPLE_RATE; h++) {
+                    x += sinf(2.0f * (float)M_PI * (float)h * f0 * t + phase[h - 1]) / (float)h;
+                }
+                seed = seed * 1664525u + 1013904223u;
+                x += CORPUS_NOISE * (2.0f * (float)(seed >> 8) / 16777216.0f - 1.0f);
+                sig[i] = 0.3f * x * hann[i];
+            }
+            rfft(sig, real, imag, n);
+            calculate_magnitude_rfft(real, imag, mag, n);
+
+            float f;
+            uint64_t t0 = bench_ticks();
+            if (yin_detect_pitch(&yin_fft, sig, &f) != 0) f = -1.0f;
+            corpus_score(&results[0], errors + 0 * total, f, f0, bench_ticks() - t0);
+
+            t0 = bench_ticks();
+            if (yin_detect_pitch(&yin_direct, sig, &f) != 0) f = -1.0f;
+            corpus_score(&results[1], errors + 1 * total, f, f0, bench_ticks() - t0);
+
+            t0 = bench_ticks();
+            if (hps_detect(&hps, mag, &f) != 0) f = -1.0f;
+            corpus_score(&results[2], errors + 2 * total, f, f0, bench_ticks() - t0);
+
+            // HPS como pré-estimador: YIN só até HPS_PRE_MARGIN períodos
+            t0 = bench_ticks();
+            float f_pre;
+            yin_set_search_range(&yin_range, (hps_detect(&hps, mag, &f_pre) == 0) ? f_pre / HPS_PRE_MARGIN : 0.0f, 0.0f);
+            if (yin_detect_pitch(&yin_range, sig, &f) != 0) f = -1.0f;
+            corpus_score(&results[3], errors + 3 * total, f, f0, bench_ticks() - t0);
+
+            t0 = bench_ticks();
+            if (pitch_engine_process(&engines, sig, &f) != 0) f = -1.0f;
+            corpus_score(&results[4], errors + 4 * total, f, f0, bench_ticks() - t0);
+        }
+    }
+    esp_log_level_set("*", ESP_LOG_INFO);
+
+    for (size_t e = 0; e < BENCH_PITCH_ENGINES; e++) {
+        bench_pitch_result_t *r = &results[e];
+        size_t good = r->detected - r->gross;
+        double *err = errors + e * total;
+        double sum = 0.0;
+        for (size_t i = 0; i < good; i++) {
+            sum += err[i];
+        }
+        qsort(err, good, sizeof(double), cmp_double);
+        r->mean_abs_cents = good ? sum / (double)good : 0.0;
+        r->p95_abs_cents = good ? err[(good * 95 + 99) / 100 - 1] : 0.0;
+        r->mean_us = r->notes ? r->mean_us / (double)r->notes : 0.0;
+    }
+    count = BENCH_PITCH_ENGINES;
+
+cleanup:
+    yin_deinit(&yin_fft);
+    yin_deinit(&yin_direct);
+    yin_deinit(&yin_range);
+    hps_deinit(&hps);
+    pitch_engine_deinit(&engines);
+    if (sig) heap_caps_free(sig);
+    if (real) heap_caps_free(real);
+    if (imag) heap_caps_free(imag);
+    if (mag) heap_caps_free(mag);
+    if (errors) heap_caps_free(errors);
+    return count;
+}
+
+/**
+ * @brief Imprime a tabela de bench_pitch_corpus.
+ *
+ * @param out     Destino.
+ * @param results Resultados.
+ * @param count   Número de resultados.
+ */
+void bench_pitch_print(FILE *out, const bench_pitch_result_t *results, size_t count) {
+    fprintf(out, "%-16s %6s %9s %8s %10s %9s %10s\n", "motor", "notas", "detect.", "grosso", "|cents|", "p95", "us/janela");
+    for (size_t i = 0; i < count; i++) {
+        const bench_pitch_result_t *r = &results[i];
+        fprintf(out, "%-16s %6zu %9zu %8zu %10.2f %9.2f %10.1f\n", r->name, r->notes, r->detected, r->gross,
+                r->mean_abs_cents, r->p95_abs_cents, r->mean_us);
+    }
+}
+
+/* ----------------------------------------------------------------
+ *  Afinador: caminho completo x banco de Goertzel
+ * ---------------------------------------------------------------- */
+#define TUNER_SEQ_SEGMENT   (SAMPLE_RATE * 3 / 5)   // Amostras de cada corda (600 ms)
+#define TUNER_SEQ_HARMONICS 8
+#define TUNER_SEQ_DECAY_S   1.5f                    // Constante de tempo do decaimento da corda
+
+static const float s_tuner_detune[] = {-23.0f, 14.0f};
+
+/**
+ * @brief Janela [start, start + n) da sequência de cordas (cada uma dedilhada no início do
+ *        seu segmento, com a anterior abafada), já com a janela Hann. Determinística por amostra:
+ *        janelas sobrepostas veem o mesmo sinal.
+ */
+static void tuner_seq_window(const tuner_instrument_t *inst, size_t start, size_t n, const float *hann, float *out) {
+    for (size_t i = 0; i < n; i++) {
+        size_t j = start + i;
+        size_t seg = j / TUNER_SEQ_SEGMENT;
+        int midi = inst->midi[seg % inst->count];
+        float detune = s_tuner_detune[seg / inst->count];
+        float f0 = A4_FREQUENCY * powf(2.0f, ((float)(midi - 69) + detune / 100.0f) / 12.0f);
+        float t = (float)(j - seg * TUNER_SEQ_SEGMENT) / SAMPLE_RATE;
+        float x = 0.0f;
+        for (size_t h = 1; h <= TUNER_SEQ_HARMONICS && (float)h * f0 < 0.5f * SAMPLE_RATE; h++) {
+            float phase = 2.0f * (float)M_PI * (float)((seg * 7 + h * 13) % 32) / 32.0f;
+            x += sinf(2.0f * (float)M_PI * (float)h * f0 * t + phase) / (float)h;
+        }
+        uint32_t r = (uint32_t)j * 2654435761u;
+        r ^= r >> 15;
+        r *= 2246822519u;
+        r ^= r >> 13;
+        x = x * expf(-t / TUNER_SEQ_DECAY_S) + CORPUS_NOISE * (2.0f * (float)(r >> 8) / 16777216.0f - 1.0f);
+        out[i] = 0.3f * x * hann[i];
+    }
+}
+
+/**
+ * @brief Acumula uma janela de um caminho: acerto da corda, cents, tempo e latência após a troca.
+ */
+static void tuner_score(bench_tuner_result_t *r, bool *found, size_t end, size_t seg, bool stable,
+                        int midi_est, float f_est, int midi_true, float f_true, uint64_t ticks) {
+    double us = ticks_to_ns(ticks) / 1000.0;
+    r->windows++;
+    r->mean_us += us;
+    bool hit = (f_est > 0.0f && midi_est == midi_true);
+    if (stable) {
+        r->stable++;
+        if (hit) {
+            r->correct++;
+            r->mean_abs_cents += fabs(1200.0 * log2((double)f_est / (double)f_true));
+        }
+    }
+    // Latência: primeira janela certa depois que a corda do fim da janela começou
+    if (hit && seg > 0 && !found[seg]) {
+        found[seg] = true;
+        r->latency_ms += 1000.0 * (double)(end - seg * TUNER_SEQ_SEGMENT) / SAMPLE_RATE + us / 1000.0;
+    }
+}
+
+/**
+ * @brief Compara, a cada hop, o caminho completo (rfft de FBUF_SIZE + magnitude + decimação +
+ *        YIN + get_note) com o afinador (decimação + banco de Goertzel de TUNER_INSTRUMENT) numa
+ *        sequência sintética de cordas dedilhadas e desafinadas, em janelas Hann de BUFFER_SIZE.
+ *
+ * @param hop         Avanço entre janelas (amostras a SAMPLE_RATE, 1..BUFFER_SIZE).
+ * @param results     Vetor de saída.
+ * @param max_results Capacidade de results (BENCH_TUNER_PATHS).
+ * @return size_t     Número de resultados preenchidos.
+ */
+size_t bench_tuner_compare(size_t hop, bench_tuner_result_t *results, size_t max_results) {
+    const tuner_instrument_t *inst = tuner_instrument_find(TUNER_INSTRUMENT);
+    if (!results || max_results < BENCH_TUNER_PATHS || hop == 0 || hop > BUFFER_SIZE || !inst) {
+        ESP_LOGE(TAG_BENCH, "Parâmetros inválidos passados para bench_tuner_compare.");
+        return 0;
+    }
+
+    const size_t n = BUFFER_SIZE;
+    const size_t segments = inst->count * (sizeof(s_tuner_detune) / sizeof(s_tuner_detune[0]));
+    const size_t total = segments * TUNER_SEQ_SEGMENT;
+    float *sig = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    float *dec = heap_caps_malloc(YIN_BUFFER_SIZE * sizeof(float), MALLOC_CAP_8BIT);
+    float *real = heap_caps_malloc((FBUF_SIZE / 2 + 1) * sizeof(float), MALLOC_CAP_8BIT);
+    float *imag = heap_caps_malloc((FBUF_SIZE / 2 + 1) * sizeof(float), MALLOC_CAP_8BIT);
+    float *mag = heap_caps_malloc((FBUF_SIZE / 2 + 1) * sizeof(float), MALLOC_CAP_8BIT);
+    bool *found = heap_caps_malloc(BENCH_TUNER_PATHS * segments * sizeof(bool), MALLOC_CAP_8BIT);
+    const float *hann = window_get(WINDOW_HANN, n);
+    Yin yin = {0};
+    decimator_t decim = {0};
+    tuner_bank_t bank;
+    size_t count = 0;
+
+    if (!sig || !dec || !real || !imag || !mag || !found || !hann ||
+        yin_init(&yin, YIN_BUFFER_SIZE, YIN_SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f,
+                 YIN_DIFF_METHOD) != ESP_OK ||
+        decimator_init(&decim, YIN_DECIMATION, SAMPLE_RATE, HIGH_FREQ, DECIM_ATTEN_DB, n) != ESP_OK ||
+        tuner_bank_init(&bank, inst, YIN_BUFFER_SIZE, YIN_SAMPLE_RATE, TUNER_HARMONICS, TUNER_RANGE_CENTS) != ESP_OK) {
+        ESP_LOGE(TAG_BENCH, "Falha ao preparar a comparação do afinador (hop=%zu).", hop);
+        goto cleanup;
+    }
+
+    static const char *names[BENCH_TUNER_PATHS] = {"fft_yin", "tuner"};
+    memset(results, 0, BENCH_TUNER_PATHS * sizeof(*results));
+    memset(found, 0, BENCH_TUNER_PATHS * segments * sizeof(bool));
+    for (size_t p = 0; p < BENCH_TUNER_PATHS; p++) {
+        snprintf(results[p].name, sizeof(results[p].name), "%s", names[p]);
+        results[p].hop = hop;
+    }
+
+    esp_log_level_set("*", ESP_LOG_WARN);
+    for (size_t start = 0; start + n <= total; start += hop) {
+        tuner_seq_window(inst, start, n, hann, sig);
+        size_t end = start + n;
+        size_t seg = (end - 1) / TUNER_SEQ_SEGMENT;
+        bool stable = (start / TUNER_SEQ_SEGMENT == seg);
+        int midi_true = inst->midi[seg % inst->count];
+        float f_true = A4_FREQUENCY * powf(2.0f, ((float)(midi_true - 69) + s_tuner_detune[seg / inst->count] / 100.0f) / 12.0f);
+
+        // Caminho completo: espectro para a saída + YIN na taxa decimada + nota
+        float f;
+        note_t note = {0};
+        uint64_t t0 = bench_ticks();
+        rfft(sig, real, imag, FBUF_SIZE);
+        calculate_magnitude_rfft(real, imag, mag, FBUF_SIZE);
+        decimator_reset(&decim);
+        decimator_process(&decim, sig, n, dec);
+        if (yin_detect_pitch(&yin, dec, &f) != 0 || f <= 0.0f || get_note(f, &note) != 0) {
+            f = -1.0f;
+        }
+        tuner_score(&results[0], found, end, seg, stable, note.midi, f, midi_true, f_true, bench_ticks() - t0);
+
+        // Afinador: só os filtros das cordas
+        t0 = bench_ticks();
+        decimator_reset(&decim);
+        decimator_process(&decim, sig, n, dec);
+        if (tuner_bank_process(&bank, dec, &f, &note) != 0) {
+            f = -1.0f;
+        }
+        tuner_score(&results[1], found + segments, end, seg, stable, note.midi, f, midi_true, f_true, bench_ticks() - t0);
+    }
+    esp_log_level_set("*", ESP_LOG_INFO);
+
+    for (size_t p = 0; p < BENCH_TUNER_PATHS; p++) {
+        bench_tuner_result_t *r = &results[p];
+        size_t hits = 0;
+        for (size_t s = 1; s < segments; s++) {
+            hits += found[p * segments + s] ? 1 : 0;
+        }
+        r->missed = segments - 1 - hits;
+        r->latency_ms = hits ? r->latency_ms / (double)hits : 0.0;
+        r->mean_abs_cents = r->correct ? r->mean_abs_cents / (double)r->correct : 0.0;
+        r->mean_us = r->windows ? r->mean_us / (double)r->windows : 0.0;
+        r->cpu_pct = 100.0 * r->mean_us / (1e6 * (double)hop / SAMPLE_RATE);
+    }
+    count = BENCH_TUNER_PATHS;
+
+cleanup:
+    yin_deinit(&yin);
+    decimator_deinit(&decim);
+    if (sig) heap_caps_free(sig);
+    if (dec) heap_caps_free(dec);
+    if (real) heap_caps_free(real);
+    if (imag) heap_caps_free(imag);
+    if (mag) heap_caps_free(mag);
+    if (found) heap_caps_free(found);
+    return count;
+}
+
+/**
+ * @brief Imprime a tabela de bench_tuner_compare.
+ *
+ * @param out     Destino.
+ * @param results Resultados.
+ * @param count   Número de resultados.
+ */
+void bench_tuner_print(FILE *out, const bench_tuner_result_t *results, size_t count) {
+    fprintf(out, "%-10s %6s %8s %13s %9s %10s %7s %9s %7s\n", "caminho", "hop", "janelas", "certas", "|cents|",
+            "us/janela", "CPU %", "lat. ms", "perdas");
+    for (size_t i = 0; i < count; i++) {
+        const bench_tuner_result_t *r = &results[i];
+        fprintf(out, "%-10s %6zu %8zu %6zu/%-6zu %9.2f %10.1f %7.2f %9.1f %7zu\n", r->name, r->hop, r->windows,
+                r->correct, r->stable, r->mean_abs_cents, r->mean_us, r->cpu_pct, r->latency_ms, r->missed);
+    }
+}
+
+/* ----------------------------------------------------------------
+ *  JSON e comparação com baseline
+ * ---------------------------------------------------------------- */
+
+/**
+ * @brief Escreve os resultados em JSON.
+ *
+ * @param out     Destino (ex.: stdout no alvo, arquivo no host).
+ * @param results Resultados.
+ * @param count   Número de resultados.
+ */
+void bench_write_json(FILE *out, const bench_result_t *results, size_t count) {
+    if (!out || (!results && count)) {
+        ESP_LOGE(TAG_BENCH, "Parâmetros inválidos passados para bench_write_json.");
+        return;
+    }
+
+    fprintf(out, "{\n  \"backend\": \"%s\",\n  \"cpu_mhz\": %d,\n  \"results\": [\n", BENCH_BACKEND, BENCH_CPU_MHZ);
+    for (size_t i = 0; i < count; i++) {
+        const bench_result_t *r = &results[i];
+        fprintf(out, "    {\"name\": \"%s\", \"n\": %zu, \"reps\": %zu, \"median_ns\": %.1f, \"p99_ns\": %.1f, "
+                     "\"ns_per_sample\": %.3f, \"median_cycles\": %" PRIu64 "}%s\n",
+                r->name, r->n, r->reps, r->median_ns, r->p99_ns, r->ns_per_sample, r->median_cycles,
+                (i + 1 < count) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+/**
+ * @brief Lê o número após "key": dentro de [obj, end).
+ */
+static int json_number(const char *obj, const char *end, const char *key, double *value) {
+    char pattern[BENCH_NAME_LEN + 4];
+    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+    const char *p = strstr(obj, pattern);
+    if (!p || p >= end) {
+        return -1;
+    }
+    p = strchr(p + strlen(pattern), ':');
+    if (!p || p >= end) {
+        return -1;
+    }
+    char *stop = NULL;
+    *value = strtod(p + 1, &stop);
+    return (stop == p + 1) ? -1 : 0;
+}
+
+/**
+ * @brief Lê resultados de um JSON produzido por bench_write_json (ex.: baseline salvo).
+ *
+ * @param json        Texto JSON terminado em '\0'.
+ * @param results     Vetor de saída.
+ * @param max_results Capacidade de results.
+ * @return size_t     Número de resultados lidos.
+ */
+size_t bench_parse_json(const char *json, bench_result_t *results, size_t max_results) {
+    if (!json || !results) {
+        ESP_LOGE(TAG_BENCH, "Parâmetros inválidos passados para bench_parse_json.");
+        return 0;
+    }
+
+    size_t count = 0;
+    const char *p = json;
+    while (count < max_results && (p = strstr(p, "{\"name\"")) != NULL) {
+        const char *end = strchr(p, '}');
+        if (!end) {
+            break;
+        }
+
+        bench_result_t r = {0};
+        const char *q = strchr(p + 7, '"');                 // Abre aspas do valor
+        const char *q_end = q ? strchr(q + 1, '"') : NULL;  // Fecha aspas do valor
+        double n = 0, reps = 0, cycles = 0;
+        if (q && q_end && q_end < end && (size_t)(q_end - q - 1) < sizeof(r.name) &&
+            json_number(p, end, "n", &n) == 0 && json_number(p, end, "median_ns", &r.median_ns) == 0) {
+            memcpy(r.name, q + 1, (size_t)(q_end - q - 1));
+            r.n = (size_t)n;
+            json_number(p, end, "reps", &reps);
+            json_number(p, end, "p99_ns", &r.p99_ns);
+            json_number(p, end, "ns_per_sample", &r.ns_per_sample);
+            json_number(p, end, "median_cycles", &cycles);
+            r.reps = (size_t)reps;
+            r.median_cycles = (uint64_t)cycles;
+            results[count++] = r;
+        }
+        p = end + 1;
+    }
+    return count;
+}
+
+/**
+ * @brief Compara resultados com um baseline (mesmo nome e tamanho, pela mediana).
+ *
+ * @param current     Resultados atuais.
+ * @param n_current   Número de resultados atuais.
+ * @param baseline    Resultados de referência.
+ * @param n_baseline  Número de resultados de referência.
+ * @param threshold   Piora relativa tolerada (ex.: 0.10 = 10%).
+ * @return int        Número de regressões acima do threshold.
+ */
+int bench_compare(const bench_result_t *current, size_t n_current,
+                  const bench_result_t *baseline, size_t n_baseline, float threshold) {
+    if ((!current && n_current) || (!baseline && n_baseline) || threshold < 0.0f) {
+        ESP_LOGE(TAG_BENCH, "Parâmetros inválidos passados para bench_compare.");
+        return -1;
+    }
+
+    int regressions = 0;
+    size_t matched = 0;
+    for (size_t i = 0; i < n_current; i++) {
+        const bench_result_t *cur = &current[i];
+        for (size_t j = 0; j < n_baseline; j++) {
+            const bench_result_t *base = &baseline[j];
+            if (base->n != cur->n || strcmp(base->name, cur->name) != 0 || base->median_ns <= 0.0) {
+                continue;
+            }
+            matched++;
+            double ratio = cur->median_ns / base->median_ns;
+            if (ratio > 1.0 + threshold) {
+                regressions++;
+                ESP_LOGW(TAG_BENCH, "Regressão: %s n=%zu %.1f ns -> %.1f ns (%+.1f%%)",
+                         cur->name, cur->n, base->median_ns, cur->median_ns, (ratio - 1.0) * 100.0);
+            } else if (ratio < 1.0 - threshold) {
+                ESP_LOGI(TAG_BENCH, "Melhora: %s n=%zu %.1f ns -> %.1f ns (%+.1f%%)",
+                         cur->name, cur->n, base->median_ns, cur->median_ns, (ratio - 1.0) * 100.0);
+            }
+            break;
+        }
+    }
+    ESP_LOGI(TAG_BENCH, "%zu casos comparados com o baseline, %d regressões (threshold %.0f%%).",
+             matched, regressions, threshold * 100.0f);
+    return regressions;
+}
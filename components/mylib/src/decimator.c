@@ -0,0 +1,218 @@
+// src/decimator.c
+#include "decimator.h"
+#include "utils.h"
+#include "esp_log.h"
+
+static const char *TAG_DECIM = "DECIM";
+
+/**
+ * @brief Projeta um estágio half-band por janela Kaiser para a taxa de entrada rate.
+ *        Banda passante [0, passband_hz]; rejeição a partir de rate/2 - passband_hz.
+ */
+static esp_err_t halfband_init(halfband_t *h, float rate, float passband_hz, float atten_db, size_t max_block) {
+    double delta = ((double)rate / 2.0 - 2.0 * (double)passband_hz) / (double)rate; // Transição normalizada
+    double a = (double)atten_db;
+    size_t n = (size_t)ceil((a - 7.95) / (14.36 * delta)) + 1;
+    size_t m = (n + 1 + 3) / 4;
+    if (m < 1) {
+        m = 1;
+    }
+
+    double beta = (a > 50.0) ? 0.1102 * (a - 8.7) :
+                  (a >= 21.0) ? 0.5842 * pow(a - 21.0, 0.4) + 0.07886 * (a - 21.0) : 0.0;
+
+    h->half_taps = m;
+    h->taps = 4 * m - 1;
+    h->max_block = max_block;
+    h->coefs = (float *)heap_caps_malloc(m * sizeof(float), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    h->work = (float *)heap_caps_calloc(h->taps - 1 + max_block, sizeof(float), MALLOC_CAP_8BIT);
+    if (!h->coefs || !h->work) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // h[c +- t] = 0.5 * sinc(t / 2) * kaiser(t), t = 1, 3, ..., 2M - 1 (pares são nulos)
+    double center = (double)(2 * m - 1);
+    double i0_beta = bessel_i0(beta);
+    double sum = 0.0;
+    for (size_t j = 0; j < m; j++) {
+        double t = (double)(2 * j + 1);
+        double x = M_PI * t / 2.0;
+        double r = t / center;
+        double g = 0.5 * sin(x) / x * bessel_i0(beta * sqrt(fmax(0.0, 1.0 - r * r))) / i0_beta;
+        h->coefs[j] = (float)g;
+        sum += g;
+    }
+    // Ganho DC unitário mantendo o centro em 0.5 (propriedade half-band)
+    for (size_t j = 0; j < m; j++) {
+        h->coefs[j] = (float)((double)h->coefs[j] * 0.25 / sum);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Decima um bloco por 2: uma saída a cada duas entradas, M + 1 multiplicações por saída.
+ */
+static size_t halfband_process(halfband_t *h, const float *in, size_t length, float *out) {
+    const size_t hist = h->taps - 1;
+    const size_t m = h->half_taps;
+    const float *g = h->coefs;
+    float *w = h->work;
+
+    memcpy(w + hist, in, length * sizeof(float));
+
+    size_t out_len = length / 2;
+    for (size_t k = 0; k < out_len; k++) {
+        // Amostra mais nova: w[hist + 2k + 1]; centro do FIR c = 2M - 1 amostras antes
+        const float *c = w + 2 * k + 1 + hist / 2;
+        float acc = 0.5f * c[0];
+        for (size_t j = 0; j < m; j++) {
+            size_t t = 2 * j + 1;
+            acc += g[j] * (c[-(ptrdiff_t)t] + c[t]);
+        }
+        out[k] = acc;
+    }
+
+    memmove(w, w + length, hist * sizeof(float));
+    return out_len;
+}
+
+/**
+ * @brief Projeta a cascata half-band (Kaiser), cada estágio com o menor comprimento que
+ *        atenua em atten_db o que dobraria sobre [0, passband_hz] na taxa final.
+ *
+ * @param d           Ponteiro para o decimador.
+ * @param factor      Fator de decimação (potência de 2, até 2^DECIM_MAX_STAGES; 1 = cópia).
+ * @param input_rate  Taxa de entrada em Hz.
+ * @param passband_hz Maior frequência preservada (< taxa de saída / 2).
+ * @param atten_db    Atenuação mínima do aliasing em dB.
+ * @param max_block   Maior bloco passado a decimator_process (múltiplo de factor).
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t decimator_init(decimator_t *d, size_t factor, float input_rate, float passband_hz,
+                         float atten_db, size_t max_block) {
+    if (!d || factor == 0 || (factor & (factor - 1)) != 0 || factor > (1u << DECIM_MAX_STAGES) ||
+        input_rate <= 0.0f || atten_db <= 0.0f || max_block == 0 || (max_block % factor) != 0 ||
+        passband_hz <= 0.0f || passband_hz >= input_rate / (2.0f * (float)factor)) {
+        ESP_LOGE(TAG_DECIM, "Parâmetros inválidos passados para decimator_init.");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(d, 0, sizeof(*d));
+    d->factor = factor;
+    d->input_rate = input_rate;
+    d->output_rate = input_rate / (float)factor;
+
+    float rate = input_rate;
+    size_t block = max_block;
+    for (size_t f = factor; f > 1; f >>= 1) {
+        if (halfband_init(&d->stages[d->num_stages], rate, passband_hz, atten_db, block) != ESP_OK) {
+            ESP_LOGE(TAG_DECIM, "Falha ao alocar estágio %zu do decimador.", d->num_stages);
+            decimator_deinit(d);
+            return ESP_ERR_NO_MEM;
+        }
+        d->num_stages++;
+        rate /= 2.0f;
+        block /= 2;
+    }
+    if (d->num_stages > 1) {
+        d->scratch = (float *)heap_caps_malloc((max_block / 2) * sizeof(float), MALLOC_CAP_8BIT);
+        if (!d->scratch) {
+            ESP_LOGE(TAG_DECIM, "Falha ao alocar scratch do decimador.");
+            decimator_deinit(d);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    for (size_t s = 0; s < d->num_stages; s++) {
+        ESP_LOGI(TAG_DECIM, "Estágio %zu: %.0f -> %.0f Hz, %zu taps (%zu multiplicações por saída).",
+                 s, input_rate / (float)(1u << s), input_rate / (float)(2u << s),
+                 d->stages[s].taps, d->stages[s].half_taps + 1);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Decima um bloco (stream contínuo: o histórico dos FIR é mantido entre chamadas).
+ *
+ * @param d      Ponteiro para o decimador.
+ * @param in     Entrada (length amostras, múltiplo de factor, até max_block).
+ * @param length Número de amostras de entrada.
+ * @param out    Saída (length / factor amostras; pode ser igual a in).
+ * @return size_t Número de amostras de saída (0 em erro).
+ */
+size_t decimator_process(decimator_t *d, const float *in, size_t length, float *out) {
+    if (!d || !in || !out || d->factor == 0 || (length % d->factor) != 0 ||
+        (d->num_stages > 0 && length > d->stages[0].max_block)) {
+        ESP_LOGE(TAG_DECIM, "Parâmetros inválidos passados para decimator_process.");
+        return 0;
+    }
+    if (d->num_stages == 0) {
+        if (in != out) {
+            memmove(out, in, length * sizeof(float));
+        }
+        return length;
+    }
+
+    // Cada estágio copia a entrada para o próprio histórico: saída in-place no scratch é segura
+    const float *src = in;
+    size_t n = length;
+    for (size_t s = 0; s < d->num_stages; s++) {
+        float *dst = (s + 1 == d->num_stages) ? out : d->scratch;
+        n = halfband_process(&d->stages[s], src, n, dst);
+        src = dst;
+    }
+    return n;
+}
+
+/**
+ * @brief Zera o histórico (descontinuidade no stream).
+ *
+ * @param d Ponteiro para o decimador.
+ */
+void decimator_reset(decimator_t *d) {
+    if (!d) {
+        return;
+    }
+    for (size_t s = 0; s < d->num_stages; s++) {
+        memset(d->stages[s].work, 0, (d->stages[s].taps - 1) * sizeof(float));
+    }
+}
+
+/**
+ * @brief Atraso de grupo total em amostras de entrada.
+ *
+ * @param d Ponteiro para o decimador.
+ * @return float Atraso em amostras na taxa de entrada.
+ */
+float decimator_delay(const decimator_t *d) {
+    if (!d) {
+        return 0.0f;
+    }
+    float delay = 0.0f;
+    for (size_t s = 0; s < d->num_stages; s++) {
+        delay += (float)((d->stages[s].taps - 1) / 2) * (float)(1u << s);
+    }
+    return delay;
+}
+
+/**
+ * @brief Libera os buffers do decimador.
+ *
+ * @param d Ponteiro para o decimador.
+ */
+void decimator_deinit(decimator_t *d) {
+    if (!d) {
+        return;
+    }
+    for (size_t s = 0; s < DECIM_MAX_STAGES; s++) {
+        if (d->stages[s].coefs) heap_caps_free(d->stages[s].coefs);
+        if (d->stages[s].work)  heap_caps_free(d->stages[s].work);
+        d->stages[s].coefs = NULL;
+        d->stages[s].work = NULL;
+    }
+    if (d->scratch) {
+        heap_caps_free(d->scratch);
+        d->scratch = NULL;
+    }
+    d->num_stages = 0;
+}
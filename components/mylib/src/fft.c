@@ -6,60 +6,183 @@
 #include <math.h>
 #include <string.h>
 
+#if DSP_BACKEND == DSP_BACKEND_ESP_DSP
+#include "esp_dsp.h"
+#endif
+
 static const char *TAG_FFT = "FFT";
 
+// Cache de planos por tamanho (compartilhado entre tarefas)
+static fft_plan_t *s_plan_cache[FFT_PLAN_CACHE_SIZE];
+static portMUX_TYPE s_plan_lock = portMUX_INITIALIZER_UNLOCKED;
+
 /*
- * @brief Rearranjo de bit-reversal.
- * @param real Buffer de partes reais.
- * @param imag Buffer de partes imaginárias.
- * @param n    Número de pontos.
+ * @brief Aloca uma tabela do plano, preferindo a RAM interna para tamanhos pequenos.
+ * @param size Tamanho em bytes.
+ * @param n    Tamanho da FFT do plano.
+ */
+static void *plan_alloc(size_t size, size_t n) {
+    void *ptr = NULL;
+    if (n <= FFT_PLAN_INTERNAL_MAX) {
+        ptr = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (!ptr) {
+        ptr = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    return ptr;
+}
+
+/**
+ * @brief Cria um plano de FFT com tabelas de twiddle e de bit-reversal.
+ * @param n Tamanho (potência de 2, até 65536)
+ * @return Plano alocado ou NULL em erro.
  */
-static void bit_reversal(float *real, float *imag, size_t n) {
-    size_t j = 0;
+fft_plan_t *fft_plan_create(size_t n) {
+    if (n == 0 || (n & (n - 1)) != 0 || n > 65536) {
+        ESP_LOGE(TAG_FFT, "Tamanho inválido para plano de FFT: %zu.", n);
+        return NULL;
+    }
+
+    fft_plan_t *plan = (fft_plan_t *)heap_caps_malloc(sizeof(fft_plan_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!plan) {
+        ESP_LOGE(TAG_FFT, "Falha ao alocar plano de FFT.");
+        return NULL;
+    }
+
+    size_t half = (n > 1) ? (n >> 1) : 1;
+    plan->n = n;
+    plan->cos_table = (float *)plan_alloc(half * sizeof(float), n);
+    plan->sin_table = (float *)plan_alloc(half * sizeof(float), n);
+    plan->bitrev = (uint16_t *)plan_alloc(n * sizeof(uint16_t), n);
+    if (!plan->cos_table || !plan->sin_table || !plan->bitrev) {
+        ESP_LOGE(TAG_FFT, "Falha ao alocar tabelas do plano de FFT (n=%zu).", n);
+        fft_plan_destroy(plan);
+        return NULL;
+    }
+
+    // Twiddles calculados diretamente (sem recorrência), sem acúmulo de erro
+    for (size_t k = 0; k < half; k++) {
+        float theta = 2.0f * (float)M_PI * (float)k / (float)n;
+        plan->cos_table[k] = cosf(theta);
+        plan->sin_table[k] = sinf(theta);
+    }
+
+    size_t bits = 0;
+    while (((size_t)1 << bits) < n) {
+        bits++;
+    }
     for (size_t i = 0; i < n; i++) {
-        if (i < j) {
-            // Troca os elementos
-            float tmp_real = real[i];
-            float tmp_imag = imag[i];
-            real[i] = real[j];
-            imag[i] = imag[j];
-            real[j] = tmp_real;
-            imag[j] = tmp_imag;
+        size_t r = 0;
+        for (size_t b = 0; b < bits; b++) {
+            r |= ((i >> b) & 1u) << (bits - 1 - b);
         }
-        size_t m = n >> 1;
-        while (j >= m && m > 0) {
-            j -= m;
-            m >>= 1;
+        plan->bitrev[i] = (uint16_t)r;
+    }
+
+    return plan;
+}
+
+/**
+ * @brief Libera um plano criado com fft_plan_create (não usar em planos do cache).
+ * @param plan Plano a liberar.
+ */
+void fft_plan_destroy(fft_plan_t *plan) {
+    if (!plan) {
+        return;
+    }
+    if (plan->cos_table) heap_caps_free(plan->cos_table);
+    if (plan->sin_table) heap_caps_free(plan->sin_table);
+    if (plan->bitrev)    heap_caps_free(plan->bitrev);
+    heap_caps_free(plan);
+}
+
+/**
+ * @brief Retorna o plano em cache para o tamanho n, criando-o na primeira chamada.
+ * @param n Tamanho (potência de 2)
+ * @return Plano em cache, ou NULL se não foi possível criar/armazenar.
+ */
+const fft_plan_t *fft_plan_get(size_t n) {
+    portENTER_CRITICAL(&s_plan_lock);
+    for (size_t i = 0; i < FFT_PLAN_CACHE_SIZE; i++) {
+        if (s_plan_cache[i] && s_plan_cache[i]->n == n) {
+            fft_plan_t *hit = s_plan_cache[i];
+            portEXIT_CRITICAL(&s_plan_lock);
+            return hit;
+        }
+    }
+    portEXIT_CRITICAL(&s_plan_lock);
+
+    // Alocação fora da seção crítica
+    fft_plan_t *plan = fft_plan_create(n);
+    if (!plan) {
+        return NULL;
+    }
+
+    fft_plan_t *result = NULL;
+    portENTER_CRITICAL(&s_plan_lock);
+    for (size_t i = 0; i < FFT_PLAN_CACHE_SIZE; i++) {
+        if (s_plan_cache[i] && s_plan_cache[i]->n == n) {
+            result = s_plan_cache[i]; // Outra tarefa criou o mesmo plano
+            break;
+        }
+    }
+    if (!result) {
+        for (size_t i = 0; i < FFT_PLAN_CACHE_SIZE; i++) {
+            if (!s_plan_cache[i]) {
+                s_plan_cache[i] = plan;
+                result = plan;
+                break;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&s_plan_lock);
+
+    if (result != plan) {
+        fft_plan_destroy(plan);
+        if (!result) {
+            ESP_LOGW(TAG_FFT, "Cache de planos de FFT cheio (n=%zu).", n);
         }
-        j += m;
     }
+    return result;
 }
 
-/*
- * @brief Executa FFT (Transformada Rápida de Fourier) in-place (real + imag).
+/**
+ * @brief Executa FFT in-place (real + imag) usando as tabelas do plano.
+ * @param plan Plano criado para o tamanho dos buffers
  * @param real Array de floats com parte real
  * @param imag Array de floats com parte imaginária
- * @param n    Tamanho (potência de 2)
  */
-void fft(float *real, float *imag, size_t n) {
-    if ((n & (n - 1)) != 0) {
-        ESP_LOGE(TAG_FFT, "FFT: n não é potência de 2.");
+void fft_execute(const fft_plan_t *plan, float *real, float *imag) {
+    if (!plan || !real || !imag) {
+        ESP_LOGE(TAG_FFT, "Parâmetros inválidos passados para fft_execute.");
         return;
     }
 
-    bit_reversal(real, imag, n);
+    size_t n = plan->n;
+    const uint16_t *bitrev = plan->bitrev;
+
+    // Rearranjo de bit-reversal pela tabela
+    for (size_t i = 0; i < n; i++) {
+        size_t j = bitrev[i];
+        if (i < j) {
+            float tmp_real = real[i];
+            float tmp_imag = imag[i];
+            real[i] = real[j];
+            imag[i] = imag[j];
+            real[j] = tmp_real;
+            imag[j] = tmp_imag;
+        }
+    }
 
     for (size_t s = 1; s < n; s <<= 1) {
         size_t m = s << 1;
-        float theta = -M_PI / (float)s;
-        float w_real = cosf(theta);
-        float w_imag = sinf(theta);
+        size_t stride = n / m; // Passo na tabela para W_m^x = W_n^(x * n/m)
 
         for (size_t k = 0; k < n; k += m) {
-            float wr = 1.0f;
-            float wi = 0.0f;
             for (size_t x = 0; x < s; x++) {
                 size_t t = k + x + s;
+                float wr = plan->cos_table[x * stride];
+                float wi = -plan->sin_table[x * stride];
 
                 // Cálculo dos fatores de torção
                 float tr = wr * real[t] - wi * imag[t];
@@ -73,20 +196,274 @@ void fft(float *real, float *imag, size_t n) {
                 imag[k + x] = u_imag + ti;
                 real[t] = u_real - tr;
                 imag[t] = u_imag - ti;
+            }
+        }
+    }
+}
+
+/*
+ * @brief Executa FFT (Transformada Rápida de Fourier) in-place (real + imag).
+ * @param real Array de floats com parte real
+ * @param imag Array de floats com parte imaginária
+ * @param n    Tamanho (potência de 2)
+ */
+void fft(float *real, float *imag, size_t n) {
+    if ((n & (n - 1)) != 0) {
+        ESP_LOGE(TAG_FFT, "FFT: n não é potência de 2.");
+        return;
+    }
+
+    const fft_plan_t *plan = fft_plan_get(n);
+    if (plan) {
+        fft_execute(plan, real, imag);
+    } else {
+        // Cache cheio: plano temporário
+        fft_plan_t *tmp = fft_plan_create(n);
+        if (!tmp) {
+            return;
+        }
+        fft_execute(tmp, real, imag);
+        fft_plan_destroy(tmp);
+    }
+
+    ESP_LOGD(TAG_FFT, "FFT concluída."); // Por janela: INFO na UART custaria parte do orçamento do frame
+}
 
-                // Atualiza wr e wi para o próximo ponto
-                float tmp_wr_new = wr * w_real - wi * w_imag;
-                float tmp_wi_new = wr * w_imag + wi * w_real;
-                wr = tmp_wr_new;
-                wi = tmp_wi_new;   
+/*
+ * @brief Lê W_n^idx = cos - i sin da tabela do plano, para idx < 3n/4.
+ * @param plan Plano de tamanho n
+ * @param idx  Expoente do twiddle
+ * @param wr   Parte real de saída
+ * @param wi   Parte imaginária de saída
+ */
+static inline void plan_twiddle(const fft_plan_t *plan, size_t idx, float *wr, float *wi) {
+    size_t half = plan->n >> 1;
+    if (idx < half) {
+        *wr = plan->cos_table[idx];
+        *wi = -plan->sin_table[idx];
+    } else {
+        // W^(idx) = -W^(idx - n/2)
+        *wr = -plan->cos_table[idx - half];
+        *wi = plan->sin_table[idx - half];
+    }
+}
+
+/**
+ * @brief FFT radix-4 portátil in-place sobre complexos intercalados
+ *        [re0, im0, re1, im1, ...] (layout dos buffers dsps_fft2r/4r do esp-dsp).
+ *        Para log2(n) ímpar, um estágio radix-2 precede os estágios radix-4.
+ * @param plan Plano criado para o tamanho n
+ * @param data Buffer com 2*n floats intercalados
+ */
+void fft_radix4_execute(const fft_plan_t *plan, float *data) {
+    if (!plan || !data) {
+        ESP_LOGE(TAG_FFT, "Parâmetros inválidos passados para fft_radix4_execute.");
+        return;
+    }
+
+    size_t n = plan->n;
+    const uint16_t *bitrev = plan->bitrev;
+
+    // Rearranjo de bit-reversal pela tabela
+    for (size_t i = 0; i < n; i++) {
+        size_t j = bitrev[i];
+        if (i < j) {
+            float tr = data[2 * i];
+            float ti = data[2 * i + 1];
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = tr;
+            data[2 * j + 1] = ti;
+        }
+    }
+
+    size_t L = 1;
+    size_t bits = 0;
+    while (((size_t)1 << bits) < n) {
+        bits++;
+    }
+
+    // Estágio radix-2 inicial quando n não é potência de 4 (twiddle trivial)
+    if (bits & 1u) {
+        for (size_t i = 0; i < n; i += 2) {
+            float ar = data[2 * i], ai = data[2 * i + 1];
+            float br = data[2 * i + 2], bi = data[2 * i + 3];
+            data[2 * i] = ar + br;
+            data[2 * i + 1] = ai + bi;
+            data[2 * i + 2] = ar - br;
+            data[2 * i + 3] = ai - bi;
+        }
+        L = 2;
+    }
+
+    // Estágios radix-4: em ordem bit-reversa, um bloco de 4L contém
+    // as sub-DFTs de tamanho L na ordem Y0, Y2, Y1, Y3
+    for (; L < n; L <<= 2) {
+        size_t stride = n / (4 * L);
+        for (size_t b = 0; b < n; b += 4 * L) {
+            for (size_t k = 0; k < L; k++) {
+                float *p0 = &data[2 * (b + k)];
+                float *p1 = &data[2 * (b + k + L)];
+                float *p2 = &data[2 * (b + k + 2 * L)];
+                float *p3 = &data[2 * (b + k + 3 * L)];
+
+                float w1r, w1i, w2r, w2i, w3r, w3i;
+                plan_twiddle(plan, k * stride, &w1r, &w1i);
+                plan_twiddle(plan, 2 * k * stride, &w2r, &w2i);
+                plan_twiddle(plan, 3 * k * stride, &w3r, &w3i);
+
+                float ar = p0[0], ai = p0[1];
+                // b = W^2k * Y2, c = W^k * Y1, d = W^3k * Y3
+                float br = w2r * p1[0] - w2i * p1[1];
+                float bi = w2r * p1[1] + w2i * p1[0];
+                float cr = w1r * p2[0] - w1i * p2[1];
+                float ci = w1r * p2[1] + w1i * p2[0];
+                float dr = w3r * p3[0] - w3i * p3[1];
+                float di = w3r * p3[1] + w3i * p3[0];
+
+                float s0r = ar + br, s0i = ai + bi;   // a + b
+                float s1r = ar - br, s1i = ai - bi;   // a - b
+                float s2r = cr + dr, s2i = ci + di;   // c + d
+                float s3r = cr - dr, s3i = ci - di;   // c - d
+
+                p0[0] = s0r + s2r;  p0[1] = s0i + s2i;
+                p2[0] = s0r - s2r;  p2[1] = s0i - s2i;
+                // (a - b) -/+ i (c - d)
+                p1[0] = s1r + s3i;  p1[1] = s1i - s3r;
+                p3[0] = s1r - s3i;  p3[1] = s1i + s3r;
             }
         }
-        if ((s % 50) == 0) {
-            taskYIELD();
-        }    
     }
+}
 
-    ESP_LOGI(TAG_FFT, "FFT concluída.");
+#if DSP_BACKEND == DSP_BACKEND_ESP_DSP
+static bool s_dsp_ready = false;
+#endif
+
+/**
+ * @brief Inicializa o backend da FFT intercalada (tabelas do esp-dsp no alvo).
+ * @param max_n Maior tamanho que será usado com fft_interleaved (potência de 2)
+ * @return 0 em sucesso, -1 em erro.
+ */
+int fft_interleaved_init(size_t max_n) {
+    if (max_n == 0 || (max_n & (max_n - 1)) != 0 || max_n > FFT_INTERLEAVED_MAX) {
+        ESP_LOGE(TAG_FFT, "Tamanho inválido para fft_interleaved_init: %zu.", max_n);
+        return -1;
+    }
+#if DSP_BACKEND == DSP_BACKEND_ESP_DSP
+    if (s_dsp_ready) {
+        return 0;
+    }
+    esp_err_t ret = dsps_fft2r_init_fc32(NULL, (int)max_n);
+    if (ret == ESP_OK) {
+        ret = dsps_fft4r_init_fc32(NULL, (int)max_n);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_FFT, "Falha ao inicializar tabelas do esp-dsp: %s", esp_err_to_name(ret));
+        return -1;
+    }
+    s_dsp_ready = true;
+#else
+    // Backend portátil: planos são criados sob demanda pelo cache
+    if (!fft_plan_get(max_n)) {
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * @brief FFT in-place sobre complexos intercalados usando o backend de DSP_BACKEND
+ *        (esp-dsp no alvo, radix-4 portátil no host).
+ * @param data Buffer com 2*n floats intercalados
+ * @param n    Tamanho (potência de 2)
+ */
+void fft_interleaved(float *data, size_t n) {
+    if (!data || n == 0 || (n & (n - 1)) != 0) {
+        ESP_LOGE(TAG_FFT, "Parâmetros inválidos passados para fft_interleaved.");
+        return;
+    }
+
+#if DSP_BACKEND == DSP_BACKEND_ESP_DSP
+    if (!s_dsp_ready) {
+        ESP_LOGE(TAG_FFT, "fft_interleaved_init não foi chamada.");
+        return;
+    }
+    // dsps_fft4r exige n potência de 4; caso contrário usa o radix-2
+    if ((n & 0x55555555u) != 0) {
+        dsps_fft4r_fc32(data, (int)n);
+        dsps_bit_rev4r_fc32(data, (int)n);
+    } else {
+        dsps_fft2r_fc32(data, (int)n);
+        dsps_bit_rev_fc32(data, (int)n);
+    }
+#else
+    const fft_plan_t *plan = fft_plan_get(n);
+    if (!plan) {
+        return;
+    }
+    fft_radix4_execute(plan, data);
+#endif
+}
+
+/**
+ * @brief FFT de entrada real: FFT complexa de N/2 pontos sobre as amostras
+ *        empacotadas (pares na parte real, ímpares na imaginária) seguida da
+ *        etapa de separação que produz os N/2+1 bins não redundantes.
+ * @param input Buffer com n amostras reais.
+ * @param real  Buffer de saída com n/2+1 partes reais.
+ * @param imag  Buffer de saída com n/2+1 partes imaginárias.
+ * @param n     Tamanho da transformada (potência de 2, >= 2)
+ */
+void rfft(const float *input, float *real, float *imag, size_t n) {
+    if (!input || !real || !imag || n < 2 || (n & (n - 1)) != 0) {
+        ESP_LOGE(TAG_FFT, "Parâmetros inválidos passados para rfft.");
+        return;
+    }
+
+    size_t h = n >> 1;
+
+    // Empacota x[2k] + i x[2k+1]
+    for (size_t k = 0; k < h; k++) {
+        real[k] = input[2 * k];
+        imag[k] = input[2 * k + 1];
+    }
+
+    fft(real, imag, h);
+
+    // Twiddles W_n^k da etapa de separação vêm do plano de tamanho n
+    const fft_plan_t *twiddle = fft_plan_get(n);
+
+    // Separação: X[k] = Fe + W^k Fo e X[h-k] = conj(Fe - W^k Fo)
+    float z0r = real[0];
+    float z0i = imag[0];
+    real[0] = z0r + z0i;
+    imag[0] = 0.0f;
+    real[h] = z0r - z0i;
+    imag[h] = 0.0f;
+
+    for (size_t k = 1; k <= h / 2; k++) {
+        size_t m = h - k;
+        float ar = real[k], ai = imag[k];
+        float br = real[m], bi = imag[m];
+
+        float fer = 0.5f * (ar + br);
+        float fei = 0.5f * (ai - bi);
+        float for_ = 0.5f * (ai + bi);
+        float foi = -0.5f * (ar - br);
+
+        float wr = twiddle ? twiddle->cos_table[k] : cosf(2.0f * (float)M_PI * (float)k / (float)n);
+        float wi = twiddle ? -twiddle->sin_table[k] : -sinf(2.0f * (float)M_PI * (float)k / (float)n);
+        float tr = wr * for_ - wi * foi;
+        float ti = wr * foi + wi * for_;
+
+        real[k] = fer + tr;
+        imag[k] = fei + ti;
+        if (m != k) {
+            real[m] = fer - tr;
+            imag[m] = -(fei - ti);
+        }
+    }
 }
 
 /**
@@ -110,6 +487,26 @@ void calculate_magnitude(const float *real, const float *imag, float *magnitude,
         }    
     }
 }
+/**
+ * @brief Calcula a magnitude do espectro no layout da rfft (n/2+1 bins).
+ * @param real      Buffer de partes reais (n/2+1).
+ * @param imag      Buffer de partes imaginárias (n/2+1).
+ * @param magnitude Buffer de saída para as n/2+1 magnitudes.
+ * @param n         Tamanho da transformada real.
+ */
+void calculate_magnitude_rfft(const float *real, const float *imag, float *magnitude, size_t n) {
+    if (!real || !imag || !magnitude || n < 2) {
+        ESP_LOGE(TAG_FFT, "Parâmetros inválidos passados para calculate_magnitude_rfft.");
+        return;
+    }
+
+    // Mesma normalização de calculate_magnitude (pelo tamanho da transformada)
+    size_t bins = (n >> 1) + 1;
+    for (size_t i = 0; i < bins; i++) {
+        magnitude[i] = sqrtf(real[i] * real[i] + imag[i] * imag[i]) / (float)n;
+    }
+}
+
 /**
  * @brief Calcula as frequências correspondentes a cada bin de magnitude da FFT.
  * @param magnitude    Array com magnitudes da FFT.
@@ -137,3 +534,216 @@ float frequency(const float *magnitude, float *frequency, size_t length, int sam
     ESP_LOGI(TAG_FFT, "Frequências calculadas com sucesso.");
     return 0.0f; // Sucesso
 }
+
+/**
+ * @brief Calcula as frequências dos n/2+1 bins produzidos pela rfft.
+ * @param magnitude    Array com magnitudes da rfft.
+ * @param frequency    Buffer onde serão armazenadas as n/2+1 frequências.
+ * @param n            Tamanho da transformada real.
+ * @param sample_rate  Taxa de amostragem em Hz.
+ * @return 0 em sucesso, -1 em erro.
+ */
+float frequency_rfft(const float *magnitude, float *frequency, size_t n, int sample_rate) {
+    if (!magnitude || n < 2 || !frequency) {
+        ESP_LOGE(TAG_FFT, "Parâmetros inválidos passados para frequency_rfft.");
+        return -1.0f;
+    }
+
+    float freq_resolution = (float)sample_rate / (float)n;
+    size_t bins = (n >> 1) + 1;
+    for (size_t i = 0; i < bins; i++) {
+        frequency[i] = i * freq_resolution;
+    }
+
+    return 0.0f; // Sucesso
+}
+
+/* ----------------------------------------------------------------
+ *  Harmonic Product Spectrum
+ * ---------------------------------------------------------------- */
+
+/**
+ * @brief Prepara o estimador HPS.
+ *
+ * @param hps         Ponteiro para o estimador.
+ * @param fft_size    Tamanho da rfft (as magnitudes têm fft_size/2 + 1 bins).
+ * @param sample_rate Taxa de amostragem em Hz.
+ * @param harmonics   Espectros no produto (>= 1).
+ * @param f_min       Menor fundamental buscada (Hz).
+ * @param f_max       Maior fundamental buscada (Hz; limitada para o último harmônico caber no espectro).
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t hps_init(hps_t *hps, size_t fft_size, float sample_rate, size_t harmonics, float f_min, float f_max) {
+    if (!hps || fft_size < 16 || sample_rate <= 0.0f || harmonics == 0 || f_min <= 0.0f || f_max <= f_min) {
+        ESP_LOGE(TAG_FFT, "Parâmetros inválidos passados para hps_init.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(hps, 0, sizeof(*hps));
+
+    float bin_hz = sample_rate / (float)fft_size;
+    hps->fft_size = fft_size;
+    hps->sample_rate = sample_rate;
+    hps->bins = fft_size / 2 + 1;
+    hps->harmonics = harmonics;
+
+    // O bin 0 (DC) não é candidato; o último harmônico (e o vizinho da interpolação) precisa caber
+    hps->k_min = (size_t)floorf(f_min / bin_hz);
+    hps->k_min = (hps->k_min < 1) ? 1 : hps->k_min;
+    hps->k_max = (size_t)ceilf(f_max / bin_hz);
+    size_t k_fit = (hps->bins - 2) / harmonics;
+    if (hps->k_max > k_fit) {
+        ESP_LOGW(TAG_FFT, "HPS: f_max limitada a %.1f Hz por %zu harmônicos.", (float)k_fit * bin_hz, harmonics);
+        hps->k_max = k_fit;
+    }
+    if (hps->k_max < hps->k_min + 2) {
+        ESP_LOGE(TAG_FFT, "HPS: faixa [%.1f, %.1f] Hz sem bins suficientes (n=%zu).", f_min, f_max, fft_size);
+        return ESP_ERR_INVALID_ARG;
+    }
+    hps->candidates = (hps->k_max - hps->k_min) * HPS_GRID + 1;
+
+    hps->log_mag = (float *)heap_caps_malloc((harmonics * hps->k_max + 2) * sizeof(float), MALLOC_CAP_8BIT);
+    hps->hps = (float *)heap_caps_malloc(hps->candidates * sizeof(float), MALLOC_CAP_8BIT);
+    if (!hps->log_mag || !hps->hps) {
+        ESP_LOGE(TAG_FFT, "Falha ao alocar scratch do HPS.");
+        hps_deinit(hps);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Deslocamento (-0.5..0.5) do vértice da parábola por (a, b, c), com b o maior dos três.
+ */
+static inline float parabolic_offset(float a, float b, float c) {
+    float den = a - 2.0f * b + c;
+    return (den < 0.0f) ? 0.5f * (a - c) / den : 0.0f;
+}
+
+/**
+ * @brief Estima a fundamental: produto dos espectros decimados, pico, correção de oitava
+ *        e interpolação parabólica dos picos dos harmônicos.
+ *
+ * @param hps       Ponteiro para o estimador.
+ * @param magnitude fft_size/2 + 1 magnitudes (ex.: calculate_magnitude_rfft).
+ * @param frequency Frequência estimada em Hz (-1 sem pitch).
+ * @return int      0 se uma frequência foi estimada, -1 caso contrário.
+ */
+int hps_detect(hps_t *hps, const float *magnitude, float *frequency) {
+    if (!hps || !hps->hps || !magnitude || !frequency) {
+        ESP_LOGE(TAG_FFT, "Parâmetros inválidos passados para hps_detect.");
+        return -1;
+    }
+    *frequency = -1.0f;
+    hps->salience = 0.0f;
+
+    const size_t H = hps->harmonics;
+    const size_t k_min = hps->k_min, n_cand = hps->candidates;
+    const size_t log_len = H * hps->k_max + 2;
+    const float step = 1.0f / (float)HPS_GRID;
+
+    // log|X| uma vez por bin; o piso relativo ao pico evita -inf e que bins vazios dominem a soma
+    float peak = 0.0f, energy = 0.0f;
+    for (size_t k = k_min; k < log_len; k++) {
+        float m = magnitude[k];
+        peak = (m > peak) ? m : peak;
+        energy += m * m;
+    }
+    if (peak <= 0.0f) {
+        return -1;
+    }
+    const float floor_mag = peak * 1e-5f;
+    for (size_t k = 0; k < log_len; k++) {
+        hps->log_mag[k] = logf(fmaxf(magnitude[k], floor_mag));
+    }
+
+    // Produto dos espectros decimados numa grade fracionária: o harmônico h do candidato c é lido
+    // em h*c por interpolação linear de log|X|. Tomar o máximo de uma janela de h bins tolera a
+    // fundamental fora do centro do bin, mas em bins baixos a janela vira ±25% e qualquer
+    // subharmônico encontra picos; na grade o erro de posição fica em h/(2*HPS_GRID) bin
+    size_t best = 0;
+    for (size_t i = 0; i < n_cand; i++) {
+        float c = (float)k_min + (float)i * step;
+        float sum = 0.0f;
+        for (size_t h = 1; h <= H; h++) {
+            float pos = (float)h * c;
+            size_t j = (size_t)pos;
+            float frac = pos - (float)j;
+            sum += hps->log_mag[j] + frac * (hps->log_mag[j + 1] - hps->log_mag[j]);
+        }
+        hps->hps[i] = sum;
+        if (sum > hps->hps[best]) {
+            best = i;
+        }
+    }
+
+    // Correção de oitava: fundamental fraca puxa o pico para 2*f0; aceita a suboitava quando
+    // o produto dela não fica muito abaixo do pico
+    const float octave_drop = (float)H * logf(HPS_OCTAVE_RATIO);
+    float c_best = (float)k_min + (float)best * step;
+    float c_half = 0.5f * c_best;
+    if (c_half >= (float)k_min + 1.0f) {
+        size_t mid = (size_t)lroundf((c_half - (float)k_min) * (float)HPS_GRID);
+        size_t cand = mid;
+        for (size_t i = mid - HPS_GRID / 2; i <= mid + HPS_GRID / 2 && i < n_cand; i++) {
+            cand = (hps->hps[i] > hps->hps[cand]) ? i : cand;
+        }
+        if (hps->hps[cand] - hps->hps[best] > octave_drop) {
+            best = cand;
+        }
+    }
+
+    // Fundamental fracionária pelo vértice da curva HPS
+    float k0 = (float)k_min + (float)best * step;
+    if (best > 0 && best + 1 < n_cand) {
+        k0 += step * parabolic_offset(hps->hps[best - 1], hps->hps[best], hps->hps[best + 1]);
+    }
+
+    // Refinamento: pico de cada harmônico (vizinhança de h*k0), interpolado em log|X|
+    // (parábola gaussiana); harmônicos altos dividem o erro de posição por h
+    float num = 0.0f, den = 0.0f, harm_energy = 0.0f;
+    for (size_t h = 1; h <= H; h++) {
+        long c = lroundf((float)h * k0);
+        if (c < 1 || (size_t)c + 1 >= hps->bins) {
+            break;
+        }
+        size_t j = (size_t)c;
+        if (magnitude[j - 1] > magnitude[j]) j--;
+        else if (magnitude[j + 1] > magnitude[j]) j++;
+        if (j < 1 || j + 1 >= log_len || magnitude[j] < magnitude[j - 1] || magnitude[j] < magnitude[j + 1]) {
+            continue;   // Sem pico local: harmônico ausente
+        }
+        float pos = (float)j + parabolic_offset(hps->log_mag[j - 1], hps->log_mag[j], hps->log_mag[j + 1]);
+        float w = magnitude[j] * (float)h;
+        num += w * pos / (float)h;
+        den += w;
+        harm_energy += magnitude[j - 1] * magnitude[j - 1] + magnitude[j] * magnitude[j] + magnitude[j + 1] * magnitude[j + 1];
+    }
+    float k_est = (den > 0.0f) ? num / den : k0;
+    if (k_est <= 0.0f) {
+        return -1;
+    }
+
+    hps->salience = (energy > 0.0f) ? fminf(harm_energy / energy, 1.0f) : 0.0f;
+    *frequency = k_est * hps->sample_rate / (float)hps->fft_size;
+    return 0;
+}
+
+/**
+ * @brief Confiança da última estimativa (fração da energia da faixa nos harmônicos, 0..1).
+ */
+float hps_confidence(const hps_t *hps) {
+    return hps ? hps->salience : 0.0f;
+}
+
+/**
+ * @brief Libera o scratch do estimador.
+ */
+void hps_deinit(hps_t *hps) {
+    if (!hps) {
+        return;
+    }
+    if (hps->log_mag) heap_caps_free(hps->log_mag);
+    if (hps->hps) heap_caps_free(hps->hps);
+    hps->log_mag = NULL;
+    hps->hps = NULL;
+}
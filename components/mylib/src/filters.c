@@ -2,6 +2,15 @@
 #include "filters.h"
 #include "utils.h"
 #include "esp_log.h"
+#include <complex.h>
+
+#if DSP_BACKEND == DSP_BACKEND_ESP_DSP
+#include "esp_dsp.h"
+#endif
+
+// sos_process passa &b0 / &z1 como coef[5] / w[2] ao dsps_biquad_f32
+_Static_assert(offsetof(biquad_t, z1) == 5 * sizeof(float) && offsetof(biquad_t, z2) == 6 * sizeof(float),
+               "biquad_t deve ser {b0, b1, b2, a1, a2, z1, z2} contíguos");
 
 const char *TAG_FILTER = "FILTER";
 
@@ -116,3 +125,427 @@ void biquad_process(biquad_t *filter, const float *in, float *out, size_t length
     filter->z1 = z1;
     filter->z2 = z2;
 }
+
+/* ----------------------------------------------------------------
+ *  Cascata de seções de 2ª ordem (SOS)
+ * ---------------------------------------------------------------- */
+
+/**
+ * @brief Polos do protótipo analógico passa-baixa normalizado (corte em 1 rad/s).
+ *
+ * @param poles     Saída com order polos.
+ * @param order     Ordem do protótipo.
+ * @param ripple_db Ripple do Chebyshev I em dB; <= 0 para Butterworth.
+ */
+static void analog_prototype(double complex *poles, int order, double ripple_db) {
+    if (ripple_db <= 0.0) {
+        for (int k = 0; k < order; k++) {
+            poles[k] = cexp(I * M_PI * (double)(2 * k + order + 1) / (double)(2 * order));
+        }
+        return;
+    }
+    double eps = sqrt(pow(10.0, ripple_db / 10.0) - 1.0);
+    double mu = asinh(1.0 / eps) / (double)order;
+    for (int k = 0; k < order; k++) {
+        double theta = M_PI * (double)(2 * k + 1) / (double)(2 * order);
+        poles[k] = -sinh(mu) * sin(theta) + I * cosh(mu) * cos(theta);
+    }
+}
+
+/**
+ * @brief Módulo de uma seção em exp(-jw).
+ */
+static double section_magnitude(const biquad_t *s, double w) {
+    double complex z1 = cexp(-I * w);
+    double complex z2 = z1 * z1;
+    double complex num = s->b0 + s->b1 * z1 + s->b2 * z2;
+    double complex den = 1.0 + s->a1 * z1 + s->a2 * z2;
+    return cabs(num) / cabs(den);
+}
+
+/**
+ * @brief Projeto comum (Butterworth / Chebyshev I): protótipo -> transformação analógica
+ *        -> bilinear -> pares de polos em seções, ganho unitário por seção na referência.
+ */
+static esp_err_t sos_design(sos_filter_t *f, sos_band_t band, int order, double ripple_db,
+                            float sample_rate, float f1, float f2) {
+    double nyquist = sample_rate / 2.0;
+    bool bp = (band == SOS_BANDPASS);
+    int max_order = bp ? FILTER_SOS_MAX_SECTIONS : 2 * FILTER_SOS_MAX_SECTIONS;
+    if (!f || sample_rate <= 0.0f || order < 1 || order > max_order || band > SOS_BANDPASS ||
+        f1 <= 0.0f || f1 >= nyquist || (bp && (f2 <= f1 || f2 >= nyquist))) {
+        ESP_LOGE(TAG_FILTER, "Parâmetros inválidos no projeto de SOS.");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Frequências analógicas pré-distorcidas para a bilinear
+    const double k = 2.0 * sample_rate;
+    double w1 = k * tan(M_PI * f1 / sample_rate);
+    double w2 = bp ? k * tan(M_PI * f2 / sample_rate) : 0.0;
+    double w0 = bp ? sqrt(w1 * w2) : w1;
+    double bw = w2 - w1;
+
+    double complex proto[2 * FILTER_SOS_MAX_SECTIONS];
+    double complex poles[2 * FILTER_SOS_MAX_SECTIONS];
+    analog_prototype(proto, order, ripple_db);
+
+    // Transformação analógica + bilinear, z = (k + s) / (k - s)
+    int num_poles = 0;
+    for (int i = 0; i < order; i++) {
+        if (band == SOS_LOWPASS) {
+            double complex s = w1 * proto[i];
+            poles[num_poles++] = (k + s) / (k - s);
+        } else if (band == SOS_HIGHPASS) {
+            double complex s = w1 / proto[i];
+            poles[num_poles++] = (k + s) / (k - s);
+        } else {
+            // s^2 - p*bw*s + w0^2 = 0: cada polo do protótipo gera dois polos
+            double complex pb = proto[i] * bw;
+            double complex root = csqrt(pb * pb - 4.0 * w0 * w0);
+            double complex sa = (pb + root) / 2.0;
+            double complex sb = (pb - root) / 2.0;
+            poles[num_poles++] = (k + sa) / (k - sa);
+            poles[num_poles++] = (k + sb) / (k - sb);
+        }
+    }
+
+    // Agrupa pares conjugados e pares de polos reais em seções
+    double radius[FILTER_SOS_MAX_SECTIONS];
+    double real_poles[2 * FILTER_SOS_MAX_SECTIONS];
+    int num_real = 0;
+    size_t n = 0;
+    for (int i = 0; i < num_poles; i++) {
+        double re = creal(poles[i]), im = cimag(poles[i]);
+        if (fabs(im) <= 1e-12) {
+            real_poles[num_real++] = re;
+        } else if (im > 0.0) {
+            biquad_t *s = &f->sections[n];
+            s->a1 = (float)(-2.0 * re);
+            s->a2 = (float)(re * re + im * im);
+            radius[n++] = cabs(poles[i]);
+        }
+    }
+    for (int i = 0; i < num_real; i += 2) {
+        biquad_t *s = &f->sections[n];
+        if (i + 1 < num_real) {
+            s->a1 = (float)(-(real_poles[i] + real_poles[i + 1]));
+            s->a2 = (float)(real_poles[i] * real_poles[i + 1]);
+            radius[n++] = fmax(fabs(real_poles[i]), fabs(real_poles[i + 1]));
+        } else {
+            s->a1 = (float)(-real_poles[i]);
+            s->a2 = 0.0f;
+            radius[n++] = fabs(real_poles[i]);
+        }
+    }
+    f->num_sections = n;
+
+    // Zeros: LP em z = -1, HP em z = +1, BP um em cada por seção
+    for (size_t i = 0; i < n; i++) {
+        biquad_t *s = &f->sections[i];
+        bool first_order = (s->a2 == 0.0f && !bp);
+        if (band == SOS_LOWPASS) {
+            s->b0 = 1.0f; s->b1 = first_order ? 1.0f : 2.0f;  s->b2 = first_order ? 0.0f : 1.0f;
+        } else if (band == SOS_HIGHPASS) {
+            s->b0 = 1.0f; s->b1 = first_order ? -1.0f : -2.0f; s->b2 = first_order ? 0.0f : 1.0f;
+        } else {
+            s->b0 = 1.0f; s->b1 = 0.0f; s->b2 = -1.0f;
+        }
+        s->z1 = s->z2 = 0.0f;
+    }
+
+    // Seções de polo menos ressonante primeiro (menor pico interno na cascata)
+    for (size_t i = 1; i < n; i++) {
+        biquad_t s = f->sections[i];
+        double r = radius[i];
+        size_t j = i;
+        for (; j > 0 && radius[j - 1] > r; j--) {
+            f->sections[j] = f->sections[j - 1];
+            radius[j] = radius[j - 1];
+        }
+        f->sections[j] = s;
+        radius[j] = r;
+    }
+
+    // Ganho unitário por seção na frequência de referência (distribui a escala pela cascata)
+    double w_ref = (band == SOS_LOWPASS) ? 0.0 :
+                   (band == SOS_HIGHPASS) ? M_PI : 2.0 * atan(w0 / k);
+    for (size_t i = 0; i < n; i++) {
+        biquad_t *s = &f->sections[i];
+        double g = 1.0 / section_magnitude(s, w_ref);
+        s->b0 = (float)(s->b0 * g);
+        s->b1 = (float)(s->b1 * g);
+        s->b2 = (float)(s->b2 * g);
+    }
+    // Chebyshev de ordem par: a referência fica no vale do ripple
+    if (ripple_db > 0.0 && (order % 2) == 0) {
+        double g = 1.0 / sqrt(pow(10.0, ripple_db / 10.0));
+        f->sections[0].b0 = (float)(f->sections[0].b0 * g);
+        f->sections[0].b1 = (float)(f->sections[0].b1 * g);
+        f->sections[0].b2 = (float)(f->sections[0].b2 * g);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Projeta um Butterworth (bilinear com pré-distorção) como cascata de SOS.
+ *
+ * @param f           Ponteiro para a cascata (substituída).
+ * @param band        Passa-baixa, passa-alta ou passa-banda.
+ * @param order       Ordem do protótipo (1..FILTER_SOS_MAX_SECTIONS, até 2x para LP/HP).
+ * @param sample_rate Taxa de amostragem em Hz.
+ * @param f1          Corte (LP/HP) ou borda inferior (BP) em Hz.
+ * @param f2          Borda superior (BP) em Hz; ignorado para LP/HP.
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t sos_design_butterworth(sos_filter_t *f, sos_band_t band, int order,
+                                 float sample_rate, float f1, float f2) {
+    return sos_design(f, band, order, 0.0, sample_rate, f1, f2);
+}
+
+/**
+ * @brief Projeta um Chebyshev tipo I (ripple na banda passante) como cascata de SOS.
+ *
+ * @param f           Ponteiro para a cascata (substituída).
+ * @param band        Passa-baixa, passa-alta ou passa-banda.
+ * @param order       Ordem do protótipo.
+ * @param ripple_db   Ripple máximo na banda passante em dB (> 0).
+ * @param sample_rate Taxa de amostragem em Hz.
+ * @param f1          Borda da banda passante (LP/HP) ou borda inferior (BP) em Hz.
+ * @param f2          Borda superior (BP) em Hz; ignorado para LP/HP.
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t sos_design_chebyshev1(sos_filter_t *f, sos_band_t band, int order, float ripple_db,
+                                float sample_rate, float f1, float f2) {
+    if (ripple_db <= 0.0f) {
+        ESP_LOGE(TAG_FILTER, "Ripple inválido para Chebyshev: %.3f dB.", ripple_db);
+        return ESP_ERR_INVALID_ARG;
+    }
+    return sos_design(f, band, order, ripple_db, sample_rate, f1, f2);
+}
+
+/**
+ * @brief Preset: bloqueador de DC de 1ª ordem, y[n] = x[n] - x[n-1] + R*y[n-1].
+ *
+ * @param f           Ponteiro para a cascata (substituída).
+ * @param sample_rate Taxa de amostragem em Hz.
+ * @param cutoff      Frequência de -3 dB em Hz (ex.: 10 Hz).
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t sos_dc_blocker(sos_filter_t *f, float sample_rate, float cutoff) {
+    if (!f || sample_rate <= 0.0f || cutoff <= 0.0f || cutoff >= sample_rate / 4.0f) {
+        ESP_LOGE(TAG_FILTER, "Parâmetros inválidos em sos_dc_blocker.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    float r = expf(-2.0f * (float)M_PI * cutoff / sample_rate);
+    float g = (1.0f + r) / 2.0f; // Ganho unitário em Nyquist
+    f->sections[0] = (biquad_t){ .b0 = g, .b1 = -g, .b2 = 0.0f, .a1 = -r, .a2 = 0.0f };
+    f->num_sections = 1;
+    return ESP_OK;
+}
+
+/**
+ * @brief Preset: notches anti-zumbido na frequência da rede e harmônicos.
+ *
+ * @param f           Ponteiro para a cascata (substituída).
+ * @param sample_rate Taxa de amostragem em Hz.
+ * @param mains_hz    Frequência da rede (50 ou 60 Hz).
+ * @param harmonics   Número de notches (f, 2f, ...), até FILTER_SOS_MAX_SECTIONS.
+ * @param q           Fator Q de cada notch.
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t sos_hum_notch(sos_filter_t *f, float sample_rate, float mains_hz, int harmonics, float q) {
+    if (!f || sample_rate <= 0.0f || mains_hz <= 0.0f || q <= 0.0f ||
+        harmonics < 1 || harmonics > FILTER_SOS_MAX_SECTIONS) {
+        ESP_LOGE(TAG_FILTER, "Parâmetros inválidos em sos_hum_notch.");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    f->num_sections = 0;
+    for (int h = 1; h <= harmonics; h++) {
+        float f0 = mains_hz * (float)h;
+        if (f0 >= sample_rate / 2.0f) {
+            break;
+        }
+        // Em double: em 50/60 Hz, cos(w0) ~ 0.9997 e a profundidade do notch depende dos últimos bits
+        double w0 = 2.0 * M_PI * (double)f0 / (double)sample_rate;
+        double cos_w0 = cos(w0);
+        double alpha = sin(w0) / (2.0 * (double)q);
+        double a0 = 1.0 + alpha;
+        f->sections[f->num_sections++] = (biquad_t){
+            .b0 = (float)(1.0 / a0), .b1 = (float)(-2.0 * cos_w0 / a0), .b2 = (float)(1.0 / a0),
+            .a1 = (float)(-2.0 * cos_w0 / a0), .a2 = (float)((1.0 - alpha) / a0),
+        };
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Concatena as seções de src ao fim de dst (ex.: passa-banda + notch).
+ *
+ * @param dst Cascata de destino.
+ * @param src Cascata de origem.
+ * @return esp_err_t ESP_OK em sucesso, ESP_ERR_INVALID_SIZE se exceder FILTER_SOS_MAX_SECTIONS.
+ */
+esp_err_t sos_append(sos_filter_t *dst, const sos_filter_t *src) {
+    if (!dst || !src) {
+        ESP_LOGE(TAG_FILTER, "Ponteiro nulo passado para sos_append.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (dst->num_sections + src->num_sections > FILTER_SOS_MAX_SECTIONS) {
+        ESP_LOGE(TAG_FILTER, "Cascata excede %d seções.", FILTER_SOS_MAX_SECTIONS);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(&dst->sections[dst->num_sections], src->sections, src->num_sections * sizeof(biquad_t));
+    dst->num_sections += src->num_sections;
+    return ESP_OK;
+}
+
+/**
+ * @brief Filtro de entrada do pipeline: passa-banda Butterworth [f_low, f_high] de ordem
+ *        2*FILTER_BANDPASS_ORDER e, com FILTER_HUM_HZ > 0, os notches da rede.
+ *
+ * @param f           Ponteiro para a cascata.
+ * @param sample_rate Taxa de amostragem em Hz.
+ * @param f_low       Borda inferior em Hz.
+ * @param f_high      Borda superior em Hz.
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t sos_input_filter_init(sos_filter_t *f, float sample_rate, float f_low, float f_high) {
+    esp_err_t ret = sos_design_butterworth(f, SOS_BANDPASS, FILTER_BANDPASS_ORDER, sample_rate, f_low, f_high);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (FILTER_HUM_HZ > 0.0f) {
+        sos_filter_t hum;
+        ret = sos_hum_notch(&hum, sample_rate, FILTER_HUM_HZ, FILTER_HUM_HARMONICS, FILTER_HUM_Q);
+        if (ret == ESP_OK) {
+            ret = sos_append(f, &hum);
+        }
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    ESP_LOGI(TAG_FILTER, "Filtro de entrada: passa-banda %.1f-%.1f Hz ordem %d, %zu seções.",
+             f_low, f_high, 2 * FILTER_BANDPASS_ORDER, f->num_sections);
+    return ESP_OK;
+}
+
+/**
+ * @brief Zera os estados de todas as seções.
+ *
+ * @param f Ponteiro para a cascata.
+ */
+void sos_reset(sos_filter_t *f) {
+    if (!f) {
+        return;
+    }
+    for (size_t i = 0; i < f->num_sections; i++) {
+        f->sections[i].z1 = 0.0f;
+        f->sections[i].z2 = 0.0f;
+    }
+}
+
+#if DSP_BACKEND != DSP_BACKEND_ESP_DSP
+/**
+ * @brief Duas seções em cascata, com a segunda defasada de uma amostra: na iteração i,
+ *        a seção 0 processa a amostra i e a seção 1 a amostra i-1. As duas recorrências
+ *        ficam independentes dentro da iteração e o bloco é lido/escrito uma vez só.
+ */
+static void sos_process_pair(biquad_t *s0, biquad_t *s1, const float *in, float *out, size_t length) {
+    const float b00 = s0->b0, b01 = s0->b1, b02 = s0->b2, a01 = s0->a1, a02 = s0->a2;
+    const float b10 = s1->b0, b11 = s1->b1, b12 = s1->b2, a11 = s1->a1, a12 = s1->a2;
+    float z01 = s0->z1, z02 = s0->z2;
+    float z11 = s1->z1, z12 = s1->z2;
+
+    // Prólogo: seção 0 na amostra 0
+    float x = in[0];
+    float y0 = b00 * x + z01;
+    z01 = b01 * x + z02 - a01 * y0;
+    z02 = b02 * x - a02 * y0;
+
+    for (size_t i = 1; i < length; i++) {
+        x = in[i];
+        float y0_next = b00 * x + z01;
+        float y1 = b10 * y0 + z11;
+        z01 = b01 * x + z02 - a01 * y0_next;
+        z11 = b11 * y0 + z12 - a11 * y1;
+        z02 = b02 * x - a02 * y0_next;
+        z12 = b12 * y0 - a12 * y1;
+        out[i - 1] = y1; // in[i - 1] já foi lido: in-place seguro
+        y0 = y0_next;
+    }
+
+    // Epílogo: seção 1 na última amostra
+    float y1 = b10 * y0 + z11;
+    z11 = b11 * y0 + z12 - a11 * y1;
+    z12 = b12 * y0 - a12 * y1;
+    out[length - 1] = y1;
+
+    s0->z1 = z01; s0->z2 = z02;
+    s1->z1 = z11; s1->z2 = z12;
+}
+#endif
+
+/**
+ * @brief Aplica a cascata a um bloco (in-place permitido). Portátil: seções processadas
+ *        aos pares com defasagem de uma amostra, para as duas recorrências se sobreporem;
+ *        esp-dsp: dsps_biquad_f32 por seção.
+ *
+ * @param f      Ponteiro para a cascata.
+ * @param in     Buffer de entrada.
+ * @param out    Buffer de saída.
+ * @param length Número de amostras.
+ */
+void sos_process(sos_filter_t *f, const float *in, float *out, size_t length) {
+    if (!f || !in || !out) {
+        ESP_LOGE(TAG_FILTER, "Ponteiro nulo passado para sos_process.");
+        return;
+    }
+    if (length == 0) {
+        return;
+    }
+    if (f->num_sections == 0) {
+        if (in != out) {
+            memmove(out, in, length * sizeof(float));
+        }
+        return;
+    }
+
+    const float *src = in;
+#if DSP_BACKEND == DSP_BACKEND_ESP_DSP
+    // Estado em forma direta II (w[2] do esp-dsp), consistente enquanto o backend for o mesmo
+    for (size_t i = 0; i < f->num_sections; i++) {
+        dsps_biquad_f32(src, out, (int)length, &f->sections[i].b0, &f->sections[i].z1);
+        src = out;
+    }
+#else
+    size_t i = 0;
+    for (; i + 1 < f->num_sections; i += 2) {
+        sos_process_pair(&f->sections[i], &f->sections[i + 1], src, out, length);
+        src = out;
+    }
+    if (i < f->num_sections) {
+        biquad_process(&f->sections[i], src, out, length);
+    }
+#endif
+}
+
+/**
+ * @brief Módulo da resposta em frequência da cascata.
+ *
+ * @param f           Ponteiro para a cascata.
+ * @param freq        Frequência em Hz.
+ * @param sample_rate Taxa de amostragem em Hz.
+ * @return float      |H(e^jw)|.
+ */
+float sos_magnitude(const sos_filter_t *f, float freq, float sample_rate) {
+    if (!f || sample_rate <= 0.0f) {
+        return 0.0f;
+    }
+    double w = 2.0 * M_PI * (double)freq / (double)sample_rate;
+    double mag = 1.0;
+    for (size_t i = 0; i < f->num_sections; i++) {
+        mag *= section_magnitude(&f->sections[i], w);
+    }
+    return (float)mag;
+}
@@ -0,0 +1,402 @@
+// src/fixed_dsp.c
+#include "fixed_dsp.h"
+#include "fft.h"
+#include "utils.h"
+#include "def.h"
+#include "esp_log.h"
+
+static const char *TAG_FIXED = "FIXED";
+
+// Pior crescimento de um butterfly radix-2 por componente: 1 + sqrt(2).
+// Mantendo |x| <= 13500 antes do estágio, a saída fica abaixo de 32767.
+#define FX_BFP_LIMIT        (13500)
+
+/**
+ * @brief Satura um valor de 64 bits para Q31.
+ */
+static inline q31_t sat_q31(int64_t x) {
+    if (x > INT32_MAX) return INT32_MAX;
+    if (x < INT32_MIN) return INT32_MIN;
+    return (q31_t)x;
+}
+
+/**
+ * @brief Satura um valor de 32 bits para Q15.
+ */
+static inline q15_t sat_q15(int32_t x) {
+    if (x > INT16_MAX) return INT16_MAX;
+    if (x < INT16_MIN) return INT16_MIN;
+    return (q15_t)x;
+}
+
+/**
+ * @brief Converte frames brutos do INMP441 (24 bits alinhados à esquerda) para Q31.
+ *        O formato já é Q31: apenas zera os 8 bits menos significativos.
+ *
+ * @param raw    Frames int32 como vindos do DMA.
+ * @param out    Saída em Q31 (pode ser igual a raw).
+ * @param length Número de frames.
+ * @param level  Acumula soma, quadrados e pico (em unidades de fundo de escala) para o gate
+ *               de energia, ou NULL.
+ */
+void fx_i2s_to_q31(const int32_t *raw, q31_t *out, size_t length, audio_level_t *level) {
+    if (!level) {
+        for (size_t i = 0; i < length; i++) {
+            out[i] = (q31_t)((uint32_t)raw[i] & 0xFFFFFF00u);
+        }
+        return;
+    }
+
+    // Acumuladores inteiros sobre os 24 bits: |s|^2 < 2^46, cabe em int64 para qualquer janela
+    int64_t sum = 0, sum_sq = 0;
+    int32_t peak = 0;
+    for (size_t i = 0; i < length; i++) {
+        int32_t s = raw[i] >> 8;
+        out[i] = (q31_t)((uint32_t)raw[i] & 0xFFFFFF00u);
+        sum += s;
+        sum_sq += (int64_t)s * s;
+        int32_t a = (s < 0) ? -s : s;
+        peak = (a > peak) ? a : peak;
+    }
+    const float scale = 1.0f / (float)(1 << 23);
+    level->sum += (float)sum * scale;
+    level->sum_sq += (float)sum_sq * scale * scale;
+    level->peak = fmaxf(level->peak, (float)peak * scale);
+    level->count += length;
+}
+
+/**
+ * @brief Reduz Q31 para Q15 normalizando o bloco (usa toda a faixa dinâmica do Q15).
+ *
+ * @param in     Buffer em Q31.
+ * @param out    Buffer em Q15.
+ * @param length Número de amostras.
+ * @return int   Expoente do bloco: valor real = out / 2^15 * 2^expoente.
+ */
+int fx_q31_to_q15_block(const q31_t *in, q15_t *out, size_t length) {
+    uint32_t peak = 0;
+    for (size_t i = 0; i < length; i++) {
+        uint32_t a = (in[i] < 0) ? (uint32_t)0 - (uint32_t)in[i] : (uint32_t)in[i];
+        if (a > peak) {
+            peak = a;
+        }
+    }
+
+    // Bits de folga: deslocamentos à esquerda possíveis sem estourar o Q31
+    int headroom = 0;
+    if (peak == 0) {
+        headroom = 0;
+    } else {
+        while (headroom < 16 && (peak << headroom) < 0x40000000u) {
+            headroom++;
+        }
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        int32_t v = (int32_t)((uint32_t)in[i] << headroom);
+        out[i] = sat_q15((v >> 16) + ((v >> 15) & 1));
+    }
+    return -headroom;
+}
+
+/**
+ * @brief Pré-computa uma janela em Q15.
+ *
+ * @param w           Ponteiro para a janela.
+ * @param length      Comprimento da janela.
+ * @param window_type Tipo de janela (window_type_t).
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t fx_window_init(fx_window_t *w, size_t length, int window_type) {
+    if (!w || length < 2) {
+        ESP_LOGE(TAG_FIXED, "Parâmetros inválidos passados para fx_window_init.");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Coeficientes da mesma tabela em cache do caminho float (NULL = retangular)
+    const float *src = window_get(window_type, length);
+    if (!src && window_type != WINDOW_RECTANGULAR) {
+        return ESP_FAIL;
+    }
+
+    w->table = (q15_t *)heap_caps_malloc(length * sizeof(q15_t), MALLOC_CAP_8BIT);
+    if (!w->table) {
+        ESP_LOGE(TAG_FIXED, "Falha ao alocar tabela da janela Q15.");
+        return ESP_ERR_NO_MEM;
+    }
+    w->length = length;
+    w->window_type = window_type;
+
+    for (size_t i = 0; i < length; i++) {
+        float v = src ? src[i] : 1.0f;
+        w->table[i] = sat_q15((int32_t)lrintf(v * 32767.0f));
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Aplica a janela Q15 a um buffer Q31 (in-place).
+ *
+ * @param w      Janela pré-computada.
+ * @param buffer Buffer Q31 com w->length amostras.
+ */
+void fx_window_apply_q31(const fx_window_t *w, q31_t *buffer) {
+    if (!w || !w->table || !buffer) {
+        ESP_LOGE(TAG_FIXED, "Parâmetros inválidos passados para fx_window_apply_q31.");
+        return;
+    }
+    for (size_t i = 0; i < w->length; i++) {
+        buffer[i] = (q31_t)(((int64_t)buffer[i] * w->table[i]) >> 15);
+    }
+}
+
+/**
+ * @brief Libera a tabela da janela.
+ *
+ * @param w Ponteiro para a janela.
+ */
+void fx_window_deinit(fx_window_t *w) {
+    if (w && w->table) {
+        heap_caps_free(w->table);
+        w->table = NULL;
+        w->length = 0;
+    }
+}
+
+/**
+ * @brief Converte um coeficiente em float para Q30 (com saturação em [-2, 2)).
+ */
+static q31_t coef_to_q30(float c) {
+    float scaled = c * (float)FX_Q30_ONE;
+    if (scaled >= 2147483647.0f)  return INT32_MAX;
+    if (scaled <= -2147483648.0f) return INT32_MIN;
+    return (q31_t)lrintf(scaled);
+}
+
+/**
+ * @brief Converte um biquad em float (coeficientes já projetados) para Q31 e zera os estados.
+ *
+ * @param dst Biquad em ponto fixo.
+ * @param src Biquad em float (ex.: de bandpass_init).
+ */
+void biquad_q31_from_float(biquad_q31_t *dst, const biquad_t *src) {
+    if (!dst || !src) {
+        ESP_LOGE(TAG_FIXED, "Ponteiro nulo passado para biquad_q31_from_float.");
+        return;
+    }
+    dst->b0 = coef_to_q30(src->b0);
+    dst->b1 = coef_to_q30(src->b1);
+    dst->b2 = coef_to_q30(src->b2);
+    dst->a1 = coef_to_q30(src->a1);
+    dst->a2 = coef_to_q30(src->a2);
+    dst->x1 = dst->x2 = 0;
+    dst->y1 = dst->y2 = 0;
+}
+
+/**
+ * @brief Aplica o biquad Q31 (acumulador de 64 bits, saída saturada).
+ *
+ * @param f      Ponteiro para o biquad.
+ * @param in     Buffer de entrada Q31.
+ * @param out    Buffer de saída Q31 (pode ser igual a in).
+ * @param length Número de amostras.
+ */
+void biquad_q31_process(biquad_q31_t *f, const q31_t *in, q31_t *out, size_t length) {
+    if (!f || !in || !out) {
+        ESP_LOGE(TAG_FIXED, "Ponteiro nulo passado para biquad_q31_process.");
+        return;
+    }
+
+    const int64_t b0 = f->b0, b1 = f->b1, b2 = f->b2;
+    const int64_t a1 = f->a1, a2 = f->a2;
+    q31_t x1 = f->x1, x2 = f->x2;
+    q31_t y1 = f->y1, y2 = f->y2;
+
+    for (size_t i = 0; i < length; i++) {
+        q31_t x0 = in[i];
+        int64_t acc = b0 * x0 + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2; // Q61
+        q31_t y0 = sat_q31(acc >> 30);
+        x2 = x1; x1 = x0;
+        y2 = y1; y1 = y0;
+        out[i] = y0;
+    }
+
+    f->x1 = x1; f->x2 = x2;
+    f->y1 = y1; f->y2 = y2;
+}
+
+/**
+ * @brief Converte uma cascata SOS em float para Q31 e zera os estados.
+ *
+ * @param dst Cascata em ponto fixo.
+ * @param src Cascata em float (ex.: de sos_input_filter_init).
+ */
+void sos_q31_from_float(sos_q31_t *dst, const sos_filter_t *src) {
+    if (!dst || !src) {
+        ESP_LOGE(TAG_FIXED, "Ponteiro nulo passado para sos_q31_from_float.");
+        return;
+    }
+    dst->num_sections = src->num_sections;
+    for (size_t i = 0; i < src->num_sections; i++) {
+        biquad_q31_from_float(&dst->sections[i], &src->sections[i]);
+    }
+}
+
+/**
+ * @brief Aplica a cascata Q31, seção por seção (in-place permitido).
+ *
+ * @param f      Ponteiro para a cascata.
+ * @param in     Buffer de entrada Q31.
+ * @param out    Buffer de saída Q31.
+ * @param length Número de amostras.
+ */
+void sos_q31_process(sos_q31_t *f, const q31_t *in, q31_t *out, size_t length) {
+    if (!f || !in || !out) {
+        ESP_LOGE(TAG_FIXED, "Ponteiro nulo passado para sos_q31_process.");
+        return;
+    }
+    if (f->num_sections == 0 && in != out) {
+        memmove(out, in, length * sizeof(q31_t));
+    }
+    const q31_t *src = in;
+    for (size_t i = 0; i < f->num_sections; i++) {
+        biquad_q31_process(&f->sections[i], src, out, length);
+        src = out;
+    }
+}
+
+/**
+ * @brief Prepara as tabelas Q15 da FFT de tamanho n.
+ *
+ * @param fft Ponteiro para a estrutura da FFT.
+ * @param n   Tamanho (potência de 2, até 32768).
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t fx_fft_init(fx_fft_t *fft, size_t n) {
+    if (!fft || n < 2 || (n & (n - 1)) != 0 || n > 32768) {
+        ESP_LOGE(TAG_FIXED, "Parâmetros inválidos passados para fx_fft_init.");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const fft_plan_t *plan = fft_plan_get(n);
+    if (!plan) {
+        ESP_LOGE(TAG_FIXED, "Plano de FFT indisponível para n=%zu.", n);
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t half = n >> 1;
+    fft->twiddle = (q15_t *)heap_caps_malloc(2 * half * sizeof(q15_t), MALLOC_CAP_8BIT);
+    if (!fft->twiddle) {
+        ESP_LOGE(TAG_FIXED, "Falha ao alocar twiddles Q15.");
+        return ESP_ERR_NO_MEM;
+    }
+    for (size_t k = 0; k < half; k++) {
+        fft->twiddle[2 * k]     = sat_q15((int32_t)lrintf(plan->cos_table[k] * 32767.0f));
+        fft->twiddle[2 * k + 1] = sat_q15((int32_t)lrintf(-plan->sin_table[k] * 32767.0f));
+    }
+    fft->bitrev = plan->bitrev;
+    fft->n = n;
+    return ESP_OK;
+}
+
+/**
+ * @brief FFT complexa in-place em ponto flutuante de bloco: a cada estágio o bloco
+ *        é escalado por 2^-s apenas quando necessário para evitar overflow.
+ *
+ * @param fft      Tabelas da FFT.
+ * @param data     2*n valores Q15 intercalados (re, im).
+ * @param exponent Entrada: expoente atual do bloco; saída: expoente após a FFT.
+ */
+void fx_fft_q15(const fx_fft_t *fft, q15_t *data, int *exponent) {
+    if (!fft || !fft->twiddle || !data || !exponent) {
+        ESP_LOGE(TAG_FIXED, "Parâmetros inválidos passados para fx_fft_q15.");
+        return;
+    }
+    size_t n = fft->n;
+
+    // Permutação bit-reversal
+    for (size_t i = 0; i < n; i++) {
+        size_t j = fft->bitrev[i];
+        if (j > i) {
+            q15_t tr = data[2 * i], ti = data[2 * i + 1];
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = tr;
+            data[2 * j + 1] = ti;
+        }
+    }
+
+    for (size_t len = 2; len <= n; len <<= 1) {
+        // Escala do bloco para este estágio
+        int32_t peak = 0;
+        for (size_t i = 0; i < 2 * n; i++) {
+            int32_t a = data[i] < 0 ? -(int32_t)data[i] : data[i];
+            if (a > peak) {
+                peak = a;
+            }
+        }
+        int s = 0;
+        while ((peak >> s) > FX_BFP_LIMIT) {
+            s++;
+        }
+        *exponent += s;
+
+        size_t half = len >> 1;
+        size_t step = n / len;
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t k = 0; k < half; k++) {
+                int32_t wr = fft->twiddle[2 * k * step];
+                int32_t wi = fft->twiddle[2 * k * step + 1];
+                size_t a = i + k;
+                size_t b = a + half;
+
+                int32_t br = data[2 * b], bi = data[2 * b + 1];
+                // |w| <= 1 garante |wr*br - wi*bi| < 2^31
+                int32_t tr = (wr * br - wi * bi + (1 << 14)) >> 15;
+                int32_t ti = (wr * bi + wi * br + (1 << 14)) >> 15;
+                int32_t ar = data[2 * a], ai = data[2 * a + 1];
+
+                data[2 * a]     = sat_q15((ar + tr) >> s);
+                data[2 * a + 1] = sat_q15((ai + ti) >> s);
+                data[2 * b]     = sat_q15((ar - tr) >> s);
+                data[2 * b + 1] = sat_q15((ai - ti) >> s);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Magnitude normalizada (como calculate_magnitude_rfft) dos bins 0..n/2.
+ *
+ * @param data      Saída de fx_fft_q15 (intercalada).
+ * @param exponent  Expoente do bloco.
+ * @param magnitude Saída com n/2 + 1 magnitudes.
+ * @param n         Tamanho da FFT.
+ */
+void fx_magnitude_q15(const q15_t *data, int exponent, float *magnitude, size_t n) {
+    if (!data || !magnitude || n < 2) {
+        ESP_LOGE(TAG_FIXED, "Parâmetros inválidos passados para fx_magnitude_q15.");
+        return;
+    }
+
+    float scale = ldexpf(1.0f, exponent - 15) / (float)n;
+    size_t bins = (n >> 1) + 1;
+    for (size_t k = 0; k < bins; k++) {
+        float re = data[2 * k], im = data[2 * k + 1];
+        magnitude[k] = sqrtf(re * re + im * im) * scale;
+    }
+}
+
+/**
+ * @brief Libera as tabelas da FFT.
+ *
+ * @param fft Ponteiro para a estrutura da FFT.
+ */
+void fx_fft_deinit(fx_fft_t *fft) {
+    if (fft && fft->twiddle) {
+        heap_caps_free(fft->twiddle);
+        fft->twiddle = NULL;
+        fft->bitrev = NULL;
+        fft->n = 0;
+    }
+}
@@ -0,0 +1,150 @@
+// src/gate.c
+#include "gate.h"
+#include "esp_log.h"
+#include <math.h>
+#include <string.h>
+#include <inttypes.h>
+
+static const char *TAG_GATE = "GATE";
+
+#define GATE_FLOOR_DBFS (-200.0f)   // Nível de um bloco vazio ou em silêncio digital
+
+/**
+ * @brief Zera o acumulador de nível.
+ */
+void audio_level_reset(audio_level_t *level) {
+    if (level) {
+        memset(level, 0, sizeof(*level));
+    }
+}
+
+/**
+ * @brief Acumula amostras já em float (fontes que não passam pela conversão do I2S, ex.: WAV no host).
+ */
+void audio_level_accumulate(audio_level_t *level, const float *x, size_t length) {
+    if (!level || !x) {
+        return;
+    }
+    float sum = 0.0f, sum_sq = 0.0f, peak = level->peak;
+    for (size_t i = 0; i < length; i++) {
+        sum += x[i];
+        sum_sq += x[i] * x[i];
+        peak = fmaxf(peak, fabsf(x[i]));
+    }
+    level->sum += sum;
+    level->sum_sq += sum_sq;
+    level->peak = peak;
+    level->count += length;
+}
+
+/**
+ * @brief RMS do bloco em dBFS, sem o DC (-200 para bloco vazio ou silêncio digital).
+ */
+float audio_level_rms_dbfs(const audio_level_t *level) {
+    if (!level || level->count == 0) {
+        return GATE_FLOOR_DBFS;
+    }
+    float mean = level->sum / (float)level->count;
+    float var = level->sum_sq / (float)level->count - mean * mean;
+    return (var > 1e-20f) ? 10.0f * log10f(var) : GATE_FLOOR_DBFS;
+}
+
+/**
+ * @brief Pico do bloco em dBFS (-200 para bloco vazio ou silêncio digital).
+ */
+float audio_level_peak_dbfs(const audio_level_t *level) {
+    if (!level || level->count == 0 || level->peak <= 1e-10f) {
+        return GATE_FLOOR_DBFS;
+    }
+    return 20.0f * log10f(level->peak);
+}
+
+/**
+ * @brief Inicializa o gate (fechado).
+ *
+ * @param gate        Ponteiro para o gate.
+ * @param open_dbfs   RMS de abertura em dBFS.
+ * @param close_dbfs  RMS de fechamento em dBFS (<= open_dbfs).
+ * @param peak_dbfs   Pico que também abre o gate, em dBFS.
+ * @param hold_frames Janelas abaixo de close_dbfs antes de fechar.
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t energy_gate_init(energy_gate_t *gate, float open_dbfs, float close_dbfs, float peak_dbfs, uint32_t hold_frames) {
+    if (!gate || close_dbfs > open_dbfs) {
+        ESP_LOGE(TAG_GATE, "Parâmetros inválidos passados para energy_gate_init.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(gate, 0, sizeof(*gate));
+    gate->open_dbfs = open_dbfs;
+    gate->close_dbfs = close_dbfs;
+    gate->peak_dbfs = peak_dbfs;
+    gate->hold_frames = hold_frames;
+    gate->last_rms_dbfs = GATE_FLOOR_DBFS;
+    ESP_LOGI(TAG_GATE, "Gate: abre em %.1f dBFS (pico %.1f), fecha em %.1f dBFS após %" PRIu32 " janelas.",
+             open_dbfs, peak_dbfs, close_dbfs, hold_frames);
+    return ESP_OK;
+}
+
+/**
+ * @brief Avalia uma janela.
+ *
+ * @param gate   Ponteiro para o gate.
+ * @param level  Nível acumulado na conversão da janela.
+ * @return bool  true se a janela segue para a análise, false se é silêncio.
+ */
+bool energy_gate_process(energy_gate_t *gate, const audio_level_t *level) {
+    if (!gate || !level) {
+        return true;
+    }
+    float rms = audio_level_rms_dbfs(level);
+    gate->last_rms_dbfs = rms;
+    gate->frames++;
+
+    if (!gate->open) {
+        if (rms >= gate->open_dbfs || audio_level_peak_dbfs(level) >= gate->peak_dbfs) {
+            gate->open = true;
+            gate->below = 0;
+            gate->opens++;
+        }
+    } else if (rms < gate->close_dbfs) {
+        // Histerese no tempo: a cauda de uma nota não liga/desliga a cada janela
+        if (++gate->below > gate->hold_frames) {
+            gate->open = false;
+        }
+    } else {
+        gate->below = 0;
+    }
+
+    if (!gate->open) {
+        gate->skipped++;
+    }
+    return gate->open;
+}
+
+/**
+ * @brief Lê as estatísticas do gate.
+ *
+ * @param gate  Ponteiro para o gate.
+ * @param stats Estrutura de saída.
+ */
+void energy_gate_get_stats(const energy_gate_t *gate, energy_gate_stats_t *stats) {
+    if (!gate || !stats) {
+        return;
+    }
+    stats->frames = gate->frames;
+    stats->skipped = gate->skipped;
+    stats->opens = gate->opens;
+    stats->skip_ratio = gate->frames ? (float)gate->skipped / (float)gate->frames : 0.0f;
+    stats->last_rms_dbfs = gate->last_rms_dbfs;
+}
+
+/**
+ * @brief Zera os contadores (o estado aberto/fechado é mantido).
+ */
+void energy_gate_reset_stats(energy_gate_t *gate) {
+    if (gate) {
+        gate->frames = 0;
+        gate->skipped = 0;
+        gate->opens = 0;
+    }
+}
@@ -8,6 +8,9 @@ static const char *TAG_MIC = "MIC";
 // Handle do Canal I2S RX
 static i2s_chan_handle_t rx_handle = NULL;
 
+// Buffer de leitura estático (RAM interna), reutilizado por i2s_read_samples e i2s_discard_samples
+static int32_t s_chunk[I2S_READ_CHUNK];
+
 
 esp_err_t i2s_init(void)
 {
@@ -78,6 +81,21 @@ esp_err_t i2s_init(void)
     return ESP_OK;
 }
 
+/**
+ * @brief Converte frames brutos do INMP441 (24 bits em slot de 32) para float em [-1, +1].
+ * @param raw    Frames int32 como vindos do DMA
+ * @param out    Saída normalizada (pode ser o próprio buffer do consumidor)
+ * @param length Número de frames
+ */
+void i2s_convert_samples(const int32_t *raw, float *out, size_t length)
+{
+    const float scale = 1.0f / (float)(1 << 23);
+    for (size_t i = 0; i < length; i++) {
+        // SHIFT aritmético de 8 mantém os 24 bits significativos com sinal
+        out[i] = (float)(raw[i] >> 8) * scale;
+    }
+}
+
 size_t i2s_read_samples(float *buffer, size_t length)
 {
     if (rx_handle == NULL) {
@@ -85,41 +103,91 @@ size_t i2s_read_samples(float *buffer, size_t length)
         return 0;
     }
 
-    // Buffer temporário para leitura (int32_t devido a 24 bits)
-    int32_t *temp_buf = (int32_t *)heap_caps_malloc(BUFFER_SIZE * sizeof(int32_t), MALLOC_CAP_SPIRAM);
-    if (temp_buf == NULL) {
-        ESP_LOGE(TAG_MIC, "Falha ao alocar temp_buf.");
-        return 0;
+    size_t samples_read = 0;
+
+    while (samples_read < length) {
+        size_t want = length - samples_read;
+        if (want > I2S_READ_CHUNK) {
+            want = I2S_READ_CHUNK;
+        }
+
+        size_t bytes_read = 0;
+        esp_err_t ret = i2s_channel_read(rx_handle, s_chunk, want * sizeof(int32_t), &bytes_read, pdMS_TO_TICKS(1000));
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG_MIC, "Erro ao ler do I2S: %s", esp_err_to_name(ret));
+            break;
+        }
+
+        size_t got = bytes_read / sizeof(int32_t);
+        i2s_convert_samples(s_chunk, &buffer[samples_read], got);
+        samples_read += got;
+        if (got < want) {
+            break;
+        }
     }
-    size_t bytes_read = 0;
-    size_t to_read = length * sizeof(int32_t);
+    ESP_LOGD(TAG_MIC, "Processamento de %zu samples concluído.", samples_read);
 
-    // Bloqueia até ler
-    esp_err_t ret = i2s_channel_read(rx_handle, temp_buf, to_read, &bytes_read,  pdMS_TO_TICKS(1000));
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG_MIC, "Erro ao ler do I2S: %s", esp_err_to_name(ret));
+    return samples_read;
+}
+
+size_t i2s_read_to_ring(audio_ring_t *ring, size_t frames, TickType_t timeout)
+{
+    if (rx_handle == NULL || ring == NULL) {
+        ESP_LOGE(TAG_MIC, "I2S não foi inicializado.");
         return 0;
     }
 
-    size_t samples_read = bytes_read / sizeof(int32_t);
-    if (samples_read > BUFFER_SIZE) {
-        samples_read = BUFFER_SIZE;
-    }
+    size_t written = 0;
+    while (written < frames) {
+        int32_t *dst = NULL;
+        size_t span = audio_ring_write_acquire(ring, &dst);
+        if (span == 0) {
+            break; // Ring cheio: o chamador decide o que fazer
+        }
+        if (span > frames - written) {
+            span = frames - written;
+        }
 
-    for (size_t i = 0; i < samples_read; i++) {
-        // Conversão para 24 bits se for INMP441: 
-        // SHIFT 8 (24 bits significativos) e normaliza p/ [-1, +1]
-        int32_t d = (temp_buf[i] >> 8);
-        if (d & 0x800000) { // Verifica o bit de sinal (24º bit)
-            d |= 0xFF000000;
+        // DMA -> ring, sem buffer intermediário
+        size_t bytes_read = 0;
+        esp_err_t ret = i2s_channel_read(rx_handle, dst, span * sizeof(int32_t), &bytes_read, timeout);
+        size_t got = bytes_read / sizeof(int32_t);
+        audio_ring_write_commit(ring, got);
+        written += got;
+
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG_MIC, "Erro ao ler do I2S: %s", esp_err_to_name(ret));
+            break;
+        }
+        if (got < span) {
+            break;
         }
-        // Normalização para float
-        buffer[i] = (float)d / (float)(1 << 23);
     }
-    ESP_LOGD(TAG_MIC, "Processamento de %zu samples concluído.", samples_read);
+    return written;
+}
 
-    heap_caps_free(temp_buf);
-    return samples_read;
+size_t i2s_discard_samples(size_t length, TickType_t timeout)
+{
+    if (rx_handle == NULL) {
+        ESP_LOGE(TAG_MIC, "I2S não foi inicializado.");
+        return 0;
+    }
+
+    size_t discarded = 0;
+    while (discarded < length) {
+        size_t want = length - discarded;
+        if (want > I2S_READ_CHUNK) {
+            want = I2S_READ_CHUNK;
+        }
+
+        size_t bytes_read = 0;
+        esp_err_t ret = i2s_channel_read(rx_handle, s_chunk, want * sizeof(int32_t), &bytes_read, timeout);
+        discarded += bytes_read / sizeof(int32_t);
+        if (ret != ESP_OK || bytes_read < want * sizeof(int32_t)) {
+            break;
+        }
+    }
+    return discarded;
 }
 
 void i2s_deinit(void)
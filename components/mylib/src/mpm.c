@@ -0,0 +1,284 @@
+// src/mpm.c
+#include "mpm.h"
+#include "fft.h"
+#include "utils.h"
+#include "esp_log.h"
+#include <math.h>
+#include <string.h>
+
+static const char *TAG_MPM = "MPM";
+
+/**
+ * @brief Maior lag da busca: o período precisa caber ao menos duas vezes na janela.
+ */
+static size_t mpm_tau_max(size_t buffer_size, float sample_rate) {
+    size_t tau_max = (size_t)(sample_rate / LOW_FREQ);
+    return (tau_max > buffer_size / 2) ? buffer_size / 2 : tau_max;
+}
+
+/**
+ * @brief Tamanho da FFT da autocorrelação para buffer_size amostras a sample_rate
+ *        (o mesmo do YIN com YIN_DIFF_FFT, para os dois dividirem o scratch).
+ */
+size_t mpm_fft_size(size_t buffer_size, float sample_rate) {
+    size_t m = 1;
+    while (m < buffer_size + mpm_tau_max(buffer_size, sample_rate) + 1) {
+        m <<= 1;
+    }
+    return m;
+}
+
+/**
+ * @brief Inicializa o MPM.
+ *
+ * @param mpm          Ponteiro para o estado.
+ * @param buffer_size  Amostras por janela.
+ * @param sample_rate  Taxa de amostragem em Hz.
+ * @param k            Fração do maior pico-chave aceita (0..1).
+ * @param min_clarity  NSDF mínima no pico escolhido (0..1).
+ * @param fft_real     Scratch externo (mpm_fft_size floats) ou NULL para alocar um próprio.
+ * @param fft_imag     Idem, parte imaginária.
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t mpm_init(mpm_t *mpm, size_t buffer_size, float sample_rate, float k, float min_clarity,
+                   float *fft_real, float *fft_imag) {
+    if (!mpm || buffer_size < 16 || sample_rate <= 0.0f || k <= 0.0f || k > 1.0f || (!fft_real != !fft_imag)) {
+        ESP_LOGE(TAG_MPM, "Parâmetros inválidos passados para mpm_init.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(mpm, 0, sizeof(*mpm));
+
+    mpm->buffer_size = buffer_size;
+    mpm->sample_rate = sample_rate;
+    mpm->k = k;
+    mpm->min_clarity = min_clarity;
+    mpm->tau_min = (size_t)(sample_rate / HIGH_FREQ);
+    mpm->tau_min = (mpm->tau_min < 1) ? 1 : mpm->tau_min;
+    mpm->tau_max = mpm_tau_max(buffer_size, sample_rate);
+    if (mpm->tau_max < mpm->tau_min + 2) {
+        ESP_LOGE(TAG_MPM, "Janela de %zu amostras curta demais para a faixa de busca.", buffer_size);
+        return ESP_ERR_INVALID_ARG;
+    }
+    mpm->tau_min_limit = mpm->tau_min;
+    mpm->tau_max_limit = mpm->tau_max;
+    mpm->fft_size = mpm_fft_size(buffer_size, sample_rate);
+
+    mpm->fft_shared = (fft_real != NULL);
+    if (mpm->fft_shared) {
+        mpm->fft_real = fft_real;
+        mpm->fft_imag = fft_imag;
+    } else {
+        mpm->fft_real = (float *)heap_caps_malloc(mpm->fft_size * sizeof(float), MALLOC_CAP_8BIT);
+        mpm->fft_imag = (float *)heap_caps_malloc(mpm->fft_size * sizeof(float), MALLOC_CAP_8BIT);
+    }
+    mpm->nsdf = (float *)heap_caps_malloc((mpm->tau_max_limit + 2) * sizeof(float), MALLOC_CAP_8BIT);
+    mpm->energy = (float *)heap_caps_malloc((buffer_size + 1) * sizeof(float), MALLOC_CAP_8BIT);
+    if (!mpm->fft_real || !mpm->fft_imag || !mpm->nsdf || !mpm->energy) {
+        ESP_LOGE(TAG_MPM, "Falha na alocação de memória para buffers MPM.");
+        mpm_deinit(mpm);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG_MPM, "MPM inicializado com buffer_size=%zu, sample_rate=%.2f Hz, k=%.2f, fft=%zu%s",
+             buffer_size, sample_rate, k, mpm->fft_size, mpm->fft_shared ? " (compartilhada)" : "");
+    return ESP_OK;
+}
+
+/**
+ * @brief NSDF e escolha do pico a partir de fft_real[0..N) (amostras) e energy (somas prefixas).
+ */
+static int mpm_search(mpm_t *mpm, float *frequency) {
+    const size_t n = mpm->buffer_size;
+    const size_t m = mpm->fft_size;
+    const size_t tau_min = mpm->tau_min;
+    const size_t tau_max = mpm->tau_max;
+    float *re = mpm->fft_real;
+    float *im = mpm->fft_imag;
+    const float *e = mpm->energy;
+    float *nsdf = mpm->nsdf;
+
+    *frequency = -1.0f;
+    mpm->clarity = 0.0f;
+
+    // r(tau) pela FFT do espectro de potência (zero-padding até M evita aliasing circular)
+    memset(re + n, 0, (m - n) * sizeof(float));
+    memset(im, 0, m * sizeof(float));
+    fft(re, im, m);
+    for (size_t k = 0; k < m; k++) {
+        re[k] = re[k] * re[k] + im[k] * im[k];
+        im[k] = 0.0f;
+    }
+    fft(re, im, m);
+
+    // n(tau) = 2 r(tau) / m(tau), m(tau) = soma de x[j]^2 (j < N - tau) + soma de x[j]^2 (j >= tau)
+    const float scale = 2.0f / (float)m;
+    for (size_t tau = 0; tau <= tau_max + 1; tau++) {
+        float energy = e[n - tau] + (e[n] - e[tau]);
+        nsdf[tau] = (energy > 0.0f) ? scale * re[tau] / energy : 0.0f;
+    }
+
+    // Picos-chave: o maior valor de cada região positiva entre cruzamentos por zero,
+    // depois do lóbulo de tau = 0
+    size_t peaks[MPM_MAX_PEAKS];
+    size_t num_peaks = 0;
+    size_t tau = 1;
+    while (tau <= tau_max && nsdf[tau] > 0.0f) {
+        tau++;
+    }
+    bool in_region = false;
+    size_t cur = 0;
+    float best = 0.0f;
+    for (; tau <= tau_max && num_peaks < MPM_MAX_PEAKS; tau++) {
+        if (nsdf[tau] > 0.0f) {
+            if (!in_region || nsdf[tau] > nsdf[cur]) {
+                cur = tau;
+            }
+            in_region = true;
+        } else if (in_region) {
+            in_region = false;
+            if (cur >= tau_min) {
+                peaks[num_peaks++] = cur;
+                best = fmaxf(best, nsdf[cur]);
+            }
+        }
+    }
+    // Região aberta no fim: só conta se o máximo é interno (não a borda da busca)
+    if (in_region && cur >= tau_min && cur < tau_max && num_peaks < MPM_MAX_PEAKS) {
+        peaks[num_peaks++] = cur;
+        best = fmaxf(best, nsdf[cur]);
+    }
+    if (num_peaks == 0) {
+        return -1;
+    }
+
+    // Primeiro pico-chave acima de k x o maior (evita o erro de oitava para baixo)
+    size_t chosen = peaks[0];
+    for (size_t i = 0; i < num_peaks; i++) {
+        if (nsdf[peaks[i]] >= mpm->k * best) {
+            chosen = peaks[i];
+            break;
+        }
+    }
+
+    // Vértice da parábola: lag fracionário e clarity no pico
+    float a = nsdf[chosen - 1], b = nsdf[chosen], c = nsdf[chosen + 1];
+    float den = a - 2.0f * b + c;
+    float delta = (den < 0.0f) ? 0.5f * (a - c) / den : 0.0f;
+    float clarity = b - 0.25f * (a - c) * delta;
+    if (clarity < mpm->min_clarity) {
+        return -1;
+    }
+    mpm->clarity = (clarity > 1.0f) ? 1.0f : clarity;
+    *frequency = mpm->sample_rate / ((float)chosen + delta);
+    return 0;
+}
+
+/**
+ * @brief Detecta a fundamental de uma janela.
+ *
+ * @param mpm          Ponteiro para o estado.
+ * @param buffer       buffer_size amostras.
+ * @param frequency    Frequência detectada em Hz (-1 sem pitch).
+ * @return int         0 se uma frequência foi detectada, -1 caso contrário.
+ */
+int mpm_detect_pitch(mpm_t *mpm, const float *buffer, float *frequency) {
+    if (!mpm || !mpm->nsdf || !buffer || !frequency) {
+        ESP_LOGE(TAG_MPM, "Parâmetros inválidos passados para mpm_detect_pitch.");
+        return -1;
+    }
+    float acc = 0.0f;
+    mpm->energy[0] = 0.0f;
+    for (size_t j = 0; j < mpm->buffer_size; j++) {
+        float x = buffer[j];
+        mpm->fft_real[j] = x;
+        acc += x * x;
+        mpm->energy[j + 1] = acc;
+    }
+    return mpm_search(mpm, frequency);
+}
+
+/**
+ * @brief mpm_detect_pitch sobre amostras Q15 (convertidas direto no scratch da FFT).
+ */
+int mpm_detect_pitch_q15(mpm_t *mpm, const q15_t *buffer, float *frequency) {
+    if (!mpm || !mpm->nsdf || !buffer || !frequency) {
+        ESP_LOGE(TAG_MPM, "Parâmetros inválidos passados para mpm_detect_pitch_q15.");
+        return -1;
+    }
+    const float q = 1.0f / 32768.0f;
+    float acc = 0.0f;
+    mpm->energy[0] = 0.0f;
+    for (size_t j = 0; j < mpm->buffer_size; j++) {
+        float x = (float)buffer[j] * q;
+        mpm->fft_real[j] = x;
+        acc += x * x;
+        mpm->energy[j + 1] = acc;
+    }
+    return mpm_search(mpm, frequency);
+}
+
+/**
+ * @brief Restringe a faixa de busca a [f_min, f_max] (dentro da faixa de mpm_init);
+ *        valores <= 0 restauram o limite correspondente.
+ */
+esp_err_t mpm_set_search_range(mpm_t *mpm, float f_min, float f_max) {
+    if (!mpm || !mpm->nsdf || (f_min > 0.0f && f_max > 0.0f && f_max <= f_min)) {
+        ESP_LOGE(TAG_MPM, "Parâmetros inválidos passados para mpm_set_search_range.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t tau_min = mpm->tau_min_limit;
+    size_t tau_max = mpm->tau_max_limit;
+    if (f_max > 0.0f) {
+        float t = floorf(mpm->sample_rate / f_max);
+        tau_min = (t > (float)tau_min) ? (size_t)t : tau_min;
+    }
+    if (f_min > 0.0f) {
+        float t = ceilf(mpm->sample_rate / f_min);
+        tau_max = (t < (float)tau_max) ? (size_t)t : tau_max;
+    }
+    if (tau_max < tau_min + 2) {
+        tau_max = (tau_min + 2 < mpm->tau_max_limit) ? tau_min + 2 : mpm->tau_max_limit;
+        tau_min = tau_max - 2;
+    }
+    mpm->tau_min = tau_min;
+    mpm->tau_max = tau_max;
+    return ESP_OK;
+}
+
+/**
+ * @brief Volta à faixa completa e descarta a última estimativa.
+ */
+void mpm_reset(mpm_t *mpm) {
+    if (!mpm) {
+        return;
+    }
+    mpm->tau_min = mpm->tau_min_limit;
+    mpm->tau_max = mpm->tau_max_limit;
+    mpm->clarity = 0.0f;
+}
+
+/**
+ * @brief Confiança da última estimativa (clarity: NSDF no pico, 0..1).
+ */
+float mpm_confidence(const mpm_t *mpm) {
+    return mpm ? mpm->clarity : 0.0f;
+}
+
+/**
+ * @brief Libera os buffers (o scratch externo não é liberado).
+ */
+void mpm_deinit(mpm_t *mpm) {
+    if (!mpm) {
+        return;
+    }
+    if (!mpm->fft_shared) {
+        if (mpm->fft_real) heap_caps_free(mpm->fft_real);
+        if (mpm->fft_imag) heap_caps_free(mpm->fft_imag);
+    }
+    if (mpm->nsdf) heap_caps_free(mpm->nsdf);
+    if (mpm->energy) heap_caps_free(mpm->energy);
+    mpm->fft_real = NULL;
+    mpm->fft_imag = NULL;
+    mpm->nsdf = NULL;
+    mpm->energy = NULL;
+}
@@ -0,0 +1,232 @@
+// src/parallel.c
+#include "parallel.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG_PAR = "PARALLEL";
+
+#ifdef ESP_PLATFORM
+/* ----------------------------------------------------------------
+ *  Alvo: tasks FreeRTOS fixadas nos outros núcleos
+ *
+ *  Disparo: xTaskNotifyGive em cada worker. Join: o último worker a terminar
+ *  notifica a chamadora. O slot de notificação da chamadora pode ser compartilhado
+ *  com outros usos (o sdkconfig tem um único índice), então o join espera por pending
+ *  e tolera acordar antes; uma notificação do join que chegue atrasada só provoca
+ *  uma verificação extra em quem usa o mesmo slot.
+ * ---------------------------------------------------------------- */
+static size_t worker_part(par_executor_t *ex) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (size_t i = 0; i + 1 < ex->num_workers; i++) {
+        if (ex->tasks[i] == self) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static void par_worker_task(void *arg) {
+    par_executor_t *ex = (par_executor_t *)arg;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (atomic_load(&ex->stop)) {
+            break;
+        }
+        // O handle só é consultado após o primeiro disparo (já gravado por par_executor_init)
+        ex->fn(ex->ctx, worker_part(ex), ex->num_workers);
+        TaskHandle_t caller = ex->caller;
+        if (atomic_fetch_sub(&ex->pending, 1) == 1) {
+            xTaskNotifyGive(caller);
+        }
+    }
+    atomic_fetch_sub(&ex->pending, 1);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Cria os workers (num_workers - 1; com 1 o job roda inteiro na chamadora).
+ *
+ * @param ex          Ponteiro para o executor.
+ * @param num_workers Partes por job (1..PAR_MAX_WORKERS).
+ * @return esp_err_t  ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t par_executor_init(par_executor_t *ex, size_t num_workers) {
+    if (!ex || num_workers == 0 || num_workers > PAR_MAX_WORKERS) {
+        ESP_LOGE(TAG_PAR, "Parâmetros inválidos passados para par_executor_init.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(ex, 0, sizeof(*ex));
+    ex->num_workers = 1;
+
+    // Worker i no núcleo seguinte ao da chamadora (no S3: o outro núcleo)
+    BaseType_t core = xPortGetCoreID();
+    for (size_t i = 0; i + 1 < num_workers; i++) {
+        BaseType_t worker_core = (core + 1 + (BaseType_t)i) % portNUM_PROCESSORS;
+        if (xTaskCreatePinnedToCore(par_worker_task, "par_worker", PAR_WORKER_STACK, ex,
+                                    PAR_WORKER_PRIORITY, &ex->tasks[i], worker_core) != pdPASS) {
+            ESP_LOGE(TAG_PAR, "Falha ao criar o worker %zu.", i + 1);
+            par_executor_deinit(ex);
+            return ESP_ERR_NO_MEM;
+        }
+        ex->num_workers++;
+    }
+    ESP_LOGI(TAG_PAR, "Executor com %zu partes (chamadora no núcleo %d).", ex->num_workers, (int)core);
+    return ESP_OK;
+}
+
+/**
+ * @brief Executa fn em num_workers partes e retorna quando todas terminarem.
+ *        Não reentrante: um job por vez por executor.
+ *
+ * @param ex  Ponteiro para o executor (NULL: roda a parte única na chamadora).
+ * @param fn  Job.
+ * @param ctx Contexto repassado a cada parte.
+ */
+void par_executor_run(par_executor_t *ex, par_job_fn_t fn, void *ctx) {
+    if (!ex || ex->num_workers <= 1) {
+        fn(ctx, 0, 1);
+        return;
+    }
+
+    ex->fn = fn;
+    ex->ctx = ctx;
+    ex->caller = xTaskGetCurrentTaskHandle();
+    atomic_store(&ex->pending, ex->num_workers - 1);
+    for (size_t i = 0; i + 1 < ex->num_workers; i++) {
+        xTaskNotifyGive(ex->tasks[i]);
+    }
+
+    fn(ctx, 0, ex->num_workers);
+
+    while (atomic_load(&ex->pending) > 0) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+/**
+ * @brief Encerra os workers e libera o executor.
+ *
+ * @param ex Ponteiro para o executor.
+ */
+void par_executor_deinit(par_executor_t *ex) {
+    if (!ex || ex->num_workers <= 1) {
+        return;
+    }
+    atomic_store(&ex->stop, true);
+    atomic_store(&ex->pending, ex->num_workers - 1);
+    for (size_t i = 0; i + 1 < ex->num_workers; i++) {
+        xTaskNotifyGive(ex->tasks[i]);
+    }
+    while (atomic_load(&ex->pending) > 0) {
+        vTaskDelay(1);
+    }
+    ex->num_workers = 1;
+}
+
+#else
+/* ----------------------------------------------------------------
+ *  Host: pthreads (mesma divisão de partes do alvo)
+ * ---------------------------------------------------------------- */
+static size_t worker_part(par_executor_t *ex) {
+    pthread_t self = pthread_self();
+    for (size_t i = 0; i + 1 < ex->num_workers; i++) {
+        if (pthread_equal(ex->threads[i], self)) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static void *par_worker_thread(void *arg) {
+    par_executor_t *ex = (par_executor_t *)arg;
+    unsigned seen = 0;
+
+    pthread_mutex_lock(&ex->lock);
+    for (;;) {
+        while (ex->generation == seen && !atomic_load(&ex->stop)) {
+            pthread_cond_wait(&ex->start_cv, &ex->lock);
+        }
+        if (atomic_load(&ex->stop)) {
+            break;
+        }
+        seen = ex->generation;
+        pthread_mutex_unlock(&ex->lock);
+
+        ex->fn(ex->ctx, worker_part(ex), ex->num_workers);
+
+        pthread_mutex_lock(&ex->lock);
+        if (atomic_fetch_sub(&ex->pending, 1) == 1) {
+            pthread_cond_signal(&ex->done_cv);
+        }
+    }
+    pthread_mutex_unlock(&ex->lock);
+    return NULL;
+}
+
+esp_err_t par_executor_init(par_executor_t *ex, size_t num_workers) {
+    if (!ex || num_workers == 0 || num_workers > PAR_MAX_WORKERS) {
+        ESP_LOGE(TAG_PAR, "Parâmetros inválidos passados para par_executor_init.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(ex, 0, sizeof(*ex));
+    ex->num_workers = 1;
+    pthread_mutex_init(&ex->lock, NULL);
+    pthread_cond_init(&ex->start_cv, NULL);
+    pthread_cond_init(&ex->done_cv, NULL);
+
+    // Trava durante a criação: workers só consultam threads[] depois do primeiro job
+    pthread_mutex_lock(&ex->lock);
+    for (size_t i = 0; i + 1 < num_workers; i++) {
+        if (pthread_create(&ex->threads[i], NULL, par_worker_thread, ex) != 0) {
+            pthread_mutex_unlock(&ex->lock);
+            ESP_LOGE(TAG_PAR, "Falha ao criar o worker %zu.", i + 1);
+            par_executor_deinit(ex);
+            return ESP_ERR_NO_MEM;
+        }
+        ex->num_workers++;
+    }
+    pthread_mutex_unlock(&ex->lock);
+    ESP_LOGI(TAG_PAR, "Executor com %zu partes (pthreads).", ex->num_workers);
+    return ESP_OK;
+}
+
+void par_executor_run(par_executor_t *ex, par_job_fn_t fn, void *ctx) {
+    if (!ex || ex->num_workers <= 1) {
+        fn(ctx, 0, 1);
+        return;
+    }
+
+    pthread_mutex_lock(&ex->lock);
+    ex->fn = fn;
+    ex->ctx = ctx;
+    atomic_store(&ex->pending, ex->num_workers - 1);
+    ex->generation++;
+    pthread_cond_broadcast(&ex->start_cv);
+    pthread_mutex_unlock(&ex->lock);
+
+    fn(ctx, 0, ex->num_workers);
+
+    pthread_mutex_lock(&ex->lock);
+    while (atomic_load(&ex->pending) > 0) {
+        pthread_cond_wait(&ex->done_cv, &ex->lock);
+    }
+    pthread_mutex_unlock(&ex->lock);
+}
+
+void par_executor_deinit(par_executor_t *ex) {
+    if (!ex || atomic_load(&ex->stop)) {
+        return;
+    }
+    pthread_mutex_lock(&ex->lock);
+    atomic_store(&ex->stop, true);
+    pthread_cond_broadcast(&ex->start_cv);
+    pthread_mutex_unlock(&ex->lock);
+    for (size_t i = 0; i + 1 < ex->num_workers; i++) {
+        pthread_join(ex->threads[i], NULL);
+    }
+    ex->num_workers = 1;
+    pthread_cond_destroy(&ex->start_cv);
+    pthread_cond_destroy(&ex->done_cv);
+    pthread_mutex_destroy(&ex->lock);
+}
+#endif
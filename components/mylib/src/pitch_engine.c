@@ -0,0 +1,255 @@
+// src/pitch_engine.c
+#include "pitch_engine.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG_PENG = "PITCH_ENGINE";
+
+/* ----------------------------------------------------------------
+ *  YIN
+ * ---------------------------------------------------------------- */
+
+static esp_err_t yin_engine_init(void *state, const pitch_engine_config_t *cfg, pitch_scratch_t *scratch) {
+    Yin *yin = (Yin *)state;
+    // Inicializa sem scratch próprio; com YIN_DIFF_FFT passa a usar o compartilhado
+    esp_err_t ret = yin_init(yin, cfg->buffer_size, cfg->sample_rate, cfg->yin_threshold, cfg->yin_mode,
+                             cfg->yin_adaptive_min, cfg->yin_adaptive_max, cfg->yin_adaptive_step, YIN_DIFF_DIRECT);
+    if (ret == ESP_OK && cfg->yin_diff == YIN_DIFF_FFT) {
+        ret = yin_set_fft_scratch(yin, scratch->real, scratch->imag, scratch->fft_size);
+    }
+    return ret;
+}
+
+static int yin_engine_process(void *state, const float *frame, float *frequency) {
+    return yin_detect_pitch((Yin *)state, frame, frequency);
+}
+
+static int yin_engine_process_q15(void *state, const q15_t *frame, float *frequency) {
+    return yin_detect_pitch_q15((Yin *)state, frame, frequency);
+}
+
+static void yin_engine_reset(void *state)                  { yin_reset((Yin *)state); }
+static float yin_engine_confidence(const void *state)      { return yin_confidence((const Yin *)state); }
+static void yin_engine_deinit(void *state)                 { yin_deinit((Yin *)state); }
+
+static esp_err_t yin_engine_range(void *state, float f_min, float f_max) {
+    return yin_set_search_range((Yin *)state, f_min, f_max);
+}
+
+static const pitch_engine_ops_t s_yin_ops = {
+    .name = "yin",
+    .init = yin_engine_init,
+    .process_frame = yin_engine_process,
+    .process_frame_q15 = yin_engine_process_q15,
+    .reset = yin_engine_reset,
+    .get_confidence = yin_engine_confidence,
+    .set_search_range = yin_engine_range,
+    .deinit = yin_engine_deinit,
+};
+
+/* ----------------------------------------------------------------
+ *  MPM
+ * ---------------------------------------------------------------- */
+
+static esp_err_t mpm_engine_init(void *state, const pitch_engine_config_t *cfg, pitch_scratch_t *scratch) {
+    return mpm_init((mpm_t *)state, cfg->buffer_size, cfg->sample_rate, cfg->mpm_k, cfg->mpm_min_clarity,
+                    scratch->real, scratch->imag);
+}
+
+static int mpm_engine_process(void *state, const float *frame, float *frequency) {
+    return mpm_detect_pitch((mpm_t *)state, frame, frequency);
+}
+
+static int mpm_engine_process_q15(void *state, const q15_t *frame, float *frequency) {
+    return mpm_detect_pitch_q15((mpm_t *)state, frame, frequency);
+}
+
+static void mpm_engine_reset(void *state)                  { mpm_reset((mpm_t *)state); }
+static float mpm_engine_confidence(const void *state)      { return mpm_confidence((const mpm_t *)state); }
+static void mpm_engine_deinit(void *state)                 { mpm_deinit((mpm_t *)state); }
+
+static esp_err_t mpm_engine_range(void *state, float f_min, float f_max) {
+    return mpm_set_search_range((mpm_t *)state, f_min, f_max);
+}
+
+static const pitch_engine_ops_t s_mpm_ops = {
+    .name = "mpm",
+    .init = mpm_engine_init,
+    .process_frame = mpm_engine_process,
+    .process_frame_q15 = mpm_engine_process_q15,
+    .reset = mpm_engine_reset,
+    .get_confidence = mpm_engine_confidence,
+    .set_search_range = mpm_engine_range,
+    .deinit = mpm_engine_deinit,
+};
+
+static const pitch_engine_ops_t *const s_engines[PITCH_DETECTOR_COUNT] = {
+    [PITCH_DETECTOR_YIN] = &s_yin_ops,
+    [PITCH_DETECTOR_MPM] = &s_mpm_ops,
+};
+
+/* ----------------------------------------------------------------
+ *  Conjunto de motores
+ * ---------------------------------------------------------------- */
+
+/**
+ * @brief Interface de um detector (NULL se id inválido).
+ */
+const pitch_engine_ops_t *pitch_engine_ops(pitch_detector_t id) {
+    return ((unsigned)id < PITCH_DETECTOR_COUNT) ? s_engines[id] : NULL;
+}
+
+/**
+ * @brief Inicializa todos os motores sobre um scratch de autocorrelação compartilhado.
+ *
+ * @param pe       Ponteiro para o conjunto.
+ * @param cfg      Parâmetros (PITCH_ENGINE_CONFIG_DEFAULT).
+ * @param initial  Detector ativo no início.
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t pitch_engine_init(pitch_engine_t *pe, const pitch_engine_config_t *cfg, pitch_detector_t initial) {
+    if (!pe || !cfg || !pitch_engine_ops(initial)) {
+        ESP_LOGE(TAG_PENG, "Parâmetros inválidos passados para pitch_engine_init.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(pe, 0, sizeof(*pe));
+    pe->states[PITCH_DETECTOR_YIN] = &pe->yin;
+    pe->states[PITCH_DETECTOR_MPM] = &pe->mpm;
+
+    // Um só scratch de autocorrelação para YIN_DIFF_FFT e MPM (mesmo M >= N + tau_max + 1)
+    pe->scratch.fft_size = mpm_fft_size(cfg->buffer_size, cfg->sample_rate);
+    pe->scratch.real = (float *)heap_caps_malloc(pe->scratch.fft_size * sizeof(float), MALLOC_CAP_8BIT);
+    pe->scratch.imag = (float *)heap_caps_malloc(pe->scratch.fft_size * sizeof(float), MALLOC_CAP_8BIT);
+    if (!pe->scratch.real || !pe->scratch.imag) {
+        ESP_LOGE(TAG_PENG, "Falha ao alocar o scratch da autocorrelação (%zu pontos).", pe->scratch.fft_size);
+        pitch_engine_deinit(pe);
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < PITCH_DETECTOR_COUNT; i++) {
+        esp_err_t ret = s_engines[i]->init(pe->states[i], cfg, &pe->scratch);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG_PENG, "Falha ao inicializar o motor %s.", s_engines[i]->name);
+            pitch_engine_deinit(pe);
+            return ret;
+        }
+    }
+    pe->active = initial;
+    pe->requested = initial;
+    ESP_LOGI(TAG_PENG, "Motores de pitch prontos (ativo: %s, scratch de %zu pontos).",
+             s_engines[initial]->name, pe->scratch.fft_size);
+    return ESP_OK;
+}
+
+/**
+ * @brief Pede a troca do detector ativo (aplicada na próxima janela, com reset do novo motor).
+ */
+esp_err_t pitch_engine_select(pitch_engine_t *pe, pitch_detector_t id) {
+    if (!pe || !pitch_engine_ops(id)) {
+        ESP_LOGE(TAG_PENG, "Parâmetros inválidos passados para pitch_engine_select.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    pe->requested = id;
+    return ESP_OK;
+}
+
+/**
+ * @brief Detector ativo.
+ */
+pitch_detector_t pitch_engine_active(const pitch_engine_t *pe) {
+    return pe ? pe->active : PITCH_DETECTOR_YIN;
+}
+
+/**
+ * @brief Nome do detector ativo.
+ */
+const char *pitch_engine_name(const pitch_engine_t *pe) {
+    return pe ? s_engines[pe->active]->name : "?";
+}
+
+/**
+ * @brief Aplica a troca pedida antes de processar uma janela.
+ */
+static inline void apply_request(pitch_engine_t *pe) {
+    pitch_detector_t id = pe->requested;
+    if (id != pe->active) {
+        pe->active = id;
+        s_engines[id]->reset(pe->states[id]);
+        pe->switches++;
+        ESP_LOGI(TAG_PENG, "Detector de pitch: %s.", s_engines[id]->name);
+    }
+}
+
+/**
+ * @brief Detecta a fundamental de uma janela com o detector ativo.
+ *
+ * @param pe        Ponteiro para o conjunto.
+ * @param frame     buffer_size amostras.
+ * @param frequency Frequência em Hz (-1 sem pitch).
+ * @return int      0 se uma frequência foi detectada, -1 caso contrário.
+ */
+int pitch_engine_process(pitch_engine_t *pe, const float *frame, float *frequency) {
+    if (!pe || !pe->scratch.real) {
+        ESP_LOGE(TAG_PENG, "Parâmetros inválidos passados para pitch_engine_process.");
+        return -1;
+    }
+    apply_request(pe);
+    return s_engines[pe->active]->process_frame(pe->states[pe->active], frame, frequency);
+}
+
+/**
+ * @brief pitch_engine_process sobre amostras Q15.
+ */
+int pitch_engine_process_q15(pitch_engine_t *pe, const q15_t *frame, float *frequency) {
+    if (!pe || !pe->scratch.real) {
+        ESP_LOGE(TAG_PENG, "Parâmetros inválidos passados para pitch_engine_process_q15.");
+        return -1;
+    }
+    apply_request(pe);
+    return s_engines[pe->active]->process_frame_q15(pe->states[pe->active], frame, frequency);
+}
+
+/**
+ * @brief Confiança da última janela do detector ativo (0..1).
+ */
+float pitch_engine_confidence(const pitch_engine_t *pe) {
+    return pe ? s_engines[pe->active]->get_confidence(pe->states[pe->active]) : 0.0f;
+}
+
+/**
+ * @brief Restringe a faixa de busca do detector ativo (ex.: pré-estimativa do HPS).
+ */
+esp_err_t pitch_engine_set_search_range(pitch_engine_t *pe, float f_min, float f_max) {
+    if (!pe) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    apply_request(pe);
+    return s_engines[pe->active]->set_search_range(pe->states[pe->active], f_min, f_max);
+}
+
+/**
+ * @brief Reset do detector ativo.
+ */
+void pitch_engine_reset(pitch_engine_t *pe) {
+    if (pe) {
+        s_engines[pe->active]->reset(pe->states[pe->active]);
+    }
+}
+
+/**
+ * @brief Libera os motores e o scratch.
+ */
+void pitch_engine_deinit(pitch_engine_t *pe) {
+    if (!pe) {
+        return;
+    }
+    for (int i = 0; i < PITCH_DETECTOR_COUNT; i++) {
+        if (pe->states[i]) {
+            s_engines[i]->deinit(pe->states[i]);
+        }
+    }
+    if (pe->scratch.real) heap_caps_free(pe->scratch.real);
+    if (pe->scratch.imag) heap_caps_free(pe->scratch.imag);
+    pe->scratch.real = NULL;
+    pe->scratch.imag = NULL;
+}
@@ -0,0 +1,160 @@
+// src/pool.c
+#include "pool.h"
+#include "def.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG_POOL = "POOL";
+
+#define HEAD_INDEX(h)       ((uint16_t)((h) & 0xFFFFu))
+#define HEAD_PACK(tag, idx) ((((uint32_t)(tag) & 0xFFFFu) << 16) | (uint32_t)(idx))
+
+/**
+ * @brief Pré-aloca o slab do pool (chamar apenas na inicialização).
+ *
+ * @param pool       Ponteiro para o pool.
+ * @param name       Nome do pool para logs.
+ * @param block_size Tamanho de cada bloco em bytes.
+ * @param capacity   Número de blocos.
+ * @param caps       Capacidades de memória (ex.: MALLOC_CAP_SPIRAM).
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t block_pool_init(block_pool_t *pool, const char *name, size_t block_size, size_t capacity, uint32_t caps) {
+    if (!pool || block_size == 0 || capacity == 0 || capacity > POOL_MAX_CAPACITY) {
+        ESP_LOGE(TAG_POOL, "Parâmetros inválidos passados para block_pool_init.");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pool->name = name ? name : "pool";
+    pool->block_size = (block_size + 7u) & ~(size_t)7u;
+    pool->capacity = (uint16_t)capacity;
+    pool->slab = (uint8_t *)heap_caps_malloc(pool->block_size * capacity, caps);
+    pool->next = (_Atomic uint16_t *)heap_caps_malloc(capacity * sizeof(*pool->next), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!pool->slab || !pool->next) {
+        ESP_LOGE(TAG_POOL, "Falha ao alocar slab do pool %s (%zu x %zu bytes).", pool->name, capacity, pool->block_size);
+        block_pool_deinit(pool);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Free-list inicial: 0 -> 1 -> ... -> capacity-1 -> inválido
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_init(&pool->next[i], (uint16_t)((i + 1 < capacity) ? i + 1 : POOL_INVALID_INDEX));
+    }
+    atomic_init(&pool->head, HEAD_PACK(0, 0));
+    atomic_init(&pool->in_use, 0);
+    atomic_init(&pool->high_water, 0);
+    atomic_init(&pool->exhausted, 0);
+    atomic_init(&pool->acquired, 0);
+
+    ESP_LOGI(TAG_POOL, "Pool %s: %zu blocos de %zu bytes.", pool->name, capacity, pool->block_size);
+    return ESP_OK;
+}
+
+/**
+ * @brief Retira um bloco livre do pool (lock-free, não bloqueia).
+ *
+ * @param pool Ponteiro para o pool.
+ * @return pool_index_t Índice do bloco, ou POOL_INVALID_INDEX se o pool estiver vazio.
+ */
+pool_index_t block_pool_acquire(block_pool_t *pool) {
+    if (!pool || !pool->slab) {
+        return POOL_INVALID_INDEX;
+    }
+
+    uint32_t head = atomic_load_explicit(&pool->head, memory_order_acquire);
+    uint16_t idx;
+    do {
+        idx = HEAD_INDEX(head);
+        if (idx == POOL_INVALID_INDEX) {
+            atomic_fetch_add_explicit(&pool->exhausted, 1, memory_order_relaxed);
+            return POOL_INVALID_INDEX;
+        }
+        uint16_t next = atomic_load_explicit(&pool->next[idx], memory_order_relaxed);
+        uint32_t desired = HEAD_PACK((head >> 16) + 1, next);
+        if (atomic_compare_exchange_weak_explicit(&pool->head, &head, desired,
+                                                  memory_order_acq_rel, memory_order_acquire)) {
+            break;
+        }
+    } while (1);
+
+    atomic_fetch_add_explicit(&pool->acquired, 1, memory_order_relaxed);
+    uint32_t used = atomic_fetch_add_explicit(&pool->in_use, 1, memory_order_relaxed) + 1;
+    uint32_t peak = atomic_load_explicit(&pool->high_water, memory_order_relaxed);
+    while (used > peak &&
+           !atomic_compare_exchange_weak_explicit(&pool->high_water, &peak, used,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+    return idx;
+}
+
+/**
+ * @brief Devolve um bloco ao pool.
+ *
+ * @param pool Ponteiro para o pool.
+ * @param idx  Índice obtido por block_pool_acquire.
+ */
+void block_pool_release(block_pool_t *pool, pool_index_t idx) {
+    if (!pool || !pool->slab || idx >= pool->capacity) {
+        ESP_LOGE(TAG_POOL, "Índice inválido devolvido ao pool: %u.", (unsigned)idx);
+        return;
+    }
+
+    uint32_t head = atomic_load_explicit(&pool->head, memory_order_relaxed);
+    do {
+        atomic_store_explicit(&pool->next[idx], HEAD_INDEX(head), memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->head, &head, HEAD_PACK((head >> 16) + 1, idx),
+                                                    memory_order_release, memory_order_relaxed));
+
+    atomic_fetch_sub_explicit(&pool->in_use, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Retorna o endereço do bloco de índice idx.
+ *
+ * @param pool Ponteiro para o pool.
+ * @param idx  Índice do bloco.
+ * @return void* Ponteiro para o bloco, ou NULL se o índice for inválido.
+ */
+void *block_pool_get(const block_pool_t *pool, pool_index_t idx) {
+    if (!pool || !pool->slab || idx >= pool->capacity) {
+        return NULL;
+    }
+    return pool->slab + (size_t)idx * pool->block_size;
+}
+
+/**
+ * @brief Lê as estatísticas do pool.
+ *
+ * @param pool  Ponteiro para o pool.
+ * @param stats Estrutura de saída.
+ */
+void block_pool_get_stats(block_pool_t *pool, block_pool_stats_t *stats) {
+    if (!pool || !stats) {
+        return;
+    }
+    stats->capacity   = pool->capacity;
+    stats->in_use     = atomic_load_explicit(&pool->in_use, memory_order_relaxed);
+    stats->high_water = atomic_load_explicit(&pool->high_water, memory_order_relaxed);
+    stats->exhausted  = atomic_load_explicit(&pool->exhausted, memory_order_relaxed);
+    stats->acquired   = atomic_load_explicit(&pool->acquired, memory_order_relaxed);
+}
+
+/**
+ * @brief Libera o slab do pool.
+ *
+ * @param pool Ponteiro para o pool.
+ */
+void block_pool_deinit(block_pool_t *pool) {
+    if (!pool) {
+        return;
+    }
+    if (pool->slab) {
+        heap_caps_free(pool->slab);
+        pool->slab = NULL;
+    }
+    if (pool->next) {
+        heap_caps_free((void *)pool->next);
+        pool->next = NULL;
+    }
+    pool->capacity = 0;
+}
@@ -0,0 +1,438 @@
+// src/stage_graph.c
+#include "stage_graph.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+
+static const char *TAG_SG = "STAGE_GRAPH";
+
+/* ----------------------------------------------------------------
+ *  Backend: filas FreeRTOS e tasks fixadas no alvo, mutex/condição e pthreads no host
+ * ---------------------------------------------------------------- */
+#ifdef ESP_PLATFORM
+static bool sg_queue_create(stage_t *s, size_t capacity) {
+    s->queue = xQueueCreate(capacity, sizeof(pool_index_t));
+    return s->queue != NULL;
+}
+
+static void sg_queue_send(stage_t *s, pool_index_t idx) {
+    xQueueSend(s->queue, &idx, portMAX_DELAY);
+}
+
+static pool_index_t sg_queue_receive(stage_t *s) {
+    pool_index_t idx = POOL_INVALID_INDEX;
+    xQueueReceive(s->queue, &idx, portMAX_DELAY);
+    return idx;
+}
+
+static uint32_t sg_queue_depth(stage_t *s) {
+    return s->queue ? (uint32_t)uxQueueMessagesWaiting(s->queue) : 0;
+}
+
+static void sg_queue_delete(stage_t *s) {
+    if (s->queue) {
+        vQueueDelete(s->queue);
+        s->queue = NULL;
+    }
+}
+#else
+static bool sg_queue_create(stage_t *s, size_t capacity) {
+    stage_queue_t *q = &s->queue;
+    q->items = heap_caps_malloc(capacity * sizeof(pool_index_t), MALLOC_CAP_8BIT);
+    if (!q->items) {
+        return false;
+    }
+    q->capacity = capacity;
+    q->head = 0;
+    q->count = 0;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    return true;
+}
+
+// Cada frame entra no máximo uma vez em cada fila (capacidade = frames + sentinela): nunca enche
+static void sg_queue_send(stage_t *s, pool_index_t idx) {
+    stage_queue_t *q = &s->queue;
+    pthread_mutex_lock(&q->lock);
+    q->items[(q->head + q->count) % q->capacity] = idx;
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+static pool_index_t sg_queue_receive(stage_t *s) {
+    stage_queue_t *q = &s->queue;
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0) {
+        pthread_cond_wait(&q->not_empty, &q->lock);
+    }
+    pool_index_t idx = q->items[q->head];
+    q->head = (q->head + 1) % q->capacity;
+    q->count--;
+    pthread_mutex_unlock(&q->lock);
+    return idx;
+}
+
+static uint32_t sg_queue_depth(stage_t *s) {
+    stage_queue_t *q = &s->queue;
+    if (!q->items) {
+        return 0;
+    }
+    pthread_mutex_lock(&q->lock);
+    uint32_t depth = (uint32_t)q->count;
+    pthread_mutex_unlock(&q->lock);
+    return depth;
+}
+
+static void sg_queue_delete(stage_t *s) {
+    stage_queue_t *q = &s->queue;
+    if (q->items) {
+        heap_caps_free(q->items);
+        q->items = NULL;
+        pthread_cond_destroy(&q->not_empty);
+        pthread_mutex_destroy(&q->lock);
+    }
+}
+#endif
+
+/* ----------------------------------------------------------------
+ *  Fluxo dos frames
+ * ---------------------------------------------------------------- */
+static inline _Atomic uint8_t *remaining_of(stage_graph_t *g, pool_index_t idx, size_t stage) {
+    return &g->remaining[(size_t)idx * STAGE_GRAPH_MAX_STAGES + stage];
+}
+
+// Frame novo da fonte: cada estágio espera todas as suas entradas, e o frame volta ao pool com o último sink
+static void stage_arm(stage_graph_t *g, pool_index_t idx) {
+    for (size_t i = 0; i < g->num_stages; i++) {
+        atomic_store_explicit(remaining_of(g, idx, i), g->stages[i].num_inputs, memory_order_relaxed);
+    }
+    atomic_store_explicit(&g->sinks_left[idx], (uint8_t)__builtin_popcount(g->sinks), memory_order_release);
+}
+
+// O estágio s terminou o frame idx: libera os dependentes prontos, ou o frame se s for o último sink
+static void stage_done(stage_graph_t *g, stage_t *s, pool_index_t idx) {
+    if (s->dependents == 0) {
+        if (atomic_fetch_sub(&g->sinks_left[idx], 1) == 1) {
+            block_pool_release(&g->frames, idx);
+        }
+        return;
+    }
+    for (size_t i = 0; i < g->num_stages; i++) {
+        if (!(s->dependents & (1u << i)) || atomic_fetch_sub(remaining_of(g, idx, i), 1) != 1) {
+            continue;
+        }
+        stage_t *next = &g->stages[i];
+        sg_queue_send(next, idx);
+        uint32_t depth = sg_queue_depth(next);
+        uint32_t peak = atomic_load_explicit(&next->high_water, memory_order_relaxed);
+        while (depth > peak &&
+               !atomic_compare_exchange_weak_explicit(&next->high_water, &peak, depth,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+        }
+    }
+}
+
+static inline bool stage_call(stage_t *s, void *frame, uint32_t frame_id) {
+    int64_t t0 = esp_timer_get_time();
+    bool ok = s->desc.fn(s->desc.ctx, frame, frame_id);
+    atomic_fetch_add_explicit(&s->busy_us, (uint64_t)(esp_timer_get_time() - t0), memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->frames, 1, memory_order_relaxed);
+    return ok;
+}
+
+// Fonte: produz frames (com dependentes) ou roda em laço livre (sem dependentes) até o stop
+static void stage_run_source(stage_graph_t *g, stage_t *s) {
+    bool produces = s->dependents != 0;
+    uint32_t frame_id = 0;
+    while (atomic_load(&g->running)) {
+        if (s->desc.wait && !s->desc.wait(s->desc.ctx)) {
+            continue;
+        }
+        if (!produces) {
+            stage_call(s, NULL, frame_id++);
+            continue;
+        }
+        pool_index_t idx;
+        while ((idx = block_pool_acquire(&g->frames)) == POOL_INVALID_INDEX && atomic_load(&g->running)) {
+            // Pipeline cheio: a fonte espera um frame voltar (a entrada já pronta não é perdida)
+            atomic_fetch_add_explicit(&s->starved, 1, memory_order_relaxed);
+            vTaskDelay(1);
+        }
+        if (idx == POOL_INVALID_INDEX) {
+            break;
+        }
+        if (!stage_call(s, block_pool_get(&g->frames, idx), frame_id)) {
+            block_pool_release(&g->frames, idx);
+            continue;
+        }
+        g->frame_ids[idx] = frame_id++;
+        stage_arm(g, idx);
+        stage_done(g, s, idx);
+    }
+}
+
+static void stage_run(stage_t *s) {
+    stage_graph_t *g = s->graph;
+    if (s->num_inputs == 0) {
+        stage_run_source(g, s);
+        return;
+    }
+    for (;;) {
+        pool_index_t idx = sg_queue_receive(s);
+        if (idx == POOL_INVALID_INDEX) {
+            break; // Sentinela de stop
+        }
+        stage_call(s, block_pool_get(&g->frames, idx), g->frame_ids[idx]);
+        stage_done(g, s, idx);
+    }
+}
+
+#ifdef ESP_PLATFORM
+static void stage_task(void *arg) {
+    stage_t *s = (stage_t *)arg;
+    stage_run(s);
+    atomic_fetch_sub(&s->graph->alive, 1);
+    vTaskDelete(NULL);
+}
+
+static bool stage_spawn(stage_t *s) {
+    BaseType_t core = s->desc.core == STAGE_NO_AFFINITY ? tskNO_AFFINITY : (BaseType_t)s->desc.core;
+    return xTaskCreatePinnedToCore(stage_task, s->desc.name, s->desc.stack, s,
+                                   s->desc.priority, &s->task, core) == pdPASS;
+}
+#else
+static void *stage_thread(void *arg) {
+    stage_t *s = (stage_t *)arg;
+    stage_run(s);
+    atomic_fetch_sub(&s->graph->alive, 1);
+    return NULL;
+}
+
+// Host: núcleo e prioridade são ignorados
+static bool stage_spawn(stage_t *s) {
+    return pthread_create(&s->thread, NULL, stage_thread, s) == 0;
+}
+#endif
+
+// Para as tasks criadas: fontes saem pelo flag, demais pela sentinela (depois dos frames já na fila)
+static void stage_graph_stop(stage_graph_t *g) {
+    atomic_store(&g->running, false);
+    for (size_t i = 0; i < g->num_tasks; i++) {
+        if (g->stages[i].num_inputs > 0) {
+            sg_queue_send(&g->stages[i], POOL_INVALID_INDEX);
+        }
+    }
+#ifdef ESP_PLATFORM
+    while (atomic_load(&g->alive) > 0) {
+        vTaskDelay(1);
+    }
+#else
+    for (size_t i = 0; i < g->num_tasks; i++) {
+        pthread_join(g->stages[i].thread, NULL);
+    }
+#endif
+    g->num_tasks = 0;
+}
+
+/* ----------------------------------------------------------------
+ *  API
+ * ---------------------------------------------------------------- */
+
+/**
+ * @brief Inicializa um grafo vazio com o pool de frames.
+ *
+ * @param g          Ponteiro para o grafo.
+ * @param frame_size Tamanho de cada frame em bytes.
+ * @param num_frames Frames em trânsito (profundidade do pipeline).
+ * @param caps       Capacidades de memória do pool (ex.: MALLOC_CAP_SPIRAM).
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t stage_graph_init(stage_graph_t *g, size_t frame_size, size_t num_frames, uint32_t caps) {
+    if (!g || frame_size == 0 || num_frames == 0 || num_frames > POOL_MAX_CAPACITY) {
+        ESP_LOGE(TAG_SG, "Parâmetros inválidos passados para stage_graph_init.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(g, 0, sizeof(*g));
+    g->source = -1;
+
+    esp_err_t ret = block_pool_init(&g->frames, "frames", frame_size, num_frames, caps);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    g->remaining  = heap_caps_calloc(num_frames * STAGE_GRAPH_MAX_STAGES, sizeof(*g->remaining), MALLOC_CAP_8BIT);
+    g->sinks_left = heap_caps_calloc(num_frames, sizeof(*g->sinks_left), MALLOC_CAP_8BIT);
+    g->frame_ids  = heap_caps_calloc(num_frames, sizeof(*g->frame_ids), MALLOC_CAP_8BIT);
+    if (!g->remaining || !g->sinks_left || !g->frame_ids) {
+        ESP_LOGE(TAG_SG, "Falha ao alocar o estado dos frames.");
+        stage_graph_deinit(g);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Declara um estágio (antes de stage_graph_start).
+ *
+ * @param g    Ponteiro para o grafo.
+ * @param desc Declaração (copiada).
+ * @return int Id do estágio (bit para as máscaras de entrada), ou -1 em erro.
+ */
+int stage_graph_add(stage_graph_t *g, const stage_desc_t *desc) {
+    if (!g || !desc || !desc->fn || g->num_tasks > 0) {
+        ESP_LOGE(TAG_SG, "Parâmetros inválidos passados para stage_graph_add.");
+        return -1;
+    }
+    size_t id = g->num_stages;
+    if (id >= STAGE_GRAPH_MAX_STAGES || (desc->inputs >> id) != 0) {
+        ESP_LOGE(TAG_SG, "Estágio %s: limite de estágios ou entrada ainda não declarada.", desc->name);
+        return -1;
+    }
+
+    stage_t *s = &g->stages[id];
+    s->desc = *desc;
+    s->graph = g;
+    s->num_inputs = (uint8_t)__builtin_popcount(desc->inputs);
+    for (size_t i = 0; i < id; i++) {
+        if (desc->inputs & (1u << i)) {
+            g->stages[i].dependents |= 1u << id;
+        }
+    }
+    g->num_stages++;
+    return (int)id;
+}
+
+/**
+ * @brief Cria as filas e as tasks dos estágios.
+ *
+ * @param g Ponteiro para o grafo.
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t stage_graph_start(stage_graph_t *g) {
+    if (!g || g->num_stages == 0 || g->num_tasks > 0) {
+        ESP_LOGE(TAG_SG, "Parâmetros inválidos passados para stage_graph_start.");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Uma única fonte de frames: todo estágio com entradas descende dela
+    g->source = -1;
+    g->sinks = 0;
+    for (size_t i = 0; i < g->num_stages; i++) {
+        stage_t *s = &g->stages[i];
+        if (s->num_inputs == 0 && s->dependents != 0) {
+            if (g->source >= 0) {
+                ESP_LOGE(TAG_SG, "Mais de uma fonte de frames (%s e %s).", g->stages[g->source].desc.name, s->desc.name);
+                return ESP_ERR_INVALID_ARG;
+            }
+            g->source = (int)i;
+        }
+        if (s->num_inputs > 0 && s->dependents == 0) {
+            g->sinks |= 1u << i;
+        }
+    }
+
+    for (size_t i = 0; i < g->num_stages; i++) {
+        stage_t *s = &g->stages[i];
+        if (s->num_inputs > 0 && !sg_queue_create(s, (size_t)g->frames.capacity + 1)) {
+            ESP_LOGE(TAG_SG, "Falha ao criar a fila do estágio %s.", s->desc.name);
+            for (size_t j = 0; j < i; j++) {
+                sg_queue_delete(&g->stages[j]);
+            }
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    atomic_store(&g->running, true);
+    stage_graph_reset_stats(g);
+    for (size_t i = 0; i < g->num_stages; i++) {
+        atomic_fetch_add(&g->alive, 1);
+        if (!stage_spawn(&g->stages[i])) {
+            atomic_fetch_sub(&g->alive, 1);
+            ESP_LOGE(TAG_SG, "Falha ao criar a task do estágio %s.", g->stages[i].desc.name);
+            stage_graph_stop(g);
+            return ESP_ERR_NO_MEM;
+        }
+        g->num_tasks++;
+    }
+    ESP_LOGI(TAG_SG, "Grafo com %zu estágios e %u frames em trânsito.", g->num_stages, (unsigned)g->frames.capacity);
+    return ESP_OK;
+}
+
+/**
+ * @brief Handle da task de um estágio (ex.: para xTaskNotifyGive); NULL no host.
+ */
+TaskHandle_t stage_graph_task(const stage_graph_t *g, int stage) {
+    if (!g || stage < 0 || (size_t)stage >= g->num_tasks) {
+        return NULL;
+    }
+#ifdef ESP_PLATFORM
+    return g->stages[stage].task;
+#else
+    return NULL;
+#endif
+}
+
+/**
+ * @brief Lê as estatísticas de um estágio.
+ *
+ * @param g     Ponteiro para o grafo.
+ * @param stage Id do estágio.
+ * @param stats Estrutura de saída.
+ */
+void stage_graph_get_stats(stage_graph_t *g, int stage, stage_stats_t *stats) {
+    if (!g || !stats || stage < 0 || (size_t)stage >= g->num_stages) {
+        ESP_LOGE(TAG_SG, "Parâmetros inválidos passados para stage_graph_get_stats.");
+        return;
+    }
+    stage_t *s = &g->stages[stage];
+    stats->frames           = atomic_load_explicit(&s->frames, memory_order_relaxed);
+    stats->queue_depth      = s->num_inputs > 0 && g->num_tasks > 0 ? sg_queue_depth(s) : 0;
+    stats->queue_high_water = atomic_load_explicit(&s->high_water, memory_order_relaxed);
+    stats->starved          = atomic_load_explicit(&s->starved, memory_order_relaxed);
+    stats->busy_us          = atomic_load_explicit(&s->busy_us, memory_order_relaxed);
+    int64_t elapsed = esp_timer_get_time() - atomic_load(&g->stats_start_us);
+    stats->utilization = elapsed > 0 ? (float)((double)stats->busy_us / (double)elapsed) : 0.0f;
+}
+
+/**
+ * @brief Zera as estatísticas e reinicia a janela de utilização.
+ */
+void stage_graph_reset_stats(stage_graph_t *g) {
+    if (!g) {
+        return;
+    }
+    for (size_t i = 0; i < g->num_stages; i++) {
+        stage_t *s = &g->stages[i];
+        atomic_store_explicit(&s->frames, 0, memory_order_relaxed);
+        atomic_store_explicit(&s->high_water, 0, memory_order_relaxed);
+        atomic_store_explicit(&s->starved, 0, memory_order_relaxed);
+        atomic_store_explicit(&s->busy_us, 0, memory_order_relaxed);
+    }
+    atomic_store(&g->stats_start_us, esp_timer_get_time());
+}
+
+/**
+ * @brief Para as tasks (as fontes terminam a chamada em curso) e libera filas e pool.
+ *
+ * @param g Ponteiro para o grafo.
+ */
+void stage_graph_deinit(stage_graph_t *g) {
+    if (!g) {
+        return;
+    }
+    if (g->num_tasks > 0) {
+        stage_graph_stop(g);
+    }
+    for (size_t i = 0; i < g->num_stages; i++) {
+        sg_queue_delete(&g->stages[i]);
+    }
+    block_pool_deinit(&g->frames);
+    heap_caps_free(g->remaining);
+    heap_caps_free(g->sinks_left);
+    heap_caps_free(g->frame_ids);
+    g->remaining = NULL;
+    g->sinks_left = NULL;
+    g->frame_ids = NULL;
+    g->num_stages = 0;
+}
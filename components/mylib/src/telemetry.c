@@ -0,0 +1,435 @@
+// src/telemetry.c
+#include "telemetry.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <math.h>
+#include <string.h>
+
+static const char *TAG_TELEM = "TELEM";
+
+/* ----------------------------------------------------------------
+ *  Empacotamento little-endian (independe do alinhamento e do endianness do host)
+ * ---------------------------------------------------------------- */
+static inline void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline void put_f32(uint8_t *p, float v) {
+    uint32_t u;
+    memcpy(&u, &v, sizeof(u));
+    put_u32(p, u);
+}
+
+static inline uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline float get_f32(const uint8_t *p) {
+    uint32_t u = get_u32(p);
+    float v;
+    memcpy(&v, &u, sizeof(v));
+    return v;
+}
+
+/**
+ * @brief float32 -> float16 (IEEE 754 binary16, arredondamento para o mais próximo).
+ *        Subnormais do float16 viram zero: a faixa útil (magnitudes e amostras) fica em [6e-5, 65504].
+ */
+static uint16_t f32_to_f16(float v) {
+    uint32_t u;
+    memcpy(&u, &v, sizeof(u));
+    uint16_t sign = (uint16_t)((u >> 16) & 0x8000u);
+    int32_t exp = (int32_t)((u >> 23) & 0xFF) - 127 + 15;
+    uint32_t mant = u & 0x7FFFFFu;
+
+    if (((u >> 23) & 0xFF) == 0xFF) {
+        return sign | 0x7C00u | (mant ? 0x200u : 0);   // Inf/NaN
+    }
+    if (exp <= 0) {
+        return sign;
+    }
+    uint32_t h = ((uint32_t)exp << 10) | (mant >> 13);
+    if ((mant & 0x1FFFu) > 0x1000u || ((mant & 0x1FFFu) == 0x1000u && (h & 1u))) {
+        h++;                                            // Pode subir o expoente: correto
+    }
+    if (h >= 0x7C00u) {
+        return sign | 0x7C00u;
+    }
+    return sign | (uint16_t)h;
+}
+
+static float f16_to_f32(uint16_t h) {
+    uint32_t sign = (uint32_t)(h & 0x8000u) << 16;
+    uint32_t exp = (h >> 10) & 0x1Fu;
+    uint32_t mant = h & 0x3FFu;
+    uint32_t u;
+
+    if (exp == 0) {
+        if (mant == 0) {
+            u = sign;
+        } else {
+            // Subnormal do float16: normaliza
+            exp = 127 - 15 + 1;
+            while (!(mant & 0x400u)) {
+                mant <<= 1;
+                exp--;
+            }
+            u = sign | (exp << 23) | ((mant & 0x3FFu) << 13);
+        }
+    } else if (exp == 0x1F) {
+        u = sign | 0x7F800000u | (mant << 13);
+    } else {
+        u = sign | ((exp - 15 + 127) << 23) | (mant << 13);
+    }
+    float v;
+    memcpy(&v, &u, sizeof(v));
+    return v;
+}
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poli 0x1021), continuando de crc (0xFFFF no início).
+ *        Tabela de nibbles: 32 bytes, dois passos por byte.
+ */
+uint16_t telem_crc16(const uint8_t *data, size_t len, uint16_t crc) {
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    };
+    for (size_t i = 0; i < len; i++) {
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (data[i] & 0x0F)]);
+    }
+    return crc;
+}
+
+/**
+ * @brief Bytes de um vetor codificado (contagem + escala opcional + valores).
+ */
+static inline size_t vector_size(size_t n, bool half) {
+    return 2 + (half ? 0 : 4) + 2 * n;
+}
+
+/**
+ * @brief Tamanho em bytes do frame codificado.
+ */
+size_t telem_frame_size(const telem_frame_t *frame) {
+    if (!frame) {
+        return 0;
+    }
+    bool half = (frame->flags & TELEM_FLAG_HALF) != 0;
+    size_t size = TELEM_HEADER_SIZE + TELEM_CRC_SIZE;
+    if (frame->flags & TELEM_FLAG_SPECTRUM) {
+        size += vector_size(frame->spectrum_len, half);
+    }
+    if (frame->flags & TELEM_FLAG_SAMPLES) {
+        size += vector_size(frame->samples_len, half);
+    }
+    return size;
+}
+
+/**
+ * @brief Escreve um vetor: float16, ou int16 com escala = max|x| / 32767 (precisão relativa ao pico).
+ *
+ * @return size_t Bytes escritos.
+ */
+static size_t encode_vector(uint8_t *p, const float *v, size_t n, bool half) {
+    put_u16(p, (uint16_t)n);
+    p += 2;
+    if (half) {
+        for (size_t i = 0; i < n; i++) {
+            put_u16(p + 2 * i, f32_to_f16(v[i]));
+        }
+        return vector_size(n, true);
+    }
+
+    float peak = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        float a = fabsf(v[i]);
+        if (a > peak && isfinite(a)) {
+            peak = a;
+        }
+    }
+    float scale = (peak > 0.0f) ? peak / 32767.0f : 1.0f;
+    float inv = 1.0f / scale;
+    put_f32(p, scale);
+    p += 4;
+    for (size_t i = 0; i < n; i++) {
+        float q = isfinite(v[i]) ? roundf(v[i] * inv) : 0.0f;
+        q = (q > 32767.0f) ? 32767.0f : (q < -32767.0f ? -32767.0f : q);
+        put_u16(p + 2 * i, (uint16_t)(int16_t)q);
+    }
+    return vector_size(n, false);
+}
+
+/**
+ * @brief Codifica um frame.
+ *
+ * @param frame Conteúdo.
+ * @param out   Destino.
+ * @param cap   Capacidade de out.
+ * @return size_t Bytes escritos, ou 0 em erro.
+ */
+size_t telem_encode(const telem_frame_t *frame, uint8_t *out, size_t cap) {
+    if (!frame || !out ||
+        ((frame->flags & TELEM_FLAG_SPECTRUM) && (!frame->spectrum || frame->spectrum_len > TELEM_MAX_VECTOR)) ||
+        ((frame->flags & TELEM_FLAG_SAMPLES) && (!frame->samples || frame->samples_len > TELEM_MAX_VECTOR))) {
+        ESP_LOGE(TAG_TELEM, "Parâmetros inválidos passados para telem_encode.");
+        return 0;
+    }
+    size_t size = telem_frame_size(frame);
+    if (size > cap) {
+        ESP_LOGE(TAG_TELEM, "Frame de %zu bytes não cabe em %zu.", size, cap);
+        return 0;
+    }
+    bool half = (frame->flags & TELEM_FLAG_HALF) != 0;
+    size_t payload = size - TELEM_HEADER_SIZE - TELEM_CRC_SIZE;
+
+    float cents = roundf(frame->cents * 100.0f);
+    cents = (cents > 32767.0f) ? 32767.0f : (cents < -32768.0f ? -32768.0f : cents);
+    float conf = roundf(frame->confidence * 255.0f);
+    conf = (conf > 255.0f) ? 255.0f : (conf < 0.0f ? 0.0f : conf);
+
+    out[0] = TELEM_SYNC0;
+    out[1] = TELEM_SYNC1;
+    out[2] = TELEM_VERSION;
+    out[3] = frame->flags;
+    put_u16(&out[4], (uint16_t)payload);
+    put_u32(&out[6], frame->seq);
+    put_u32(&out[10], frame->timestamp_us);
+    put_f32(&out[14], frame->fundamental);
+    put_u16(&out[18], (uint16_t)(int16_t)cents);
+    out[20] = frame->note;
+    out[21] = (uint8_t)conf;
+
+    uint8_t *p = out + TELEM_HEADER_SIZE;
+    if (frame->flags & TELEM_FLAG_SPECTRUM) {
+        p += encode_vector(p, frame->spectrum, frame->spectrum_len, half);
+    }
+    if (frame->flags & TELEM_FLAG_SAMPLES) {
+        p += encode_vector(p, frame->samples, frame->samples_len, half);
+    }
+    put_u16(p, telem_crc16(out + 2, size - 2 - TELEM_CRC_SIZE, 0xFFFF));
+    return size;
+}
+
+/**
+ * @brief Lê um vetor do payload.
+ *
+ * @return size_t Bytes consumidos, ou 0 se o vetor não cabe no payload ou em max_vector.
+ */
+static size_t decode_vector(const uint8_t *p, size_t avail, float *v, size_t *n_out, size_t max_vector, bool half) {
+    if (avail < 2) {
+        return 0;
+    }
+    size_t n = get_u16(p);
+    size_t size = vector_size(n, half);
+    if (n > max_vector || size > avail) {
+        return 0;
+    }
+    p += 2;
+    if (half) {
+        for (size_t i = 0; i < n; i++) {
+            v[i] = f16_to_f32(get_u16(p + 2 * i));
+        }
+    } else {
+        float scale = get_f32(p);
+        p += 4;
+        for (size_t i = 0; i < n; i++) {
+            v[i] = (float)(int16_t)get_u16(p + 2 * i) * scale;
+        }
+    }
+    *n_out = n;
+    return size;
+}
+
+/**
+ * @brief Decodifica um frame completo que começa em buf[0] (com sync).
+ *
+ * @param buf      Bytes do frame.
+ * @param len      Bytes disponíveis.
+ * @param frame    Saída; spectrum/samples devem apontar para buffers de max_vector floats.
+ * @param max_vector Capacidade dos vetores de frame.
+ * @return int     Bytes consumidos (> 0), 0 se faltam bytes, -1 se inválido.
+ */
+int telem_decode(const uint8_t *buf, size_t len, telem_frame_t *frame, size_t max_vector) {
+    if (len < TELEM_HEADER_SIZE) {
+        return 0;
+    }
+    if (buf[0] != TELEM_SYNC0 || buf[1] != TELEM_SYNC1 || buf[2] != TELEM_VERSION) {
+        return -1;
+    }
+    size_t payload = get_u16(&buf[4]);
+    size_t size = TELEM_HEADER_SIZE + payload + TELEM_CRC_SIZE;
+    if (len < size) {
+        return 0;
+    }
+    if (telem_crc16(buf + 2, size - 2 - TELEM_CRC_SIZE, 0xFFFF) != get_u16(&buf[size - TELEM_CRC_SIZE])) {
+        return -1;
+    }
+
+    uint8_t flags = buf[3];
+    bool half = (flags & TELEM_FLAG_HALF) != 0;
+    frame->flags = flags;
+    frame->seq = get_u32(&buf[6]);
+    frame->timestamp_us = get_u32(&buf[10]);
+    frame->fundamental = get_f32(&buf[14]);
+    frame->cents = (float)(int16_t)get_u16(&buf[18]) / 100.0f;
+    frame->note = buf[20];
+    frame->confidence = (float)buf[21] / 255.0f;
+    frame->spectrum_len = 0;
+    frame->samples_len = 0;
+
+    const uint8_t *p = buf + TELEM_HEADER_SIZE;
+    size_t avail = payload;
+    if (flags & TELEM_FLAG_SPECTRUM) {
+        size_t used = frame->spectrum ? decode_vector(p, avail, frame->spectrum, &frame->spectrum_len, max_vector, half) : 0;
+        if (used == 0) {
+            return -1;
+        }
+        p += used;
+        avail -= used;
+    }
+    if (flags & TELEM_FLAG_SAMPLES) {
+        size_t used = frame->samples ? decode_vector(p, avail, frame->samples, &frame->samples_len, max_vector, half) : 0;
+        if (used == 0) {
+            return -1;
+        }
+        avail -= used;
+    }
+    return (avail == 0) ? (int)size : -1;
+}
+
+/**
+ * @brief Aloca o decodificador de stream.
+ *
+ * @param dec        Ponteiro para o decodificador.
+ * @param max_vector Maior vetor aceito (<= TELEM_MAX_VECTOR).
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t telem_decoder_init(telem_decoder_t *dec, size_t max_vector) {
+    if (!dec || max_vector == 0 || max_vector > TELEM_MAX_VECTOR) {
+        ESP_LOGE(TAG_TELEM, "Parâmetros inválidos passados para telem_decoder_init.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(dec, 0, sizeof(*dec));
+    // Maior frame possível: dois vetores int16 de max_vector valores
+    dec->capacity = TELEM_HEADER_SIZE + 2 * vector_size(max_vector, false) + TELEM_CRC_SIZE;
+    dec->buf = (uint8_t *)heap_caps_malloc(dec->capacity, MALLOC_CAP_8BIT);
+    dec->spectrum = (float *)heap_caps_malloc(max_vector * sizeof(float), MALLOC_CAP_8BIT);
+    dec->samples = (float *)heap_caps_malloc(max_vector * sizeof(float), MALLOC_CAP_8BIT);
+    if (!dec->buf || !dec->spectrum || !dec->samples) {
+        ESP_LOGE(TAG_TELEM, "Falha ao alocar o decodificador de telemetria.");
+        telem_decoder_deinit(dec);
+        return ESP_ERR_NO_MEM;
+    }
+    dec->max_vector = max_vector;
+    return ESP_OK;
+}
+
+/**
+ * @brief Consome bytes do stream e chama cb para cada frame válido.
+ *        Sem sync no início do buffer, descarta até o próximo 0xA5; com frame inválido
+ *        (CRC, versão, tamanho), descarta só o primeiro byte e procura de novo, então um sync
+ *        falso dentro de um log de texto não engole frames verdadeiros.
+ *
+ * @param dec  Ponteiro para o decodificador.
+ * @param data Bytes recebidos.
+ * @param len  Número de bytes.
+ * @param cb   Callback por frame.
+ * @param user Repassado a cb.
+ * @return size_t Frames entregues nesta chamada.
+ */
+size_t telem_decoder_push(telem_decoder_t *dec, const uint8_t *data, size_t len, telem_frame_cb_t cb, void *user) {
+    if (!dec || !dec->buf || (!data && len > 0)) {
+        ESP_LOGE(TAG_TELEM, "Parâmetros inválidos passados para telem_decoder_push.");
+        return 0;
+    }
+    size_t delivered = 0;
+    telem_frame_t frame;
+
+    while (len > 0) {
+        size_t n = dec->capacity - dec->len;
+        n = (n < len) ? n : len;
+        memcpy(dec->buf + dec->len, data, n);
+        dec->len += n;
+        data += n;
+        len -= n;
+
+        size_t pos = 0;
+        while (pos < dec->len) {
+            if (dec->buf[pos] != TELEM_SYNC0) {
+                pos++;
+                dec->stats.bytes_skipped++;
+                continue;
+            }
+            frame.spectrum = dec->spectrum;
+            frame.samples = dec->samples;
+            int used = telem_decode(dec->buf + pos, dec->len - pos, &frame, dec->max_vector);
+            if (used == 0) {
+                // Frame incompleto; um cabeçalho que declara mais que a capacidade nunca completa
+                size_t avail = dec->len - pos;
+                if (avail >= 6 && TELEM_HEADER_SIZE + (size_t)get_u16(&dec->buf[pos + 4]) + TELEM_CRC_SIZE > dec->capacity) {
+                    dec->stats.crc_errors++;
+                    dec->stats.bytes_skipped++;
+                    pos++;
+                    continue;
+                }
+                break;
+            }
+            if (used < 0) {
+                if (dec->len - pos >= 3 && dec->buf[pos + 1] == TELEM_SYNC1 && dec->buf[pos + 2] == TELEM_VERSION) {
+                    dec->stats.crc_errors++;
+                }
+                dec->stats.bytes_skipped++;
+                pos++;
+                continue;
+            }
+
+            // Sequência que volta (reset do dispositivo) não conta como perda
+            uint32_t gap = frame.seq - dec->last_seq - 1;
+            if (dec->have_seq && gap < 0x80000000u) {
+                dec->stats.seq_gaps += gap;
+            }
+            dec->have_seq = true;
+            dec->last_seq = frame.seq;
+            dec->stats.frames++;
+            delivered++;
+            if (cb) {
+                cb(&frame, dec->buf + pos, (size_t)used, user);
+            }
+            pos += (size_t)used;
+        }
+
+        memmove(dec->buf, dec->buf + pos, dec->len - pos);
+        dec->len -= pos;
+    }
+    return delivered;
+}
+
+/**
+ * @brief Libera o decodificador.
+ */
+void telem_decoder_deinit(telem_decoder_t *dec) {
+    if (!dec) {
+        return;
+    }
+    heap_caps_free(dec->buf);
+    heap_caps_free(dec->spectrum);
+    heap_caps_free(dec->samples);
+    dec->buf = NULL;
+    dec->spectrum = NULL;
+    dec->samples = NULL;
+    dec->len = 0;
+}
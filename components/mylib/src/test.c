@@ -1,9 +1,20 @@
 // src/test_all.c
 #include "test.h"
-#include "filters.h"   // biquad_t, bandpass_init(), biquad_process()
+#include "filters.h"   // biquad_t, bandpass_init(), biquad_process(), sos_*
 #include "yin.h"       // yin_init(), yin_detect_pitch(), yin_deinit()
 #include "tuner.h"     // get_note()
 #include "fft.h"       // fft(), calculate_magnitude(), peak_frequency()
+#include "pool.h"      // block_pool_init(), block_pool_acquire(), block_pool_release()
+#include "audio_ring.h" // audio_ring_init(), audio_ring_peek(), audio_ring_consume()
+#include "fixed_dsp.h"  // fx_window_*, biquad_q31_*, fx_fft_*
+#include "trace.h"      // trace_init(), trace_end(), trace_snapshot()
+#include "decimator.h"  // decimator_init(), decimator_process()
+#include "parallel.h"   // par_executor_init(), par_executor_deinit()
+#include "stage_graph.h" // stage_graph_init(), stage_graph_add(), stage_graph_start()
+#include "telemetry.h"   // telem_encode(), telem_decode(), telem_decoder_push()
+#include "pitch_engine.h" // pitch_engine_init(), pitch_engine_select(), pitch_engine_process()
+#include "gate.h"          // energy_gate_init(), energy_gate_process(), audio_level_*
+#include "tuner_bank.h"    // tuner_instrument_find(), tuner_bank_init(), tuner_bank_process()
 #include "esp_log.h"
 #include <math.h>
 #include <string.h>
@@ -18,6 +29,11 @@ void wait_for_enter(void) {
         if (c == '\n' || c == '\r') {
             break;
         }
+#ifndef ESP_PLATFORM
+        if (c == EOF) {
+            break; // Host sem terminal (ex.: ctest): segue direto
+        }
+#endif
         vTaskDelay(10);
     }
 }
@@ -37,7 +53,7 @@ static void test_vector_functions(void *pv) {
     sub_vect(a, b, result_sub, 4);
     uint32_t end_time = esp_timer_get_time();
     ESP_LOGI("TEST_ALL", "Resultado da Subtração: %.2f, %.2f, %.2f, %.2f", result_sub[0], result_sub[1], result_sub[2], result_sub[3]);
-    ESP_LOGI("TEST_ALL", "Tempo de execução: %ld us\n", end_time-start_time);
+    ESP_LOGI("TEST_ALL", "Tempo de execução: %" PRIu32 " us\n", end_time-start_time);
 
     // Test mult_vect
     ESP_LOGI("TEST_ALL", "Testando mult_vect...");
@@ -46,7 +62,7 @@ static void test_vector_functions(void *pv) {
     mult_vect(a, b, result_mul, 4);
     end_time = esp_timer_get_time();
     ESP_LOGI("TEST_ALL", "Resultado da Multiplicação: %.2f, %.2f, %.2f, %.2f", result_mul[0], result_mul[1], result_mul[2], result_mul[3]);
-    ESP_LOGI("TEST_ALL", "Tempo de execução: %ld us\n", end_time-start_time);
+    ESP_LOGI("TEST_ALL", "Tempo de execução: %" PRIu32 " us\n", end_time-start_time);
 
     // Test add_vect
     ESP_LOGI("TEST_ALL", "Testando add_vect...");
@@ -55,7 +71,7 @@ static void test_vector_functions(void *pv) {
     add_vect(a, b, result_add, 4);
     end_time = esp_timer_get_time();
     ESP_LOGI("TEST_ALL", "Resultado da Adição: %.2f, %.2f, %.2f, %.2f", result_add[0], result_add[1], result_add[2], result_add[3]);
-    ESP_LOGI("TEST_ALL", "Tempo de execução: %ld us\n", end_time-start_time);
+    ESP_LOGI("TEST_ALL", "Tempo de execução: %" PRIu32 " us\n", end_time-start_time);
 
     // Test sum_vect
     ESP_LOGI("TEST_ALL", "Testando sum_vect...");
@@ -63,7 +79,7 @@ static void test_vector_functions(void *pv) {
     float sum = sum_vect(a, 4);
     end_time = esp_timer_get_time();
     ESP_LOGI("TEST_ALL", "Resultado da Soma: %.2f", sum);
-    ESP_LOGI("TEST_ALL", "Tempo de execução: %ld us\n", end_time-start_time);
+    ESP_LOGI("TEST_ALL", "Tempo de execução: %" PRIu32 " us\n", end_time-start_time);
 
     // Test cos_vect
     ESP_LOGI("TEST_ALL", "Testando cos_vect...");
@@ -73,7 +89,7 @@ static void test_vector_functions(void *pv) {
     cos_vect(angles, cos_results, 4);
     end_time = esp_timer_get_time();
     ESP_LOGI("TEST_ALL", "Resultados do Cosseno: %.2f, %.2f, %.2f, %.2f", cos_results[0], cos_results[1], cos_results[2], cos_results[3]);
-    ESP_LOGI("TEST_ALL", "Tempo de execução: %ld us\n", end_time-start_time);
+    ESP_LOGI("TEST_ALL", "Tempo de execução: %" PRIu32 " us\n", end_time-start_time);
 
     // Test sin_vect
     ESP_LOGI("TEST_ALL", "Testando sin_vect...");
@@ -82,7 +98,7 @@ static void test_vector_functions(void *pv) {
     sin_vect(angles, sin_results, 4);
     end_time = esp_timer_get_time();
     ESP_LOGI("TEST_ALL", "Resultados do Seno: %.2f, %.2f, %.2f, %.2f", sin_results[0], sin_results[1], sin_results[2], sin_results[3]);
-    ESP_LOGI("TEST_ALL", "Tempo de execução: %ld us\n", end_time-start_time);
+    ESP_LOGI("TEST_ALL", "Tempo de execução: %" PRIu32 " us\n", end_time-start_time);
 
     // Test sqrt_vect
     ESP_LOGI("TEST_ALL", "Testando sqrt_vect...");
@@ -92,7 +108,7 @@ static void test_vector_functions(void *pv) {
     sqrt_vect(sqrt_input, sqrt_results, 4);
     end_time = esp_timer_get_time();
     ESP_LOGI("TEST_ALL", "Resultados da Sqrt: %.2f, %.2f, %.2f, %.2f", sqrt_results[0], sqrt_results[1], sqrt_results[2], sqrt_results[3]);
-    ESP_LOGI("TEST_ALL", "Tempo de execução: %ld us\n", end_time-start_time);
+    ESP_LOGI("TEST_ALL", "Tempo de execução: %" PRIu32 " us\n", end_time-start_time);
 
     ESP_LOGI("TEST_ALL", "===== Teste das Funções Vetoriais Personalizadas Concluído =====\n");
     vTaskDelete(NULL);
@@ -107,7 +123,6 @@ static void test_fft_manual(void *pv) {
     // Parâmetros do teste
     const size_t n = 1024; // Deve ser potência de 2
     const float sample_rate = 48000.0f; // Hz
-    const float frequency = 1.0f; // Hz
     float  test_phase = 0.0f;
 
 
@@ -135,13 +150,323 @@ static void test_fft_manual(void *pv) {
     for (size_t i = 0; i < n; i++) {
         ESP_LOGI("TEST_ALL", "Bin %zu: Magnitude = %.5f", i, magnitude[i]);
     }
-    ESP_LOGI("TEST_ALL", "Tempo de execução da FFT: %ld us\n", end_time-start_time);
+    ESP_LOGI("TEST_ALL", "Tempo de execução da FFT: %" PRIu32 " us\n", end_time-start_time);
 
     ESP_LOGI("TEST_ALL", "===== Teste da FFT Manual Concluído =====\n");
     vTaskDelete(NULL);
 
 }
 
+/**
+ * @brief Verifica a FFT com plano pré-computado contra uma DFT direta
+ *        e mede o custo da primeira chamada (criação do plano) vs. chamadas em cache.
+ */
+static void test_fft_plan(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste do Plano de FFT =====");
+
+    const size_t n = 256;
+    float real[256];
+    float imag[256];
+    float ref_real[256];
+    float ref_imag[256];
+    float test_phase = 0.0f;
+
+    generate_sine_wave(real, n, 3000.0f, SAMPLE_RATE, &test_phase);
+    add_noise(real, n, 0.1f);
+    memset(imag, 0, sizeof(imag));
+
+    // DFT direta de referência
+    for (size_t k = 0; k < n; k++) {
+        double acc_r = 0.0;
+        double acc_i = 0.0;
+        for (size_t j = 0; j < n; j++) {
+            double theta = -2.0 * M_PI * (double)(k * j % n) / (double)n;
+            acc_r += real[j] * cos(theta);
+            acc_i += real[j] * sin(theta);
+        }
+        ref_real[k] = (float)acc_r;
+        ref_imag[k] = (float)acc_i;
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    const fft_plan_t *plan = fft_plan_get(n);
+    int64_t setup_us = esp_timer_get_time() - t0;
+    t0 = esp_timer_get_time();
+    const fft_plan_t *cached = fft_plan_get(n);
+    int64_t cached_us = esp_timer_get_time() - t0;
+    if (!plan || plan != cached) {
+        ESP_LOGE("TEST_ALL", "Plano de FFT não foi reaproveitado do cache.");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    t0 = esp_timer_get_time();
+    fft_execute(plan, real, imag);
+    int64_t exec_us = esp_timer_get_time() - t0;
+
+    float max_err = 0.0f;
+    for (size_t k = 0; k < n; k++) {
+        max_err = fmaxf(max_err, fmaxf(fabsf(real[k] - ref_real[k]), fabsf(imag[k] - ref_imag[k])));
+    }
+
+    ESP_LOGI("TEST_ALL", "N=%zu | erro máximo vs DFT: %.3e | criação: %lld us | cache: %lld us | execução: %lld us",
+             n, max_err, (long long)setup_us, (long long)cached_us, (long long)exec_us);
+    if (max_err < 1e-3f) {
+        ESP_LOGI("TEST_ALL", "FFT com plano consistente com a DFT.");
+    } else {
+        ESP_LOGE("TEST_ALL", "FFT com plano diverge da DFT.");
+    }
+
+    ESP_LOGI("TEST_ALL", "===== Teste do Plano de FFT Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Conta operações reais (multiplicações, adições) de uma FFT de n pontos.
+ * @param n     Tamanho (potência de 2)
+ * @param radix 2 ou 4
+ * @param mults Multiplicações reais
+ * @param adds  Adições reais
+ */
+static void fft_op_count(size_t n, int radix, size_t *mults, size_t *adds) {
+    size_t bits = 0;
+    while (((size_t)1 << bits) < n) {
+        bits++;
+    }
+    if (radix == 2) {
+        // n/2 borboletas por estágio: 1 mult. complexa (4M+2A) + 2 somas complexas (4A)
+        *mults = 4 * (n / 2) * bits;
+        *adds  = 6 * (n / 2) * bits;
+    } else {
+        // n/4 borboletas por estágio radix-4: 3 mult. complexas (12M+6A) + 8 somas complexas (16A)
+        size_t stages4 = bits / 2;
+        *mults = 12 * (n / 4) * stages4;
+        *adds  = 22 * (n / 4) * stages4;
+        if (bits & 1u) {
+            *adds += 4 * (n / 2); // Estágio radix-2 inicial sem twiddle
+        }
+    }
+}
+
+/**
+ * @brief Compara a FFT radix-2 (planar) com a radix-4 (intercalada) em
+ *        N=1024..8192: erro, contagem de operações e tempo.
+ */
+static void test_fft_radix4(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Benchmark FFT Radix-2 vs Radix-4 =====");
+
+    const size_t max_n = 8192;
+    const int repetitions = 10;
+    float *real = heap_caps_malloc(max_n * sizeof(float), MALLOC_CAP_8BIT);
+    float *imag = heap_caps_malloc(max_n * sizeof(float), MALLOC_CAP_8BIT);
+    float *data = heap_caps_malloc(2 * max_n * sizeof(float), MALLOC_CAP_8BIT);
+    if (!real || !imag || !data) {
+        ESP_LOGE("TEST_ALL", "Falha ao alocar buffers do benchmark.");
+        goto cleanup;
+    }
+
+    for (size_t n = 1024; n <= max_n; n <<= 1) {
+        const fft_plan_t *plan = fft_plan_get(n);
+        if (!plan) {
+            break;
+        }
+
+        float test_phase = 0.0f;
+        generate_sine_wave(real, n, 1000.0f, SAMPLE_RATE, &test_phase);
+        add_noise(real, n, 0.1f);
+        memset(imag, 0, n * sizeof(float));
+        for (size_t i = 0; i < n; i++) {
+            data[2 * i] = real[i];
+            data[2 * i + 1] = 0.0f;
+        }
+
+        fft_execute(plan, real, imag);
+        fft_radix4_execute(plan, data);
+        float max_err = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            max_err = fmaxf(max_err, fmaxf(fabsf(data[2 * i] - real[i]), fabsf(data[2 * i + 1] - imag[i])));
+        }
+
+        int64_t t0 = esp_timer_get_time();
+        for (int r = 0; r < repetitions; r++) {
+            fft_execute(plan, real, imag);
+        }
+        int64_t r2_us = (esp_timer_get_time() - t0) / repetitions;
+
+        t0 = esp_timer_get_time();
+        for (int r = 0; r < repetitions; r++) {
+            fft_radix4_execute(plan, data);
+        }
+        int64_t r4_us = (esp_timer_get_time() - t0) / repetitions;
+
+        size_t m2, a2, m4, a4;
+        fft_op_count(n, 2, &m2, &a2);
+        fft_op_count(n, 4, &m4, &a4);
+        ESP_LOGI("TEST_ALL", "N=%4zu | radix-2: %6zu mul %6zu add %6lld us | radix-4: %6zu mul %6zu add %6lld us | erro: %.2e",
+                 n, m2, a2, (long long)r2_us, m4, a4, (long long)r4_us, max_err);
+    }
+
+#if DSP_BACKEND == DSP_BACKEND_ESP_DSP
+    if (fft_interleaved_init(max_n) == 0) {
+        for (size_t n = 1024; n <= max_n; n <<= 1) {
+            int64_t t0 = esp_timer_get_time();
+            for (int r = 0; r < repetitions; r++) {
+                fft_interleaved(data, n);
+            }
+            ESP_LOGI("TEST_ALL", "N=%4zu | esp-dsp: %6lld us", n, (long long)((esp_timer_get_time() - t0) / repetitions));
+        }
+    }
+#endif
+
+cleanup:
+    if (real) heap_caps_free(real);
+    if (imag) heap_caps_free(imag);
+    if (data) heap_caps_free(data);
+
+    ESP_LOGI("TEST_ALL", "===== Benchmark FFT Radix-2 vs Radix-4 Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Compara a rfft (N/2 complexa + separação) com a FFT complexa completa.
+ */
+static void test_rfft(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste da RFFT =====");
+
+    const size_t n = FBUF_SIZE;
+    const size_t bins = RFFT_BINS;
+    float *input = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    float *real  = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    float *imag  = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    float *rre   = heap_caps_malloc(bins * sizeof(float), MALLOC_CAP_8BIT);
+    float *rim   = heap_caps_malloc(bins * sizeof(float), MALLOC_CAP_8BIT);
+    if (!input || !real || !imag || !rre || !rim) {
+        ESP_LOGE("TEST_ALL", "Falha ao alocar buffers do teste.");
+        goto cleanup;
+    }
+
+    float frequencies[NUM_WAVES] = {330.0f, 1000.0f, 660.0f};
+    float amplitudes[NUM_WAVES]  = {0.7f, 1.0f, 0.25f};
+    float phases[NUM_WAVES]      = {0.0f, 0.0f, 0.0f};
+    generate_complex_wave(input, n, SAMPLE_RATE, frequencies, amplitudes, phases, NUM_WAVES);
+    add_noise(input, n, 0.05f);
+
+    memcpy(real, input, n * sizeof(float));
+    memset(imag, 0, n * sizeof(float));
+    int64_t t0 = esp_timer_get_time();
+    fft(real, imag, n);
+    int64_t fft_us = esp_timer_get_time() - t0;
+
+    t0 = esp_timer_get_time();
+    rfft(input, rre, rim, n);
+    int64_t rfft_us = esp_timer_get_time() - t0;
+
+    float max_err = 0.0f;
+    float max_ref = 0.0f;
+    for (size_t k = 0; k < bins; k++) {
+        float err = fmaxf(fabsf(rre[k] - real[k]), fabsf(rim[k] - imag[k]));
+        max_err = fmaxf(max_err, err);
+        max_ref = fmaxf(max_ref, sqrtf(real[k] * real[k] + imag[k] * imag[k]));
+    }
+
+    ESP_LOGI("TEST_ALL", "N=%zu | erro máximo: %.3e (pico %.3e) | FFT complexa: %lld us | RFFT: %lld us",
+             n, max_err, max_ref, (long long)fft_us, (long long)rfft_us);
+    if (max_err <= 1e-4f * max_ref) {
+        ESP_LOGI("TEST_ALL", "RFFT consistente com a FFT complexa.");
+    } else {
+        ESP_LOGE("TEST_ALL", "RFFT diverge da FFT complexa.");
+    }
+
+cleanup:
+    if (input) heap_caps_free(input);
+    if (real)  heap_caps_free(real);
+    if (imag)  heap_caps_free(imag);
+    if (rre)   heap_caps_free(rre);
+    if (rim)   heap_caps_free(rim);
+
+    ESP_LOGI("TEST_ALL", "===== Teste da RFFT Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Testa o cache de janelas (todos os tipos) e a conversão fundida int32 -> float.
+ */
+static void test_window(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste do Cache de Janelas =====");
+
+    const size_t n = 1024;
+    static const struct {
+        int type;
+        const char *name;
+        float edge;     // w[0] esperado
+    } cases[] = {
+        {WINDOW_HANN,            "Hann",            0.0f},
+        {WINDOW_HAMMING,         "Hamming",         0.08f},
+        {WINDOW_BLACKMAN_HARRIS, "Blackman-Harris", 6.0e-5f},
+        {WINDOW_KAISER,          "Kaiser",          1.0f / 750.0f}, // 1 / I0(8.6)
+    };
+
+    size_t errors = 0;
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        const float *w = window_get(cases[c].type, n);
+        if (!w || window_get(cases[c].type, n) != w) {
+            ESP_LOGE("TEST_ALL", "%s: tabela ausente ou fora do cache.", cases[c].name);
+            errors++;
+            continue;
+        }
+        float asym = 0.0f, peak = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            asym = fmaxf(asym, fabsf(w[i] - w[n - 1 - i]));
+            peak = fmaxf(peak, w[i]);
+        }
+        bool ok = asym < 1e-6f && fabsf(w[0] - cases[c].edge) < 1e-3f && peak > 0.99f && peak <= 1.0f + 1e-6f;
+        ESP_LOGI("TEST_ALL", "%-16s w[0]=%.6f pico=%.6f assimetria=%.2e %s",
+                 cases[c].name, w[0], peak, asym, ok ? "ok" : "falhou");
+        errors += !ok;
+    }
+    if (window_get(WINDOW_RECTANGULAR, n) != NULL) {
+        errors++;
+    }
+
+    // Fundida (em dois trechos, como a view do ring) == conversão seguida de apply_window
+    int32_t *raw = heap_caps_malloc(n * sizeof(int32_t), MALLOC_CAP_8BIT);
+    float *fused = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    float *ref = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    if (raw && fused && ref) {
+        for (size_t i = 0; i < n; i++) {
+            int32_t s24 = (int32_t)(0.8f * 8388607.0f * sinf(2.0f * (float)M_PI * 440.0f * (float)i / SAMPLE_RATE));
+            raw[i] = s24 * 256;
+            ref[i] = (float)s24 / (float)(1 << 23);
+        }
+        apply_window(ref, n, WINDOW_HANN);
+        const float *hann = window_get(WINDOW_HANN, n);
+        size_t split = 300;
+        window_and_convert(raw, hann, fused, split, NULL);
+        window_and_convert(raw + split, hann + split, fused + split, n - split, NULL);
+        float max_diff = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            max_diff = fmaxf(max_diff, fabsf(fused[i] - ref[i]));
+        }
+        ESP_LOGI("TEST_ALL", "window_and_convert: diferença máxima %.2e", max_diff);
+        errors += (max_diff > 1e-6f);
+    } else {
+        ESP_LOGE("TEST_ALL", "Falha ao alocar buffers do teste de janelas.");
+        errors++;
+    }
+    heap_caps_free(raw);
+    heap_caps_free(fused);
+    heap_caps_free(ref);
+
+    if (errors == 0) {
+        ESP_LOGI("TEST_ALL", "Janelas consistentes.");
+    } else {
+        ESP_LOGE("TEST_ALL", "Janelas inconsistentes (%zu erros).", errors);
+    }
+
+    ESP_LOGI("TEST_ALL", "===== Teste do Cache de Janelas Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
 /**
  * @brief Testa o filtro Biquad.
  */
@@ -160,7 +485,7 @@ static void test_filter(void *pv) {
     uint32_t start_time1 = esp_timer_get_time();
     bandpass_init(&bandpass_filter, sample_rate, f_low, f_high);
     uint32_t end_time = esp_timer_get_time();
-    ESP_LOGI("TEST_ALL", "Inicialização do Filtro Passa-Banda concluída em %ld us", end_time-start_time1);
+    ESP_LOGI("TEST_ALL", "Inicialização do Filtro Passa-Banda concluída em %" PRIu32 " us", end_time-start_time1);
 
     // Gerar um sinal de teste (onda senoidal de 1000 Hz)
     size_t buffer_size = 1024;
@@ -173,20 +498,125 @@ static void test_filter(void *pv) {
     uint32_t start_time = esp_timer_get_time();
     biquad_process(&bandpass_filter, audio_buffer, filtered_buffer, buffer_size);
     uint32_t end_time1 = esp_timer_get_time();
-    ESP_LOGI("TEST_ALL", "Processamento do Filtro concluído em %ld us", end_time1-start_time);
+    ESP_LOGI("TEST_ALL", "Processamento do Filtro concluído em %" PRIu32 " us", end_time1-start_time);
 
     // Opcional: Verificar alguns valores filtrados
     ESP_LOGI("TEST_ALL", "Primeiros 5 valores filtrados:");
     for (int i = 0; i < 5; i++) {
         ESP_LOGI("TEST_ALL", "filtered_buffer[%d] = %.5f", i, filtered_buffer[i]);
     }
-    ESP_LOGI("TEST_ALL", "Tempo total do teste do filtro: %ld us\n", end_time1-start_time1);
+    ESP_LOGI("TEST_ALL", "Tempo total do teste do filtro: %" PRIu32 " us\n", end_time1-start_time1);
 
     ESP_LOGI("TEST_ALL", "===== Teste do Filtro Biquad Concluído =====\n");
     vTaskDelete(NULL);
 
 }
 
+/**
+ * @brief Testa os projetos de SOS (Butterworth, Chebyshev I, presets) pela resposta em
+ *        frequência e compara sos_process (seções aos pares) com biquads em sequência.
+ */
+static void test_sos(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste da Cascata SOS =====");
+
+    const float fs = SAMPLE_RATE;
+    sos_filter_t f;
+    size_t errors = 0;
+
+#define SOS_CHECK_DB(label, freq, lo, hi) do {                                       \
+        float db_ = 20.0f * log10f(sos_magnitude(&f, (freq), fs) + 1e-12f);          \
+        bool ok_ = db_ >= (lo) && db_ <= (hi);                                       \
+        ESP_LOGI("TEST_ALL", "%-22s %7.1f Hz: %8.2f dB %s", label, (double)(freq), db_, ok_ ? "ok" : "falhou"); \
+        errors += !ok_;                                                              \
+    } while (0)
+
+    // Butterworth passa-baixa ordem 5: -3 dB no corte, >= 60 dB uma oitava e meia acima
+    if (sos_design_butterworth(&f, SOS_LOWPASS, 5, fs, 1000.0f, 0.0f) == ESP_OK && f.num_sections == 3) {
+        SOS_CHECK_DB("Butterworth LP5", 0.0f, -0.01f, 0.01f);
+        SOS_CHECK_DB("Butterworth LP5", 1000.0f, -3.1f, -2.9f);
+        SOS_CHECK_DB("Butterworth LP5", 3000.0f, -200.0f, -47.0f);
+    } else {
+        errors++;
+    }
+
+    // Chebyshev I passa-alta ordem 4, ripple 1 dB: banda passante em [-1, 0] dB
+    if (sos_design_chebyshev1(&f, SOS_HIGHPASS, 4, 1.0f, fs, 500.0f, 0.0f) == ESP_OK) {
+        SOS_CHECK_DB("Chebyshev HP4", 500.0f, -1.05f, -0.95f);
+        SOS_CHECK_DB("Chebyshev HP4", 2000.0f, -1.01f, 0.01f);
+        SOS_CHECK_DB("Chebyshev HP4", 10000.0f, -1.01f, 0.01f);
+        SOS_CHECK_DB("Chebyshev HP4", 100.0f, -200.0f, -40.0f);
+    } else {
+        errors++;
+    }
+
+    // Passa-banda de entrada: bordas em -3 dB, centro em 0 dB
+    if (sos_input_filter_init(&f, fs, LOW_FREQ, HIGH_FREQ) == ESP_OK) {
+        float center = sqrtf(LOW_FREQ * HIGH_FREQ);
+        SOS_CHECK_DB("Passa-banda entrada", LOW_FREQ, -3.2f, -2.8f);
+        SOS_CHECK_DB("Passa-banda entrada", HIGH_FREQ, -3.2f, -2.8f);
+        SOS_CHECK_DB("Passa-banda entrada", center, -0.1f, 0.01f);
+        SOS_CHECK_DB("Passa-banda entrada", 5.0f, -200.0f, -25.0f);
+    } else {
+        errors++;
+    }
+
+    // Presets: DC blocker e notch de 60 Hz com harmônicos
+    if (sos_dc_blocker(&f, fs, 10.0f) == ESP_OK) {
+        SOS_CHECK_DB("DC blocker", 0.0f, -400.0f, -100.0f);
+        SOS_CHECK_DB("DC blocker", 440.0f, -0.05f, 0.01f);
+    } else {
+        errors++;
+    }
+    if (sos_hum_notch(&f, fs, 60.0f, 3, FILTER_HUM_Q) == ESP_OK && f.num_sections == 3) {
+        // Em 60 Hz a profundidade é limitada pela precisão float dos coeficientes (~0.06 Hz de desvio do zero)
+        SOS_CHECK_DB("Notch 60 Hz", 60.0f, -400.0f, -30.0f);
+        SOS_CHECK_DB("Notch 60 Hz", 180.0f, -400.0f, -40.0f);
+        SOS_CHECK_DB("Notch 60 Hz", 82.4f, -0.5f, 0.01f);
+    } else {
+        errors++;
+    }
+#undef SOS_CHECK_DB
+
+    // sos_process (blocos de tamanhos variados, in-place) == biquad_process seção a seção
+    sos_design_chebyshev1(&f, SOS_BANDPASS, 3, 0.5f, fs, 200.0f, 2000.0f); // 3 seções: par + ímpar
+    sos_filter_t ref = f;
+    const size_t n = 2048;
+    float *x = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    float *y = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    if (x && y) {
+        for (size_t i = 0; i < n; i++) {
+            x[i] = 0.5f * sinf(2.0f * (float)M_PI * 440.0f * (float)i / fs) + 0.1f * ((float)rand() / RAND_MAX - 0.5f);
+        }
+        memcpy(y, x, n * sizeof(float));
+        size_t blocks[] = {1, 7, 256, 1000, n - 1264};
+        for (size_t b = 0, pos = 0; b < sizeof(blocks) / sizeof(blocks[0]); pos += blocks[b++]) {
+            sos_process(&f, y + pos, y + pos, blocks[b]);
+        }
+        for (size_t sidx = 0; sidx < ref.num_sections; sidx++) {
+            biquad_process(&ref.sections[sidx], x, x, n);
+        }
+        float max_diff = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            max_diff = fmaxf(max_diff, fabsf(x[i] - y[i]));
+        }
+        ESP_LOGI("TEST_ALL", "sos_process vs biquads em sequência: diferença máxima %.2e", max_diff);
+        errors += (max_diff > 1e-5f);
+    } else {
+        errors++;
+    }
+    heap_caps_free(x);
+    heap_caps_free(y);
+
+    if (errors == 0) {
+        ESP_LOGI("TEST_ALL", "Cascata SOS consistente.");
+    } else {
+        ESP_LOGE("TEST_ALL", "Cascata SOS inconsistente (%zu erros).", errors);
+    }
+
+    ESP_LOGI("TEST_ALL", "===== Teste da Cascata SOS Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
 /**
  * @brief Testa a implementação do YIN (Detecção de Pitch).
  */
@@ -198,13 +628,13 @@ static void test_yin(void *pv) {
     int sample_rate = 44100;
     Yin yin;
     uint32_t start_time = esp_timer_get_time();   
-    esp_err_t ret = yin_init(&yin, buffer_size, sample_rate, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.1f, 0.2f, 0.01f);
+    esp_err_t ret = yin_init(&yin, buffer_size, sample_rate, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.1f, 0.2f, 0.01f, YIN_DIFF_DIRECT);
     uint32_t end_time = esp_timer_get_time();
     if (ret != ESP_OK) {
         ESP_LOGE("TEST_ALL", "Falha na inicialização do YIN.");
         return;
     }
-    ESP_LOGI("TEST_ALL", "Inicialização do YIN concluída em %ld us", end_time-start_time);
+    ESP_LOGI("TEST_ALL", "Inicialização do YIN concluída em %" PRIu32 " us", end_time-start_time);
 
     // Gerar um sinal de teste (onda senoidal de 440 Hz)
     float test_phase = 0.0f;
@@ -221,7 +651,7 @@ static void test_yin(void *pv) {
     } else {
         ESP_LOGW("TEST_ALL", "Pitch não detectado.");
     }
-    ESP_LOGI("TEST_ALL", "Tempo de detecção do Pitch: %ld us\n", end_time-start_time);
+    ESP_LOGI("TEST_ALL", "Tempo de detecção do Pitch: %" PRIu32 " us\n", end_time-start_time);
 
     // Liberar recursos do YIN
     yin_deinit(&yin);
@@ -231,49 +661,1708 @@ static void test_yin(void *pv) {
 }
 
 /**
- * @brief Testa a função get_note.
+ * @brief Compara o YIN streaming (atualização incremental por salto) com o YIN em bloco.
  */
-static void test_get_note(void *pv) {
-    ESP_LOGI("TEST_ALL", "===== Teste da Função get_note =====");
-    
-    // Lista de frequências para testar
-    float test_frequencies[] = {440.0f, 261.63f, 329.63f, 0.0f, 5000.0f};
-    size_t num_tests = sizeof(test_frequencies) / sizeof(test_frequencies[0]);
+static void test_yin_stream(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste do YIN Streaming =====");
 
-    for (size_t i = 0; i < num_tests; i++) {
-        float freq = test_frequencies[i];
-        note_t note;
-        uint32_t start_time = esp_timer_get_time();
-        int ret = get_note(freq, &note);
-        uint32_t end_time = esp_timer_get_time();
+    const size_t window_size = BUFFER_SIZE;
+    const size_t hop_size = YIN_STREAM_HOP;
+    const size_t num_hops = 3 * (BUFFER_SIZE / YIN_STREAM_HOP);
+    const float tolerance_hz = 0.5f;
 
-        if (ret == 0) {
-            ESP_LOGI("TEST_ALL", "Frequência: %.2f Hz -> Nota: %s%d (%.2f Hz)", freq, note.note, note.octave, note.frequency);
-        } else {
-            ESP_LOGW("TEST_ALL", "Frequência: %.2f Hz -> Nota não detectada.", freq);
+    Yin yin;
+    yin_stream_t stream;
+    if (yin_init(&yin, window_size, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha na inicialização do YIN.");
+        vTaskDelete(NULL);
+        return;
+    }
+    if (yin_stream_init(&stream, window_size, hop_size, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha na inicialização do YIN streaming.");
+        yin_deinit(&yin);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    float *window = heap_caps_calloc(window_size, sizeof(float), MALLOC_CAP_8BIT);
+    float *hop = heap_caps_malloc(hop_size * sizeof(float), MALLOC_CAP_8BIT);
+    if (!window || !hop) {
+        ESP_LOGE("TEST_ALL", "Falha ao alocar buffers do teste.");
+        if (window) heap_caps_free(window);
+        if (hop) heap_caps_free(hop);
+        yin_stream_deinit(&stream);
+        yin_deinit(&yin);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    float test_phase = 0.0f;
+    float max_freq_err = 0.0f;
+    float max_rel_diff = 0.0f;
+    size_t compared = 0;
+    size_t mismatches = 0;
+    int64_t stream_us = 0;
+    int64_t batch_us = 0;
+
+    for (size_t k = 0; k < num_hops; k++) {
+        generate_sine_wave(hop, hop_size, 440.0f, SAMPLE_RATE, &test_phase);
+
+        float f_stream = 0.0f;
+        int64_t t0 = esp_timer_get_time();
+        int ret_stream = yin_stream_push(&stream, hop, &f_stream);
+        stream_us += esp_timer_get_time() - t0;
+
+        memmove(window, window + hop_size, (window_size - hop_size) * sizeof(float));
+        memcpy(window + window_size - hop_size, hop, hop_size * sizeof(float));
+        if ((k + 1) * hop_size < window_size) {
+            continue;
+        }
+
+        float f_batch = 0.0f;
+        t0 = esp_timer_get_time();
+        int ret_batch = yin_detect_pitch(&yin, window, &f_batch);
+        batch_us += esp_timer_get_time() - t0;
+        compared++;
+
+        if (ret_stream != ret_batch) {
+            mismatches++;
+            continue;
+        }
+        if (ret_batch == 0 && fabsf(f_stream - f_batch) > max_freq_err) {
+            max_freq_err = fabsf(f_stream - f_batch);
+        }
+        for (size_t tau = yin.config.tau_min; tau <= yin.config.tau_max; tau++) {
+            float ref = yin.config.cumulative_difference[tau];
+            float rel = fabsf(stream.yin.config.cumulative_difference[tau] - ref) / (ref + 1e-6f);
+            if (rel > max_rel_diff) {
+                max_rel_diff = rel;
+            }
         }
-        ESP_LOGI("TEST_ALL", "Tempo de execução do get_note: %ld us\n", end_time-start_time);
     }
 
+    ESP_LOGI("TEST_ALL", "Janelas comparadas: %zu | Divergências de detecção: %zu", compared, mismatches);
+    ESP_LOGI("TEST_ALL", "Erro máximo de frequência: %.4f Hz | Erro relativo máximo em d(tau): %.2e", max_freq_err, max_rel_diff);
+    ESP_LOGI("TEST_ALL", "Tempo total streaming: %lld us | bloco: %lld us", (long long)stream_us, (long long)batch_us);
+    if (mismatches == 0 && max_freq_err <= tolerance_hz) {
+        ESP_LOGI("TEST_ALL", "YIN streaming dentro da tolerância (%.2f Hz).", tolerance_hz);
+    } else {
+        ESP_LOGE("TEST_ALL", "YIN streaming fora da tolerância (%.2f Hz).", tolerance_hz);
+    }
 
-    ESP_LOGI("TEST_ALL", "===== Teste da Função get_note Concluído =====\n");
+    heap_caps_free(window);
+    heap_caps_free(hop);
+    yin_stream_deinit(&stream);
+    yin_deinit(&yin);
+
+    ESP_LOGI("TEST_ALL", "===== Teste do YIN Streaming Concluído =====\n");
     vTaskDelete(NULL);
 }
 
 /**
- * @brief Executa todos os testes consolidando os testes de funções vetoriais, FFT, filtros, YIN e get_note.
+ * @brief Compara os backends direto e FFT da função de diferença do YIN
+ *        e reporta o tamanho de buffer a partir do qual a FFT é mais rápida.
  */
-void run_all_tests(void) {
-    ESP_LOGI("TEST_ALL", "===== Iniciando Testes Consolidados =====\n");
-    xTaskCreate(test_vector_functions, "vetores", 16384, NULL, 0, NULL);
-    wait_for_enter();
-    xTaskCreate(test_fft_manual, "fft", 16384, NULL, 0, NULL);
-    wait_for_enter();
-    xTaskCreate(test_filter, "filtro", 16384, NULL, 0, NULL);
-    wait_for_enter();
-    xTaskCreate(test_yin, "yin", 16384, NULL, 0, NULL);
-    wait_for_enter();
-    xTaskCreate(test_get_note, "note", 16384, NULL, 0, NULL);
+static void test_yin_backends(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Benchmark dos Backends de d(tau) do YIN =====");
+
+    const size_t sizes[] = {256, 512, 1024, 2048, 4096};
+    const size_t num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+    const int repetitions = 5;
+    size_t crossover = 0;
+
+    for (size_t s = 0; s < num_sizes; s++) {
+        size_t n = sizes[s];
+        float *buffer = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+        if (!buffer) {
+            ESP_LOGE("TEST_ALL", "Falha ao alocar buffer de %zu amostras.", n);
+            break;
+        }
+        float test_phase = 0.0f;
+        generate_sine_wave(buffer, n, 440.0f, SAMPLE_RATE, &test_phase);
+
+        Yin direct;
+        Yin by_fft;
+        if (yin_init(&direct, n, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) != ESP_OK) {
+            heap_caps_free(buffer);
+            break;
+        }
+        if (yin_init(&by_fft, n, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_FFT) != ESP_OK) {
+            yin_deinit(&direct);
+            heap_caps_free(buffer);
+            break;
+        }
+
+        float f_direct = -1.0f;
+        float f_fft = -1.0f;
+        int64_t t0 = esp_timer_get_time();
+        for (int r = 0; r < repetitions; r++) {
+            yin_detect_pitch(&direct, buffer, &f_direct);
+        }
+        int64_t direct_us = (esp_timer_get_time() - t0) / repetitions;
+
+        t0 = esp_timer_get_time();
+        for (int r = 0; r < repetitions; r++) {
+            yin_detect_pitch(&by_fft, buffer, &f_fft);
+        }
+        int64_t fft_us = (esp_timer_get_time() - t0) / repetitions;
+
+        ESP_LOGI("TEST_ALL", "N=%4zu | direto: %7lld us (%.2f Hz) | FFT (M=%zu): %7lld us (%.2f Hz)",
+                 n, (long long)direct_us, f_direct, by_fft.config.fft_size, (long long)fft_us, f_fft);
+        if (crossover == 0 && fft_us < direct_us) {
+            crossover = n;
+        }
+
+        yin_deinit(&direct);
+        yin_deinit(&by_fft);
+        heap_caps_free(buffer);
+    }
+
+    if (crossover) {
+        ESP_LOGI("TEST_ALL", "Crossover: backend FFT mais rápido a partir de N=%zu.", crossover);
+    } else {
+        ESP_LOGI("TEST_ALL", "Crossover: backend direto mais rápido em todos os tamanhos testados.");
+    }
+
+    ESP_LOGI("TEST_ALL", "===== Benchmark dos Backends de d(tau) Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Testa o decimador half-band (banda passante, aliasing, stream em blocos)
+ *        e o YIN na taxa decimada contra o YIN na taxa cheia.
+ */
+static void test_decimator(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste do Decimador Half-Band =====");
+
+    const size_t factor = 4;
+    const size_t n = BUFFER_SIZE;
+    const size_t n_dec = n / factor;
+    const float fs = SAMPLE_RATE;
+    size_t errors = 0;
+
+    decimator_t dec;
+    float *x = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    float *y = heap_caps_malloc(n_dec * sizeof(float), MALLOC_CAP_8BIT);
+    float *y_blocks = heap_caps_malloc(n_dec * sizeof(float), MALLOC_CAP_8BIT);
+    if (!x || !y || !y_blocks || decimator_init(&dec, factor, fs, HIGH_FREQ, DECIM_ATTEN_DB, n) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha na inicialização do decimador.");
+        heap_caps_free(x); heap_caps_free(y); heap_caps_free(y_blocks);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    // Ganho de tons na banda passante e de tons que dobrariam sobre [0, HIGH_FREQ]
+    const float tones[] = {110.0f, 1000.0f, HIGH_FREQ, 7900.0f, 10000.0f, 20000.0f};
+    size_t settle = (size_t)(2.0f * decimator_delay(&dec) / factor) + 1; // Transitório do histórico zerado
+    for (size_t t = 0; t < sizeof(tones) / sizeof(tones[0]); t++) {
+        for (size_t i = 0; i < n; i++) {
+            x[i] = sinf(2.0f * (float)M_PI * tones[t] * (float)i / fs);
+        }
+        decimator_reset(&dec);
+        decimator_process(&dec, x, n, y);
+        float sum_sq = 0.0f;
+        for (size_t i = settle; i < n_dec; i++) {
+            sum_sq += y[i] * y[i];
+        }
+        float gain_db = 10.0f * log10f(2.0f * sum_sq / (float)(n_dec - settle) + 1e-20f);
+        bool passband = tones[t] <= HIGH_FREQ;
+        bool ok = passband ? fabsf(gain_db) < 0.1f : gain_db < -DECIM_ATTEN_DB + 3.0f;
+        ESP_LOGI("TEST_ALL", "Tom %7.1f Hz: ganho %7.2f dB (%s) %s", tones[t], gain_db,
+                 passband ? "banda passante" : "aliasing", ok ? "ok" : "falhou");
+        errors += !ok;
+    }
+
+    // Stream em blocos == bloco único
+    for (size_t i = 0; i < n; i++) {
+        x[i] = 0.5f * sinf(2.0f * (float)M_PI * 440.0f * (float)i / fs) + 0.1f * ((float)rand() / RAND_MAX - 0.5f);
+    }
+    decimator_reset(&dec);
+    decimator_process(&dec, x, n, y);
+    decimator_reset(&dec);
+    size_t pos_in = 0, pos_out = 0;
+    const size_t blocks[] = {4, 64, 1024, 8, n - 1100};
+    for (size_t b = 0; b < sizeof(blocks) / sizeof(blocks[0]); b++) {
+        pos_out += decimator_process(&dec, x + pos_in, blocks[b], y_blocks + pos_out);
+        pos_in += blocks[b];
+    }
+    float max_diff = 0.0f;
+    for (size_t i = 0; i < n_dec; i++) {
+        max_diff = fmaxf(max_diff, fabsf(y[i] - y_blocks[i]));
+    }
+    ESP_LOGI("TEST_ALL", "Stream em blocos vs bloco único: %zu amostras, diferença máxima %.2e", pos_out, max_diff);
+    errors += (pos_out != n_dec || max_diff > 1e-6f);
+
+    // YIN decimado (N/4 amostras a fs/4) contra YIN na taxa cheia
+    Yin yin_full, yin_dec;
+    if (yin_init(&yin_full, n, fs, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) == ESP_OK &&
+        yin_init(&yin_dec, n_dec, dec.output_rate, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) == ESP_OK) {
+        // Até C7: acima disso restam menos de 6 amostras por período a fs/4
+        const float pitches[] = {82.41f, 220.0f, 440.0f, 1318.5f, 2093.0f};
+        for (size_t p = 0; p < sizeof(pitches) / sizeof(pitches[0]); p++) {
+            for (size_t i = 0; i < n; i++) {
+                float ph = 2.0f * (float)M_PI * pitches[p] * (float)i / fs;
+                x[i] = 0.6f * sinf(ph) + 0.3f * sinf(2.0f * ph) + 0.1f * sinf(3.0f * ph);
+            }
+            float f_full = -1.0f, f_dec = -1.0f;
+            int64_t t0 = esp_timer_get_time();
+            yin_detect_pitch(&yin_full, x, &f_full);
+            int64_t t1 = esp_timer_get_time();
+            decimator_reset(&dec);
+            decimator_process(&dec, x, n, y);
+            yin_detect_pitch(&yin_dec, y, &f_dec);
+            int64_t t2 = esp_timer_get_time();
+            float cents = f_dec > 0.0f ? 1200.0f * log2f(f_dec / pitches[p]) : 1200.0f;
+            bool ok = fabsf(cents) < 20.0f;
+            ESP_LOGI("TEST_ALL", "Pitch %7.2f Hz: cheio %7.2f Hz (%lld us) | decimado %7.2f Hz, %+.1f cents (%lld us, com decimação) %s",
+                     pitches[p], f_full, (long long)(t1 - t0), f_dec, cents, (long long)(t2 - t1), ok ? "ok" : "falhou");
+            errors += !ok;
+        }
+        yin_deinit(&yin_full);
+        yin_deinit(&yin_dec);
+    } else {
+        errors++;
+    }
+
+    if (errors == 0) {
+        ESP_LOGI("TEST_ALL", "Decimador consistente.");
+    } else {
+        ESP_LOGE("TEST_ALL", "Decimador inconsistente (%zu erros).", errors);
+    }
+
+    decimator_deinit(&dec);
+    heap_caps_free(x);
+    heap_caps_free(y);
+    heap_caps_free(y_blocks);
+
+    ESP_LOGI("TEST_ALL", "===== Teste do Decimador Half-Band Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Compara a busca hierárquica (coarse-to-fine) do YIN com a exaustiva de 27.5 a 4186 Hz:
+ *        erro em cents de cada uma e tempo por janela.
+ */
+static void test_yin_hierarchical(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste da Busca Hierárquica do YIN =====");
+
+    const size_t n = 4096;             // tau_max = fs / 27.5 cabe em N / 2
+    const float fs = SAMPLE_RATE;
+    size_t errors = 0;
+
+    float *x = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    Yin full, hier;
+    if (!x || yin_init(&full, n, fs, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) != ESP_OK ||
+        yin_init(&hier, n, fs, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) != ESP_OK ||
+        yin_set_hierarchical(&hier, YIN_COARSE_FACTOR, YIN_COARSE_CANDIDATES, YIN_REFINE_RADIUS) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha na inicialização do YIN.");
+        heap_caps_free(x);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    // A0 a C8 em passos de terça menor (notas MIDI 21 a 108)
+    int64_t total_full = 0, total_hier = 0;
+    float worst_full = 0.0f, worst_hier = 0.0f;
+    for (int midi = 21; midi <= 108; midi += 3) {
+        float f0 = 440.0f * powf(2.0f, (float)(midi - 69) / 12.0f);
+        for (size_t i = 0; i < n; i++) {
+            float ph = 2.0f * (float)M_PI * f0 * (float)i / fs;
+            x[i] = 0.6f * sinf(ph) + 0.3f * sinf(2.0f * ph) + 0.1f * sinf(3.0f * ph);
+        }
+
+        float f_full = -1.0f, f_hier = -1.0f;
+        int64_t t0 = esp_timer_get_time();
+        yin_detect_pitch(&full, x, &f_full);
+        int64_t t1 = esp_timer_get_time();
+        yin_detect_pitch(&hier, x, &f_hier);
+        int64_t t2 = esp_timer_get_time();
+        total_full += t1 - t0;
+        total_hier += t2 - t1;
+
+        float c_full = f_full > 0.0f ? 1200.0f * log2f(f_full / f0) : 1200.0f;
+        float c_hier = f_hier > 0.0f ? 1200.0f * log2f(f_hier / f0) : 1200.0f;
+        worst_full = fmaxf(worst_full, fabsf(c_full));
+        worst_hier = fmaxf(worst_hier, fabsf(c_hier));
+
+        // A hierárquica deve acertar onde a exaustiva acerta
+        bool ok = fabsf(c_full) >= 20.0f || fabsf(c_hier) < 20.0f;
+        ESP_LOGI("TEST_ALL", "%7.2f Hz: exaustiva %7.2f Hz (%+6.1f cents, %5lld us) | hierárquica %7.2f Hz (%+6.1f cents, %4lld us) %s",
+                 f0, f_full, c_full, (long long)(t1 - t0), f_hier, c_hier, (long long)(t2 - t1), ok ? "ok" : "falhou");
+        errors += !ok;
+    }
+
+    ESP_LOGI("TEST_ALL", "Pior erro: exaustiva %.1f cents, hierárquica %.1f cents | tempo total %lld us vs %lld us (%.1fx)",
+             worst_full, worst_hier, (long long)total_full, (long long)total_hier,
+             total_hier ? (double)total_full / (double)total_hier : 0.0);
+
+    // Silêncio não pode produzir pitch
+    memset(x, 0, n * sizeof(float));
+    float f_silence = 0.0f;
+    errors += (yin_detect_pitch(&hier, x, &f_silence) == 0);
+
+    if (errors == 0) {
+        ESP_LOGI("TEST_ALL", "Busca hierárquica consistente com a exaustiva.");
+    } else {
+        ESP_LOGE("TEST_ALL", "Busca hierárquica inconsistente (%zu erros).", errors);
+    }
+
+    yin_deinit(&full);
+    yin_deinit(&hier);
+    heap_caps_free(x);
+
+    ESP_LOGI("TEST_ALL", "===== Teste da Busca Hierárquica do YIN Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Compara a busca com saída antecipada do YIN com a exaustiva de 27.5 a 4186 Hz:
+ *        erro em cents, lags avaliados por janela e tempo.
+ */
+static void test_yin_early_exit(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste do YIN com Saída Antecipada =====");
+
+    const size_t n = 4096;             // tau_max = fs / 27.5 cabe em N / 2
+    const float fs = SAMPLE_RATE;
+    size_t errors = 0;
+
+    float *x = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    Yin full, early;
+    if (!x || yin_init(&full, n, fs, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) != ESP_OK ||
+        yin_init(&early, n, fs, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) != ESP_OK ||
+        yin_set_early_exit(&early, true) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha na inicialização do YIN.");
+        heap_caps_free(x);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    // A0 a C8 em passos de quarta (notas MIDI 21 a 108)
+    int64_t total_full = 0, total_early = 0;
+    size_t total_taus_full = 0, total_taus_early = 0;
+    for (int midi = 21; midi <= 108; midi += 5) {
+        float f0 = 440.0f * powf(2.0f, (float)(midi - 69) / 12.0f);
+        for (size_t i = 0; i < n; i++) {
+            float ph = 2.0f * (float)M_PI * f0 * (float)i / fs;
+            x[i] = 0.6f * sinf(ph) + 0.3f * sinf(2.0f * ph) + 0.1f * sinf(3.0f * ph);
+        }
+
+        float f_full = -1.0f, f_early = -1.0f;
+        int64_t t0 = esp_timer_get_time();
+        yin_detect_pitch(&full, x, &f_full);
+        int64_t t1 = esp_timer_get_time();
+        yin_detect_pitch(&early, x, &f_early);
+        int64_t t2 = esp_timer_get_time();
+        total_full += t1 - t0;
+        total_early += t2 - t1;
+        total_taus_full += yin_taus_evaluated(&full);
+        total_taus_early += yin_taus_evaluated(&early);
+
+        float c_full = f_full > 0.0f ? 1200.0f * log2f(f_full / f0) : 1200.0f;
+        float c_early = f_early > 0.0f ? 1200.0f * log2f(f_early / f0) : 1200.0f;
+
+        // Deve acertar onde a exaustiva acerta, sem avaliar mais lags (em A0 o período é tau_max)
+        bool ok = fabsf(c_full) >= 20.0f ||
+                  (fabsf(c_early) < 20.0f && yin_taus_evaluated(&early) <= yin_taus_evaluated(&full));
+        ESP_LOGI("TEST_ALL", "%7.2f Hz: exaustiva %+7.1f cents (%4zu lags, %5lld us) | antecipada %+7.1f cents (%4zu lags, %5lld us) %s",
+                 f0, c_full, yin_taus_evaluated(&full), (long long)(t1 - t0),
+                 c_early, yin_taus_evaluated(&early), (long long)(t2 - t1), ok ? "ok" : "falhou");
+        errors += !ok;
+    }
+
+    ESP_LOGI("TEST_ALL", "Lags avaliados: %zu vs %zu (%.1f%%) | tempo total %lld us vs %lld us (%.1fx)",
+             total_taus_early, total_taus_full, 100.0 * (double)total_taus_early / (double)total_taus_full,
+             (long long)total_full, (long long)total_early,
+             total_early ? (double)total_full / (double)total_early : 0.0);
+
+    // Silêncio percorre a faixa toda e não produz pitch
+    memset(x, 0, n * sizeof(float));
+    float f_silence = 0.0f;
+    errors += (yin_detect_pitch(&early, x, &f_silence) == 0);
+    errors += (yin_taus_evaluated(&early) != full.config.tau_max - full.config.tau_min + 1);
+
+    if (errors == 0) {
+        ESP_LOGI("TEST_ALL", "Saída antecipada consistente com a busca exaustiva.");
+    } else {
+        ESP_LOGE("TEST_ALL", "Saída antecipada inconsistente (%zu erros).", errors);
+    }
+
+    yin_deinit(&full);
+    yin_deinit(&early);
+    heap_caps_free(x);
+
+    ESP_LOGI("TEST_ALL", "===== Teste do YIN com Saída Antecipada Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Rastreamento do YIN numa sequência de notas sustentadas (quinta, oitava acima e
+ *        abaixo): exatidão contra a busca completa, travamentos/destravamentos e lags por janela.
+ */
+static void test_yin_tracking(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste do Rastreamento do YIN =====");
+
+    const size_t n = 4096;             // tau_max = fs / 27.5 cabe em N / 2
+    const size_t hop = 1024;
+    const float fs = SAMPLE_RATE;
+    const float notes[] = {220.0f, 440.0f, 329.63f, 164.81f};
+    const size_t frames_per_note = 8;
+    const size_t num_notes = sizeof(notes) / sizeof(notes[0]);
+    size_t errors = 0;
+
+    float *x = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    q15_t *xq = heap_caps_malloc(n * sizeof(q15_t), MALLOC_CAP_8BIT);
+    Yin full, track;
+    if (!x || !xq || yin_init(&full, n, fs, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) != ESP_OK ||
+        yin_init(&track, n, fs, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) != ESP_OK ||
+        yin_set_tracking(&track, true, YIN_TRACK_SEMITONES) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha na inicialização do YIN.");
+        if (x) heap_caps_free(x);
+        if (xq) heap_caps_free(xq);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    // Sinal contínuo: cada janela avança hop amostras; troca de nota sem mudar a amplitude
+    int64_t time_full = 0, time_track = 0;
+    size_t taus_full = 0;
+    for (size_t k = 0; k < num_notes; k++) {
+        float f0 = notes[k];
+        float worst = 0.0f;
+        for (size_t fr = 0; fr < frames_per_note; fr++) {
+            size_t start = (k * frames_per_note + fr) * hop;
+            for (size_t i = 0; i < n; i++) {
+                float ph = 2.0f * (float)M_PI * f0 * (float)(start + i) / fs;
+                x[i] = 0.6f * sinf(ph) + 0.3f * sinf(2.0f * ph) + 0.1f * sinf(3.0f * ph);
+            }
+            float f_full = -1.0f, f_track = -1.0f;
+            int64_t t0 = esp_timer_get_time();
+            yin_detect_pitch(&full, x, &f_full);
+            int64_t t1 = esp_timer_get_time();
+            yin_detect_pitch(&track, x, &f_track);
+            int64_t t2 = esp_timer_get_time();
+            time_full += t1 - t0;
+            time_track += t2 - t1;
+            taus_full += yin_taus_evaluated(&full);
+
+            float c_track = f_track > 0.0f ? 1200.0f * log2f(f_track / f0) : 1200.0f;
+            float c_full = f_full > 0.0f ? 1200.0f * log2f(f_full / f0) : 1200.0f;
+            // A primeira janela de cada nota já sai certa (a trava perdida refaz a busca completa)
+            if (fabsf(c_track) > fabsf(worst)) {
+                worst = c_track;
+            }
+            errors += !(fabsf(c_track) < 10.0f && fabsf(c_full) < 10.0f);
+        }
+        ESP_LOGI("TEST_ALL", "%7.2f Hz: pior erro rastreado %+6.2f cents", f0, worst);
+    }
+
+    yin_tracking_stats_t stats;
+    yin_get_tracking_stats(&track, &stats);
+    float avg_full = (float)taus_full / (float)(num_notes * frames_per_note);
+    ESP_LOGI("TEST_ALL", "Janelas %" PRIu32 " | rastreadas %" PRIu32 " | travas %" PRIu32 " | destravas %" PRIu32,
+             stats.frames, stats.tracked, stats.locks, stats.unlocks);
+    ESP_LOGI("TEST_ALL", "Lags por janela: %.1f vs %.1f (%.1f%%) | tempo total %lld us vs %lld us (%.1fx)",
+             stats.avg_taus, avg_full, 100.0f * stats.avg_taus / avg_full,
+             (long long)time_full, (long long)time_track,
+             time_track ? (double)time_full / (double)time_track : 0.0);
+    errors += (stats.locks != num_notes) + (stats.unlocks != num_notes - 1);
+    errors += (stats.tracked != num_notes * (frames_per_note - 1));
+    errors += (stats.avg_taus > 0.25f * avg_full);
+
+    // Q15 na mesma trava (última nota)
+    for (size_t i = 0; i < n; i++) {
+        xq[i] = (q15_t)(x[i] * 32767.0f);
+    }
+    float f_q15 = -1.0f;
+    yin_detect_pitch_q15(&track, xq, &f_q15);
+    yin_get_tracking_stats(&track, &stats);
+    bool q15_ok = f_q15 > 0.0f && fabsf(1200.0f * log2f(f_q15 / notes[num_notes - 1])) < 10.0f &&
+                  stats.tracked == num_notes * (frames_per_note - 1) + 1;
+
+    // Ataque (+12 dB na mesma nota) destrava e trava de novo; reset também destrava
+    for (size_t i = 0; i < n; i++) {
+        x[i] *= 4.0f;
+    }
+    float f_onset = -1.0f;
+    yin_detect_pitch(&track, x, &f_onset);
+    yin_get_tracking_stats(&track, &stats);
+    bool onset_ok = stats.unlocks == num_notes && stats.locks == num_notes + 1 && track.config.locked;
+    yin_reset(&track);
+    bool reset_ok = !track.config.locked;
+    ESP_LOGI("TEST_ALL", "Q15 rastreado: %.2f Hz %s | ataque: %s | reset: %s", f_q15, q15_ok ? "ok" : "falhou",
+             onset_ok ? "ok" : "falhou", reset_ok ? "ok" : "falhou");
+    errors += !q15_ok + !onset_ok + !reset_ok;
+
+    if (errors == 0) {
+        ESP_LOGI("TEST_ALL", "Rastreamento consistente com a busca completa.");
+    } else {
+        ESP_LOGE("TEST_ALL", "Rastreamento inconsistente (%zu erros).", errors);
+    }
+
+    yin_deinit(&full);
+    yin_deinit(&track);
+    heap_caps_free(x);
+    heap_caps_free(xq);
+
+    ESP_LOGI("TEST_ALL", "===== Teste do Rastreamento do YIN Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Compara o laço direto de d(tau) serial com o dividido pelo executor
+ *        (YIN_PARALLEL_WORKERS partes): resultados idênticos, tempo e speedup.
+ */
+static void test_yin_parallel(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste do YIN Paralelo =====");
+
+    const size_t n = 2048;
+    const float fs = SAMPLE_RATE;
+    size_t errors = 0;
+
+    static par_executor_t executor;
+    float *x = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    q15_t *xq = heap_caps_malloc(n * sizeof(q15_t), MALLOC_CAP_8BIT);
+    Yin serial, parallel;
+    // Cada etapa só roda se a anterior deu certo; a falha desfaz as que deram
+    bool ex_ok = x && xq && par_executor_init(&executor, YIN_PARALLEL_WORKERS) == ESP_OK;
+    bool serial_ok = ex_ok &&
+        yin_init(&serial, n, fs, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) == ESP_OK;
+    bool parallel_ok = serial_ok &&
+        yin_init(&parallel, n, fs, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) == ESP_OK;
+    if (!parallel_ok || yin_set_executor(&parallel, &executor) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha na inicialização do YIN/executor.");
+        if (parallel_ok) yin_deinit(&parallel);
+        if (serial_ok) yin_deinit(&serial);
+        if (ex_ok) par_executor_deinit(&executor);
+        if (x) heap_caps_free(x);
+        if (xq) heap_caps_free(xq);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    // Cada lag é somado inteiro por uma única parte: d(tau) deve ser bit a bit igual
+    int64_t us_serial = 0, us_parallel = 0;
+    const float test_freqs[] = {55.0f, 110.0f, 220.0f, 440.0f, 880.0f, 1760.0f};
+    for (size_t f = 0; f < sizeof(test_freqs) / sizeof(test_freqs[0]); f++) {
+        for (size_t i = 0; i < n; i++) {
+            float ph = 2.0f * (float)M_PI * test_freqs[f] * (float)i / fs;
+            x[i] = 0.6f * sinf(ph) + 0.3f * sinf(2.0f * ph);
+            xq[i] = (q15_t)lrintf(x[i] * 32767.0f);
+        }
+
+        float f_serial = -1.0f, f_parallel = -1.0f;
+        int64_t t0 = esp_timer_get_time();
+        yin_detect_pitch(&serial, x, &f_serial);
+        int64_t t1 = esp_timer_get_time();
+        yin_detect_pitch(&parallel, x, &f_parallel);
+        int64_t t2 = esp_timer_get_time();
+        us_serial += t1 - t0;
+        us_parallel += t2 - t1;
+        bool same = f_serial == f_parallel &&
+                    memcmp(serial.config.cumulative_difference, parallel.config.cumulative_difference,
+                           (serial.config.tau_max + 1) * sizeof(float)) == 0;
+
+        float q_serial = -1.0f, q_parallel = -1.0f;
+        yin_detect_pitch_q15(&serial, xq, &q_serial);
+        yin_detect_pitch_q15(&parallel, xq, &q_parallel);
+        same = same && q_serial == q_parallel;
+
+        ESP_LOGI("TEST_ALL", "%7.2f Hz: serial %8.3f Hz (%5lld us) | paralelo %8.3f Hz (%5lld us) | Q15 %8.3f/%8.3f Hz %s",
+                 test_freqs[f], f_serial, (long long)(t1 - t0), f_parallel, (long long)(t2 - t1),
+                 q_serial, q_parallel, same ? "ok" : "falhou");
+        errors += !same;
+    }
+
+    ESP_LOGI("TEST_ALL", "%zu partes: %lld us vs %lld us (%.2fx)", executor.num_workers,
+             (long long)us_serial, (long long)us_parallel,
+             us_parallel ? (double)us_serial / (double)us_parallel : 0.0);
+
+    if (errors == 0) {
+        ESP_LOGI("TEST_ALL", "YIN paralelo idêntico ao serial.");
+    } else {
+        ESP_LOGE("TEST_ALL", "YIN paralelo diverge do serial (%zu erros).", errors);
+    }
+
+    yin_deinit(&serial);
+    yin_deinit(&parallel);
+    par_executor_deinit(&executor);
+    heap_caps_free(x);
+    heap_caps_free(xq);
+
+    ESP_LOGI("TEST_ALL", "===== Teste do YIN Paralelo Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Testa o pool de blocos: esgotamento, pico de uso e reaproveitamento.
+ */
+static void test_block_pool(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste do Pool de Blocos =====");
+
+    const size_t capacity = 4;
+    block_pool_t pool;
+    if (block_pool_init(&pool, "teste", 100, capacity, MALLOC_CAP_8BIT) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha na inicialização do pool.");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    pool_index_t idx[4];
+    bool distinct = true;
+    for (size_t i = 0; i < capacity; i++) {
+        idx[i] = block_pool_acquire(&pool);
+        memset(block_pool_get(&pool, idx[i]), (int)i, 100);
+        for (size_t j = 0; j < i; j++) {
+            distinct &= (idx[i] != idx[j]);
+        }
+    }
+    pool_index_t extra = block_pool_acquire(&pool);
+
+    int64_t t0 = esp_timer_get_time();
+    for (int r = 0; r < 1000; r++) {
+        block_pool_release(&pool, idx[0]);
+        idx[0] = block_pool_acquire(&pool);
+    }
+    int64_t cycle_us = esp_timer_get_time() - t0;
+
+    for (size_t i = 0; i < capacity; i++) {
+        block_pool_release(&pool, idx[i]);
+    }
+
+    block_pool_stats_t stats;
+    block_pool_get_stats(&pool, &stats);
+    ESP_LOGI("TEST_ALL", "Blocos distintos: %s | Aquisição extra: %s | uso=%" PRIu32 " pico=%" PRIu32 " esgotado=%" PRIu32,
+             distinct ? "sim" : "não", extra == POOL_INVALID_INDEX ? "recusada" : "aceita",
+             stats.in_use, stats.high_water, stats.exhausted);
+    ESP_LOGI("TEST_ALL", "1000 ciclos release/acquire: %lld us", (long long)cycle_us);
+    if (distinct && extra == POOL_INVALID_INDEX && stats.in_use == 0 && stats.high_water == capacity && stats.exhausted == 1) {
+        ESP_LOGI("TEST_ALL", "Pool de blocos consistente.");
+    } else {
+        ESP_LOGE("TEST_ALL", "Pool de blocos inconsistente.");
+    }
+
+    block_pool_deinit(&pool);
+
+    ESP_LOGI("TEST_ALL", "===== Teste do Pool de Blocos Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Testa o ring SPSC: janelas sobrepostas (window/hop) cruzando o fim do armazenamento.
+ */
+static void test_audio_ring(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste do Ring de Áudio =====");
+
+    const size_t capacity = 64;
+    const size_t window = 24;
+    const size_t hop = 10;
+    const size_t chunk = 7;
+    audio_ring_t ring;
+    if (audio_ring_init(&ring, capacity, MALLOC_CAP_8BIT) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha na inicialização do ring.");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    int32_t next_write = 0;   // Valor do próximo frame escrito (frame i vale i)
+    int32_t window_start = 0; // Valor esperado do primeiro frame da janela
+    size_t windows = 0, split_views = 0, errors = 0;
+
+    for (int iter = 0; iter < 200; iter++) {
+        // Produtor: escreve um chunk em até dois trechos contíguos
+        size_t remaining = chunk;
+        while (remaining > 0) {
+            int32_t *dst = NULL;
+            size_t span = audio_ring_write_acquire(&ring, &dst);
+            if (span == 0) {
+                break;
+            }
+            if (span > remaining) {
+                span = remaining;
+            }
+            for (size_t i = 0; i < span; i++) {
+                dst[i] = next_write++;
+            }
+            audio_ring_write_commit(&ring, span);
+            remaining -= span;
+        }
+
+        // Consumidor: todas as janelas completas disponíveis
+        audio_ring_view_t view;
+        while (audio_ring_peek(&ring, window, &view)) {
+            if (view.first_len + view.second_len != window) {
+                errors++;
+            }
+            for (size_t i = 0; i < window; i++) {
+                int32_t v = (i < view.first_len) ? view.first[i] : view.second[i - view.first_len];
+                if (v != window_start + (int32_t)i) {
+                    errors++;
+                }
+            }
+            split_views += (view.second != NULL);
+            windows++;
+            audio_ring_consume(&ring, hop);
+            window_start += hop;
+        }
+    }
+
+    // Ring cheio: o produtor não recebe espaço
+    int32_t *dst = NULL;
+    size_t span;
+    while ((span = audio_ring_write_acquire(&ring, &dst)) > 0) {
+        audio_ring_write_commit(&ring, span);
+    }
+    bool full_ok = audio_ring_available(&ring) == capacity;
+
+    ESP_LOGI("TEST_ALL", "Janelas: %zu (%zu cruzando o fim) | erros=%zu | ring cheio: %s",
+             windows, split_views, errors, full_ok ? "ok" : "falhou");
+    if (errors == 0 && split_views > 0 && full_ok) {
+        ESP_LOGI("TEST_ALL", "Ring de áudio consistente.");
+    } else {
+        ESP_LOGE("TEST_ALL", "Ring de áudio inconsistente.");
+    }
+
+    audio_ring_deinit(&ring);
+
+    ESP_LOGI("TEST_ALL", "===== Teste do Ring de Áudio Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+// Frame do teste do grafo: a fonte numera, dois estágios paralelos preenchem a e b, a junção soma
+typedef struct {
+    uint32_t seq;
+    uint32_t a, b, sum;
+} sg_test_frame_t;
+
+typedef struct {
+    uint32_t total;                 // Frames a produzir
+    _Atomic uint32_t produced;
+    _Atomic uint32_t consumed;
+    _Atomic uint32_t errors;
+    uint32_t next_seq;              // Próximo frame esperado no sink (só o sink escreve)
+} sg_test_ctx_t;
+
+// Terminada a produção, a fonte só espera o stop (fora do tempo ocupado)
+static bool sg_test_wait(void *ctx) {
+    sg_test_ctx_t *c = (sg_test_ctx_t *)ctx;
+    if (atomic_load(&c->produced) >= c->total) {
+        vTaskDelay(1);
+        return false;
+    }
+    return true;
+}
+
+static bool sg_test_source(void *ctx, void *frame, uint32_t frame_id) {
+    sg_test_ctx_t *c = (sg_test_ctx_t *)ctx;
+    sg_test_frame_t *f = (sg_test_frame_t *)frame;
+    f->seq = atomic_fetch_add(&c->produced, 1);
+    f->a = f->b = f->sum = 0;
+    if (frame_id != f->seq) {
+        atomic_fetch_add(&c->errors, 1);
+    }
+    return true;
+}
+
+static bool sg_test_double(void *ctx, void *frame, uint32_t frame_id) {
+    (void)ctx;
+    (void)frame_id;
+    sg_test_frame_t *f = (sg_test_frame_t *)frame;
+    f->a = 2 * f->seq;
+    return true;
+}
+
+static bool sg_test_square(void *ctx, void *frame, uint32_t frame_id) {
+    (void)ctx;
+    (void)frame_id;
+    sg_test_frame_t *f = (sg_test_frame_t *)frame;
+    f->b = f->seq * f->seq;
+    return true;
+}
+
+static bool sg_test_join(void *ctx, void *frame, uint32_t frame_id) {
+    (void)ctx;
+    (void)frame_id;
+    sg_test_frame_t *f = (sg_test_frame_t *)frame;
+    f->sum = f->a + f->b;
+    return true;
+}
+
+static bool sg_test_sink(void *ctx, void *frame, uint32_t frame_id) {
+    sg_test_ctx_t *c = (sg_test_ctx_t *)ctx;
+    const sg_test_frame_t *f = (const sg_test_frame_t *)frame;
+    if (f->seq != c->next_seq || frame_id != f->seq || f->sum != 2 * f->seq + f->seq * f->seq) {
+        atomic_fetch_add(&c->errors, 1);
+    }
+    c->next_seq = f->seq + 1;
+    atomic_fetch_add(&c->consumed, 1);
+    return true;
+}
+
+/**
+ * @brief Testa o grafo de estágios: fonte -> (dobro || quadrado) -> junção -> sink com poucos
+ *        frames em trânsito. Confere ordem, resultados, devolução dos frames, estatísticas e
+ *        a validação da declaração.
+ */
+static void test_stage_graph(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste do Grafo de Estágios =====");
+
+    static stage_graph_t graph;
+    static sg_test_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.total = 500;
+    const size_t num_frames = 4;
+    if (stage_graph_init(&graph, sizeof(sg_test_frame_t), num_frames, MALLOC_CAP_8BIT) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha na inicialização do grafo.");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    const stage_desc_t stages[] = {
+        {"fonte",    sg_test_source, &ctx, sg_test_wait, 0,                               STAGE_NO_AFFINITY, 4, 4096},
+        {"dobro",    sg_test_double, NULL, NULL,         STAGE_INPUT(0),                  0,                 4, 4096},
+        {"quadrado", sg_test_square, NULL, NULL,         STAGE_INPUT(0),                  1,                 4, 4096},
+        {"soma",     sg_test_join,   NULL, NULL,         STAGE_INPUT(1) | STAGE_INPUT(2), STAGE_NO_AFFINITY, 4, 4096},
+        {"sink",     sg_test_sink,   &ctx, NULL,         STAGE_INPUT(3),                  STAGE_NO_AFFINITY, 3, 4096},
+    };
+    const size_t num_stages = sizeof(stages) / sizeof(stages[0]);
+    size_t errors = 0;
+    for (size_t i = 0; i < num_stages; i++) {
+        errors += stage_graph_add(&graph, &stages[i]) != (int)i;
+    }
+    if (errors || stage_graph_start(&graph) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha ao iniciar o grafo.");
+        stage_graph_deinit(&graph);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    // Espera o sink consumir tudo e o último frame voltar ao pool (até ~5 s)
+    block_pool_stats_t pool_stats;
+    for (int t = 0; t < 5000; t++) {
+        block_pool_get_stats(&graph.frames, &pool_stats);
+        if (atomic_load(&ctx.consumed) == ctx.total && pool_stats.in_use == 0) {
+            break;
+        }
+        vTaskDelay(1);
+    }
+
+    for (size_t i = 0; i < num_stages; i++) {
+        stage_stats_t st;
+        stage_graph_get_stats(&graph, (int)i, &st);
+        ESP_LOGI("TEST_ALL", "%-9s: %4" PRIu32 " chamadas | fila pico %" PRIu32 " | sem frame %" PRIu32 " | %5.1f%% CPU",
+                 stages[i].name, st.frames, st.queue_high_water, st.starved, 100.0f * st.utilization);
+        if (st.frames != ctx.total || st.queue_high_water > num_frames) {
+            ESP_LOGE("TEST_ALL", "Estágio %s: %" PRIu32 " chamadas, fila pico %" PRIu32 ".",
+                     stages[i].name, st.frames, st.queue_high_water);
+            errors++;
+        }
+    }
+    errors += atomic_load(&ctx.errors);
+    errors += atomic_load(&ctx.consumed) != ctx.total;
+    errors += pool_stats.in_use != 0 || pool_stats.high_water > num_frames;
+    stage_graph_deinit(&graph);
+
+    // Declarações inválidas: entrada ainda não declarada e duas fontes de frames
+    static stage_graph_t bad;
+    if (stage_graph_init(&bad, sizeof(sg_test_frame_t), 2, MALLOC_CAP_8BIT) == ESP_OK) {
+        stage_desc_t d = stages[1];
+        errors += stage_graph_add(&bad, &d) != -1;          // Entrada 0 ainda não existe
+        d = stages[0];
+        errors += stage_graph_add(&bad, &d) != 0;
+        errors += stage_graph_add(&bad, &d) != 1;
+        d = stages[3];
+        d.inputs = STAGE_INPUT(0) | STAGE_INPUT(1);
+        errors += stage_graph_add(&bad, &d) != 2;           // Consome as duas fontes
+        errors += stage_graph_start(&bad) != ESP_ERR_INVALID_ARG;
+        stage_graph_deinit(&bad);
+    } else {
+        errors++;
+    }
+
+    if (errors == 0) {
+        ESP_LOGI("TEST_ALL", "Grafo de estágios consistente (%" PRIu32 " frames, %zu em trânsito).", ctx.total, num_frames);
+    } else {
+        ESP_LOGE("TEST_ALL", "Grafo de estágios inconsistente (%zu erros).", errors);
+    }
+
+    ESP_LOGI("TEST_ALL", "===== Teste do Grafo de Estágios Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Testa o ring de trace: sobrescrita dos eventos antigos, ordem do snapshot,
+ *        reset e exportação.
+ */
+static void test_trace(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste do Trace =====");
+
+    const size_t capacity = 16;
+    const uint32_t total = 40;
+    if (trace_init(capacity) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha na inicialização do trace.");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    for (uint32_t i = 0; i < total; i++) {
+        uint32_t start = trace_begin();
+        trace_end((trace_stage_t)(i % TRACE_STAGE_COUNT), i, start);
+    }
+
+    // Apenas os capacity eventos mais recentes, do mais antigo ao mais novo
+    trace_event_t events[32];
+    size_t count = trace_snapshot(events, 32);
+    size_t errors = 0;
+    for (size_t k = 0; k < count; k++) {
+        uint32_t expected = total - (uint32_t)capacity + (uint32_t)k;
+        if (events[k].frame != expected || events[k].stage != expected % TRACE_STAGE_COUNT) {
+            errors++;
+        }
+    }
+    size_t exported = trace_export_csv(stdout);
+
+    // Desabilitado não grava; reset esvazia
+    trace_set_enabled(false);
+    trace_end(TRACE_STAGE_FFT, 999, trace_begin());
+    trace_set_enabled(true);
+    bool disabled_ok = trace_snapshot(events, 32) == capacity && events[capacity - 1].frame == total - 1;
+    trace_reset();
+    bool reset_ok = trace_snapshot(events, 32) == 0;
+
+    ESP_LOGI("TEST_ALL", "Eventos: %zu (esperado %zu) | erros=%zu | exportados=%zu | desabilitado: %s | reset: %s",
+             count, capacity, errors, exported, disabled_ok ? "ok" : "falhou", reset_ok ? "ok" : "falhou");
+    if (count == capacity && errors == 0 && exported == capacity && disabled_ok && reset_ok) {
+        ESP_LOGI("TEST_ALL", "Trace consistente.");
+    } else {
+        ESP_LOGE("TEST_ALL", "Trace inconsistente.");
+    }
+
+    trace_deinit();
+
+    ESP_LOGI("TEST_ALL", "===== Teste do Trace Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Callback do teste de telemetria: guarda o último frame e os vetores.
+ */
+typedef struct {
+    size_t frames;
+    telem_frame_t last;
+    float spectrum[64];
+    float samples[64];
+} telem_capture_t;
+
+static void telem_capture_cb(const telem_frame_t *frame, const uint8_t *raw, size_t raw_len, void *user) {
+    (void)raw;
+    (void)raw_len;
+    telem_capture_t *cap = (telem_capture_t *)user;
+    cap->frames++;
+    cap->last = *frame;
+    memcpy(cap->spectrum, frame->spectrum, frame->spectrum_len * sizeof(float));
+    memcpy(cap->samples, frame->samples, frame->samples_len * sizeof(float));
+}
+
+/**
+ * @brief Testa os frames de telemetria: ida e volta em int16 e float16, detecção de
+ *        corrupção pelo CRC e ressincronização num stream com texto no meio.
+ */
+static void test_telemetry(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste da Telemetria =====");
+
+    enum { N = 64 };
+    float spectrum[N], samples[N];
+    for (size_t i = 0; i < N; i++) {
+        spectrum[i] = 100.0f * expf(-(float)i / 8.0f);
+        samples[i] = 0.8f * sinf(2.0f * M_PI * (float)i / 16.0f);
+    }
+    telem_frame_t tf = {
+        .flags = TELEM_FLAG_SPECTRUM | TELEM_FLAG_SAMPLES,
+        .seq = 7, .timestamp_us = 123456, .fundamental = 440.25f,
+        .cents = 1.23f, .note = 69, .confidence = 0.9f,
+        .spectrum = spectrum, .spectrum_len = N,
+        .samples = samples, .samples_len = N,
+    };
+
+    // CRC-16/CCITT-FALSE de "123456789" = 0x29B1 (valor de referência)
+    bool crc_ok = telem_crc16((const uint8_t *)"123456789", 9, 0xFFFF) == 0x29B1;
+
+    // Ida e volta: int16 com escala (erro <= meio passo do pico) e float16 (~1e-3 relativo)
+    uint8_t buf[1024];
+    float dec_spec[N], dec_samp[N];
+    bool round_ok = true;
+    for (int half = 0; half <= 1; half++) {
+        tf.flags = TELEM_FLAG_SPECTRUM | TELEM_FLAG_SAMPLES | (half ? TELEM_FLAG_HALF : 0);
+        size_t len = telem_encode(&tf, buf, sizeof(buf));
+        telem_frame_t out = {.spectrum = dec_spec, .samples = dec_samp};
+        int used = telem_decode(buf, len, &out, N);
+        float max_err = 0.0f;
+        for (size_t i = 0; i < N; i++) {
+            max_err = fmaxf(max_err, fabsf(dec_spec[i] - spectrum[i]) / 100.0f);
+            max_err = fmaxf(max_err, fabsf(dec_samp[i] - samples[i]));
+        }
+        bool ok = len == telem_frame_size(&tf) && used == (int)len && out.seq == tf.seq &&
+                  out.timestamp_us == tf.timestamp_us && out.fundamental == tf.fundamental &&
+                  fabsf(out.cents - tf.cents) < 0.01f && out.note == tf.note &&
+                  fabsf(out.confidence - tf.confidence) < 0.01f &&
+                  out.spectrum_len == N && out.samples_len == N && max_err < 1e-3f;
+        ESP_LOGI("TEST_ALL", "%s: %zu bytes, erro máx. %.2e -> %s", half ? "float16" : "int16", len, max_err, ok ? "ok" : "falhou");
+        round_ok = round_ok && ok;
+    }
+
+    // Um bit trocado no payload: o CRC rejeita
+    tf.flags = TELEM_FLAG_SPECTRUM;
+    size_t len = telem_encode(&tf, buf, sizeof(buf));
+    buf[len / 2] ^= 0x10;
+    telem_frame_t out = {.spectrum = dec_spec, .samples = dec_samp};
+    bool corrupt_ok = telem_decode(buf, len, &out, N) == -1;
+    buf[len / 2] ^= 0x10;
+
+    // Stream: texto, frame 1, frame 2 corrompido, texto com sync falso, frame 4, entregue de 5 em 5 bytes
+    static uint8_t stream[2048];
+    size_t pos = 0;
+    const char *noise1 = "I (123) MAIN: log no meio\n";
+    const char noise2[] = {'x', (char)TELEM_SYNC0, (char)TELEM_SYNC1, TELEM_VERSION, 'y', '\n'};
+    memcpy(stream + pos, noise1, strlen(noise1));
+    pos += strlen(noise1);
+    for (uint32_t seq = 1; seq <= 4; seq++) {
+        if (seq == 3) {
+            memcpy(stream + pos, noise2, sizeof(noise2));
+            pos += sizeof(noise2);
+            continue;   // Frame 3 perdido
+        }
+        tf.seq = seq;
+        size_t n = telem_encode(&tf, stream + pos, sizeof(stream) - pos);
+        if (seq == 2) {
+            stream[pos + n - 1] ^= 0xFF;
+        }
+        pos += n;
+    }
+
+    telem_decoder_t dec;
+    telem_capture_t cap = {0};
+    bool stream_ok = false;
+    if (telem_decoder_init(&dec, N) == ESP_OK) {
+        for (size_t i = 0; i < pos; i += 5) {
+            telem_decoder_push(&dec, stream + i, (pos - i < 5) ? pos - i : 5, telem_capture_cb, &cap);
+        }
+        ESP_LOGI("TEST_ALL", "Stream: %zu frames (último seq=%" PRIu32 ") | erros=%" PRIu32 " | pulados=%" PRIu32 " | perdidos=%" PRIu32,
+                 cap.frames, cap.last.seq, dec.stats.crc_errors, dec.stats.bytes_skipped, dec.stats.seq_gaps);
+        stream_ok = cap.frames == 2 && cap.last.seq == 4 && dec.stats.crc_errors >= 1 &&
+                    dec.stats.seq_gaps == 2 && fabsf(cap.spectrum[0] - spectrum[0]) < 0.1f;
+        telem_decoder_deinit(&dec);
+    }
+
+    ESP_LOGI("TEST_ALL", "CRC: %s | ida e volta: %s | corrupção: %s | stream: %s",
+             crc_ok ? "ok" : "falhou", round_ok ? "ok" : "falhou",
+             corrupt_ok ? "ok" : "falhou", stream_ok ? "ok" : "falhou");
+    if (crc_ok && round_ok && corrupt_ok && stream_ok) {
+        ESP_LOGI("TEST_ALL", "Telemetria consistente.");
+    } else {
+        ESP_LOGE("TEST_ALL", "Telemetria inconsistente.");
+    }
+
+    ESP_LOGI("TEST_ALL", "===== Teste da Telemetria Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Testa o HPS sobre as magnitudes da rfft: notas com harmônicos, fundamental ausente,
+ *        e o YIN limitado pela estimativa do HPS (mesmo pitch com menos lags).
+ */
+static void test_hps(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste do HPS =====");
+
+    const size_t n = BUFFER_SIZE;
+    const size_t bins = n / 2 + 1;
+    float *signal = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    float *windowed = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    float *breal = heap_caps_malloc(bins * sizeof(float), MALLOC_CAP_8BIT);
+    float *bimg = heap_caps_malloc(bins * sizeof(float), MALLOC_CAP_8BIT);
+    float *mag = heap_caps_malloc(bins * sizeof(float), MALLOC_CAP_8BIT);
+    hps_t hps;
+    Yin yin;
+    if (!signal || !windowed || !breal || !bimg || !mag ||
+        hps_init(&hps, n, SAMPLE_RATE, HPS_HARMONICS, LOW_FREQ, HIGH_FREQ) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha ao preparar o teste do HPS.");
+        goto cleanup;
+    }
+    if (yin_init(&yin, n, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha ao inicializar o YIN do teste do HPS.");
+        hps_deinit(&hps);
+        goto cleanup;
+    }
+
+    // {fundamental, primeiro harmônico}: 2 = fundamental ausente
+    const float notes[][2] = {{82.41f, 1}, {110.0f, 1}, {196.0f, 1}, {440.0f, 1}, {1046.5f, 1}, {110.0f, 2}};
+    const size_t num_notes = sizeof(notes) / sizeof(notes[0]);
+    bool hps_ok = true, range_ok = true;
+    for (size_t t = 0; t < num_notes; t++) {
+        float f0 = notes[t][0];
+        for (size_t i = 0; i < n; i++) {
+            float x = 0.0f;
+            for (int h = (int)notes[t][1]; h <= 6; h++) {
+                x += sinf(2.0f * M_PI * f0 * h * (float)i / SAMPLE_RATE + 0.3f * h) / (float)h;
+            }
+            signal[i] = 0.3f * x;
+            windowed[i] = signal[i] * 0.5f * (1.0f - cosf(2.0f * M_PI * (float)i / (float)(n - 1)));
+        }
+        rfft(windowed, breal, bimg, n);
+        calculate_magnitude_rfft(breal, bimg, mag, n);
+
+        float f_hps = -1.0f;
+        hps_detect(&hps, mag, &f_hps);
+        float cents = (f_hps > 0.0f) ? 1200.0f * log2f(f_hps / f0) : 9999.0f;
+        bool ok = fabsf(cents) < 5.0f;
+        hps_ok = hps_ok && ok;
+
+        // YIN completo x YIN até HPS_PRE_MARGIN períodos estimados (sinal sem janela)
+        float f_full = -1.0f, f_range = -1.0f;
+        yin_set_search_range(&yin, 0.0f, 0.0f);
+        yin_detect_pitch(&yin, signal, &f_full);
+        size_t taus_full = yin_taus_evaluated(&yin);
+        yin_set_search_range(&yin, (f_hps > 0.0f) ? f_hps / HPS_PRE_MARGIN : 0.0f, 0.0f);
+        yin_detect_pitch(&yin, signal, &f_range);
+        size_t taus_range = yin_taus_evaluated(&yin);
+        bool same = fabsf(f_full - f_range) < 0.01f * f0 && taus_range < taus_full;
+        range_ok = range_ok && same;
+
+        ESP_LOGI("TEST_ALL", "f0=%.2f Hz%s: HPS=%.2f Hz (%+.2f cents, confiança %.2f) | YIN %.2f/%.2f Hz, lags %zu/%zu -> %s",
+                 f0, notes[t][1] > 1 ? " (sem fundamental)" : "", f_hps, cents, hps_confidence(&hps),
+                 f_full, f_range, taus_full, taus_range, (ok && same) ? "ok" : "falhou");
+    }
+    yin_set_search_range(&yin, 0.0f, 0.0f);
+
+    if (hps_ok && range_ok) {
+        ESP_LOGI("TEST_ALL", "HPS dentro de 5 cents; YIN limitado igual ao completo.");
+    } else {
+        ESP_LOGE("TEST_ALL", "HPS fora da tolerância ou YIN limitado divergente.");
+    }
+    yin_deinit(&yin);
+    hps_deinit(&hps);
+
+cleanup:
+    if (signal) heap_caps_free(signal);
+    if (windowed) heap_caps_free(windowed);
+    if (breal) heap_caps_free(breal);
+    if (bimg) heap_caps_free(bimg);
+    if (mag) heap_caps_free(mag);
+    ESP_LOGI("TEST_ALL", "===== Teste do HPS Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Testa a interface de motores de pitch: YIN e MPM no mesmo scratch de autocorrelação,
+ *        troca em tempo de execução (aplicada na próxima janela) e faixa de busca pelo vtable.
+ */
+static void test_pitch_engine(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste dos Motores de Pitch =====");
+
+    const size_t n = BUFFER_SIZE;
+    float *signal = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    static pitch_engine_t pe;
+    pitch_engine_config_t cfg = PITCH_ENGINE_CONFIG_DEFAULT(n, SAMPLE_RATE);
+    cfg.yin_diff = YIN_DIFF_FFT;
+    if (!signal || pitch_engine_init(&pe, &cfg, PITCH_DETECTOR_YIN) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha ao preparar os motores de pitch.");
+        if (signal) heap_caps_free(signal);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    // Um só scratch: os dois motores apontam para o buffer do conjunto
+    bool shared_ok = pe.yin.config.fft_real == pe.scratch.real && pe.mpm.fft_real == pe.scratch.real &&
+                     pe.yin.config.fft_size == pe.scratch.fft_size && pe.mpm.fft_size == pe.scratch.fft_size;
+
+    const float test_freqs[] = {82.41f, 196.0f, 440.0f, 1046.5f};
+    const size_t num_freqs = sizeof(test_freqs) / sizeof(test_freqs[0]);
+    bool accuracy_ok = true, switch_ok = true;
+    for (size_t t = 0; t < num_freqs; t++) {
+        float f0 = test_freqs[t];
+        for (size_t i = 0; i < n; i++) {
+            float x = 0.0f;
+            for (int h = 1; h <= 5; h++) {
+                x += sinf(2.0f * M_PI * f0 * h * (float)i / SAMPLE_RATE + 0.7f * h) / (float)h;
+            }
+            signal[i] = 0.3f * x;
+        }
+
+        float f_engine[PITCH_DETECTOR_COUNT], conf[PITCH_DETECTOR_COUNT];
+        for (int id = 0; id < PITCH_DETECTOR_COUNT; id++) {
+            pitch_engine_select(&pe, (pitch_detector_t)id);
+            // A troca só vale na próxima janela
+            switch_ok = switch_ok && (t == 0 && id == 0 ? true : pitch_engine_active(&pe) != (pitch_detector_t)id);
+            if (pitch_engine_process(&pe, signal, &f_engine[id]) != 0) {
+                f_engine[id] = -1.0f;
+            }
+            switch_ok = switch_ok && pitch_engine_active(&pe) == (pitch_detector_t)id;
+            conf[id] = pitch_engine_confidence(&pe);
+            float cents = (f_engine[id] > 0.0f) ? 1200.0f * log2f(f_engine[id] / f0) : 9999.0f;
+            accuracy_ok = accuracy_ok && fabsf(cents) < 10.0f && conf[id] > 0.8f;
+        }
+        ESP_LOGI("TEST_ALL", "f0=%.2f Hz: yin=%.2f Hz (conf %.2f) | mpm=%.2f Hz (conf %.2f)",
+                 f0, f_engine[PITCH_DETECTOR_YIN], conf[PITCH_DETECTOR_YIN],
+                 f_engine[PITCH_DETECTOR_MPM], conf[PITCH_DETECTOR_MPM]);
+    }
+
+    // Faixa de busca pelo vtable (MPM ativo): fora da faixa a fundamental não pode ser devolvida
+    float f_in = -1.0f, f_out = -1.0f;
+    pitch_engine_set_search_range(&pe, 300.0f, 600.0f);
+    pitch_engine_process(&pe, signal, &f_in);       // Último sinal: 1046,5 Hz, fora de [300, 600]
+    pitch_engine_reset(&pe);
+    pitch_engine_process(&pe, signal, &f_out);
+    bool range_ok = fabsf(f_in - 1046.5f) > 50.0f && fabsf(f_out - 1046.5f) < 5.0f;
+    ESP_LOGI("TEST_ALL", "Faixa [300, 600] Hz: %.2f Hz | após reset: %.2f Hz | trocas: %" PRIu32,
+             f_in, f_out, pe.switches);
+
+    ESP_LOGI("TEST_ALL", "Scratch: %s | exatidão: %s | troca: %s | faixa: %s",
+             shared_ok ? "ok" : "falhou", accuracy_ok ? "ok" : "falhou",
+             switch_ok ? "ok" : "falhou", range_ok ? "ok" : "falhou");
+    if (shared_ok && accuracy_ok && switch_ok && range_ok) {
+        ESP_LOGI("TEST_ALL", "Motores de pitch consistentes.");
+    } else {
+        ESP_LOGE("TEST_ALL", "Motores de pitch inconsistentes.");
+    }
+
+    pitch_engine_deinit(&pe);
+    heap_caps_free(signal);
+    ESP_LOGI("TEST_ALL", "===== Teste dos Motores de Pitch Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Preenche frames int32 do I2S com um seno de amplitude amp mais um DC.
+ */
+static void gate_test_block(int32_t *raw, size_t n, float amp, float dc) {
+    for (size_t i = 0; i < n; i++) {
+        float x = dc + amp * sinf(2.0f * (float)M_PI * 440.0f * (float)i / SAMPLE_RATE);
+        raw[i] = (int32_t)(x * 8388607.0f) * 256; // 24 bits alinhados à esquerda
+    }
+}
+
+/**
+ * @brief Testa o gate de energia: nível medido na conversão (float e Q31, sem o DC),
+ *        histerese em nível e no tempo, abertura por pico e razão de janelas puladas.
+ */
+static void test_energy_gate(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste do Gate de Energia =====");
+
+    const size_t n = 2048;
+    const float dc = 0.01f;                      // Offset típico do MEMS (-40 dBFS), fora do RMS
+    int32_t *raw = heap_caps_malloc(n * sizeof(int32_t), MALLOC_CAP_8BIT);
+    float *out = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    q31_t *out_q31 = heap_caps_malloc(n * sizeof(q31_t), MALLOC_CAP_8BIT);
+    if (!raw || !out || !out_q31) {
+        ESP_LOGE("TEST_ALL", "Falha ao alocar buffers do gate.");
+        if (raw) heap_caps_free(raw);
+        if (out) heap_caps_free(out);
+        if (out_q31) heap_caps_free(out_q31);
+        vTaskDelete(NULL);
+        return;
+    }
+    size_t errors = 0;
+
+    // Nível: seno de -20 dBFS RMS (amplitude 0,1 * sqrt(2)) medido nas duas conversões, em duas partes
+    gate_test_block(raw, n, 0.1f * sqrtf(2.0f), dc);
+    audio_level_t lf, lq;
+    audio_level_reset(&lf);
+    audio_level_reset(&lq);
+    window_and_convert(raw, window_get(WINDOW_HANN, n), out, n / 2, &lf);
+    window_and_convert(raw + n / 2, window_get(WINDOW_HANN, n) + n / 2, out + n / 2, n / 2, &lf);
+    fx_i2s_to_q31(raw, out_q31, n, &lq);
+    float rms_f = audio_level_rms_dbfs(&lf), rms_q = audio_level_rms_dbfs(&lq);
+    ESP_LOGI("TEST_ALL", "Nível: float %.2f dBFS | Q31 %.2f dBFS | pico %.2f dBFS (esperado -20 / -20 / %.2f)",
+             rms_f, rms_q, audio_level_peak_dbfs(&lf), 20.0f * log10f(0.1f * sqrtf(2.0f) + dc));
+    errors += fabsf(rms_f + 20.0f) > 0.2f || fabsf(rms_q + 20.0f) > 0.2f;
+    errors += lf.count != n || lq.count != n;
+
+    // Sequência de níveis (RMS em dBFS): abre, fica aberto entre close e open, fecha só após o hold
+    energy_gate_t gate;
+    if (energy_gate_init(&gate, -60.0f, -66.0f, -30.0f, 2) != ESP_OK) {
+        errors++;
+    }
+    const struct { float rms_db; bool open; } seq[] = {
+        {-90.0f, false}, {-90.0f, false}, {-63.0f, false},   // Abaixo de open: segue fechado
+        {-40.0f, true},  {-63.0f, true},  {-63.0f, true},    // Entre close e open: segue aberto
+        {-80.0f, true},  {-80.0f, true},  {-80.0f, false},   // Fecha na terceira abaixo de close (hold 2)
+        {-63.0f, false}, {-59.0f, true},
+    };
+    const size_t num_seq = sizeof(seq) / sizeof(seq[0]);
+    size_t expected_skipped = 0;
+    for (size_t k = 0; k < num_seq; k++) {
+        gate_test_block(raw, n, powf(10.0f, seq[k].rms_db / 20.0f) * sqrtf(2.0f), dc);
+        audio_level_t level;
+        audio_level_reset(&level);
+        window_and_convert(raw, NULL, out, n, &level);
+        bool open = energy_gate_process(&gate, &level);
+        expected_skipped += !seq[k].open;
+        if (open != seq[k].open) {
+            ESP_LOGW("TEST_ALL", "Passo %zu (%.0f dBFS): gate %s, esperado %s.", k, seq[k].rms_db,
+                     open ? "aberto" : "fechado", seq[k].open ? "aberto" : "fechado");
+            errors++;
+        }
+    }
+
+    // Ataque curto: um clique de ~-27 dBFS de pico em silêncio abre pelo pico, com RMS < -60 dBFS
+    for (int k = 0; k < 4; k++) {
+        gate_test_block(raw, n, 1e-4f, dc);
+        audio_level_t level;
+        audio_level_reset(&level);
+        window_and_convert(raw, NULL, out, n, &level);
+        energy_gate_process(&gate, &level);
+    }
+    bool closed_before = !gate.open;
+    gate_test_block(raw, n, 1e-4f, dc);
+    raw[n / 2] = (int32_t)((dc + 0.035f) * 8388607.0f) * 256;
+    audio_level_t click;
+    audio_level_reset(&click);
+    window_and_convert(raw, NULL, out, n, &click);
+    bool click_ok = closed_before && audio_level_rms_dbfs(&click) < -60.0f && energy_gate_process(&gate, &click);
+    errors += !click_ok;
+    expected_skipped += 4 - 2; // As duas primeiras janelas de silêncio ainda estão no hold
+
+    energy_gate_stats_t stats;
+    energy_gate_get_stats(&gate, &stats);
+    ESP_LOGI("TEST_ALL", "Clique: %s | janelas %" PRIu32 ", puladas %" PRIu32 " (%.1f%%), aberturas %" PRIu32,
+             click_ok ? "ok" : "falhou", stats.frames, stats.skipped, 100.0f * stats.skip_ratio, stats.opens);
+    errors += stats.frames != num_seq + 5 || stats.skipped != expected_skipped || stats.opens != 3;
+    energy_gate_reset_stats(&gate);
+    energy_gate_get_stats(&gate, &stats);
+    errors += stats.frames != 0 || !gate.open;
+
+    if (errors == 0) {
+        ESP_LOGI("TEST_ALL", "Gate de energia consistente.");
+    } else {
+        ESP_LOGE("TEST_ALL", "Gate de energia inconsistente (%zu erros).", errors);
+    }
+
+    heap_caps_free(raw);
+    heap_caps_free(out);
+    heap_caps_free(out_q31);
+    ESP_LOGI("TEST_ALL", "===== Teste do Gate de Energia Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Janela Hann de uma nota com harmônicos 1/h (até 6, abaixo de Nyquist) na taxa do afinador.
+ */
+static void tuner_test_note(float *x, size_t n, float fs, float midi) {
+    const float *hann = window_get(WINDOW_HANN, n);
+    float f0 = A4_FREQUENCY * powf(2.0f, (midi - 69.0f) / 12.0f);
+    for (size_t i = 0; i < n; i++) {
+        float t = (float)i / fs, v = 0.0f;
+        for (int h = 1; h <= 6 && (float)h * f0 < 0.5f * fs; h++) {
+            v += sinf(2.0f * (float)M_PI * (float)h * f0 * t + (float)h) / (float)h;
+        }
+        x[i] = 0.3f * v * hann[i];
+    }
+}
+
+/**
+ * @brief Testa o banco de Goertzel do afinador: corda e cents de cada corda da guitarra
+ *        desafinada, notas fora das cordas, ruído, silêncio e parâmetros inválidos.
+ */
+static void test_tuner_bank(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste do Banco do Afinador =====");
+
+    const size_t n = YIN_BUFFER_SIZE;
+    const float fs = YIN_SAMPLE_RATE;
+    float *x = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    const tuner_instrument_t *guitar = tuner_instrument_find("guitar");
+    tuner_bank_t bank;
+    if (!x || !guitar || tuner_bank_init(&bank, guitar, n, fs, TUNER_HARMONICS, TUNER_RANGE_CENTS) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha ao preparar o afinador.");
+        if (x) heap_caps_free(x);
+        vTaskDelete(NULL);
+        return;
+    }
+    size_t errors = 0;
+
+    // Cada corda desafinada: corda certa e cents dentro de 1
+    const float detune[] = {-45.0f, -12.0f, 0.0f, 7.0f, 30.0f};
+    size_t filters = 0, runs = 0;
+    for (size_t s = 0; s < guitar->count; s++) {
+        float worst = 0.0f;
+        for (size_t d = 0; d < sizeof(detune) / sizeof(detune[0]); d++) {
+            tuner_test_note(x, n, fs, (float)guitar->midi[s] + detune[d] / 100.0f);
+            float f = -1.0f;
+            note_t note;
+            int ret = tuner_bank_process(&bank, x, &f, &note);
+            float err = (ret == 0) ? fabsf(note.cents - detune[d]) : INFINITY;
+            filters += tuner_bank_filters_evaluated(&bank);
+            runs++;
+            if (ret != 0 || note.midi != guitar->midi[s] || err > 1.0f) {
+                ESP_LOGW("TEST_ALL", "Corda %zu (%+.0f cents): %s%d, %.2f cents (ret %d).", s, detune[d],
+                         ret ? "-" : note.note, ret ? 0 : note.octave, ret ? 0.0f : note.cents, ret);
+                errors++;
+            } else if (err > worst) {
+                worst = err;
+            }
+        }
+        ESP_LOGI("TEST_ALL", "Corda %zu (MIDI %d): pior erro %.2f cents, confiança %.2f", s, guitar->midi[s],
+                 worst, tuner_bank_confidence(&bank));
+    }
+    ESP_LOGI("TEST_ALL", "Média de %.1f filtros de Goertzel por janela.", (float)filters / (float)runs);
+
+    // Notas longe das cordas (C3, G#5, B1), ruído e silêncio: sem corda
+    const float outside[] = {48.0f, 80.0f, 35.0f};
+    for (size_t k = 0; k < sizeof(outside) / sizeof(outside[0]); k++) {
+        tuner_test_note(x, n, fs, outside[k]);
+        float f;
+        note_t note;
+        if (tuner_bank_process(&bank, x, &f, &note) != -1 || f != -1.0f || bank.string != -1) {
+            ESP_LOGW("TEST_ALL", "MIDI %.0f fora das cordas aceito (%.2f Hz).", outside[k], f);
+            errors++;
+        }
+    }
+    const float *hann = window_get(WINDOW_HANN, n);
+    uint32_t seed = 1u;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        x[i] = 0.3f * (2.0f * (float)(seed >> 8) / 16777216.0f - 1.0f) * hann[i];
+    }
+    float f;
+    note_t note;
+    errors += tuner_bank_process(&bank, x, &f, &note) != -1;
+    memset(x, 0, n * sizeof(float));
+    errors += tuner_bank_process(&bank, x, &f, &note) != -1 || tuner_bank_confidence(&bank) != 0.0f;
+
+    // Afinações e parâmetros inválidos
+    errors += tuner_instrument_find("bass") == NULL || tuner_instrument_find("theremin") != NULL;
+    tuner_bank_t bad;
+    errors += tuner_bank_init(&bad, NULL, n, fs, TUNER_HARMONICS, TUNER_RANGE_CENTS) == ESP_OK;
+    errors += tuner_bank_init(&bad, guitar, n, fs, 0, TUNER_RANGE_CENTS) == ESP_OK;
+    errors += tuner_bank_init(&bad, guitar, n, fs, TUNER_MAX_HARMONICS + 1, TUNER_RANGE_CENTS) == ESP_OK;
+    errors += tuner_bank_init(&bad, guitar, 64, fs, TUNER_HARMONICS, TUNER_RANGE_CENTS) == ESP_OK; // bin > E2
+    errors += tuner_bank_process(NULL, x, &f, &note) != -1;
+
+    if (errors == 0) {
+        ESP_LOGI("TEST_ALL", "Banco do afinador consistente.");
+    } else {
+        ESP_LOGE("TEST_ALL", "Banco do afinador inconsistente (%zu erros).", errors);
+    }
+
+    heap_caps_free(x);
+    ESP_LOGI("TEST_ALL", "===== Teste do Banco do Afinador Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Compara o caminho em ponto fixo (Q31/Q15) com o caminho em float:
+ *        SNR após janela + band-pass, SNR do espectro e erro do pitch YIN.
+ */
+static void test_fixed_point(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste do Caminho em Ponto Fixo =====");
+
+    const size_t n = BUFFER_SIZE;
+    const size_t fft_n = FBUF_SIZE;
+    const float test_freqs[] = {110.0f, 220.0f, 440.0f, 880.0f, 1760.0f};
+    const size_t num_freqs = sizeof(test_freqs) / sizeof(test_freqs[0]);
+    const float amplitude = 0.05f; // ~ -26 dBFS: exercita a normalização do bloco
+
+    float *ref    = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_8BIT);
+    float *breal  = heap_caps_malloc((fft_n / 2 + 1) * sizeof(float), MALLOC_CAP_8BIT);
+    float *bimg   = heap_caps_malloc((fft_n / 2 + 1) * sizeof(float), MALLOC_CAP_8BIT);
+    float *mag_f  = heap_caps_malloc((fft_n / 2 + 1) * sizeof(float), MALLOC_CAP_8BIT);
+    float *mag_q  = heap_caps_malloc((fft_n / 2 + 1) * sizeof(float), MALLOC_CAP_8BIT);
+    q31_t *buf_q31 = heap_caps_malloc(n * sizeof(q31_t), MALLOC_CAP_8BIT);
+    q15_t *buf_q15 = heap_caps_malloc(n * sizeof(q15_t), MALLOC_CAP_8BIT);
+    q15_t *spec    = heap_caps_malloc(2 * fft_n * sizeof(q15_t), MALLOC_CAP_8BIT);
+    fx_window_t window;
+    fx_fft_t fft_q;
+    Yin yin_f, yin_q;
+    if (!ref || !breal || !bimg || !mag_f || !mag_q || !buf_q31 || !buf_q15 || !spec ||
+        fx_window_init(&window, n, 1) != ESP_OK || fx_fft_init(&fft_q, fft_n) != ESP_OK ||
+        yin_init(&yin_f, n, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) != ESP_OK ||
+        yin_init(&yin_q, n, SAMPLE_RATE, YIN_THRESHOLD, YIN_THRESHOLD_FIXED, 0.02f, 0.1f, 0.01f, YIN_DIFF_DIRECT) != ESP_OK) {
+        ESP_LOGE("TEST_ALL", "Falha ao alocar buffers do teste de ponto fixo.");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    float worst_time_snr = INFINITY, worst_spec_snr = INFINITY, worst_pitch_err = 0.0f;
+    int64_t us_float = 0, us_fixed = 0;
+
+    for (size_t f = 0; f < num_freqs; f++) {
+        // Sinal: fundamental + 2º harmônico, quantizado em 24 bits como no INMP441
+        for (size_t i = 0; i < n; i++) {
+            float t = (float)i / SAMPLE_RATE;
+            ref[i] = amplitude * (sinf(2.0f * (float)M_PI * test_freqs[f] * t) +
+                                  0.5f * sinf(4.0f * (float)M_PI * test_freqs[f] * t));
+            buf_q31[i] = fx_float_to_q31(ref[i]);
+        }
+        fx_i2s_to_q31(buf_q31, buf_q31, n, NULL);
+
+        biquad_t bp;
+        bandpass_init(&bp, SAMPLE_RATE, LOW_FREQ, HIGH_FREQ);
+        biquad_q31_t bp_q;
+        biquad_q31_from_float(&bp_q, &bp);
+
+        // Caminho float
+        int64_t t0 = esp_timer_get_time();
+        apply_window(ref, n, 1);
+        biquad_process(&bp, ref, ref, n);
+        rfft(ref, breal, bimg, fft_n);
+        calculate_magnitude_rfft(breal, bimg, mag_f, fft_n);
+        float pitch_f = -1.0f;
+        yin_detect_pitch(&yin_f, ref, &pitch_f);
+        us_float += esp_timer_get_time() - t0;
+
+        // Caminho em ponto fixo
+        t0 = esp_timer_get_time();
+        fx_window_apply_q31(&window, buf_q31);
+        biquad_q31_process(&bp_q, buf_q31, buf_q31, n);
+        int exponent = fx_q31_to_q15_block(buf_q31, buf_q15, n);
+        for (size_t i = 0; i < fft_n; i++) {
+            spec[2 * i] = buf_q15[i];
+            spec[2 * i + 1] = 0;
+        }
+        fx_fft_q15(&fft_q, spec, &exponent);
+        fx_magnitude_q15(spec, exponent, mag_q, fft_n);
+        float pitch_q = -1.0f;
+        yin_detect_pitch_q15(&yin_q, buf_q15, &pitch_q);
+        us_fixed += esp_timer_get_time() - t0;
+
+        // SNR no tempo (Q31 após janela + filtro) e no espectro
+        double sig = 0.0, err = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            double d = (double)fx_q31_to_float(buf_q31[i]) - ref[i];
+            sig += (double)ref[i] * ref[i];
+            err += d * d;
+        }
+        float time_snr = (float)(10.0 * log10(sig / (err + 1e-30)));
+        sig = err = 0.0;
+        for (size_t k = 0; k <= fft_n / 2; k++) {
+            double d = (double)mag_q[k] - mag_f[k];
+            sig += (double)mag_f[k] * mag_f[k];
+            err += d * d;
+        }
+        float spec_snr = (float)(10.0 * log10(sig / (err + 1e-30)));
+        float pitch_err = fabsf(pitch_q - pitch_f);
+
+        ESP_LOGI("TEST_ALL", "f=%7.1f Hz | SNR tempo %.1f dB | SNR espectro %.1f dB | YIN float %.2f Hz, Q15 %.2f Hz",
+                 test_freqs[f], time_snr, spec_snr, pitch_f, pitch_q);
+
+        if (time_snr < worst_time_snr) worst_time_snr = time_snr;
+        if (spec_snr < worst_spec_snr) worst_spec_snr = spec_snr;
+        if (pitch_err > worst_pitch_err) worst_pitch_err = pitch_err;
+    }
+
+    ESP_LOGI("TEST_ALL", "Pior caso: SNR tempo %.1f dB, SNR espectro %.1f dB, erro de pitch %.3f Hz",
+             worst_time_snr, worst_spec_snr, worst_pitch_err);
+    ESP_LOGI("TEST_ALL", "Tempo total: float %lld us, ponto fixo %lld us",
+             (long long)us_float, (long long)us_fixed);
+    if (worst_time_snr > 60.0f && worst_spec_snr > 40.0f && worst_pitch_err < 0.5f) {
+        ESP_LOGI("TEST_ALL", "Caminho em ponto fixo equivalente ao float.");
+    } else {
+        ESP_LOGE("TEST_ALL", "Caminho em ponto fixo diverge do float.");
+    }
+
+    yin_deinit(&yin_f);
+    yin_deinit(&yin_q);
+    fx_fft_deinit(&fft_q);
+    fx_window_deinit(&window);
+    heap_caps_free(ref);
+    heap_caps_free(breal);
+    heap_caps_free(bimg);
+    heap_caps_free(mag_f);
+    heap_caps_free(mag_q);
+    heap_caps_free(buf_q31);
+    heap_caps_free(buf_q15);
+    heap_caps_free(spec);
+
+    ESP_LOGI("TEST_ALL", "===== Teste do Caminho em Ponto Fixo Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Testa a função get_note.
+ */
+static void test_get_note(void *pv) {
+    ESP_LOGI("TEST_ALL", "===== Teste da Função get_note =====");
+    
+    // Lista de frequências para testar
+    float test_frequencies[] = {440.0f, 261.63f, 329.63f, 0.0f, 5000.0f};
+    size_t num_tests = sizeof(test_frequencies) / sizeof(test_frequencies[0]);
+
+    for (size_t i = 0; i < num_tests; i++) {
+        float freq = test_frequencies[i];
+        note_t note;
+        uint32_t start_time = esp_timer_get_time();
+        int ret = get_note(freq, &note);
+        uint32_t end_time = esp_timer_get_time();
+
+        if (ret == 0) {
+            ESP_LOGI("TEST_ALL", "Frequência: %.2f Hz -> Nota: %s%d (%.2f Hz)", freq, note.note, note.octave, note.frequency);
+        } else {
+            ESP_LOGW("TEST_ALL", "Frequência: %.2f Hz -> Nota não detectada.", freq);
+        }
+        ESP_LOGI("TEST_ALL", "Tempo de execução do get_note: %" PRIu32 " us\n", end_time-start_time);
+    }
+
+
+    ESP_LOGI("TEST_ALL", "===== Teste da Função get_note Concluído =====\n");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Executa todos os testes consolidando os testes de funções vetoriais, FFT, filtros, YIN, YIN streaming e get_note.
+ */
+void run_all_tests(void) {
+    ESP_LOGI("TEST_ALL", "===== Iniciando Testes Consolidados =====\n");
+    xTaskCreate(test_vector_functions, "vetores", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_fft_manual, "fft", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_fft_plan, "fft_plan", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_rfft, "rfft", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_fft_radix4, "fft_radix4", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_window, "janelas", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_filter, "filtro", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_sos, "sos", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_yin, "yin", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_yin_stream, "yin_stream", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_yin_backends, "yin_backends", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_decimator, "decimador", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_yin_hierarchical, "yin_hierarquico", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_yin_early_exit, "yin_antecipado", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_yin_tracking, "yin_rastreamento", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_yin_parallel, "yin_paralelo", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_fixed_point, "fixed_point", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_get_note, "note", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_block_pool, "pool", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_audio_ring, "ring", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_stage_graph, "grafo", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_trace, "trace", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_telemetry, "telemetria", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_hps, "hps", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_pitch_engine, "motores", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_energy_gate, "gate", 16384, NULL, 0, NULL);
+    wait_for_enter();
+    xTaskCreate(test_tuner_bank, "afinador", 16384, NULL, 0, NULL);
     wait_for_enter();
     ESP_LOGI("TEST_ALL", "===== Testes Consolidados Finalizados =====\n");
 }
@@ -0,0 +1,310 @@
+// src/trace.c
+#include "trace.h"
+#include "def.h"
+#include "esp_log.h"
+#include <stdatomic.h>
+
+static const char *TAG_TRACE = "TRACE";
+
+/**
+ * @brief Slot do ring. seq = índice + 1 quando o evento está completo, 0 durante a escrita
+ *        (o leitor confere seq antes e depois da cópia, como num seqlock).
+ */
+typedef struct {
+    _Atomic uint32_t seq;
+    _Atomic uint32_t start_us;
+    _Atomic uint32_t dur_us;
+    _Atomic uint32_t frame;
+    _Atomic uint32_t stage;
+} trace_slot_t;
+
+static trace_slot_t *s_slots = NULL;
+static size_t s_capacity = 0;
+static _Atomic uint32_t s_head = 0;       // Total de eventos reservados (monotônico)
+static _Atomic bool s_enabled = false;
+
+static const char *const s_stage_names[TRACE_STAGE_COUNT] = {
+    [TRACE_STAGE_CAPTURE]   = "capture",
+    [TRACE_STAGE_CONVERT]   = "convert",
+    [TRACE_STAGE_WINDOW]    = "window",
+    [TRACE_STAGE_BANDPASS]  = "bandpass",
+    [TRACE_STAGE_FFT]       = "fft",
+    [TRACE_STAGE_MAGNITUDE] = "magnitude",
+    [TRACE_STAGE_DECIMATE]  = "decimate",
+    [TRACE_STAGE_YIN]       = "yin",
+    [TRACE_STAGE_HPS]       = "hps",
+    [TRACE_STAGE_TUNER]     = "tuner",
+    [TRACE_STAGE_NOTE]      = "note",
+    [TRACE_STAGE_EMIT]      = "emit",
+};
+
+/**
+ * @brief Aloca o ring de eventos (realoca se já inicializado).
+ *        Chamar antes de criar as tasks instrumentadas.
+ *
+ * @param capacity Número de eventos (potência de 2).
+ * @return esp_err_t ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t trace_init(size_t capacity) {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        ESP_LOGE(TAG_TRACE, "Capacidade inválida para o trace: %zu.", capacity);
+        return ESP_ERR_INVALID_ARG;
+    }
+    trace_deinit();
+
+    // RAM interna: a escrita fica no caminho crítico de todas as tasks
+    s_slots = (trace_slot_t *)heap_caps_calloc(capacity, sizeof(trace_slot_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!s_slots) {
+        s_slots = (trace_slot_t *)heap_caps_calloc(capacity, sizeof(trace_slot_t), MALLOC_CAP_8BIT);
+    }
+    if (!s_slots) {
+        ESP_LOGE(TAG_TRACE, "Falha ao alocar ring de trace (%zu eventos).", capacity);
+        return ESP_ERR_NO_MEM;
+    }
+    s_capacity = capacity;
+    atomic_store(&s_head, 0);
+    atomic_store(&s_enabled, true);
+    ESP_LOGI(TAG_TRACE, "Trace com %zu eventos (%zu bytes).", capacity, capacity * sizeof(trace_slot_t));
+    return ESP_OK;
+}
+
+/**
+ * @brief Habilita/desabilita a gravação (desabilitado, trace_end só retorna).
+ */
+void trace_set_enabled(bool enabled) {
+    atomic_store(&s_enabled, enabled);
+}
+
+/**
+ * @brief Grava um evento [start_us, agora) no ring. Lock-free, seguro entre núcleos.
+ *
+ * @param stage    Estágio.
+ * @param frame    Identificador do bloco/janela.
+ * @param start_us Valor retornado por trace_begin.
+ */
+void trace_end(trace_stage_t stage, uint32_t frame, uint32_t start_us) {
+    if (!s_slots || !atomic_load_explicit(&s_enabled, memory_order_relaxed)) {
+        return;
+    }
+    uint32_t now = trace_begin();
+
+    uint32_t idx = atomic_fetch_add_explicit(&s_head, 1, memory_order_relaxed);
+    trace_slot_t *slot = &s_slots[idx & (s_capacity - 1)];
+
+    atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&slot->start_us, start_us, memory_order_relaxed);
+    atomic_store_explicit(&slot->dur_us, now - start_us, memory_order_relaxed);
+    atomic_store_explicit(&slot->frame, frame, memory_order_relaxed);
+    atomic_store_explicit(&slot->stage, (uint32_t)stage, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, idx + 1, memory_order_release);
+}
+
+/**
+ * @brief Copia os eventos válidos mais recentes, do mais antigo ao mais novo.
+ *
+ * @param out     Vetor de saída.
+ * @param max_out Capacidade de out.
+ * @return size_t Número de eventos copiados.
+ */
+size_t trace_snapshot(trace_event_t *out, size_t max_out) {
+    if (!s_slots || !out) {
+        return 0;
+    }
+
+    uint32_t head = atomic_load_explicit(&s_head, memory_order_acquire);
+    uint32_t span = head < s_capacity ? head : (uint32_t)s_capacity;
+    if (span > max_out) {
+        span = (uint32_t)max_out;
+    }
+
+    size_t count = 0;
+    for (uint32_t idx = head - span; idx != head; idx++) {
+        trace_slot_t *slot = &s_slots[idx & (s_capacity - 1)];
+        uint32_t seq1 = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        trace_event_t ev = {
+            .start_us = atomic_load_explicit(&slot->start_us, memory_order_relaxed),
+            .dur_us   = atomic_load_explicit(&slot->dur_us, memory_order_relaxed),
+            .frame    = atomic_load_explicit(&slot->frame, memory_order_relaxed),
+            .stage    = (uint8_t)atomic_load_explicit(&slot->stage, memory_order_relaxed),
+        };
+        atomic_thread_fence(memory_order_acquire);
+        uint32_t seq2 = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+
+        // Descarta slots em escrita ou já sobrescritos por uma volta mais nova
+        if (seq1 == idx + 1 && seq2 == seq1 && ev.stage < TRACE_STAGE_COUNT) {
+            out[count++] = ev;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Descarta os eventos gravados.
+ */
+void trace_reset(void) {
+    if (!s_slots) {
+        return;
+    }
+    for (size_t i = 0; i < s_capacity; i++) {
+        atomic_store_explicit(&s_slots[i].seq, 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&s_head, 0, memory_order_release);
+}
+
+/**
+ * @brief Nome do estágio (ex.: "fft").
+ */
+const char *trace_stage_name(trace_stage_t stage) {
+    return (stage < TRACE_STAGE_COUNT) ? s_stage_names[stage] : "?";
+}
+
+/**
+ * @brief Estágio do grafo (tid do Chrome trace) que executa cada evento.
+ */
+static int stage_tid(uint8_t stage) {
+    switch (stage) {
+        case TRACE_STAGE_CAPTURE:   return 1; // capture
+        case TRACE_STAGE_FFT:
+        case TRACE_STAGE_MAGNITUDE: return 3; // spectrum
+        case TRACE_STAGE_DECIMATE:
+        case TRACE_STAGE_YIN:
+        case TRACE_STAGE_HPS:
+        case TRACE_STAGE_TUNER:     return 4; // pitch
+        case TRACE_STAGE_NOTE:      return 5; // note
+        case TRACE_STAGE_EMIT:      return 6; // emit
+        default:                    return 2; // condition
+    }
+}
+
+/**
+ * @brief Snapshot em buffer temporário para os exportadores.
+ */
+static trace_event_t *snapshot_alloc(size_t *count) {
+    *count = 0;
+    if (!s_slots) {
+        ESP_LOGW(TAG_TRACE, "Trace não inicializado.");
+        return NULL;
+    }
+    trace_event_t *events = (trace_event_t *)heap_caps_malloc(s_capacity * sizeof(trace_event_t), MALLOC_CAP_8BIT);
+    if (!events) {
+        ESP_LOGE(TAG_TRACE, "Falha ao alocar snapshot do trace.");
+        return NULL;
+    }
+    *count = trace_snapshot(events, s_capacity);
+    return events;
+}
+
+/**
+ * @brief Exporta no formato Chrome trace-event (abrir em chrome://tracing ou Perfetto).
+ *
+ * @param out Destino (ex.: stdout).
+ * @return size_t Número de eventos exportados.
+ */
+size_t trace_export_chrome(FILE *out) {
+    size_t count;
+    trace_event_t *events = snapshot_alloc(&count);
+    if (!events) {
+        return 0;
+    }
+
+    uint32_t base = count ? events[0].start_us : 0;
+    fprintf(out, "{\"traceEvents\":[\n");
+    static const char *const tid_names[] = {"capture", "condition", "spectrum", "pitch", "note", "emit"};
+    for (size_t t = 0; t < sizeof(tid_names) / sizeof(tid_names[0]); t++) {
+        fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"%s\"}}",
+                t ? ",\n" : "", t + 1, tid_names[t]);
+    }
+    for (size_t i = 0; i < count; i++) {
+        const trace_event_t *e = &events[i];
+        fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"audio\",\"ph\":\"X\",\"ts\":%" PRIu32 ",\"dur\":%" PRIu32
+                     ",\"pid\":1,\"tid\":%d,\"args\":{\"frame\":%" PRIu32 "}}",
+                trace_stage_name((trace_stage_t)e->stage), (uint32_t)(e->start_us - base), e->dur_us,
+                stage_tid(e->stage), e->frame);
+    }
+    fprintf(out, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    heap_caps_free(events);
+    return count;
+}
+
+/**
+ * @brief Exporta em CSV: stage;frame;start_us;dur_us.
+ *
+ * @param out Destino (ex.: stdout).
+ * @return size_t Número de eventos exportados.
+ */
+size_t trace_export_csv(FILE *out) {
+    size_t count;
+    trace_event_t *events = snapshot_alloc(&count);
+    if (!events) {
+        return 0;
+    }
+
+    fprintf(out, "stage;frame;start_us;dur_us\n");
+    for (size_t i = 0; i < count; i++) {
+        const trace_event_t *e = &events[i];
+        fprintf(out, "%s;%" PRIu32 ";%" PRIu32 ";%" PRIu32 "\n",
+                trace_stage_name((trace_stage_t)e->stage), e->frame, e->start_us, e->dur_us);
+    }
+
+    heap_caps_free(events);
+    return count;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Imprime por estágio: contagem, média, p95 e máximo das durações no ring.
+ *
+ * @param out Destino (ex.: stdout).
+ */
+void trace_print_summary(FILE *out) {
+    size_t count;
+    trace_event_t *events = snapshot_alloc(&count);
+    if (!events) {
+        return;
+    }
+    uint32_t *durs = (uint32_t *)heap_caps_malloc((count ? count : 1) * sizeof(uint32_t), MALLOC_CAP_8BIT);
+    if (!durs) {
+        heap_caps_free(events);
+        return;
+    }
+
+    fprintf(out, "stage      count   mean_us    p95_us    max_us\n");
+    for (int s = 0; s < TRACE_STAGE_COUNT; s++) {
+        size_t n = 0;
+        uint64_t total = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (events[i].stage == s) {
+                durs[n++] = events[i].dur_us;
+                total += events[i].dur_us;
+            }
+        }
+        if (n == 0) {
+            continue;
+        }
+        qsort(durs, n, sizeof(uint32_t), cmp_u32);
+        fprintf(out, "%-9s %6zu %9.1f %9" PRIu32 " %9" PRIu32 "\n",
+                trace_stage_name((trace_stage_t)s), n, (double)total / (double)n,
+                durs[(n * 95) / 100 < n ? (n * 95) / 100 : n - 1], durs[n - 1]);
+    }
+
+    heap_caps_free(durs);
+    heap_caps_free(events);
+}
+
+/**
+ * @brief Libera o ring de eventos.
+ */
+void trace_deinit(void) {
+    atomic_store(&s_enabled, false);
+    if (s_slots) {
+        heap_caps_free(s_slots);
+        s_slots = NULL;
+        s_capacity = 0;
+    }
+}
@@ -65,6 +65,8 @@ int get_note(float frequency, note_t *result) {
     float pow_result = powf(2.0f, pow_input);
     float mapped_frequency = A4_FREQUENCY * pow_result;
     result->frequency = mapped_frequency;
+    result->midi = rounded_note;
+    result->cents = 100.0f * (note_number_f - (float)rounded_note);
 
     return 0; // Sucesso
 }
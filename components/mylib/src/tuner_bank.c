@@ -0,0 +1,322 @@
+// src/tuner_bank.c
+#include "tuner_bank.h"
+#include "esp_log.h"
+#include <math.h>
+#include <string.h>
+
+static const char *TAG_TUNER = "TUNER_BANK";
+
+// Afinações padrão (notas MIDI, na ordem das cordas)
+static const tuner_instrument_t s_instruments[] = {
+    {"guitar",     6, {40, 45, 50, 55, 59, 64}},   // E2 A2 D3 G3 B3 E4
+    {"bass",       4, {28, 33, 38, 43}},           // E1 A1 D2 G2
+    {"ukulele",    4, {67, 60, 64, 69}},           // G4 C4 E4 A4 (reentrante)
+    {"violin",     4, {55, 62, 69, 76}},           // G3 D4 A4 E5
+    {"cavaquinho", 4, {62, 67, 71, 74}},           // D4 G4 B4 D5
+};
+
+/**
+ * @brief Afinação pelo nome ("guitar", "bass", "ukulele", "violin", "cavaquinho"); NULL se desconhecida.
+ */
+const tuner_instrument_t *tuner_instrument_find(const char *name) {
+    if (!name) {
+        return NULL;
+    }
+    for (size_t i = 0; i < sizeof(s_instruments) / sizeof(s_instruments[0]); i++) {
+        if (strcmp(s_instruments[i].name, name) == 0) {
+            return &s_instruments[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Prepara o banco para as cordas de um instrumento.
+ *
+ * @param tb           Ponteiro para o banco.
+ * @param instrument   Afinação alvo (tuner_instrument_find).
+ * @param length       Amostras por janela.
+ * @param sample_rate  Taxa de amostragem em Hz.
+ * @param harmonics    Harmônicos por corda (1..TUNER_MAX_HARMONICS).
+ * @param range_cents  Desvio máximo aceito em relação à corda (cents).
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t tuner_bank_init(tuner_bank_t *tb, const tuner_instrument_t *instrument, size_t length,
+                          float sample_rate, size_t harmonics, float range_cents) {
+    if (!tb || !instrument || instrument->count == 0 || instrument->count > TUNER_MAX_STRINGS || length < 64 ||
+        sample_rate <= 0.0f || harmonics == 0 || harmonics > TUNER_MAX_HARMONICS || range_cents <= 0.0f) {
+        ESP_LOGE(TAG_TUNER, "Parâmetros inválidos passados para tuner_bank_init.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(tb, 0, sizeof(*tb));
+    tb->sample_rate = sample_rate;
+    tb->length = length;
+    tb->bin_hz = sample_rate / (float)length;
+    tb->range_cents = range_cents;
+    tb->min_confidence = TUNER_MIN_CONFIDENCE;
+    tb->count = instrument->count;
+    tb->string = -1;
+
+    for (size_t k = 0; k < tb->count; k++) {
+        float f = A4_FREQUENCY * powf(2.0f, (float)(instrument->midi[k] - 69) / 12.0f);
+        // A interpolação lê um bin abaixo da fundamental; o último harmônico (+ um bin) fica abaixo de Nyquist
+        if (f - tb->bin_hz <= 0.0f || f + tb->bin_hz >= 0.5f * sample_rate) {
+            ESP_LOGE(TAG_TUNER, "Corda MIDI %d (%.1f Hz) fora da faixa com %zu amostras a %.0f Hz.",
+                     instrument->midi[k], f, length, sample_rate);
+            return ESP_ERR_INVALID_ARG;
+        }
+        tb->midi[k] = instrument->midi[k];
+        tb->target_hz[k] = f;
+        size_t h = 0;
+        while (h < harmonics && (float)(h + 1) * f + tb->bin_hz < 0.5f * sample_rate) {
+            tb->coeff[k][h] = 2.0f * cosf(2.0f * (float)M_PI * (float)(h + 1) * f / sample_rate);
+            h++;
+        }
+        tb->harmonics[k] = h;
+    }
+    ESP_LOGI(TAG_TUNER, "Afinador %s: %zu cordas x %zu harmônicos, janela de %zu amostras (bin de %.1f Hz).",
+             instrument->name, tb->count, harmonics, length, tb->bin_hz);
+    return ESP_OK;
+}
+
+// Filtros de Goertzel por passada: a recursão de cada filtro é serial, então vários filtros
+// intercalados na mesma leitura da janela escondem a latência do multiply-add
+#define TUNER_LANES 4
+
+/**
+ * @brief Estados finais (s1, s2) de até TUNER_LANES filtros de Goertzel (coeff = 2 cos w) numa passada.
+ */
+static void goertzel_lanes(const float *x, size_t n, const float *coeff, size_t count, float *s1_out, float *s2_out) {
+    float c[TUNER_LANES] = {0}, s1[TUNER_LANES] = {0}, s2[TUNER_LANES] = {0};
+    for (size_t j = 0; j < count; j++) {
+        c[j] = coeff[j];
+    }
+    for (size_t i = 0; i < n; i++) {
+        const float v = x[i];
+        for (size_t j = 0; j < TUNER_LANES; j++) {
+            float s = v + c[j] * s1[j] - s2[j];
+            s2[j] = s1[j];
+            s1[j] = s;
+        }
+    }
+    for (size_t j = 0; j < count; j++) {
+        s1_out[j] = s1[j];
+        s2_out[j] = s2[j];
+    }
+}
+
+/**
+ * @brief Potências |X(w)|^2 de count filtros, TUNER_LANES por passada.
+ */
+static void goertzel_powers(const float *x, size_t n, const float *coeff, size_t count, float *power) {
+    for (size_t j = 0; j < count; j += TUNER_LANES) {
+        size_t m = (count - j < TUNER_LANES) ? count - j : TUNER_LANES;
+        float s1[TUNER_LANES], s2[TUNER_LANES];
+        goertzel_lanes(x, n, coeff + j, m, s1, s2);
+        for (size_t i = 0; i < m; i++) {
+            power[j + i] = s1[i] * s1[i] + s2[i] * s2[i] - coeff[j + i] * s1[i] * s2[i];
+        }
+    }
+}
+
+/**
+ * @brief Desvio (bins) do tom em relação a center pelos filtros em center - bin, center e center + bin.
+ *        Com a janela Hann, X(-1) / X(0) e X(+1) / X(0) são reais e d = 2 Re[(X- - X+) / (2 X0 - X- - X+)].
+ *        Os três y do Goertzel diferem de X pelo fator e^(jw(n-1)), que entre filtros vizinhos só
+ *        difere de e^(-+j 2 pi / n): basta girar y(+-1) por e^(+-j 2 pi / n).
+ */
+static float tuner_interpolate(tuner_bank_t *tb, const float *x, float center) {
+    const size_t n = tb->length;
+    float coeff[3], cw[3], sw[3], s1[3], s2[3];
+    for (int j = 0; j < 3; j++) {
+        float w = 2.0f * (float)M_PI * (center + (float)(j - 1) * tb->bin_hz) / tb->sample_rate;
+        cw[j] = cosf(w);
+        sw[j] = sinf(w);
+        coeff[j] = 2.0f * cw[j];
+    }
+    goertzel_lanes(x, n, coeff, 3, s1, s2);
+    tb->filters += 3;
+    // y = s1 - e^(-jw) s2 = e^(jw(n-1)) X(w)
+    float mr = s1[0] - cw[0] * s2[0], mi = sw[0] * s2[0];
+    float zr = s1[1] - cw[1] * s2[1], zi = sw[1] * s2[1];
+    float pr = s1[2] - cw[2] * s2[2], pi = sw[2] * s2[2];
+
+    float cd = cosf(2.0f * (float)M_PI / (float)n), sd = sinf(2.0f * (float)M_PI / (float)n);
+    float ar = mr * cd + mi * sd, ai = mi * cd - mr * sd;     // X- (a menos do fator comum)
+    float br = pr * cd - pi * sd, bi = pi * cd + pr * sd;     // X+
+    float num_r = ar - br, num_i = ai - bi;
+    float den_r = 2.0f * zr - ar - br, den_i = 2.0f * zi - ai - bi;
+    float den = den_r * den_r + den_i * den_i;
+    if (den <= 0.0f) {
+        return 0.0f;
+    }
+    float d = 2.0f * (num_r * den_r + num_i * den_i) / den;
+    return fmaxf(-1.5f, fminf(1.5f, d));
+}
+
+/**
+ * @brief Centro refinado por até iters recentralizações da interpolação.
+ */
+static float tuner_refine(tuner_bank_t *tb, const float *x, float center, int iters) {
+    for (int it = 0; it < iters && center > tb->bin_hz; it++) {
+        float d = tuner_interpolate(tb, x, center);
+        center += d * tb->bin_hz;
+        if (fabsf(d) < 0.02f) {
+            break;
+        }
+    }
+    return center;
+}
+
+/**
+ * @brief Estimativa supondo uma corda.
+ */
+typedef struct {
+    float f0;                       // Fundamental refinada (Hz)
+    float cents;                    // Desvio em relação à corda
+    float confidence;               // Energia nos harmônicos da fundamental refinada (0..1)
+    float score;                    // Média dos logs dessas potências (desempate entre cordas)
+} tuner_candidate_t;
+
+/**
+ * @brief Fundamental, desvio e confiança supondo a corda k.
+ * @return 0 dentro de range_cents e acima de min_confidence, -1 caso contrário.
+ */
+static int tuner_estimate(tuner_bank_t *tb, const float *frame, float norm, size_t k, tuner_candidate_t *c) {
+    // Fundamental primeiro (maior faixa de captura em cents); sem ela, o harmônico mais forte
+    const float *p = tb->power[k];
+    const size_t H = tb->harmonics[k];
+    const float target = tb->target_hz[k];
+    size_t strongest = 0;
+    for (size_t h = 1; h < H; h++) {
+        strongest = (p[h] > p[strongest]) ? h : strongest;
+    }
+    size_t h_ref = (p[0] >= 0.1f * p[strongest]) ? 0 : strongest;
+    float f0 = tuner_refine(tb, frame, (float)(h_ref + 1) * target, TUNER_REFINE_ITERS) / (float)(h_ref + 1);
+    if (strongest > h_ref) {
+        // O harmônico divide o erro de posição por h (partindo da estimativa, dentro do lóbulo principal)
+        float fh = tuner_refine(tb, frame, (float)(strongest + 1) * f0, 1) / (float)(strongest + 1);
+        if (fabsf(fh - f0) * (float)(strongest + 1) < tb->bin_hz) {
+            f0 = fh;
+        }
+    }
+
+    float cents = 1200.0f * log2f(f0 / target);
+    if (!(fabsf(cents) <= tb->range_cents)) {
+        return -1;
+    }
+
+    // Confiança: energia nos harmônicos da fundamental refinada (os filtros da corda perdem até 6 dB
+    // a um bin do tom, e os harmônicos de uma corda desafinada saem do lóbulo principal)
+    float coeff[TUNER_MAX_HARMONICS], power[TUNER_MAX_HARMONICS];
+    for (size_t h = 0; h < H; h++) {
+        coeff[h] = 2.0f * cosf(2.0f * (float)M_PI * (float)(h + 1) * f0 / tb->sample_rate);
+    }
+    goertzel_powers(frame, tb->length, coeff, H, power);
+    tb->filters += H;
+    float harm = 0.0f, score = 0.0f;
+    for (size_t h = 0; h < H; h++) {
+        harm += norm * power[h];
+        score += logf(norm * power[h] + 1e-6f);
+    }
+    c->f0 = f0;
+    c->cents = cents;
+    c->confidence = fminf(harm, 1.0f);
+    c->score = score / (float)H;
+    return (c->confidence >= tb->min_confidence) ? 0 : -1;
+}
+
+/**
+ * @brief Estima a corda e a afinação de uma janela.
+ *
+ * @param tb         Ponteiro para o banco.
+ * @param frame      length amostras com a janela Hann já aplicada.
+ * @param frequency  Fundamental em Hz (-1 sem nota).
+ * @param note       Corda alvo (note, octave, frequency, midi) e desvio em cents em relação a ela.
+ * @return int       0 se uma corda foi reconhecida, -1 caso contrário.
+ */
+int tuner_bank_process(tuner_bank_t *tb, const float *frame, float *frequency, note_t *note) {
+    if (!tb || tb->count == 0 || !frame || !frequency || !note) {
+        ESP_LOGE(TAG_TUNER, "Parâmetros inválidos passados para tuner_bank_process.");
+        return -1;
+    }
+    *frequency = -1.0f;
+    tb->string = -1;
+    tb->confidence = 0.0f;
+    tb->filters = 0;
+
+    const size_t n = tb->length;
+    float energy = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        energy += frame[i] * frame[i];
+    }
+    if (energy <= 0.0f) {
+        return -1;
+    }
+
+    // Potência normalizada: um seno no centro do filtro, sozinho na janela Hann, dá |X|^2 = n E / 3
+    const float norm = 3.0f / ((float)n * energy);
+    float coeff[TUNER_MAX_STRINGS * TUNER_MAX_HARMONICS], power[TUNER_MAX_STRINGS * TUNER_MAX_HARMONICS];
+    size_t total = 0;
+    for (size_t k = 0; k < tb->count; k++) {
+        for (size_t h = 0; h < tb->harmonics[k]; h++) {
+            coeff[total++] = tb->coeff[k][h];
+        }
+    }
+    goertzel_powers(frame, n, coeff, total, power);
+    tb->filters += total;
+
+    float scores[TUNER_MAX_STRINGS];
+    size_t idx = 0;
+    for (size_t k = 0; k < tb->count; k++) {
+        float score = 0.0f;
+        for (size_t h = 0; h < tb->harmonics[k]; h++) {
+            tb->power[k][h] = norm * power[idx++];
+            score += logf(tb->power[k][h] + 1e-6f);
+        }
+        // Média geométrica: o harmônico comum a duas cordas (ex.: 3 x E2 ~ B3) não decide sozinho
+        scores[k] = score / (float)tb->harmonics[k];
+    }
+
+    // As duas cordas de maior escore são refinadas e comparadas de novo nos harmônicos refinados: longe
+    // do alvo (corda aguda a quase um semitom) os harmônicos saem do lóbulo principal e uma corda grave
+    // com um harmônico em comum pode pontuar mais nos filtros fixos
+    int chosen = -1;
+    tuner_candidate_t best = {0};
+    for (int attempt = 0; attempt < 2 && attempt < (int)tb->count; attempt++) {
+        int k = -1;
+        for (size_t i = 0; i < tb->count; i++) {
+            if (scores[i] > -INFINITY && (k < 0 || scores[i] > scores[k])) {
+                k = (int)i;
+            }
+        }
+        scores[k] = -INFINITY;
+        tuner_candidate_t cand;
+        if (tuner_estimate(tb, frame, norm, (size_t)k, &cand) == 0 && (chosen < 0 || cand.score > best.score)) {
+            chosen = k;
+            best = cand;
+        }
+    }
+    if (chosen < 0 || get_note(tb->target_hz[chosen], note) != 0) {
+        return -1;
+    }
+    note->cents = best.cents;
+    tb->string = chosen;
+    tb->confidence = best.confidence;
+    *frequency = best.f0;
+    return 0;
+}
+
+/**
+ * @brief Confiança da última estimativa (0..1).
+ */
+float tuner_bank_confidence(const tuner_bank_t *tb) {
+    return tb ? tb->confidence : 0.0f;
+}
+
+/**
+ * @brief Filtros de Goertzel avaliados na última janela (custo, em passadas de length amostras).
+ */
+size_t tuner_bank_filters_evaluated(const tuner_bank_t *tb) {
+    return tb ? tb->filters : 0;
+}
@@ -232,76 +232,215 @@ void log_heap_usage(void) {
 }
 
 /**
- * @brief Precomputa a tabela da janela Hann.
+ * @brief Função de Bessel modificada de primeira espécie, ordem zero (série de potências).
  *
- * @param buffer        Buffer de amostras.
- * @param length        Tamanho do buffer.
- * @param window_type   Tipo de janela (1: Hann, 2: Hamming).
- * @param hann_table    Tabela da janela Hann pré-computada (para tipos que utilizam).
- * @param hamming_table Tabela da janela Hamming pré-computada (para tipos que utilizam).
+ * @param x Argumento.
+ * @return double I0(x).
  */
-static int precompute_window(float *buffer, size_t length, int window_type) {
-    if (!buffer) {
-        ESP_LOGE(TAG_UTILS, "Buffer nulo passado para precompute_window.");
-        return -1;
+double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    double q = x * x / 4.0;
+    for (int k = 1; k < 64; k++) {
+        term *= q / ((double)k * (double)k);
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
     }
+    return sum;
+}
+
+/**
+ * @brief Calcula a tabela de uma janela simétrica.
+ *
+ * @param table       Tabela de saída.
+ * @param length      Tamanho da janela (>= 2).
+ * @param window_type Tipo de janela (window_type_t, exceto retangular).
+ * @return int 0 em sucesso, -1 para tipo desconhecido.
+ */
+static int precompute_window(float *table, size_t length, int window_type) {
+    const double span = (double)(length - 1);
+    const double i0_beta = bessel_i0(WINDOW_KAISER_BETA);
 
-    switch (window_type) {
-        case 1: { // Janela Hann
-            for (size_t i = 0; i < length; i++) {
-                buffer[i] = 0.5f * (1.0f - cosf(2.0f * M_PI * i / (length - 1)));
+    for (size_t i = 0; i < length; i++) {
+        double x = 2.0 * M_PI * (double)i / span;
+        double v;
+        switch (window_type) {
+            case WINDOW_HANN:
+                v = 0.5 * (1.0 - cos(x));
+                break;
+            case WINDOW_HAMMING:
+                v = 0.54 - 0.46 * cos(x);
+                break;
+            case WINDOW_BLACKMAN_HARRIS:
+                v = 0.35875 - 0.48829 * cos(x) + 0.14128 * cos(2.0 * x) - 0.01168 * cos(3.0 * x);
+                break;
+            case WINDOW_KAISER: {
+                double r = 2.0 * (double)i / span - 1.0;
+                v = bessel_i0(WINDOW_KAISER_BETA * sqrt(fmax(0.0, 1.0 - r * r))) / i0_beta;
+                break;
             }
-            break;
+            default:
+                return -1;
         }
-        case 2: { // Janela Hamming
-            for (size_t i = 0; i < length; i++) {
-                buffer[i] = 0.54f - 0.46f * cosf(2.0f * M_PI * i / (length - 1));
+        table[i] = (float)v;
+    }
+    return 0;
+}
+
+// Cache de tabelas de janela por (tipo, tamanho), compartilhado entre tarefas
+typedef struct {
+    int window_type;
+    size_t length;
+    float *table;
+} window_entry_t;
+
+static window_entry_t s_window_cache[WINDOW_CACHE_SIZE];
+static portMUX_TYPE s_window_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Procura (tipo, tamanho) no cache. Chamar com s_window_lock.
+ */
+static const float *window_lookup(int window_type, size_t length) {
+    for (size_t i = 0; i < WINDOW_CACHE_SIZE; i++) {
+        if (s_window_cache[i].table && s_window_cache[i].window_type == window_type &&
+            s_window_cache[i].length == length) {
+            return s_window_cache[i].table;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Retorna a tabela em cache da janela (tipo, tamanho), criando-a na primeira chamada.
+ *
+ * @param window_type Tipo de janela (window_type_t).
+ * @param length      Tamanho da janela.
+ * @return const float* Tabela com length coeficientes, ou NULL para retangular/erro.
+ */
+const float *window_get(int window_type, size_t length) {
+    if (window_type == WINDOW_RECTANGULAR) {
+        return NULL;
+    }
+    if (length < 2 || window_type < WINDOW_HANN || window_type > WINDOW_KAISER) {
+        ESP_LOGE(TAG_UTILS, "Janela inválida: tipo %d, tamanho %zu.", window_type, length);
+        return NULL;
+    }
+
+    portENTER_CRITICAL(&s_window_lock);
+    const float *hit = window_lookup(window_type, length);
+    portEXIT_CRITICAL(&s_window_lock);
+    if (hit) {
+        return hit;
+    }
+
+    // Cálculo e alocação fora da seção crítica; RAM interna para tamanhos usuais
+    float *table = NULL;
+    if (length <= WINDOW_INTERNAL_MAX) {
+        table = (float *)heap_caps_malloc(length * sizeof(float), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (!table) {
+        table = (float *)heap_caps_malloc(length * sizeof(float), MALLOC_CAP_8BIT);
+    }
+    if (!table) {
+        ESP_LOGE(TAG_UTILS, "Falha ao alocar tabela da janela (tamanho %zu).", length);
+        return NULL;
+    }
+    precompute_window(table, length, window_type);
+
+    const float *result = NULL;
+    portENTER_CRITICAL(&s_window_lock);
+    result = window_lookup(window_type, length); // Outra tarefa pode ter criado a mesma tabela
+    if (!result) {
+        for (size_t i = 0; i < WINDOW_CACHE_SIZE; i++) {
+            if (!s_window_cache[i].table) {
+                s_window_cache[i].window_type = window_type;
+                s_window_cache[i].length = length;
+                s_window_cache[i].table = table;
+                result = table;
+                break;
             }
         }
-        default: // Retangular (padrão)
-            // Não faz nada, já está multiplicando por 1
-            break;
     }
-    return 1;
+    portEXIT_CRITICAL(&s_window_lock);
+
+    if (result != table) {
+        heap_caps_free(table);
+        if (!result) {
+            ESP_LOGW(TAG_UTILS, "Cache de janelas cheio (tipo %d, tamanho %zu).", window_type, length);
+        }
+    }
+    return result;
 }
 
 /**
- * @brief Aplica uma janela no buffer de entrada.
+ * @brief Aplica uma janela no buffer de entrada (tabela do cache de janelas).
  *
  * @param buffer        Buffer de amostras.
  * @param length        Tamanho do buffer.
- * @param window_type   Tipo de janela (0: Retangular, 1: Hann, 2: Hamming).
- * @param hann_table    Tabela da janela Hann pré-computada (para tipos que utilizam).
- * @param hamming_table Tabela da janela Hamming pré-computada (para tipos que utilizam).
+ * @param window_type   Tipo de janela (window_type_t).
  */
 void apply_window(float *buffer, size_t length, int window_type) {
     if (!buffer) {
         ESP_LOGE(TAG_UTILS, "Buffer nulo passado para apply_window.");
         return;
     }
-    float w_table[length];
-    int pre_tab = precompute_window(w_table, length, window_type);
-    switch (window_type) {
-        case 1: { // Janela Hann
-            if (pre_tab) {
-                mult_vect(buffer, w_table, buffer, length);
-            } else {
-                ESP_LOGE(TAG_UTILS, "Hann table não fornecida para janela Hann.");
-            }
-            break;
+    if (window_type == WINDOW_RECTANGULAR) {
+        return; // Multiplicar por 1
+    }
+
+    const float *w_table = window_get(window_type, length);
+    if (!w_table) {
+        ESP_LOGW(TAG_UTILS, "Tabela da janela %d indisponível; janela não aplicada.", window_type);
+        return;
+    }
+    mult_vect(buffer, w_table, buffer, length);
+}
+
+/**
+ * @brief Converte frames int32 do I2S (24 bits alinhados à esquerda) para float
+ *        e aplica a janela na mesma passada.
+ *
+ * @param raw    Frames do I2S.
+ * @param window Coeficientes da janela para estes frames (ex.: window_get(...) + offset),
+ *               ou NULL para janela retangular.
+ * @param out    Saída em float, em [-1, 1).
+ * @param length Número de frames.
+ * @param level  Acumula soma, quadrados e pico das amostras antes da janela (gate de energia),
+ *               ou NULL.
+ */
+void window_and_convert(const int32_t *raw, const float *window, float *out, size_t length, audio_level_t *level) {
+    if (!raw || !out) {
+        ESP_LOGE(TAG_UTILS, "Ponteiros nulos passados para window_and_convert.");
+        return;
+    }
+
+    const float scale = 1.0f / (float)(1 << 23);
+    if (level) {
+        // Nível na mesma passada: o gate não relê a janela
+        float sum = 0.0f, sum_sq = 0.0f, peak = level->peak;
+        for (size_t i = 0; i < length; i++) {
+            float x = (float)(raw[i] >> 8) * scale;
+            sum += x;
+            sum_sq += x * x;
+            peak = fmaxf(peak, fabsf(x));
+            out[i] = window ? x * window[i] : x;
         }
-        case 2: { // Janela Hamming
-            if (pre_tab) {
-                mult_vect(buffer, w_table, buffer, length);
-            } else {
-                ESP_LOGW(TAG_UTILS, "Hamming table não fornecida para janela Hamming.");
-            }
-            break;
+        level->sum += sum;
+        level->sum_sq += sum_sq;
+        level->peak = peak;
+        level->count += length;
+        return;
+    }
+    if (!window) {
+        for (size_t i = 0; i < length; i++) {
+            out[i] = (float)(raw[i] >> 8) * scale;
         }
-        case 0: // Retangular (padrão)
-        default:
-            // Não faz nada, já está multiplicando por 1
-            break;
+        return;
+    }
+    for (size_t i = 0; i < length; i++) {
+        // SHIFT aritmético de 8 mantém os 24 bits significativos com sinal
+        out[i] = (float)(raw[i] >> 8) * scale * window[i];
     }
 }
 
@@ -1,8 +1,10 @@
 // src/yin.c
 #include "yin.h"
 #include "utils.h"
+#include "fft.h"
 #include "esp_log.h"
 #include <math.h>
+#include <float.h>
 #include <string.h>
 
 static const char *TAG_YIN = "YIN";
@@ -18,9 +20,10 @@ static const char *TAG_YIN = "YIN";
  * @param adaptive_min Threshold mínimo para adaptativo.
  * @param adaptive_max Threshold máximo para adaptativo.
  * @param adaptive_step Passo de ajuste para adaptativo.
+ * @param diff_method  Backend da função de diferença (YIN_DIFF_DIRECT ou YIN_DIFF_FFT).
  * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
  */
-esp_err_t yin_init(Yin *yin, size_t buffer_size, float sample_rate, float threshold, yin_threshold_mode_t mode, float adaptive_min, float adaptive_max, float adaptive_step) {
+esp_err_t yin_init(Yin *yin, size_t buffer_size, float sample_rate, float threshold, yin_threshold_mode_t mode, float adaptive_min, float adaptive_max, float adaptive_step, yin_diff_method_t diff_method) {
     if (!yin || buffer_size == 0 || sample_rate <= 0.0f) {
         ESP_LOGE(TAG_YIN, "Parâmetros inválidos passados para yin_init.");
         return ESP_ERR_INVALID_ARG;
@@ -39,20 +42,53 @@ esp_err_t yin_init(Yin *yin, size_t buffer_size, float sample_rate, float thresh
     yin->config.tau_min = (size_t)(sample_rate / HIGH_FREQ); // Frequência máxima de 4186 Hz
     yin->config.tau_max = (size_t)(sample_rate / LOW_FREQ);   // Frequência mínima de 27.5 Hz
 
+    // O período precisa caber ao menos duas vezes na janela
+    if (yin->config.tau_max > buffer_size / 2) {
+        ESP_LOGW(TAG_YIN, "tau_max=%zu limitado a %zu pelo tamanho do buffer.", yin->config.tau_max, buffer_size / 2);
+        yin->config.tau_max = buffer_size / 2;
+    }
+    yin->config.tau_min_limit = yin->config.tau_min;
+    yin->config.tau_max_limit = yin->config.tau_max;
+
+    // Busca exaustiva até yin_set_hierarchical (antes das alocações: yin_deinit inspeciona coarse_buf)
+    yin->config.search = YIN_SEARCH_EXHAUSTIVE;
+    yin->config.coarse_factor = 1;
+    yin->config.coarse_candidates = 0;
+    yin->config.refine_radius = 0;
+    yin->config.coarse_buf = NULL;
+    yin->config.taus_evaluated = 0;
+    yin->config.executor = NULL;
+    yin->config.aperiodicity = 1.0f;
+
+    // Sem rastreamento até yin_set_tracking (yin_deinit libera track_energy)
+    yin->config.tracking = false;
+    yin->config.track_energy = NULL;
+    yin->config.locked = false;
+
     // Aloca memória para os buffers
     yin->config.cumulative_difference = (float *)heap_caps_malloc(buffer_size * sizeof(float), MALLOC_CAP_8BIT);
     yin->config.cumulative_mean_difference = (float *)heap_caps_malloc(buffer_size * sizeof(float), MALLOC_CAP_8BIT);
 
-    if (!yin->config.cumulative_difference || !yin->config.cumulative_mean_difference) {
-        ESP_LOGE(TAG_YIN, "Falha na alocação de memória para buffers YIN.");
-        if (yin->config.cumulative_difference) {
-            heap_caps_free(yin->config.cumulative_difference);
-            yin->config.cumulative_difference = NULL;
-        }
-        if (yin->config.cumulative_mean_difference) {
-            heap_caps_free(yin->config.cumulative_mean_difference);
-            yin->config.cumulative_mean_difference = NULL;
+    // Scratch da autocorrelação: M >= N + tau_max evita aliasing circular até tau_max
+    yin->config.diff_method = diff_method;
+    yin->config.fft_size = 0;
+    yin->config.fft_real = NULL;
+    yin->config.fft_imag = NULL;
+    yin->config.fft_shared = false;
+    if (diff_method == YIN_DIFF_FFT) {
+        size_t m = 1;
+        while (m < buffer_size + yin->config.tau_max + 1) {
+            m <<= 1;
         }
+        yin->config.fft_size = m;
+        yin->config.fft_real = (float *)heap_caps_malloc(m * sizeof(float), MALLOC_CAP_8BIT);
+        yin->config.fft_imag = (float *)heap_caps_malloc(m * sizeof(float), MALLOC_CAP_8BIT);
+    }
+
+    if (!yin->config.cumulative_difference || !yin->config.cumulative_mean_difference ||
+        (diff_method == YIN_DIFF_FFT && (!yin->config.fft_real || !yin->config.fft_imag))) {
+        ESP_LOGE(TAG_YIN, "Falha na alocação de memória para buffers YIN.");
+        yin_deinit(yin);
         return ESP_ERR_NO_MEM;
     }
 
@@ -63,96 +99,283 @@ esp_err_t yin_init(Yin *yin, size_t buffer_size, float sample_rate, float thresh
     // Define o modo de threshold
     yin->threshold_mode = mode;
 
-    ESP_LOGI(TAG_YIN, "YIN inicializado com buffer_size=%zu, sample_rate=%.2f Hz, threshold=%.2f, mode=%s",
+    ESP_LOGI(TAG_YIN, "YIN inicializado com buffer_size=%zu, sample_rate=%.2f Hz, threshold=%.2f, mode=%s, diff=%s",
              buffer_size, sample_rate, threshold,
-             mode == YIN_THRESHOLD_FIXED ? "Fixo" : "Adaptativo");
+             mode == YIN_THRESHOLD_FIXED ? "Fixo" : "Adaptativo",
+             diff_method == YIN_DIFF_FFT ? "FFT" : "Direto");
     return ESP_OK;
 }
 
 /**
- * @brief Executa o algoritmo YIN para detectar a frequência fundamental.
+ * @brief Calcula d(tau) via autocorrelação por FFT.
+ *
+ * d(tau) = e1(tau) + e2(tau) - 2 r(tau), com e1 = soma de x[j]^2 para j < N - tau,
+ * e2 = soma de x[j]^2 para j >= tau e r(tau) obtida como FFT do espectro de potência.
  *
  * @param yin          Ponteiro para a estrutura Yin.
- * @param buffer       Buffer de entrada de amostras de áudio (float).
- * @param frequency    Ponteiro para armazenar a frequência detectada em Hz.
- * @return int          0 se uma frequência foi detectada, -1 caso contrário.
+ * @param buffer       Buffer de entrada com buffer_size amostras.
  */
-int yin_detect_pitch(Yin *yin, const float *buffer, float *frequency) {
-    if (!yin || !buffer || !frequency) {
-        ESP_LOGE(TAG_YIN, "Ponteiros nulos passados para yin_detect_pitch.");
-        return -1;
-    }
-
+static void yin_difference_fft(Yin *yin, const float *buffer) {
     size_t n = yin->config.buffer_size;
+    size_t m = yin->config.fft_size;
     size_t tau_min = yin->config.tau_min;
     size_t tau_max = yin->config.tau_max;
+    float *re = yin->config.fft_real;
+    float *im = yin->config.fft_imag;
 
-    // Inicializar os buffers para diferenças
-    for (size_t i = tau_min; i <= tau_max; i++) {
-        yin->config.cumulative_difference[i] = 0.0f;
+    memcpy(re, buffer, n * sizeof(float));
+    memset(re + n, 0, (m - n) * sizeof(float));
+    memset(im, 0, m * sizeof(float));
+
+    fft(re, im, m);
+
+    // Espectro de potência (real e par): a FFT direta equivale à inversa escalada por M
+    for (size_t k = 0; k < m; k++) {
+        re[k] = re[k] * re[k] + im[k] * im[k];
+        im[k] = 0.0f;
     }
 
-    // Passo 1 e 2 no mesmo loop
-    float running_sum = 0.0f;
-    yin->config.cumulative_mean_difference[tau_min] = 0.0f;
+    fft(re, im, m);
+
+    // Energias iniciais para tau_min
+    float e1 = 0.0f;
+    float e2 = 0.0f;
+    for (size_t j = 0; j < n - tau_min; j++) {
+        e1 += buffer[j] * buffer[j];
+    }
+    for (size_t j = tau_min; j < n; j++) {
+        e2 += buffer[j] * buffer[j];
+    }
+
+    float scale = 2.0f / (float)m;
+    for (size_t tau = tau_min; tau <= tau_max; tau++) {
+        float d = e1 + e2 - scale * re[tau];
+        yin->config.cumulative_difference[tau] = (d > 0.0f) ? d : 0.0f;
+
+        e1 -= buffer[n - 1 - tau] * buffer[n - 1 - tau];
+        e2 -= buffer[tau] * buffer[tau];
+    }
+}
+
+/**
+ * @brief Janela repassada às partes do laço direto.
+ */
+typedef struct {
+    Yin *yin;
+    const float *buffer;                  // Amostras float (laço direto)
+    const q15_t *buffer_q15;              // Amostras Q15 (yin_detect_pitch_q15)
+} yin_diff_job_t;
+
+/**
+ * @brief Parte do laço direto de d(tau): lags tau_min + part, de num_parts em num_parts
+ *        (intercalar equilibra as partes, já que o custo cai com tau).
+ */
+static void yin_difference_direct_part(void *ctx, size_t part, size_t num_parts) {
+    const yin_diff_job_t *job = (const yin_diff_job_t *)ctx;
+    Yin *yin = job->yin;
+    const float *buffer = job->buffer;
+    size_t n = yin->config.buffer_size;
+    size_t tau_min = yin->config.tau_min;
+    size_t tau_max = yin->config.tau_max;
 
     // Parâmetros da heurística
     const size_t  YIELD_INTERVAL         = 5;       // Intervalo para ceder CPU
 
-    for (size_t tau = tau_min; tau <= tau_max; tau++) {
-        // 1) diferença cumulativa (combina sub, mult, sum)
+    for (size_t tau = tau_min + part; tau <= tau_max; tau += num_parts) {
+        // diferença cumulativa (combina sub, mult, sum)
         float sum = 0.0f;
         size_t len = n - tau;
         for (size_t j=0; j < len; j++) {
             float diff = buffer[j] - buffer[j + tau];
             sum += diff * diff;
-            //vTaskDelay(pdMS_TO_TICKS(5));
         }
         yin->config.cumulative_difference[tau] = sum;
 
-        // 2) média cumulativa
-        if (tau == tau_min) {
-            running_sum = sum; // start
-        } else {
-            running_sum += sum;
+        // ceder CPU esporadicamente sem travar
+        if ((tau % YIELD_INTERVAL) == 0) {
+            taskYIELD();
         }
-        yin->config.cumulative_mean_difference[tau] = running_sum;
+    }
+}
+
+/**
+ * @brief Parte do laço Q15 de d(tau) (mesma divisão de yin_difference_direct_part).
+ */
+static void yin_difference_q15_part(void *ctx, size_t part, size_t num_parts) {
+    const yin_diff_job_t *job = (const yin_diff_job_t *)ctx;
+    Yin *yin = job->yin;
+    const q15_t *buffer = job->buffer_q15;
+    size_t n = yin->config.buffer_size;
+    size_t tau_min = yin->config.tau_min;
+    size_t tau_max = yin->config.tau_max;
 
+    // (a - b) / 2 cabe em 16 bits, logo o quadrado cabe em int32 (< 2^30)
+    const float scale = 1.0f / (float)(1 << 28); // (2 * diff)^2 em Q30 -> unidades de float
+    const size_t YIELD_INTERVAL = 5;
+
+    for (size_t tau = tau_min + part; tau <= tau_max; tau += num_parts) {
+        int64_t acc = 0;
+        size_t len = n - tau;
+        for (size_t j = 0; j < len; j++) {
+            int32_t diff = ((int32_t)buffer[j] - (int32_t)buffer[j + tau]) >> 1;
+            acc += diff * diff;
+        }
+        yin->config.cumulative_difference[tau] = (float)acc * scale;
 
-        // ceder CPU esporadicamente sem travar
         if ((tau % YIELD_INTERVAL) == 0) {
             taskYIELD();
         }
     }
+}
+
+/**
+ * @brief Calcula a função de diferença d(tau) completa para a janela atual.
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param buffer       Buffer de entrada com buffer_size amostras.
+ */
+static void yin_difference(Yin *yin, const float *buffer) {
+    if (yin->config.diff_method == YIN_DIFF_FFT) {
+        yin_difference_fft(yin, buffer);
+        return;
+    }
+
+    yin_diff_job_t job = {.yin = yin, .buffer = buffer};
+    par_executor_run(yin->config.executor, yin_difference_direct_part, &job);
+}
+
+/**
+ * @brief Diferença normalizada d'(tau) = tau * d(tau) / soma(d) (1 quando a soma é nula).
+ */
+static inline float yin_norm_diff(const Yin *yin, size_t tau) {
+    float cum_mean = yin->config.cumulative_mean_difference[tau];
+    return (cum_mean == 0.0f) ? 1.0f : ((float)tau * yin->config.cumulative_difference[tau]) / cum_mean;
+}
+
+/**
+ * @brief Valor no vértice da parábola por (prev, cur, next), ou cur se não houver mínimo local.
+ *        Com poucas amostras por período (ex.: YIN na taxa decimada) o vale verdadeiro cai
+ *        entre dois lags inteiros.
+ */
+static inline float yin_vertex(float prev, float cur, float next) {
+    float curv = prev - 2.0f * cur + next;
+    if (cur > prev || next <= cur || curv <= 0.0f) {
+        return cur;
+    }
+    return cur - (next - prev) * (next - prev) / (8.0f * curv);
+}
+
+/**
+ * @brief d' no fundo do vale que começa em tau (desce enquanto d' decresce, até hi), para a
+ *        confiança; a busca por threshold aceita o primeiro lag abaixo dele, antes do mínimo.
+ */
+static float yin_valley_aperiodicity(const Yin *yin, size_t tau, size_t lo, size_t hi) {
+    float cur = yin_norm_diff(yin, tau);
+    while (tau < hi) {
+        float next = yin_norm_diff(yin, tau + 1);
+        if (next >= cur) {
+            break;
+        }
+        tau++;
+        cur = next;
+    }
+    if (tau <= lo || tau >= hi) {
+        return cur;
+    }
+    return yin_vertex(yin_norm_diff(yin, tau - 1), cur, yin_norm_diff(yin, tau + 1));
+}
+
+/**
+ * @brief Ajusta o threshold adaptativo: mais sensível após uma detecção, menos após uma falha.
+ */
+static void yin_adapt_threshold(Yin *yin, bool found) {
+    if (yin->threshold_mode != YIN_THRESHOLD_ADAPTIVE) {
+        return;
+    }
+    if (found) {
+        yin->config.current_adaptive_threshold -= yin->config.adaptive_threshold_step;
+        if (yin->config.current_adaptive_threshold < yin->config.adaptive_threshold_min) {
+            yin->config.current_adaptive_threshold = yin->config.adaptive_threshold_min;
+        }
+    } else {
+        yin->config.current_adaptive_threshold += yin->config.adaptive_threshold_step;
+        if (yin->config.current_adaptive_threshold > yin->config.adaptive_threshold_max) {
+            yin->config.current_adaptive_threshold = yin->config.adaptive_threshold_max;
+        }
+    }
+}
+
+/**
+ * @brief Threshold em uso (fixo ou adaptativo).
+ */
+static inline float yin_used_threshold(const Yin *yin) {
+    return (yin->threshold_mode == YIN_THRESHOLD_ADAPTIVE) ? yin->config.current_adaptive_threshold : yin->config.threshold;
+}
+
+/**
+ * @brief Passo 4: interpolação parabólica de d em torno de tau (precisa de tau - 1 e tau + 1).
+ *
+ * @return float Frequência em Hz.
+ */
+static float yin_interpolate(const Yin *yin, size_t tau) {
+    float d0 = yin->config.cumulative_difference[tau - 1];
+    float d1 = yin->config.cumulative_difference[tau];
+    float d2 = yin->config.cumulative_difference[tau + 1];
+
+    // Verifica se a diferença para interpolação é válida
+    if ((2.0f * d1 - d2 - d0) == 0.0f) {
+        // Evita divisão por zero na interpolação
+        return yin->config.sample_rate / (float)tau;
+    }
+
+    // Fórmula de interpolação parabólica
+    float better_tau = (float)tau + (d2 - d0) / (2.0f * (2.0f * d1 - d2 - d0));
+    return yin->config.sample_rate / better_tau;
+}
+
+/**
+ * @brief Estima a frequência a partir de cumulative_difference já preenchido
+ *        (média cumulativa, busca por threshold e interpolação parabólica).
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param frequency    Ponteiro para armazenar a frequência detectada em Hz.
+ * @return int          0 se uma frequência foi detectada, -1 caso contrário.
+ */
+static int yin_estimate(Yin *yin, float *frequency) {
+    size_t tau_min = yin->config.tau_min;
+    size_t tau_max = yin->config.tau_max;
+
+    // Passo 2: média cumulativa
+    float running_sum = 0.0f;
+    for (size_t tau = tau_min; tau <= tau_max; tau++) {
+        running_sum += yin->config.cumulative_difference[tau];
+        yin->config.cumulative_mean_difference[tau] = running_sum;
+    }
+    yin->config.taus_evaluated = tau_max - tau_min + 1;
 
     // Passo 3: Identificação da primeira tau onde d(tau)/mean(d(tau)) < threshold
+    // (em mínimos locais, vale o vértice da parábola)
     size_t tau_found = tau_max + 1; // Indica que não foi encontrado
-    float used_threshold = (yin->threshold_mode == YIN_THRESHOLD_ADAPTIVE) ? yin->config.current_adaptive_threshold : yin->config.threshold;
+    float used_threshold = yin_used_threshold(yin);
+    float prev_norm = yin_norm_diff(yin, tau_min);
     for (size_t tau = tau_min; tau <= tau_max; tau++) {
-        float cum_mean = yin->config.cumulative_mean_difference[tau];
-        if (cum_mean == 0.0f) continue;
-        float norm_diff = ((float)tau * yin->config.cumulative_difference[tau]) / cum_mean;
-        if (norm_diff < used_threshold) {
+        float norm_diff = (tau == tau_min) ? prev_norm : yin_norm_diff(yin, tau);
+        if (norm_diff < used_threshold ||
+            (tau > tau_min && tau < tau_max && yin_vertex(prev_norm, norm_diff, yin_norm_diff(yin, tau + 1)) < used_threshold)) {
             tau_found = tau;
             break;
         }
+        prev_norm = norm_diff;
     }
 
     if (tau_found > tau_max) {
-        // Nenhuma frequência detectada
+        // Nenhuma frequência detectada; threshold menos sensível na próxima iteração
         *frequency = -1.0f;
-        ESP_LOGD(TAG_YIN, "Aqui");
-
-        // Ajusta o threshold adaptativo para torná-lo menos sensível na próxima iteração
-        if (yin->threshold_mode == YIN_THRESHOLD_ADAPTIVE) {
-            yin->config.current_adaptive_threshold += yin->config.adaptive_threshold_step;
-            if (yin->config.current_adaptive_threshold > yin->config.adaptive_threshold_max) {
-                yin->config.current_adaptive_threshold = yin->config.adaptive_threshold_max;
-            }
-        }
-
+        yin->config.aperiodicity = 1.0f;
+        yin_adapt_threshold(yin, false);
         return -1;
     }
+    yin->config.aperiodicity = yin_valley_aperiodicity(yin, tau_found, tau_min, tau_max);
 
     // Passo 4: Interpolação parabólica para refinar a estimativa de tau
     if (tau_found + 1 > tau_max || tau_found < tau_min + 1) {
@@ -160,36 +383,723 @@ int yin_detect_pitch(Yin *yin, const float *buffer, float *frequency) {
         *frequency = yin->config.sample_rate / (float)tau_found;
         return 0;
     }
+    *frequency = yin_interpolate(yin, tau_found);
+    yin_adapt_threshold(yin, true);
+    return 0;
+}
 
-    float d0 = yin->config.cumulative_difference[tau_found - 1];
-    float d1 = yin->config.cumulative_difference[tau_found];
-    float d2 = yin->config.cumulative_difference[tau_found + 1];
+/**
+ * @brief Maior lag da busca grossa: um além de tau_max / factor (o vale pode cair entre dois lags).
+ */
+static inline size_t yin_coarse_t_max(const Yin *yin) {
+    size_t nc = yin->config.buffer_size / yin->config.coarse_factor;
+    size_t t_max = yin->config.tau_max / yin->config.coarse_factor + 1;
+    return (t_max < nc / 2) ? t_max : nc / 2;
+}
 
-    // Verifica se a diferença para interpolação é válida
-    if ((2.0f * d1 - d2 - d0) == 0.0f) {
-        // Evita divisão por zero na interpolação
-        *frequency = yin->config.sample_rate / (float)tau_found;
-        return 0;
+/**
+ * @brief Busca hierárquica: d(T) numa cópia decimada (média de blocos de factor amostras),
+ *        escolha dos vales mais profundos de d'(T) e d(tau) direto só em
+ *        [T * factor - radius, T * factor + radius]. A média cumulativa na resolução cheia
+ *        vem da grossa (d(T * factor) ~ factor * d_grosso(T)). Entre os candidatos refinados,
+ *        vence o de menor lag cujo mínimo passa no threshold, como na busca exaustiva.
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param buffer       Buffer de entrada com buffer_size amostras.
+ * @param frequency    Ponteiro para armazenar a frequência detectada em Hz.
+ * @return int          0 se uma frequência foi detectada, -1 caso contrário.
+ */
+static int yin_detect_hierarchical(Yin *yin, const float *buffer, float *frequency) {
+    const size_t n = yin->config.buffer_size;
+    const size_t f = yin->config.coarse_factor;
+    const size_t tau_min = yin->config.tau_min;
+    const size_t tau_max = yin->config.tau_max;
+    const size_t nc = n / f;
+    const size_t t_min = (tau_min + f - 1) / f > 1 ? (tau_min + f - 1) / f : 1;
+    const size_t t_max = yin_coarse_t_max(yin);
+    float *xc = yin->config.coarse_buf;      // nc amostras
+    float *dc = xc + nc;                     // t_max + 1 valores de d(T)
+    float *cc = dc + t_max + 1;              // t_max + 1 somas cumulativas de d(T)
+    float *d = yin->config.cumulative_difference;
+    float *cm = yin->config.cumulative_mean_difference;
+
+    // Cópia decimada (a média já atenua o que dobraria; o período se preserva)
+    const float inv_f = 1.0f / (float)f;
+    for (size_t i = 0; i < nc; i++) {
+        float acc = 0.0f;
+        for (size_t k = 0; k < f; k++) {
+            acc += buffer[i * f + k];
+        }
+        xc[i] = acc * inv_f;
     }
 
-    // Fórmula de interpolação parabólica
-    float better_tau = tau_found + (d2 - d0) / (2.0f * (2.0f * d1 - d2 - d0));
+    // d(T) grosso: custo ~ 1 / factor^2 do exaustivo
+    yin->config.taus_evaluated = t_max - t_min + 1;
+    float running_sum = 0.0f;
+    for (size_t t = t_min; t <= t_max; t++) {
+        float sum = 0.0f;
+        for (size_t j = 0; j < nc - t; j++) {
+            float diff = xc[j] - xc[j + t];
+            sum += diff * diff;
+        }
+        dc[t] = sum;
+        running_sum += sum;
+        cc[t] = running_sum;
+    }
 
-    // Calcula a frequência fundamental
-    *frequency = yin->config.sample_rate / better_tau;
+    // Candidatos: os primeiros vales de d'(T) abaixo de um threshold folgado (a resolução
+    // grossa arredonda o vale para cima); sem nenhum, o vale mais profundo
+    const float used_threshold = yin_used_threshold(yin);
+    const float coarse_threshold = fmaxf(2.0f * used_threshold, used_threshold + YIN_COARSE_SLACK);
+    size_t cand[YIN_MAX_CANDIDATES];
+    size_t num_cand = 0;
+    size_t deepest = 0;
+    float deepest_val = INFINITY;
+    float vp = 1.0f;
+    float v = (float)t_min * dc[t_min] / fmaxf(cc[t_min], FLT_MIN);
+    for (size_t t = t_min + 1; t < t_max && num_cand < yin->config.coarse_candidates; t++) {
+        vp = v;
+        v = (float)t * dc[t] / fmaxf(cc[t], FLT_MIN);
+        float vn = (float)(t + 1) * dc[t + 1] / fmaxf(cc[t + 1], FLT_MIN);
+        if (!(v < vp && v <= vn)) {
+            continue;
+        }
+        if (yin_vertex(vp, v, vn) < coarse_threshold) {
+            cand[num_cand++] = t;
+        } else if (v < deepest_val) {
+            deepest_val = v;
+            deepest = t;
+        }
+    }
+    if (num_cand == 0 && deepest != 0) {
+        cand[num_cand++] = deepest;
+    }
 
-    // Atualiza o threshold adaptativo, se estiver habilitado
-    if (yin->threshold_mode == YIN_THRESHOLD_ADAPTIVE) {
-        // Reduz o threshold para aumentar a sensibilidade
-        yin->config.current_adaptive_threshold -= yin->config.adaptive_threshold_step;
-        if (yin->config.current_adaptive_threshold < yin->config.adaptive_threshold_min) {
-            yin->config.current_adaptive_threshold = yin->config.adaptive_threshold_min;
+    // Refinamento na resolução cheia, do menor lag ao maior
+    const float scale = (float)(f * f);
+    for (size_t c = 0; c < num_cand; c++) {
+        size_t center = cand[c] * f;
+        size_t lo = (center > tau_min + yin->config.refine_radius) ? center - yin->config.refine_radius : tau_min;
+        size_t hi = (center + yin->config.refine_radius < tau_max) ? center + yin->config.refine_radius : tau_max;
+        if (lo + 2 > hi) {
+            continue;
+        }
+        yin->config.taus_evaluated += hi - lo + 1;
+
+        for (size_t tau = lo; tau <= hi; tau++) {
+            float sum = 0.0f;
+            for (size_t j = 0; j < n - tau; j++) {
+                float diff = buffer[j] - buffer[j + tau];
+                sum += diff * diff;
+            }
+            d[tau] = sum;
+
+            // Soma cumulativa de d até tau interpolada da grossa
+            float pos = (float)tau * inv_f;
+            size_t t0 = (size_t)pos;
+            if (t0 < t_min) {
+                cm[tau] = scale * cc[t_min] * pos / (float)t_min;
+            } else if (t0 >= t_max) {
+                cm[tau] = scale * cc[t_max];
+            } else {
+                float frac = pos - (float)t0;
+                cm[tau] = scale * (cc[t0] + frac * (cc[t0 + 1] - cc[t0]));
+            }
+        }
+
+        // Mínimo de d' no interior da vizinhança
+        size_t best = 0;
+        float best_val = INFINITY;
+        for (size_t tau = lo + 1; tau < hi; tau++) {
+            float v = yin_norm_diff(yin, tau);
+            if (v < best_val) {
+                best_val = v;
+                best = tau;
+            }
+        }
+        if (best == 0) {
+            continue;
+        }
+        float vertex = yin_vertex(yin_norm_diff(yin, best - 1), best_val, yin_norm_diff(yin, best + 1));
+        if (vertex < used_threshold) {
+            yin->config.aperiodicity = vertex;
+            *frequency = yin_interpolate(yin, best);
+            yin_adapt_threshold(yin, true);
+            return 0;
+        }
+    }
+
+    *frequency = -1.0f;
+    yin->config.aperiodicity = 1.0f;
+    yin_adapt_threshold(yin, false);
+    return -1;
+}
+
+/**
+ * @brief Busca com saída antecipada: d(tau) direto, soma cumulativa e d'(tau) na mesma passada.
+ *        Para no primeiro mínimo local de d' (ou vértice da parábola) abaixo do threshold,
+ *        confirmado por d'(tau + 1) > d'(tau); notas agudas param em poucas dezenas de lags.
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param buffer       Buffer de entrada com buffer_size amostras.
+ * @param frequency    Ponteiro para armazenar a frequência detectada em Hz.
+ * @return int          0 se uma frequência foi detectada, -1 caso contrário.
+ */
+static int yin_detect_early_exit(Yin *yin, const float *buffer, float *frequency) {
+    const size_t n = yin->config.buffer_size;
+    const size_t tau_min = yin->config.tau_min;
+    const size_t tau_max = yin->config.tau_max;
+    const float used_threshold = yin_used_threshold(yin);
+    float *d = yin->config.cumulative_difference;
+    float *cm = yin->config.cumulative_mean_difference;
+    const size_t YIELD_INTERVAL = 5;
+
+    float running_sum = 0.0f;
+    float prev_norm = INFINITY, cur_norm = INFINITY;
+    size_t tau_found = tau_max + 1;
+    size_t tau = tau_min;
+    for (; tau <= tau_max; tau++) {
+        float sum = 0.0f;
+        for (size_t j = 0; j < n - tau; j++) {
+            float diff = buffer[j] - buffer[j + tau];
+            sum += diff * diff;
+        }
+        d[tau] = sum;
+        running_sum += sum;
+        cm[tau] = running_sum;
+        float norm = yin_norm_diff(yin, tau);
+
+        // Mínimo local em tau - 1 confirmado agora
+        if (tau > tau_min + 1 && cur_norm <= prev_norm && norm > cur_norm &&
+            (cur_norm < used_threshold || yin_vertex(prev_norm, cur_norm, norm) < used_threshold)) {
+            tau_found = tau - 1;
+            break;
+        }
+        prev_norm = cur_norm;
+        cur_norm = norm;
+
+        // Ceder CPU esporadicamente, como no laço direto
+        if ((tau % YIELD_INTERVAL) == 0) {
+            taskYIELD();
+        }
+    }
+    yin->config.taus_evaluated = (tau <= tau_max ? tau : tau_max) - tau_min + 1;
+
+    if (tau_found > tau_max) {
+        // Ainda descendo abaixo do threshold no fim da faixa: aceita tau_max sem interpolação
+        if (cur_norm < used_threshold) {
+            yin->config.aperiodicity = cur_norm;
+            *frequency = yin->config.sample_rate / (float)tau_max;
+            return 0;
         }
+        *frequency = -1.0f;
+        yin->config.aperiodicity = 1.0f;
+        yin_adapt_threshold(yin, false);
+        return -1;
     }
 
+    yin->config.aperiodicity = yin_vertex(yin_norm_diff(yin, tau_found - 1), cur_norm, yin_norm_diff(yin, tau_found + 1));
+    *frequency = yin_interpolate(yin, tau_found);
+    yin_adapt_threshold(yin, true);
     return 0;
 }
 
+/**
+ * @brief Busca completa na faixa atual, com a estratégia configurada (o caminho Q15 é sempre exaustivo).
+ */
+static int yin_detect_full(Yin *yin, const yin_diff_job_t *job, float *frequency) {
+    if (job->buffer_q15) {
+        par_executor_run(yin->config.executor, yin_difference_q15_part, (void *)job);
+        return yin_estimate(yin, frequency);
+    }
+    if (yin->config.search == YIN_SEARCH_HIERARCHICAL) {
+        return yin_detect_hierarchical(yin, job->buffer, frequency);
+    }
+    if (yin->config.search == YIN_SEARCH_EARLY_EXIT) {
+        return yin_detect_early_exit(yin, job->buffer, frequency);
+    }
+
+    // Passo 1: função de diferença
+    yin_difference(yin, job->buffer);
+
+    // Passos 2 a 4
+    return yin_estimate(yin, frequency);
+}
+
+/**
+ * @brief Somas prefixas de x^2 em track_energy: e1(tau) + e2(tau) de qualquer lag em O(1).
+ *
+ * @return float Energia da janela.
+ */
+static float yin_track_prefix(Yin *yin, const yin_diff_job_t *job) {
+    const size_t n = yin->config.buffer_size;
+    const float q = 1.0f / 32768.0f;
+    float *p = yin->config.track_energy;
+    float acc = 0.0f;
+    p[0] = 0.0f;
+    for (size_t j = 0; j < n; j++) {
+        float x = job->buffer_q15 ? (float)job->buffer_q15[j] * q : job->buffer[j];
+        acc += x * x;
+        p[j + 1] = acc;
+    }
+    return acc;
+}
+
+/**
+ * @brief e1(tau) + e2(tau) pelas somas prefixas.
+ */
+static inline float yin_track_energy(const Yin *yin, size_t tau) {
+    const float *p = yin->config.track_energy;
+    const size_t n = yin->config.buffer_size;
+    return p[n - tau] + (p[n] - p[tau]);
+}
+
+/**
+ * @brief d(tau) só em [center / ratio, center * ratio] (dentro da faixa atual), pelo laço direto. A soma
+ *        cumulativa de d até tau, que exigiria todos os lags menores, é estimada como
+ *        track_scale x (tau - track_base + 1) x (e1 + e2): a média de d acompanha a energia.
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param job          Janela (float ou Q15).
+ * @param center       Período central em lags.
+ * @param best         Lag do menor d' no interior da janela.
+ * @param vertex       d' no vértice da parábola em best.
+ * @return bool        false se a janela é curta demais ou o mínimo cai na borda (o vale saiu dela).
+ */
+static bool yin_track_window(Yin *yin, const yin_diff_job_t *job, float center, size_t *best, float *vertex) {
+    const size_t range_min = yin->config.tau_min;
+    const size_t range_max = yin->config.tau_max;
+    float lo_f = floorf(center / yin->config.track_ratio);
+    float hi_f = ceilf(center * yin->config.track_ratio);
+    size_t lo = (lo_f > (float)range_min) ? (size_t)lo_f : range_min;
+    size_t hi = (hi_f < (float)range_max) ? (size_t)hi_f : range_max;
+    if (hi < lo + 2) {
+        return false;
+    }
+
+    yin->config.tau_min = lo;
+    yin->config.tau_max = hi;
+    // Laço direto também com YIN_DIFF_FFT: a FFT custaria a janela inteira para poucas dezenas de lags
+    par_executor_run(yin->config.executor, job->buffer_q15 ? yin_difference_q15_part : yin_difference_direct_part,
+                     (void *)job);
+    yin->config.tau_min = range_min;
+    yin->config.tau_max = range_max;
+    yin->config.taus_evaluated += hi - lo + 1;
+
+    float *cm = yin->config.cumulative_mean_difference;
+    for (size_t tau = lo; tau <= hi; tau++) {
+        cm[tau] = yin->config.track_scale * (float)(tau - yin->config.track_base + 1) * yin_track_energy(yin, tau);
+    }
+
+    *best = 0;
+    float best_val = INFINITY;
+    for (size_t tau = lo; tau <= hi; tau++) {
+        float v = yin_norm_diff(yin, tau);
+        if (v < best_val) {
+            best_val = v;
+            *best = tau;
+        }
+    }
+    if (*best <= lo || *best >= hi) {
+        return false;
+    }
+    *vertex = yin_vertex(yin_norm_diff(yin, *best - 1), best_val, yin_norm_diff(yin, *best + 1));
+    return true;
+}
+
+/**
+ * @brief Trava na detecção da busca completa se ela for confiante: guarda o período e a escala
+ *        da média cumulativa (d acumulado até T sobre (T - tau_min + 1) x (e1 + e2)).
+ */
+static void yin_track_lock(Yin *yin, float frequency) {
+    if (yin_confidence(yin) < YIN_TRACK_MIN_CONFIDENCE) {
+        return;
+    }
+    float period = yin->config.sample_rate / frequency;
+    size_t t = (size_t)(period + 0.5f);
+    if (t < yin->config.tau_min || t > yin->config.tau_max) {
+        return;
+    }
+    float energy = yin_track_energy(yin, t);
+    float cum = yin->config.cumulative_mean_difference[t];
+    if (energy <= 0.0f || cum <= 0.0f) {
+        return;
+    }
+    yin->config.track_scale = cum / ((float)(t - yin->config.tau_min + 1) * energy);
+    yin->config.track_base = yin->config.tau_min;
+    yin->config.track_period = period;
+    yin->config.locked = true;
+    yin->config.track_locks++;
+}
+
+/**
+ * @brief Detecção com rastreamento: travado, só a vizinhança do período anterior e a guarda
+ *        da oitava acima; senão (ou se a trava se perde) a busca completa.
+ */
+static int yin_detect_tracked(Yin *yin, const yin_diff_job_t *job, float *frequency) {
+    yin->config.track_frames++;
+    yin->config.taus_evaluated = 0;
+
+    // Ataque: salto de energia em relação à janela anterior
+    float energy = yin_track_prefix(yin, job);
+    bool onset = energy > YIN_TRACK_ONSET_RATIO * yin->config.track_last_energy;
+    yin->config.track_last_energy = energy;
+
+    if (yin->config.locked && !onset) {
+        const float used_threshold = yin_used_threshold(yin);
+        const float period = yin->config.track_period;
+        size_t best = 0, guard = 0;
+        float vertex = 1.0f, guard_vertex = 1.0f;
+        bool ok = yin_track_window(yin, job, period, &best, &vertex) && vertex < used_threshold;
+
+        // Com janela < meia oitava, a guarda não sobrepõe a vizinhança de T (d em best +- 1 segue válido)
+        if (ok && 0.5f * period / yin->config.track_ratio > (float)yin->config.tau_min &&
+            yin_track_window(yin, job, 0.5f * period, &guard, &guard_vertex) && guard_vertex < used_threshold) {
+            ok = false;
+        }
+        if (ok) {
+            yin->config.aperiodicity = vertex;
+            *frequency = yin_interpolate(yin, best);
+            yin->config.track_period = yin->config.sample_rate / *frequency;
+            yin_adapt_threshold(yin, true);
+            yin->config.track_tracked++;
+            yin->config.track_taus += yin->config.taus_evaluated;
+            return 0;
+        }
+    }
+    if (yin->config.locked) {
+        yin->config.locked = false;
+        yin->config.track_unlocks++;
+    }
+
+    size_t spent = yin->config.taus_evaluated;
+    int ret = yin_detect_full(yin, job, frequency);
+    yin->config.taus_evaluated += spent;
+    yin->config.track_taus += yin->config.taus_evaluated;
+    if (ret == 0 && *frequency > 0.0f) {
+        yin_track_lock(yin, *frequency);
+    }
+    return ret;
+}
+
+/**
+ * @brief Executa o algoritmo YIN para detectar a frequência fundamental.
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param buffer       Buffer de entrada de amostras de áudio (float).
+ * @param frequency    Ponteiro para armazenar a frequência detectada em Hz.
+ * @return int          0 se uma frequência foi detectada, -1 caso contrário.
+ */
+int yin_detect_pitch(Yin *yin, const float *buffer, float *frequency) {
+    if (!yin || !buffer || !frequency) {
+        ESP_LOGE(TAG_YIN, "Ponteiros nulos passados para yin_detect_pitch.");
+        return -1;
+    }
+
+    yin_diff_job_t job = {.yin = yin, .buffer = buffer};
+    if (yin->config.tracking) {
+        return yin_detect_tracked(yin, &job, frequency);
+    }
+    return yin_detect_full(yin, &job, frequency);
+}
+
+/**
+ * @brief Volta à busca exaustiva, liberando o scratch da hierárquica.
+ */
+static void yin_search_reset(Yin *yin) {
+    if (yin->config.coarse_buf) {
+        heap_caps_free(yin->config.coarse_buf);
+        yin->config.coarse_buf = NULL;
+    }
+    yin->config.search = YIN_SEARCH_EXHAUSTIVE;
+    yin->config.coarse_factor = 1;
+    yin->config.coarse_candidates = 0;
+    yin->config.refine_radius = 0;
+}
+
+/**
+ * @brief Ativa a busca hierárquica (coarse-to-fine) em yin_detect_pitch: d(T) numa cópia
+ *        decimada por factor encontra os vales, e só as vizinhanças dos candidates mais
+ *        profundos são avaliadas na resolução cheia. factor <= 1 ou candidates == 0 volta
+ *        à busca exaustiva.
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param factor       Decimação da busca grossa.
+ * @param candidates   Número de vales refinados.
+ * @param radius       Lags avaliados de cada lado de cada candidato (>= factor / 2).
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t yin_set_hierarchical(Yin *yin, size_t factor, size_t candidates, size_t radius) {
+    if (!yin || !yin->config.cumulative_difference) {
+        ESP_LOGE(TAG_YIN, "YIN não inicializado em yin_set_hierarchical.");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    yin_search_reset(yin);
+    if (factor <= 1 || candidates == 0) {
+        return ESP_OK;
+    }
+
+    // A busca grossa precisa de ao menos dois lags entre tau_min e tau_max
+    if (candidates > YIN_MAX_CANDIDATES || radius < (factor + 1) / 2 ||
+        yin->config.tau_max / factor < (yin->config.tau_min + factor - 1) / factor + 2) {
+        ESP_LOGE(TAG_YIN, "Parâmetros inválidos passados para yin_set_hierarchical (fator %zu, %zu candidatos, raio %zu).",
+                 factor, candidates, radius);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t nc = yin->config.buffer_size / factor;
+    size_t t_max = (yin->config.tau_max / factor + 1 < nc / 2) ? yin->config.tau_max / factor + 1 : nc / 2; // yin_coarse_t_max
+    yin->config.coarse_buf = (float *)heap_caps_malloc((nc + 2 * (t_max + 1)) * sizeof(float), MALLOC_CAP_8BIT);
+    if (!yin->config.coarse_buf) {
+        ESP_LOGE(TAG_YIN, "Falha na alocação do scratch da busca hierárquica.");
+        return ESP_ERR_NO_MEM;
+    }
+
+    yin->config.search = YIN_SEARCH_HIERARCHICAL;
+    yin->config.coarse_factor = factor;
+    yin->config.coarse_candidates = candidates;
+    yin->config.refine_radius = radius;
+    ESP_LOGI(TAG_YIN, "Busca hierárquica: fator %zu, %zu candidatos, raio %zu.", factor, candidates, radius);
+    return ESP_OK;
+}
+
+/**
+ * @brief Ativa/desativa a busca com saída antecipada em yin_detect_pitch: d(tau), média
+ *        cumulativa e d'(tau) na mesma passada (laço direto), parando no primeiro mínimo
+ *        local abaixo do threshold. Desativar volta à busca exaustiva.
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param enabled      true para ativar.
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t yin_set_early_exit(Yin *yin, bool enabled) {
+    if (!yin || !yin->config.cumulative_difference) {
+        ESP_LOGE(TAG_YIN, "YIN não inicializado em yin_set_early_exit.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    yin_search_reset(yin);
+    if (enabled) {
+        yin->config.search = YIN_SEARCH_EARLY_EXIT;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Divide os laços diretos de d(tau) (backend YIN_DIFF_DIRECT e Q15) entre as partes
+ *        do executor: cada parte avalia os lags tau_min + k, tau_min + k + partes, ...
+ *        O backend FFT e as buscas hierárquica/antecipada seguem seriais.
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param executor     Executor já inicializado (NULL volta ao laço serial).
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t yin_set_executor(Yin *yin, par_executor_t *executor) {
+    if (!yin) {
+        ESP_LOGE(TAG_YIN, "Ponteiro nulo passado para yin_set_executor.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    yin->config.executor = executor;
+    return ESP_OK;
+}
+
+/**
+ * @brief Ativa/desativa o rastreamento em yin_detect_pitch/yin_detect_pitch_q15: após uma
+ *        detecção com confiança >= YIN_TRACK_MIN_CONFIDENCE, as próximas janelas avaliam só os
+ *        lags a ±semitones do período anterior (e uma guarda em torno da metade dele, contra o
+ *        salto de oitava acima). Vale fora da janela, guarda abaixo do threshold ou ataque
+ *        (energia > YIN_TRACK_ONSET_RATIO x a anterior) destravam e refazem a busca completa
+ *        na mesma janela. Não vale para yin_stream.
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param enabled      true para ativar (zera as estatísticas).
+ * @param semitones    Meia largura da janela, em semitons (0 < semitones < 6).
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t yin_set_tracking(Yin *yin, bool enabled, float semitones) {
+    if (!yin || !yin->config.cumulative_difference || (enabled && !(semitones > 0.0f && semitones < 6.0f))) {
+        ESP_LOGE(TAG_YIN, "Parâmetros inválidos passados para yin_set_tracking.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (yin->config.track_energy) {
+        heap_caps_free(yin->config.track_energy);
+        yin->config.track_energy = NULL;
+    }
+    yin->config.tracking = false;
+    yin->config.locked = false;
+    if (!enabled) {
+        return ESP_OK;
+    }
+
+    yin->config.track_energy = (float *)heap_caps_malloc((yin->config.buffer_size + 1) * sizeof(float), MALLOC_CAP_8BIT);
+    if (!yin->config.track_energy) {
+        ESP_LOGE(TAG_YIN, "Falha na alocação do scratch do rastreamento.");
+        return ESP_ERR_NO_MEM;
+    }
+    yin->config.track_ratio = powf(2.0f, semitones / 12.0f);
+    yin->config.track_last_energy = 0.0f;
+    yin->config.track_frames = 0;
+    yin->config.track_tracked = 0;
+    yin->config.track_locks = 0;
+    yin->config.track_unlocks = 0;
+    yin->config.track_taus = 0;
+    yin->config.tracking = true;
+    ESP_LOGI(TAG_YIN, "Rastreamento: janela de ±%.1f semitons.", semitones);
+    return ESP_OK;
+}
+
+/**
+ * @brief Lê as estatísticas do rastreamento.
+ *
+ * @param yin   Ponteiro para a estrutura Yin.
+ * @param stats Estrutura de saída.
+ */
+void yin_get_tracking_stats(const Yin *yin, yin_tracking_stats_t *stats) {
+    if (!yin || !stats) {
+        return;
+    }
+    stats->frames = yin->config.track_frames;
+    stats->tracked = yin->config.track_tracked;
+    stats->locks = yin->config.track_locks;
+    stats->unlocks = yin->config.track_unlocks;
+    stats->avg_taus = yin->config.track_frames ? (float)yin->config.track_taus / (float)yin->config.track_frames : 0.0f;
+}
+
+/**
+ * @brief Lags avaliados na última chamada de detecção (para medir a economia das buscas).
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @return size_t      Número de lags (resolução cheia e grossa somados na busca hierárquica).
+ */
+size_t yin_taus_evaluated(const Yin *yin) {
+    return yin ? yin->config.taus_evaluated : 0;
+}
+
+/**
+ * @brief Restringe a faixa de busca a [f_min, f_max] (dentro da faixa de yin_init) para as
+ *        próximas janelas de yin_detect_pitch/yin_detect_pitch_q15; o custo do laço direto
+ *        cai com o maior lag. Valores <= 0 restauram o limite correspondente.
+ *        Com f_max > 0 a média cumulativa de d' começa no novo tau_min (normalização diferente).
+ *        Não usar com yin_stream (d(tau) incremental).
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param f_min        Menor frequência (Hz) -> maior lag.
+ * @param f_max        Maior frequência (Hz) -> menor lag.
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t yin_set_search_range(Yin *yin, float f_min, float f_max) {
+    if (!yin || !yin->config.cumulative_difference || (f_min > 0.0f && f_max > 0.0f && f_max <= f_min)) {
+        ESP_LOGE(TAG_YIN, "Parâmetros inválidos passados para yin_set_search_range.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t tau_min = yin->config.tau_min_limit;
+    size_t tau_max = yin->config.tau_max_limit;
+    if (f_max > 0.0f) {
+        float t = floorf(yin->config.sample_rate / f_max);
+        tau_min = (t > (float)tau_min) ? (size_t)t : tau_min;
+    }
+    if (f_min > 0.0f) {
+        float t = ceilf(yin->config.sample_rate / f_min);
+        tau_max = (t < (float)tau_max) ? (size_t)t : tau_max;
+    }
+
+    // A busca e a interpolação precisam de ao menos três lags
+    if (tau_max < tau_min + 2) {
+        tau_max = tau_min + 2;
+        if (tau_max > yin->config.tau_max_limit) {
+            tau_max = yin->config.tau_max_limit;
+            tau_min = tau_max - 2;
+        }
+    }
+    yin->config.tau_min = tau_min;
+    yin->config.tau_max = tau_max;
+    return ESP_OK;
+}
+
+/**
+ * @brief Passa o backend para YIN_DIFF_FFT usando um scratch externo (ex.: a autocorrelação
+ *        compartilhada dos motores de pitch). O scratch próprio, se houver, é liberado; o
+ *        externo não é liberado por yin_deinit.
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param real         Scratch da FFT (parte real), fft_size floats.
+ * @param imag         Scratch da FFT (parte imaginária), fft_size floats.
+ * @param fft_size     Potência de 2 >= buffer_size + tau_max + 1.
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t yin_set_fft_scratch(Yin *yin, float *real, float *imag, size_t fft_size) {
+    if (!yin || !yin->config.cumulative_difference || !real || !imag ||
+        (fft_size & (fft_size - 1)) != 0 || fft_size < yin->config.buffer_size + yin->config.tau_max_limit + 1) {
+        ESP_LOGE(TAG_YIN, "Parâmetros inválidos passados para yin_set_fft_scratch.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!yin->config.fft_shared) {
+        if (yin->config.fft_real) heap_caps_free(yin->config.fft_real);
+        if (yin->config.fft_imag) heap_caps_free(yin->config.fft_imag);
+    }
+    yin->config.fft_real = real;
+    yin->config.fft_imag = imag;
+    yin->config.fft_size = fft_size;
+    yin->config.fft_shared = true;
+    yin->config.diff_method = YIN_DIFF_FFT;
+    return ESP_OK;
+}
+
+/**
+ * @brief Volta ao estado de yin_init entre notas/fontes: faixa de busca completa, threshold
+ *        adaptativo no máximo e sem estimativa anterior (destrava o rastreamento).
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ */
+void yin_reset(Yin *yin) {
+    if (!yin) {
+        return;
+    }
+    yin->config.tau_min = yin->config.tau_min_limit;
+    yin->config.tau_max = yin->config.tau_max_limit;
+    yin->config.current_adaptive_threshold = yin->config.adaptive_threshold_max;
+    yin->config.taus_evaluated = 0;
+    yin->config.aperiodicity = 1.0f;
+    yin->config.locked = false;
+    yin->config.track_last_energy = 0.0f;
+}
+
+/**
+ * @brief Confiança da última estimativa: 1 - d' no vale aceito (0 sem pitch, ~1 periódico puro).
+ *
+ * @param yin Ponteiro para a estrutura Yin.
+ * @return float Confiança em [0, 1].
+ */
+float yin_confidence(const Yin *yin) {
+    if (!yin) {
+        return 0.0f;
+    }
+    float c = 1.0f - yin->config.aperiodicity;
+    return (c < 0.0f) ? 0.0f : (c > 1.0f ? 1.0f : c);
+}
+
+/**
+ * @brief YIN sobre amostras Q15: função de diferença com acumulador inteiro de 64 bits.
+ *        Média cumulativa, threshold e interpolação seguem o caminho em float (O(tau_max)).
+ *
+ * @param yin          Ponteiro para a estrutura Yin.
+ * @param buffer       Buffer de entrada em Q15 (buffer_size amostras).
+ * @param frequency    Ponteiro para armazenar a frequência detectada em Hz.
+ * @return int          0 se uma frequência foi detectada, -1 caso contrário.
+ */
+int yin_detect_pitch_q15(Yin *yin, const q15_t *buffer, float *frequency) {
+    if (!yin || !buffer || !frequency) {
+        ESP_LOGE(TAG_YIN, "Ponteiros nulos passados para yin_detect_pitch_q15.");
+        return -1;
+    }
+
+    yin_diff_job_t job = {.yin = yin, .buffer_q15 = buffer};
+    if (yin->config.tracking) {
+        return yin_detect_tracked(yin, &job, frequency);
+    }
+    return yin_detect_full(yin, &job, frequency);
+}
+
 /**
  * @brief Libera os recursos alocados pelo algoritmo YIN.
  *
@@ -211,6 +1121,190 @@ void yin_deinit(Yin *yin) {
         yin->config.cumulative_mean_difference = NULL;
     }
 
+    if (yin->config.fft_real && !yin->config.fft_shared) {
+        heap_caps_free(yin->config.fft_real);
+    }
+    yin->config.fft_real = NULL;
+
+    if (yin->config.fft_imag && !yin->config.fft_shared) {
+        heap_caps_free(yin->config.fft_imag);
+    }
+    yin->config.fft_imag = NULL;
+    yin->config.fft_shared = false;
+
+    if (yin->config.coarse_buf) {
+        heap_caps_free(yin->config.coarse_buf);
+        yin->config.coarse_buf = NULL;
+    }
+
+    if (yin->config.track_energy) {
+        heap_caps_free(yin->config.track_energy);
+        yin->config.track_energy = NULL;
+    }
+    yin->config.tracking = false;
+
     ESP_LOGI(TAG_YIN, "YIN desinicializado e recursos liberados.");
     return;
 }
+
+/**
+ * @brief Inicializa o modo streaming (janela deslizante) do YIN.
+ *
+ * @param stream       Ponteiro para a estrutura yin_stream_t.
+ * @param window_size  Tamanho da janela de análise (equivalente ao buffer_size do YIN em bloco).
+ * @param hop_size     Número de amostras por atualização (salto).
+ * @param sample_rate  Taxa de amostragem em Hz.
+ * @param threshold    Threshold para detecção de pitch.
+ * @param mode         Modo de threshold (fixo ou adaptativo).
+ * @param adaptive_min Threshold mínimo para adaptativo.
+ * @param adaptive_max Threshold máximo para adaptativo.
+ * @param adaptive_step Passo de ajuste para adaptativo.
+ * @param diff_method  Backend usado nos recálculos completos de d(tau).
+ * @return esp_err_t   ESP_OK em sucesso, ou código de erro correspondente.
+ */
+esp_err_t yin_stream_init(yin_stream_t *stream, size_t window_size, size_t hop_size, float sample_rate, float threshold, yin_threshold_mode_t mode, float adaptive_min, float adaptive_max, float adaptive_step, yin_diff_method_t diff_method) {
+    if (!stream || hop_size == 0 || hop_size > window_size) {
+        ESP_LOGE(TAG_YIN, "Parâmetros inválidos passados para yin_stream_init.");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Zerado antes do yin_init: yin_stream_deinit após uma falha não libera lixo da pilha
+    memset(stream, 0, sizeof(*stream));
+    esp_err_t ret = yin_init(&stream->yin, window_size, sample_rate, threshold, mode, adaptive_min, adaptive_max, adaptive_step, diff_method);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    stream->window = (float *)heap_caps_malloc(window_size * sizeof(float), MALLOC_CAP_8BIT);
+    if (!stream->window) {
+        ESP_LOGE(TAG_YIN, "Falha na alocação da janela do YIN streaming.");
+        yin_deinit(&stream->yin);
+        return ESP_ERR_NO_MEM;
+    }
+
+    stream->hop_size = hop_size;
+    stream->resync_interval = YIN_STREAM_RESYNC_HOPS;
+    yin_stream_reset(stream);
+
+    ESP_LOGI(TAG_YIN, "YIN streaming inicializado com janela=%zu, hop=%zu", window_size, hop_size);
+    return ESP_OK;
+}
+
+/**
+ * @brief Descarta o histórico da janela deslizante (ex.: após troca de fonte de áudio).
+ *
+ * @param stream       Ponteiro para a estrutura yin_stream_t.
+ */
+void yin_stream_reset(yin_stream_t *stream) {
+    if (!stream || !stream->window) {
+        return;
+    }
+
+    memset(stream->window, 0, stream->yin.config.buffer_size * sizeof(float));
+    memset(stream->yin.config.cumulative_difference, 0, stream->yin.config.buffer_size * sizeof(float));
+    stream->filled = 0;
+    stream->hops_since_resync = 0;
+}
+
+/**
+ * @brief Insere um salto de amostras na janela e atualiza d(tau) incrementalmente.
+ *
+ * Para cada tau, os termos (x[j] - x[j+tau])^2 que saem da janela são subtraídos
+ * e os que entram são somados, custando O(hop * tau) em vez de O(N * tau).
+ * A cada resync_interval saltos a função é recalculada por completo para
+ * eliminar o erro de arredondamento acumulado.
+ *
+ * @param stream       Ponteiro para a estrutura yin_stream_t.
+ * @param hop          Buffer com hop_size novas amostras.
+ * @param frequency    Ponteiro para armazenar a frequência detectada em Hz.
+ * @return int          0 se uma frequência foi detectada, -1 caso contrário (inclusive enquanto a janela enche).
+ */
+int yin_stream_push(yin_stream_t *stream, const float *hop, float *frequency) {
+    if (!stream || !stream->window || !hop || !frequency) {
+        ESP_LOGE(TAG_YIN, "Ponteiros nulos passados para yin_stream_push.");
+        return -1;
+    }
+
+    Yin *yin = &stream->yin;
+    float *w = stream->window;
+    float *d = yin->config.cumulative_difference;
+    size_t n = yin->config.buffer_size;
+    size_t h = stream->hop_size;
+    size_t tau_min = yin->config.tau_min;
+    size_t tau_max = yin->config.tau_max;
+
+    // Janela ainda enchendo: apenas acumula as amostras
+    if (stream->filled < n) {
+        memmove(w, w + h, (n - h) * sizeof(float));
+        memcpy(w + n - h, hop, h * sizeof(float));
+        stream->filled += h;
+        if (stream->filled < n) {
+            *frequency = -1.0f;
+            return -1;
+        }
+        yin_difference(yin, w);
+        stream->hops_since_resync = 0;
+        return yin_estimate(yin, frequency);
+    }
+
+    bool resync = stream->resync_interval > 0 && ++stream->hops_since_resync >= stream->resync_interval;
+
+    // Remove os termos j em [0, h) que deixam a janela
+    if (!resync) {
+        for (size_t tau = tau_min; tau <= tau_max; tau++) {
+            size_t len = (h < n - tau) ? h : n - tau;
+            float sum = 0.0f;
+            for (size_t j = 0; j < len; j++) {
+                float diff = w[j] - w[j + tau];
+                sum += diff * diff;
+            }
+            d[tau] -= sum;
+        }
+    }
+
+    // Desliza a janela
+    memmove(w, w + h, (n - h) * sizeof(float));
+    memcpy(w + n - h, hop, h * sizeof(float));
+
+    if (resync) {
+        yin_difference(yin, w);
+        stream->hops_since_resync = 0;
+        return yin_estimate(yin, frequency);
+    }
+
+    // Soma os termos j em [n - tau - h, n - tau) que entram na janela
+    for (size_t tau = tau_min; tau <= tau_max; tau++) {
+        size_t end = n - tau;
+        size_t start = (end > h) ? end - h : 0;
+        float sum = 0.0f;
+        for (size_t j = start; j < end; j++) {
+            float diff = w[j] - w[j + tau];
+            sum += diff * diff;
+        }
+        d[tau] += sum;
+        if (d[tau] < 0.0f) {
+            d[tau] = 0.0f; // Erro de arredondamento
+        }
+    }
+
+    return yin_estimate(yin, frequency);
+}
+
+/**
+ * @brief Libera os recursos alocados pelo modo streaming do YIN.
+ *
+ * @param stream       Ponteiro para a estrutura yin_stream_t.
+ */
+void yin_stream_deinit(yin_stream_t *stream) {
+    if (!stream) {
+        ESP_LOGE(TAG_YIN, "Ponteiro nulo passado para yin_stream_deinit.");
+        return;
+    }
+
+    if (stream->window) {
+        heap_caps_free(stream->window);
+        stream->window = NULL;
+    }
+
+    yin_deinit(&stream->yin);
+}
@@ -0,0 +1,16 @@
+// host/shim/driver/gpio.h
+#ifndef HOST_SHIM_DRIVER_GPIO_H
+#define HOST_SHIM_DRIVER_GPIO_H
+
+// Apenas os números de pino referenciados em def.h
+typedef enum {
+    GPIO_NUM_9  = 9,
+    GPIO_NUM_10 = 10,
+    GPIO_NUM_11 = 11,
+    GPIO_NUM_12 = 12,
+    GPIO_NUM_16 = 16,
+    GPIO_NUM_17 = 17,
+    GPIO_NUM_18 = 18,
+} gpio_num_t;
+
+#endif // HOST_SHIM_DRIVER_GPIO_H
@@ -0,0 +1,8 @@
+// host/shim/driver/i2s_std.h
+#ifndef HOST_SHIM_DRIVER_I2S_STD_H
+#define HOST_SHIM_DRIVER_I2S_STD_H
+
+// O driver I2S (mic.c) não é compilado no host; def.h só precisa do número da porta
+#define I2S_NUM_0 0
+
+#endif // HOST_SHIM_DRIVER_I2S_STD_H
@@ -0,0 +1,23 @@
+// host/shim/esp_heap_caps.h
+#ifndef HOST_SHIM_ESP_HEAP_CAPS_H
+#define HOST_SHIM_ESP_HEAP_CAPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// No host todas as capacidades de memória caem no malloc da libc
+#define MALLOC_CAP_8BIT         (1 << 2)
+#define MALLOC_CAP_DMA          (1 << 3)
+#define MALLOC_CAP_SPIRAM       (1 << 10)
+#define MALLOC_CAP_INTERNAL     (1 << 11)
+#define MALLOC_CAP_DEFAULT      (1 << 12)
+
+static inline void *heap_caps_malloc(size_t size, uint32_t caps) { (void)caps; return malloc(size); }
+static inline void *heap_caps_calloc(size_t n, size_t size, uint32_t caps) { (void)caps; return calloc(n, size); }
+static inline void heap_caps_free(void *ptr) { free(ptr); }
+static inline size_t heap_caps_get_free_size(uint32_t caps) { (void)caps; return 0; }
+static inline size_t heap_caps_get_minimum_free_size(uint32_t caps) { (void)caps; return 0; }
+static inline uint32_t esp_get_free_heap_size(void) { return 0; }
+
+#endif // HOST_SHIM_ESP_HEAP_CAPS_H
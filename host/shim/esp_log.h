@@ -0,0 +1,44 @@
+// host/shim/esp_log.h
+#ifndef HOST_SHIM_ESP_LOG_H
+#define HOST_SHIM_ESP_LOG_H
+
+#include <stdio.h>
+
+typedef enum {
+    ESP_LOG_NONE = 0,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+// Nível global dos logs no host (padrão: INFO) e contador de erros registrados.
+// Se esp_log_host_error_tag != NULL, só erros com essa tag são contados.
+extern esp_log_level_t esp_log_host_level;
+extern unsigned esp_log_host_errors;
+extern const char *esp_log_host_error_tag;
+
+/**
+ * @brief Contabiliza um ESP_LOGE (usado pelo runner de testes do host).
+ */
+void esp_log_host_count_error(const char *tag);
+
+/**
+ * @brief Ajusta o nível de log (no host a tag é ignorada: o nível é global).
+ */
+void esp_log_level_set(const char *tag, esp_log_level_t level);
+
+#define HOST_LOG(level, letter, tag, format, ...) do {                          \
+        if ((level) == ESP_LOG_ERROR) esp_log_host_count_error(tag);           \
+        if ((level) <= esp_log_host_level)                                      \
+            fprintf(stderr, letter " %s: " format "\n", tag, ##__VA_ARGS__);    \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) HOST_LOG(ESP_LOG_ERROR,   "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) HOST_LOG(ESP_LOG_WARN,    "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) HOST_LOG(ESP_LOG_INFO,    "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) HOST_LOG(ESP_LOG_DEBUG,   "D", tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) HOST_LOG(ESP_LOG_VERBOSE, "V", tag, format, ##__VA_ARGS__)
+
+#endif // HOST_SHIM_ESP_LOG_H
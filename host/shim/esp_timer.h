@@ -0,0 +1,12 @@
+// host/shim/esp_timer.h
+#ifndef HOST_SHIM_ESP_TIMER_H
+#define HOST_SHIM_ESP_TIMER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Tempo monotônico em microssegundos (CLOCK_MONOTONIC).
+ */
+int64_t esp_timer_get_time(void);
+
+#endif // HOST_SHIM_ESP_TIMER_H
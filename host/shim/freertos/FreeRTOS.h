@@ -0,0 +1,30 @@
+// host/shim/freertos/FreeRTOS.h
+#ifndef HOST_SHIM_FREERTOS_H
+#define HOST_SHIM_FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_heap_caps.h"
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdFALSE             0
+#define pdTRUE              1
+#define pdFAIL              0
+#define pdPASS              1
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFu)
+#define configTICK_RATE_HZ  1000
+#define portTICK_PERIOD_MS  (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+
+#define IRAM_ATTR
+
+// Seções críticas: o host executa as tarefas de forma síncrona, sem preempção
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux)     ((void)(mux))
+#define portEXIT_CRITICAL(mux)      ((void)(mux))
+
+#endif // HOST_SHIM_FREERTOS_H
@@ -0,0 +1,22 @@
+// host/shim/freertos/task.h
+#ifndef HOST_SHIM_FREERTOS_TASK_H
+#define HOST_SHIM_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+/**
+ * @brief No host a "tarefa" roda até o fim na thread chamadora (vTaskDelete(NULL) apenas retorna).
+ */
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *handle);
+
+void vTaskDelay(TickType_t ticks);
+void vTaskDelete(TaskHandle_t task);
+TickType_t xTaskGetTickCount(void);
+
+static inline void taskYIELD(void) {}
+
+#endif // HOST_SHIM_FREERTOS_TASK_H
@@ -0,0 +1,24 @@
+// host/test_main.c
+// Executa run_all_tests() no host. Falha se algum teste registrou ESP_LOGE com a tag
+// TEST_ALL (erros de outras tags vêm de entradas inválidas testadas de propósito).
+#include <stdio.h>
+#include <string.h>
+#include "test.h"
+#include "esp_log.h"
+
+int main(int argc, char **argv) {
+    // Sem "-i", wait_for_enter() não espera pelo terminal
+    if (argc < 2 || strcmp(argv[1], "-i") != 0) {
+        if (!freopen("/dev/null", "r", stdin)) {
+            return 1;
+        }
+    }
+
+    esp_log_host_error_tag = "TEST_ALL";
+    run_all_tests();
+    if (esp_log_host_errors) {
+        fprintf(stderr, "%u teste(s) falharam.\n", esp_log_host_errors);
+        return 1;
+    }
+    return 0;
+}
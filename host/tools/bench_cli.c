@@ -0,0 +1,144 @@
+// host/tools/bench_cli.c
+// Executa a suíte de benchmarks no host (ou só compara um JSON capturado do alvo)
+// e falha quando algum kernel piora além do threshold em relação ao baseline.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <getopt.h>
+
+#include "bench.h"
+#include "def.h"
+#include "esp_log.h"
+
+static const char *TAG_CLI = "BENCH_CLI";
+
+/**
+ * @brief Lê um arquivo inteiro para um buffer terminado em '\0' (liberar com free).
+ */
+static char *read_file(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        ESP_LOGE(TAG_CLI, "Não foi possível abrir %s.", path);
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char *text = malloc((size_t)size + 1);
+    if (text && fread(text, 1, (size_t)size, fp) != (size_t)size) {
+        free(text);
+        text = NULL;
+    }
+    if (text) {
+        text[size] = '\0';
+    }
+    fclose(fp);
+    return text;
+}
+
+/**
+ * @brief Carrega resultados de um JSON de benchmark.
+ */
+static size_t load_results(const char *path, bench_result_t *results, size_t max_results) {
+    char *text = read_file(path);
+    if (!text) {
+        return 0;
+    }
+    size_t count = bench_parse_json(text, results, max_results);
+    free(text);
+    if (count == 0) {
+        ESP_LOGE(TAG_CLI, "Nenhum resultado em %s.", path);
+    }
+    return count;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [opções]\n"
+            "  -o ARQ   grava o JSON em ARQ (padrão: stdout)\n"
+            "  -b ARQ   compara com o baseline em ARQ\n"
+            "  -t T     piora relativa tolerada (padrão 0.10)\n"
+            "  -c ARQ   não executa: compara ARQ (ex.: JSON capturado do alvo) com o baseline\n"
+            "  -q       varredura rápida (256..1024, menos repetições)\n"
+            "  -p       não executa a suíte: exatidão (cents) e custo dos motores de pitch no corpus de notas\n"
+            "  -a       não executa a suíte: caminho completo x afinador (CPU, cents, latência) em ANALYSIS_HOP e ANALYSIS_HOP/4\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    const char *out_path = NULL, *baseline_path = NULL, *current_path = NULL;
+    float threshold = 0.10f;
+    bench_config_t cfg = BENCH_CONFIG_DEFAULT();
+
+    int opt;
+    bool pitch_corpus = false, tuner_compare = false;
+    while ((opt = getopt(argc, argv, "o:b:t:c:qpa")) != -1) {
+        switch (opt) {
+            case 'o': out_path = optarg; break;
+            case 'b': baseline_path = optarg; break;
+            case 't': threshold = strtof(optarg, NULL); break;
+            case 'c': current_path = optarg; break;
+            case 'q': cfg.max_n = 1024; cfg.max_reps = 15; cfg.budget_us = 20000; break;
+            case 'p': pitch_corpus = true; break;
+            case 'a': tuner_compare = true; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (current_path && !baseline_path) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (pitch_corpus) {
+        bench_pitch_result_t pitch[BENCH_PITCH_ENGINES];
+        size_t n_pitch = bench_pitch_corpus(BUFFER_SIZE, pitch, BENCH_PITCH_ENGINES);
+        bench_pitch_print(stdout, pitch, n_pitch);
+        return n_pitch > 0 ? 0 : 1;
+    }
+
+    if (tuner_compare) {
+        // Hop do pipeline e um hop menor (latência menor, mais janelas por segundo)
+        const size_t hops[] = {ANALYSIS_HOP, ANALYSIS_HOP / 4};
+        bench_tuner_result_t tuner[BENCH_TUNER_PATHS];
+        for (size_t i = 0; i < sizeof(hops) / sizeof(hops[0]); i++) {
+            size_t n_tuner = bench_tuner_compare(hops[i], tuner, BENCH_TUNER_PATHS);
+            if (n_tuner == 0) {
+                return 1;
+            }
+            bench_tuner_print(stdout, tuner, n_tuner);
+        }
+        return 0;
+    }
+
+    static bench_result_t current[BENCH_MAX_RESULTS];
+    static bench_result_t baseline[BENCH_MAX_RESULTS];
+    size_t n_current;
+
+    if (current_path) {
+        n_current = load_results(current_path, current, BENCH_MAX_RESULTS);
+    } else {
+        n_current = bench_run_suite(&cfg, current, BENCH_MAX_RESULTS);
+        FILE *out = out_path ? fopen(out_path, "w") : stdout;
+        if (!out) {
+            ESP_LOGE(TAG_CLI, "Não foi possível criar %s.", out_path);
+            return 1;
+        }
+        bench_write_json(out, current, n_current);
+        if (out != stdout) {
+            fclose(out);
+        }
+    }
+    if (n_current == 0) {
+        return 1;
+    }
+
+    if (baseline_path) {
+        size_t n_baseline = load_results(baseline_path, baseline, BENCH_MAX_RESULTS);
+        if (n_baseline == 0) {
+            return 1;
+        }
+        int regressions = bench_compare(current, n_current, baseline, n_baseline, threshold);
+        return regressions == 0 ? 0 : 1;
+    }
+    return 0;
+}
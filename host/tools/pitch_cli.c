@@ -0,0 +1,414 @@
+// host/tools/pitch_cli.c
+// Analisador offline: lê um WAV e passa cada janela pela mesma cadeia do pipeline (condition -> spectrum/pitch -> note)
+// (janela -> band-pass -> FFT -> [decimação] -> YIN -> nota), imprimindo resultado e tempo por frame.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <getopt.h>
+
+#include "def.h"
+#include "utils.h"
+#include "filters.h"
+#include "fft.h"
+#include "yin.h"
+#include "decimator.h"
+#include "tuner.h"
+#include "fixed_dsp.h"
+#include "gate.h"
+#include "tuner_bank.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG_CLI = "PITCH_CLI";
+
+/**
+ * @brief Leitor incremental de WAV (PCM 16/24/32 bits ou float 32, qualquer número de canais).
+ */
+typedef struct {
+    FILE *fp;
+    uint16_t format;            // 1: PCM inteiro, 3: IEEE float
+    uint16_t channels;
+    uint32_t sample_rate;
+    uint16_t bits;
+    uint32_t data_left;         // Bytes restantes no chunk "data"
+} wav_reader_t;
+
+static uint32_t rd_u32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint16_t rd_u16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+/**
+ * @brief Abre o WAV e posiciona no início das amostras.
+ * @return 0 em sucesso, -1 em erro.
+ */
+static int wav_open(wav_reader_t *w, const char *path) {
+    memset(w, 0, sizeof(*w));
+    w->fp = fopen(path, "rb");
+    if (!w->fp) {
+        ESP_LOGE(TAG_CLI, "Não foi possível abrir %s.", path);
+        return -1;
+    }
+
+    uint8_t hdr[12];
+    if (fread(hdr, 1, 12, w->fp) != 12 || memcmp(hdr, "RIFF", 4) != 0 || memcmp(hdr + 8, "WAVE", 4) != 0) {
+        ESP_LOGE(TAG_CLI, "%s não é um arquivo RIFF/WAVE.", path);
+        return -1;
+    }
+
+    int have_fmt = 0;
+    uint8_t ck[8];
+    while (fread(ck, 1, 8, w->fp) == 8) {
+        uint32_t size = rd_u32(ck + 4);
+        if (memcmp(ck, "fmt ", 4) == 0) {
+            uint8_t fmt[40] = {0};
+            size_t take = size < sizeof(fmt) ? size : sizeof(fmt);
+            if (fread(fmt, 1, take, w->fp) != take) {
+                break;
+            }
+            w->format = rd_u16(fmt);
+            w->channels = rd_u16(fmt + 2);
+            w->sample_rate = rd_u32(fmt + 4);
+            w->bits = rd_u16(fmt + 14);
+            if (w->format == 0xFFFE && size >= 26) {
+                w->format = rd_u16(fmt + 24); // WAVE_FORMAT_EXTENSIBLE: subformato
+            }
+            fseek(w->fp, (long)(size - take + (size & 1)), SEEK_CUR);
+            have_fmt = 1;
+        } else if (memcmp(ck, "data", 4) == 0) {
+            if (!have_fmt) {
+                break;
+            }
+            w->data_left = size;
+            int pcm_ok = (w->format == 1 && (w->bits == 16 || w->bits == 24 || w->bits == 32));
+            int flt_ok = (w->format == 3 && w->bits == 32);
+            if ((!pcm_ok && !flt_ok) || w->channels == 0) {
+                ESP_LOGE(TAG_CLI, "Formato WAV não suportado (formato %u, %u bits).", w->format, w->bits);
+                return -1;
+            }
+            return 0;
+        } else {
+            fseek(w->fp, (long)(size + (size & 1)), SEEK_CUR);
+        }
+    }
+    ESP_LOGE(TAG_CLI, "WAV sem chunks fmt/data válidos.");
+    return -1;
+}
+
+/**
+ * @brief Lê até length frames, convertendo para float em [-1, 1] (média dos canais).
+ * @return Número de frames lidos.
+ */
+static size_t wav_read(wav_reader_t *w, float *out, size_t length) {
+    size_t bytes_per_sample = w->bits / 8;
+    size_t frame_bytes = bytes_per_sample * w->channels;
+    uint8_t frame[8 * 4 * 8];
+    if (frame_bytes > sizeof(frame)) {
+        return 0;
+    }
+
+    size_t n = 0;
+    while (n < length && w->data_left >= frame_bytes) {
+        if (fread(frame, 1, frame_bytes, w->fp) != frame_bytes) {
+            break;
+        }
+        w->data_left -= (uint32_t)frame_bytes;
+
+        float acc = 0.0f;
+        for (uint16_t c = 0; c < w->channels; c++) {
+            const uint8_t *p = frame + c * bytes_per_sample;
+            float v;
+            if (w->format == 3) {
+                uint32_t u = rd_u32(p);
+                memcpy(&v, &u, sizeof(v));
+            } else if (w->bits == 16) {
+                v = (float)(int16_t)rd_u16(p) / 32768.0f;
+            } else if (w->bits == 24) {
+                int32_t s = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) >> 8;
+                v = (float)s / 8388608.0f;
+            } else {
+                v = (float)(int32_t)rd_u32(p) / 2147483648.0f;
+            }
+            acc += v;
+        }
+        out[n++] = acc / (float)w->channels;
+    }
+    return n;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [opções] arquivo.wav\n"
+            "  -w N   tamanho da janela (potência de 2, padrão %d)\n"
+            "  -H N   avanço entre janelas (padrão %d)\n"
+            "  -t T   threshold do YIN (padrão %.2f)\n"
+            "  -d N   decimação antes do YIN (potência de 2, padrão %d; 1 desativa)\n"
+            "  -e     YIN com saída antecipada (para no primeiro mínimo abaixo do threshold)\n"
+            "  -T S   YIN com rastreamento: travado numa nota, só os lags a ±S semitons do período anterior\n"
+            "  -x     usa o caminho em ponto fixo (Q31/Q15)\n"
+            "  -g     sem o gate de energia (toda janela é analisada)\n"
+            "  -a I   afinador: banco de Goertzel nas cordas de I (guitar, bass, ukulele, violin, cavaquinho),\n"
+            "         no lugar da FFT e do YIN (não combina com -x)\n"
+            "  -v     logs da biblioteca (INFO)\n",
+            prog, BUFFER_SIZE, ANALYSIS_HOP, (double)YIN_THRESHOLD, YIN_DECIMATION);
+}
+
+int main(int argc, char **argv) {
+    size_t window = BUFFER_SIZE;
+    size_t hop = ANALYSIS_HOP;
+    float threshold = YIN_THRESHOLD;
+    size_t decimation = YIN_DECIMATION;
+    int fixed = 0;
+    int early_exit = 0;
+    int gate_enabled = GATE_ENABLED;
+    float track_semitones = 0.0f;
+    const char *instrument_name = NULL;
+    int verbose = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "w:H:t:d:eT:xga:v")) != -1) {
+        switch (opt) {
+            case 'w': window = (size_t)strtoul(optarg, NULL, 10); break;
+            case 'H': hop = (size_t)strtoul(optarg, NULL, 10); break;
+            case 't': threshold = strtof(optarg, NULL); break;
+            case 'd': decimation = (size_t)strtoul(optarg, NULL, 10); break;
+            case 'e': early_exit = 1; break;
+            case 'T': track_semitones = strtof(optarg, NULL); break;
+            case 'x': fixed = 1; break;
+            case 'g': gate_enabled = 0; break;
+            case 'a': instrument_name = optarg; break;
+            case 'v': verbose = 1; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (optind != argc - 1 || window < 64 || (window & (window - 1)) != 0 || hop == 0 || hop > window ||
+        decimation == 0 || (decimation & (decimation - 1)) != 0 || window / decimation < 64 ||
+        (instrument_name && fixed)) {
+        usage(argv[0]);
+        return 2;
+    }
+    esp_log_level_set("*", verbose ? ESP_LOG_INFO : ESP_LOG_WARN);
+
+    wav_reader_t wav;
+    if (wav_open(&wav, argv[optind]) != 0) {
+        return 1;
+    }
+    float sr = (float)wav.sample_rate;
+    size_t fft_n = window / 2;          // Como no alvo: FBUF_SIZE = BUFFER_SIZE / 2
+    size_t bins = fft_n / 2 + 1;
+    float high = HIGH_FREQ < sr * 0.45f ? HIGH_FREQ : sr * 0.45f;
+    if (fixed) {
+        decimation = 1; // Como no alvo: o caminho em ponto fixo roda o YIN na taxa cheia
+    }
+
+    // Estado da cadeia (o mesmo dos estágios do pipeline)
+    decimator_t decimator;
+    float dec_band = 0.4f * sr / (float)decimation; // Banda preservada limitada pela taxa decimada
+    if (decimator_init(&decimator, decimation, sr, high < dec_band ? high : dec_band, DECIM_ATTEN_DB, window) != ESP_OK) {
+        return 1;
+    }
+    Yin yin;
+    if (yin_init(&yin, window / decimation, decimator.output_rate, threshold, YIN_THRESHOLD_ADAPTIVE, 0.02f, 0.1f, 0.01f,
+                 fixed ? YIN_DIFF_DIRECT : YIN_DIFF_METHOD) != ESP_OK ||
+        (early_exit && yin_set_early_exit(&yin, true) != ESP_OK) ||
+        (track_semitones > 0.0f && yin_set_tracking(&yin, true, track_semitones) != ESP_OK)) {
+        return 1;
+    }
+    sos_filter_t bandpass;
+    if (sos_input_filter_init(&bandpass, sr, LOW_FREQ, high) != ESP_OK) {
+        return 1;
+    }
+    sos_q31_t bandpass_q31;
+    sos_q31_from_float(&bandpass_q31, &bandpass);
+    energy_gate_t gate;
+    if (energy_gate_init(&gate, GATE_OPEN_DBFS, GATE_CLOSE_DBFS, GATE_PEAK_DBFS, GATE_HOLD_FRAMES) != ESP_OK) {
+        return 1;
+    }
+    // Afinador: o banco vê a mesma janela decimada que o YIN veria
+    tuner_bank_t bank = {0};
+    const tuner_instrument_t *instrument = instrument_name ? tuner_instrument_find(instrument_name) : NULL;
+    if (instrument_name && (!instrument ||
+        tuner_bank_init(&bank, instrument, window / decimation, decimator.output_rate, TUNER_HARMONICS, TUNER_RANGE_CENTS) != ESP_OK)) {
+        ESP_LOGE(TAG_CLI, "Afinador indisponível para \"%s\".", instrument_name);
+        return 1;
+    }
+
+    float *ring  = calloc(window, sizeof(float));  // Últimas window amostras
+    float *work  = malloc(window * sizeof(float));
+    float *dec   = malloc(window / decimation * sizeof(float));
+    float *breal = malloc(bins * sizeof(float));
+    float *bimg  = malloc(bins * sizeof(float));
+    float *mag   = calloc(bins, sizeof(float));
+    q31_t *fx_buf  = malloc(window * sizeof(q31_t));
+    q15_t *fx_q15  = malloc(window * sizeof(q15_t));
+    q15_t *fx_spec = malloc(2 * fft_n * sizeof(q15_t));
+    fx_window_t fx_win = {0};
+    fx_fft_t fx_fft = {0};
+    if (!ring || !work || !dec || !breal || !bimg || !mag || !fx_buf || !fx_q15 || !fx_spec ||
+        (fixed && (fx_window_init(&fx_win, window, 1) != ESP_OK || fx_fft_init(&fx_fft, fft_n) != ESP_OK))) {
+        ESP_LOGE(TAG_CLI, "Falha ao alocar buffers.");
+        return 1;
+    }
+
+    if (instrument) {
+        printf("frame;time_s;tuner_hz;string;cents;us\n");
+    } else {
+        printf("frame;time_s;fft_peak_hz;yin_hz;note;us\n");
+    }
+
+    size_t filled = wav_read(&wav, ring, window);
+    size_t frame = 0;
+    int64_t total_us = 0, max_us = 0;
+    size_t voiced = 0;
+    size_t total_taus = 0;
+    size_t total_filters = 0;
+
+    while (filled == window) {
+        int64_t t0 = esp_timer_get_time();
+
+        float pitch = -1.0f;
+        int ret = -1;
+        note_t tuned;
+
+        // Gate de energia, como no estágio condition (nível da janela antes do janelamento)
+        bool silent = false;
+        if (gate_enabled) {
+            audio_level_t level;
+            audio_level_reset(&level);
+            audio_level_accumulate(&level, ring, window);
+            bool was_open = gate.open;
+            silent = !energy_gate_process(&gate, &level);
+            if (!silent && !was_open) {
+                sos_reset(&bandpass);
+                sos_q31_from_float(&bandpass_q31, &bandpass);
+            }
+        }
+
+        if (silent) {
+            memset(mag, 0, bins * sizeof(float));
+        } else if (instrument) {
+            // Sem FFT: o afinador só avalia as cordas do instrumento
+            memcpy(work, ring, window * sizeof(float));
+            apply_window(work, window, 1);
+            sos_process(&bandpass, work, work, window);
+            const float *in = work;
+            if (decimation > 1) {
+                decimator_reset(&decimator);
+                decimator_process(&decimator, work, window, dec);
+                in = dec;
+            }
+            ret = tuner_bank_process(&bank, in, &pitch, &tuned);
+        } else if (fixed) {
+            for (size_t i = 0; i < window; i++) {
+                fx_buf[i] = fx_float_to_q31(ring[i]);
+            }
+            fx_window_apply_q31(&fx_win, fx_buf);
+            sos_q31_process(&bandpass_q31, fx_buf, fx_buf, window);
+            int exponent = fx_q31_to_q15_block(fx_buf, fx_q15, window);
+            for (size_t i = 0; i < fft_n; i++) {
+                fx_spec[2 * i] = fx_q15[i];
+                fx_spec[2 * i + 1] = 0;
+            }
+            fx_fft_q15(&fx_fft, fx_spec, &exponent);
+            fx_magnitude_q15(fx_spec, exponent, mag, fft_n);
+            ret = yin_detect_pitch_q15(&yin, fx_q15, &pitch);
+        } else {
+            memcpy(work, ring, window * sizeof(float));
+            apply_window(work, window, 1);
+            sos_process(&bandpass, work, work, window);
+            rfft(work, breal, bimg, fft_n);
+            calculate_magnitude_rfft(breal, bimg, mag, fft_n);
+            if (decimation > 1) {
+                decimator_reset(&decimator);
+                decimator_process(&decimator, work, window, dec);
+                ret = yin_detect_pitch(&yin, dec, &pitch);
+            } else {
+                ret = yin_detect_pitch(&yin, work, &pitch);
+            }
+        }
+
+        int64_t us = esp_timer_get_time() - t0;
+        total_taus += (silent || instrument) ? 0 : yin_taus_evaluated(&yin);
+        total_filters += silent ? 0 : tuner_bank_filters_evaluated(&bank);
+        total_us += us;
+        if (us > max_us) {
+            max_us = us;
+        }
+
+        // Pico do espectro (ignora DC)
+        size_t peak = 1;
+        for (size_t k = 2; k < bins; k++) {
+            if (mag[k] > mag[peak]) {
+                peak = k;
+            }
+        }
+        float peak_hz = silent ? 0.0f : (float)peak * sr / (float)fft_n;
+
+        note_t note;
+        char note_str[16] = "-";
+        if (instrument) {
+            if (silent) {
+                snprintf(note_str, sizeof(note_str), "silence");
+            } else if (ret == 0) {
+                voiced++;
+                snprintf(note_str, sizeof(note_str), "%s%d", tuned.note, tuned.octave);
+            }
+        } else if (silent) {
+            snprintf(note_str, sizeof(note_str), "silence");
+            pitch = -1.0f;
+        } else if (ret == 0 && pitch > 0.0f) {
+            voiced++;
+            if (get_note(pitch, &note) == 0) {
+                snprintf(note_str, sizeof(note_str), "%s%d", note.note, note.octave);
+            }
+        } else {
+            pitch = -1.0f;
+        }
+
+        if (instrument) {
+            printf("%zu;%.4f;%.2f;%s;%.1f;%lld\n", frame, (double)(frame * hop) / sr, (double)pitch, note_str,
+                   (double)((ret == 0 && !silent) ? tuned.cents : 0.0f), (long long)us);
+        } else {
+            printf("%zu;%.4f;%.2f;%.2f;%s;%lld\n", frame, (double)(frame * hop) / sr,
+                   (double)peak_hz, (double)pitch, note_str, (long long)us);
+        }
+        frame++;
+
+        // Avança hop amostras
+        memmove(ring, ring + hop, (window - hop) * sizeof(float));
+        filled = (window - hop) + wav_read(&wav, ring + (window - hop), hop);
+    }
+
+    double audio_s = (double)(frame ? (frame - 1) * hop + window : 0) / sr;
+    fprintf(stderr, "%zu frames (%zu com pitch) | média %.1f us, máx %lld us por frame | %.1fx tempo real (%s)\n",
+            frame, voiced, frame ? (double)total_us / frame : 0.0, (long long)max_us,
+            total_us ? audio_s * 1e6 / (double)total_us : 0.0, fixed ? "ponto fixo" : "float");
+    if (instrument) {
+        fprintf(stderr, "Afinador %s: média de %.1f filtros de Goertzel por frame (%zu amostras cada)\n",
+                instrument->name, frame ? (double)total_filters / frame : 0.0, bank.length);
+    } else {
+        fprintf(stderr, "YIN: média de %.1f lags avaliados por frame (faixa %zu..%zu)\n",
+                frame ? (double)total_taus / frame : 0.0, yin.config.tau_min, yin.config.tau_max);
+    }
+    if (gate_enabled) {
+        energy_gate_stats_t gs;
+        energy_gate_get_stats(&gate, &gs);
+        fprintf(stderr, "Gate: %" PRIu32 " de %" PRIu32 " frames em silêncio (%.1f%%), %" PRIu32 " aberturas\n",
+                gs.skipped, gs.frames, 100.0 * gs.skip_ratio, gs.opens);
+    }
+    if (yin.config.tracking) {
+        yin_tracking_stats_t ts;
+        yin_get_tracking_stats(&yin, &ts);
+        fprintf(stderr, "Rastreamento: %" PRIu32 " de %" PRIu32 " frames na vizinhança | %" PRIu32 " travas, %" PRIu32 " destravas\n",
+                ts.tracked, ts.frames, ts.locks, ts.unlocks);
+    }
+
+    yin_deinit(&yin);
+    decimator_deinit(&decimator);
+    fx_window_deinit(&fx_win);
+    fx_fft_deinit(&fx_fft);
+    free(ring); free(work); free(dec); free(breal); free(bimg); free(mag);
+    free(fx_buf); free(fx_q15); free(fx_spec);
+    fclose(wav.fp);
+    return 0;
+}
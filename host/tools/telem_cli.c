@@ -0,0 +1,202 @@
+// host/tools/telem_cli.c
+// Decodificador dos frames binários do estágio emit (PROCESSING 2): lê o stream da serial
+// (ou de um arquivo capturado), imprime um CSV por frame e pode regravar/reproduzir o stream
+// limpo (só frames válidos), no ritmo original dos timestamps.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "telemetry.h"
+#include "esp_log.h"
+
+static const char *TAG_CLI = "TELEM_CLI";
+
+static const char *note_names[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+
+/**
+ * @brief Opções e estado da saída.
+ */
+typedef struct {
+    FILE *csv;                  // CSV por frame (NULL: sem CSV)
+    FILE *out;                  // Stream regravado (NULL: sem regravação)
+    bool vectors;               // Inclui espectro e amostras no CSV
+    bool replay;                // Respeita os intervalos dos timestamps
+    bool have_ts;
+    uint32_t last_ts;
+} cli_state_t;
+
+static void sleep_us(uint32_t us) {
+    struct timespec ts = {.tv_sec = us / 1000000u, .tv_nsec = (long)(us % 1000000u) * 1000L};
+    nanosleep(&ts, NULL);
+}
+
+static void print_vector(FILE *fp, const float *v, size_t n) {
+    fputc(';', fp);
+    for (size_t i = 0; i < n; i++) {
+        fprintf(fp, (i + 1 < n) ? "%g," : "%g", v[i]);
+    }
+}
+
+/**
+ * @brief Um frame válido: espera o intervalo (replay), imprime o CSV e regrava os bytes originais.
+ */
+static void on_frame(const telem_frame_t *f, const uint8_t *raw, size_t raw_len, void *user) {
+    cli_state_t *st = (cli_state_t *)user;
+
+    if (st->replay && st->have_ts) {
+        uint32_t dt = f->timestamp_us - st->last_ts;
+        if (dt < 10000000u) {   // Saltos maiores (reset do dispositivo) não esperam
+            sleep_us(dt);
+        }
+    }
+    st->have_ts = true;
+    st->last_ts = f->timestamp_us;
+
+    if (st->csv) {
+        char note[8] = "-";
+        if (f->flags & TELEM_FLAG_SILENCE) {
+            snprintf(note, sizeof(note), "silence");
+        } else if (f->note != TELEM_NOTE_NONE) {
+            snprintf(note, sizeof(note), "%s%d", note_names[f->note % 12], f->note / 12 - 1);
+        }
+        fprintf(st->csv, "%" PRIu32 ";%" PRIu32 ";%.2f;%s;%+.2f;%.2f", f->seq, f->timestamp_us,
+                f->fundamental, note, f->cents, f->confidence);
+        if (st->vectors) {
+            print_vector(st->csv, f->spectrum, f->spectrum_len);
+            print_vector(st->csv, f->samples, f->samples_len);
+        }
+        fputc('\n', st->csv);
+        fflush(st->csv);
+    }
+
+    if (st->out) {
+        fwrite(raw, 1, raw_len, st->out);
+        fflush(st->out);
+    }
+}
+
+/**
+ * @brief Gera n frames sintéticos (glissando de A2 a A5 com espectro e amostras).
+ */
+static int generate(cli_state_t *st, size_t n, uint8_t flags) {
+    enum { BINS = 257, SAMPLES = 512 };
+    static float spectrum[BINS], samples[SAMPLES];
+    static uint8_t buf[TELEM_HEADER_SIZE + 2 * (6 + 2 * SAMPLES) + TELEM_CRC_SIZE];
+    const float fs = 48000.0f, hop_s = 512.0f / fs;
+
+    for (size_t k = 0; k < n; k++) {
+        float midi = 45.0f + 36.0f * (float)k / (float)(n > 1 ? n - 1 : 1);
+        float f0 = 440.0f * powf(2.0f, (midi - 69.0f) / 12.0f);
+        for (size_t i = 0; i < SAMPLES; i++) {
+            samples[i] = 0.5f * sinf(2.0f * (float)M_PI * f0 * (float)i / fs);
+        }
+        for (size_t b = 0; b < BINS; b++) {
+            float df = (float)b * fs / (2.0f * (BINS - 1)) - f0;
+            spectrum[b] = 100.0f * expf(-df * df / (2.0f * 200.0f * 200.0f));
+        }
+        int rounded = (int)lroundf(midi);
+        telem_frame_t f = {
+            .flags = flags,
+            .seq = (uint32_t)k,
+            .timestamp_us = (uint32_t)((float)k * hop_s * 1e6f),
+            .fundamental = f0,
+            .cents = 100.0f * (midi - (float)rounded),
+            .note = (uint8_t)rounded,
+            .confidence = 0.95f,
+            .spectrum = spectrum, .spectrum_len = BINS,
+            .samples = samples, .samples_len = SAMPLES,
+        };
+        size_t len = telem_encode(&f, buf, sizeof(buf));
+        if (len == 0) {
+            return 1;
+        }
+        on_frame(&f, buf, len, st);
+    }
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [opções] [ARQ]\n"
+            "  ARQ      stream capturado ou porta serial já configurada (padrão: stdin)\n"
+            "  -o ARQ   regrava só os frames válidos em ARQ ('-': stdout, desliga o CSV)\n"
+            "  -r       reproduz no ritmo dos timestamps\n"
+            "  -v       inclui espectro e amostras no CSV\n"
+            "  -q       sem CSV (só estatísticas)\n"
+            "  -g N     gera N frames sintéticos em vez de ler (teste/demonstração)\n"
+            "  -f FLAGS vetores dos frames gerados: s = espectro, t = amostras, h = float16 (padrão: s)\n"
+            "CSV: seq;timestamp_us;fundamental;nota;cents;confianca[;espectro;amostras]\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    const char *out_path = NULL;
+    const char *gen_flags = "s";
+    size_t gen_frames = 0;
+    cli_state_t st = {.csv = stdout};
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:rvqg:f:")) != -1) {
+        switch (opt) {
+            case 'o': out_path = optarg; break;
+            case 'r': st.replay = true; break;
+            case 'v': st.vectors = true; break;
+            case 'q': st.csv = NULL; break;
+            case 'g': gen_frames = (size_t)strtoul(optarg, NULL, 10); break;
+            case 'f': gen_flags = optarg; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+
+    if (out_path) {
+        if (strcmp(out_path, "-") == 0) {
+            st.out = stdout;
+            st.csv = NULL;
+        } else if (!(st.out = fopen(out_path, "wb"))) {
+            ESP_LOGE(TAG_CLI, "Não foi possível criar %s.", out_path);
+            return 1;
+        }
+    }
+
+    int ret = 0;
+    if (gen_frames > 0) {
+        uint8_t flags = 0;
+        flags |= strchr(gen_flags, 's') ? TELEM_FLAG_SPECTRUM : 0;
+        flags |= strchr(gen_flags, 't') ? TELEM_FLAG_SAMPLES : 0;
+        flags |= strchr(gen_flags, 'h') ? TELEM_FLAG_HALF : 0;
+        ret = generate(&st, gen_frames, flags);
+    } else {
+        FILE *in = stdin;
+        if (optind < argc && !(in = fopen(argv[optind], "rb"))) {
+            ESP_LOGE(TAG_CLI, "Não foi possível abrir %s.", argv[optind]);
+            return 1;
+        }
+        telem_decoder_t dec;
+        if (telem_decoder_init(&dec, TELEM_MAX_VECTOR) != ESP_OK) {
+            return 1;
+        }
+        uint8_t chunk[4096];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+            telem_decoder_push(&dec, chunk, n, on_frame, &st);
+        }
+        fprintf(stderr, "frames=%" PRIu32 " crc_erros=%" PRIu32 " bytes_pulados=%" PRIu32 " perdidos=%" PRIu32 "\n",
+                dec.stats.frames, dec.stats.crc_errors, dec.stats.bytes_skipped, dec.stats.seq_gaps);
+        ret = (dec.stats.frames > 0) ? 0 : 1;
+        telem_decoder_deinit(&dec);
+        if (in != stdin) {
+            fclose(in);
+        }
+    }
+
+    if (st.out && st.out != stdout) {
+        fclose(st.out);
+    }
+    return ret;
+}
@@ -8,7 +8,6 @@
 // FreeRTOS
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/queue.h"
 
 // ESP-IDF Drivers
 #include "driver/gptimer.h"
@@ -21,35 +20,78 @@
 #include "mic.h"     
 #include "filters.h"
 #include "yin.h"
+#include "pitch_engine.h"
 #include "tuner.h"
 #include "fft.h"
 #include "test.h"
 #include "utils.h"    // se estiver usando
+#include "pool.h"
+#include "audio_ring.h"
+#include "fixed_dsp.h"
+#include "bench.h"
+#include "trace.h"
+#include "decimator.h"
+#include "stage_graph.h"
+#include "telemetry.h"
+#include "tuner_bank.h"
 
 static const char *TAG = "MAIN";
-static const char *TAG_TMIC = "MIC_TASK";
-static const char *TAG_TAUD = "AUD_TASK";
-static const char *TAG_TCOM = "COM_TASK";
+static const char *TAG_SCND = "CONDITION";
+static const char *TAG_SPIT = "PITCH";
+static const char *TAG_SNOT = "NOTE";
+static const char *TAG_TCON = "CON_TASK";
 
 // Estruturas de Dados
 
 typedef struct {
-    float  samples[BUFFER_SIZE];
-    size_t length;
-} raw_block_t;
-
-typedef struct {
-    float  *samples;   // Dados no domínio do tempo
+    float  samples[BUFFER_SIZE];   // Dados no domínio do tempo
     size_t length;                 // Número de amostras
-    float  *frequency;   // Frequências correspondentes aos bins da FFT
-    float  *magnitude;   // Magnitudes da FFT
+    float  frequency[RFFT_BINS];   // Frequências correspondentes aos bins da FFT
+    float  magnitude[RFFT_BINS];   // Magnitudes da FFT
     float  fund_frequency;         // Frequência fundamental detectada
     char   note[16];               // Nota correspondente (ex.: "A4")
+    int    midi;                   // Número MIDI da nota (-1 sem nota)
+    float  cents;                  // Desvio em relação à nota
+    float  confidence;             // Confiança do YIN (0..1)
+    uint32_t frame_id;             // Sequência da janela (correlaciona os eventos de trace)
+    int64_t timestamp_us;          // esp_timer na leitura da janela do ring
+    bool   silent;                 // Gate de energia fechado: só o resultado compacto segue
+    float  level_dbfs;             // RMS da janela (sem DC) medido na conversão
+#if DSP_PATH == DSP_PATH_FIXED
+    q15_t  samples_q15[BUFFER_SIZE]; // Janela condicionada em Q15 (entrada da FFT e do YIN)
+    int    exponent;               // Expoente de bloco de samples_q15
+#endif
 } audio_data_t;
 
-// Filas globais
-static QueueHandle_t xRawQueue    = NULL; // mic_task -> audio_task
-static QueueHandle_t xResultQueue = NULL; // audio_task -> comm_task
+/**
+ * @brief Estágios do pipeline (ids do grafo, na ordem de declaração).
+ *        spectrum e pitch só dependem de condition, então rodam em paralelo por frame.
+ */
+enum {
+    STAGE_CAPTURE = 0,  // I2S -> ring (laço livre, sem frames)
+    STAGE_CONDITION,    // Ring -> janela + passa-banda (fonte dos frames)
+    STAGE_SPECTRUM,     // FFT + magnitude
+    STAGE_PITCH,        // Decimação + YIN
+    STAGE_NOTE,         // Frequências dos bins + nota (espera spectrum e pitch)
+    STAGE_EMIT,         // Saída pelo console (texto ou frames binários)
+    STAGE_COUNT
+};
+
+// Grafo de estágios: os frames (audio_data_t) vêm do pool do grafo e trafegam por índice
+static stage_graph_t pipeline;
+
+// Ring de frames int32 do I2S (capture -> condition, sem cópia)
+static audio_ring_t  mic_ring;
+static TaskHandle_t  condition_task_handle = NULL; // Notificado a cada escrita no ring
+
+// Contadores da captura contínua (cada campo tem um único escritor)
+typedef struct {
+    volatile uint32_t frames_captured;   // Frames gravados no ring (capture)
+    volatile uint32_t frames_overrun;    // Frames descartados com o ring cheio (capture)
+    volatile uint32_t windows_skipped;   // Hops pulados por atraso da análise (condition)
+} capture_stats_t;
+
+static capture_stats_t capture_stats = {0};
 
 #if TESTE == 1
 float phase = 0.0f;
@@ -59,6 +101,105 @@ float amplitudes_waves[NUM_WAVES]  = {0.7f, 1.0f, 0.25f};
 float phases_waves[NUM_WAVES]      = {0.0f, 0.0f, 0.0f};
 #endif
 
+#if TESTE != 0
+/**
+ * @brief Escreve um bloco de teste (float) no ring no formato do INMP441.
+ */
+static size_t ring_write_test_signal(const float *src, size_t length)
+{
+    size_t written = 0;
+    while (written < length) {
+        int32_t *dst = NULL;
+        size_t span = audio_ring_write_acquire(&mic_ring, &dst);
+        if (span == 0) {
+            break;
+        }
+        if (span > length - written) {
+            span = length - written;
+        }
+        for (size_t i = 0; i < span; i++) {
+            dst[i] = (int32_t)(src[written + i] * 8388607.0f) * 256; // 24 bits alinhados à esquerda
+        }
+        audio_ring_write_commit(&mic_ring, span);
+        written += span;
+    }
+    return written;
+}
+#endif
+
+/** ----------------------------------------------------------------
+ *  Estado de cada estágio (tocado apenas pela task do próprio estágio)
+ *  ---------------------------------------------------------------- */
+typedef struct {
+    float *test_buf;                // Bloco do sinal de teste (TESTE != 0)
+    TickType_t last_wake;           // Ritmo simulado do I2S (TESTE != 0)
+} capture_state_t;
+
+typedef struct {
+    sos_filter_t bandpass;          // Passa-banda Butterworth em cascata SOS (+ notch, se configurado)
+#if DSP_PATH == DSP_PATH_FIXED
+    sos_q31_t bandpass_q31;
+    fx_window_t window_q15;
+    q31_t *fx_buf;                  // Janela em Q31 antes da normalização para Q15
+#else
+    const float *hann;              // Tabela da janela Hann (cache de janelas, RAM interna)
+#endif
+#if GATE_ENABLED
+    energy_gate_t gate;             // Silêncio: a janela não passa do condition
+#endif
+} condition_state_t;
+
+typedef struct {
+#if DSP_PATH == DSP_PATH_FIXED
+    fx_fft_t fft_q15;
+    q15_t *fx_spec;                 // FFT intercalada em Q15
+#else
+    float *breal, *bimg;            // Scratch da RFFT
+#endif
+} spectrum_state_t;
+
+typedef struct {
+    pitch_engine_t engines;         // YIN e MPM (troca em tempo de execução pelo console)
+    smoothing_t smoothing;
+    bool in_silence;                // Última janela foi silêncio (reset dos detectores na transição)
+#if PITCH_ENGINE == PITCH_ENGINE_HPS || PITCH_ENGINE == PITCH_ENGINE_HPS_YIN
+    hps_t hps;                      // Sobre out->magnitude (o estágio pitch passa a esperar spectrum)
+#elif PITCH_ENGINE == PITCH_ENGINE_TUNER
+    tuner_bank_t bank;              // Goertzel só nas cordas de TUNER_INSTRUMENT (sem YIN)
+#endif
+#if DSP_PATH == DSP_PATH_FLOAT && YIN_DECIMATION > 1
+    decimator_t decimator;          // O YIN (ou o afinador) vê a janela a YIN_SAMPLE_RATE, a FFT segue na taxa cheia
+    float *yin_buf;
+#endif
+#if YIN_PARALLEL_WORKERS > 1
+    par_executor_t executor;        // Criado na primeira janela, para o worker ficar no outro núcleo
+    bool executor_ready;
+#endif
+} pitch_state_t;
+
+#if PROCESSING == 2
+typedef struct {
+    uint8_t *buf;                   // Frame de telemetria montado antes da escrita única
+    size_t capacity;
+} emit_state_t;
+#endif
+
+static capture_state_t   capture_state;
+static condition_state_t condition_state;
+static spectrum_state_t  spectrum_state;
+static pitch_state_t     pitch_state;
+#if PROCESSING == 2
+static emit_state_t      emit_state;
+#define EMIT_CONTEXT     (&emit_state)
+#else
+#define EMIT_CONTEXT     NULL
+#endif
+#if PITCH_ENGINE == PITCH_ENGINE_YIN || PITCH_ENGINE == PITCH_ENGINE_TUNER
+#define PITCH_INPUTS     STAGE_INPUT(STAGE_CONDITION)
+#else
+#define PITCH_INPUTS     STAGE_INPUT(STAGE_SPECTRUM)    // HPS lê as magnitudes: pitch deixa de rodar em paralelo com a FFT
+#endif
+
 /** ----------------------------------------------------------------
  *  GPTimer callback -> pisca LED (opcional)
  *  ---------------------------------------------------------------- */
@@ -132,263 +273,611 @@ static void configure_led_timer(void)
     ESP_LOGI(TAG, "GPTimer iniciado.");
 }
 
+
 /** ----------------------------------------------------------------
- *  Tarefa: mic_task
- *    - Lê continuamente do I2S
- *    - Envia blocos brutos para xRawQueue
- *    - Prioridade alta, para não perder dados
+ *  Estágio: capture (fonte em laço livre, core 0, prioridade alta)
+ *    - Lê continuamente do I2S direto para o ring (DMA -> ring)
+ *    - Captura contínua (sem pausas), em leituras de MIC_READ_FRAMES
+ *    - Notifica condition quando há uma janela completa
+ *    - Nunca bloqueia por causa da análise: com o ring cheio, descarta e contabiliza
  *  ---------------------------------------------------------------- */
-static void mic_task(void *pv)
+static bool capture_stage(void *ctx, void *frame, uint32_t frame_id)
 {
-    while (1)
-    {
-        TickType_t start_ticks = xTaskGetTickCount();
-
-        // Aloca dinamicamente um bloco
-        raw_block_t *blk = (raw_block_t *)heap_caps_malloc(sizeof(raw_block_t), MALLOC_CAP_SPIRAM);
-        if (blk == NULL) {
-            ESP_LOGE(TAG_TMIC, "Falha ao alocar raw_block_t (sem memória).");
-            vTaskDelay(pdMS_TO_TICKS(100));
-            continue;
-        }
-    #if TESTE == 0
-        // Lê amostras do microfone (I2S)
-        blk->length = i2s_read_samples(blk->samples, BUFFER_SIZE);
-        ESP_LOGI(TAG_TMIC, "Aqui");
-    #elif TESTE == 1
-        // Gera seno
-        generate_sine_wave(blk->samples, BUFFER_SIZE, 3300.0f, SAMPLE_RATE, &phase); //Limites: min->220hz, max->3200hz
-        blk->length = BUFFER_SIZE;
+    capture_state_t *st = (capture_state_t *)ctx;
+    (void)st;
+    (void)frame;
+    (void)frame_id;
+
+    // A leitura bloqueante do I2S dita o ritmo, sem pausas entre blocos
+    uint32_t t_capture = TRACE_BEGIN();
+#if TESTE == 0
+    // Lê amostras do microfone (I2S) direto para o ring
+    size_t written = i2s_read_to_ring(&mic_ring, MIC_READ_FRAMES, pdMS_TO_TICKS(1000));
+    if (written < MIC_READ_FRAMES && audio_ring_available(&mic_ring) + MIC_READ_FRAMES > mic_ring.capacity) {
+        // Ring cheio: mantém o DMA drenado e contabiliza a perda em vez de bloquear
+        capture_stats.frames_overrun += i2s_discard_samples(MIC_READ_FRAMES - written, pdMS_TO_TICKS(1000));
+    }
+#else
+    #if TESTE == 1
+    // Gera seno
+    generate_sine_wave(st->test_buf, ANALYSIS_HOP, 3300.0f, SAMPLE_RATE, &phase); //Limites: min->220hz, max->3200hz
     #elif TESTE == 2
-        // Gera onda composta
-        generate_complex_wave(blk->samples, BUFFER_SIZE, SAMPLE_RATE, frequencies_waves, amplitudes_waves, phases_waves, NUM_WAVES);
-        blk->length = BUFFER_SIZE;
+    // Gera onda composta
+    generate_complex_wave(st->test_buf, ANALYSIS_HOP, SAMPLE_RATE, frequencies_waves, amplitudes_waves, phases_waves, NUM_WAVES);
     #endif
+    size_t written = ring_write_test_signal(st->test_buf, ANALYSIS_HOP);
+    capture_stats.frames_overrun += ANALYSIS_HOP - written;
+    // Simula o ritmo do I2S
+    vTaskDelayUntil(&st->last_wake, pdMS_TO_TICKS((ANALYSIS_HOP * 1000) / SAMPLE_RATE));
+#endif
 
-        if (blk->length > 0)
-        {
-            // Trunca se for maior que o BUFFER_SIZE (por garantia)
-            if (blk->length > BUFFER_SIZE) {
-                blk->length = BUFFER_SIZE;
-            }
+    TRACE_END(TRACE_STAGE_CAPTURE, capture_stats.frames_captured, t_capture); // frame = posição da leitura no stream
+    capture_stats.frames_captured += written;
+    if (written > 0 && condition_task_handle && audio_ring_available(&mic_ring) >= BUFFER_SIZE) {
+        xTaskNotifyGive(condition_task_handle);
+    }
+    return false; // Não produz frames
+}
 
-            // Envia o ponteiro para a fila
-            if (xQueueSend(xRawQueue, &blk, portMAX_DELAY) != pdTRUE) {
-                ESP_LOGE(TAG_TMIC, "Falha ao enviar para xRawQueue.");
-                free(blk); // libera se não conseguiu enfileirar
-            } else {
-                ESP_LOGD(TAG_TMIC, "mic_task: Enviado bloco para xRawQueue.");
-            }
-        }
-        else {
-            ESP_LOGW(TAG_TMIC, "mic_task: Nenhuma amostra lida.");
-            free(blk);
-        }
+/** ----------------------------------------------------------------
+ *  Estágio: condition (fonte dos frames)
+ *    - Espera (fora do tempo ocupado): janela completa no ring (avanço de ANALYSIS_HOP);
+ *      se atrasada mais de ANALYSIS_MAX_LAG hops, pula para a janela mais recente
+ *    - Converte int32 -> float direto no frame (primeiro toque), com a janela Hann
+ *    - Aplica o band-pass
+ *  ---------------------------------------------------------------- */
+static bool condition_wait(void *ctx)
+{
+    (void)ctx;
+
+    // Backpressure: se a análise atrasou, pula para a janela mais recente (a captura nunca espera)
+    size_t backlog = audio_ring_available(&mic_ring);
+    if (backlog > BUFFER_SIZE + ANALYSIS_MAX_LAG * ANALYSIS_HOP) {
+        size_t skip_hops = (backlog - BUFFER_SIZE) / ANALYSIS_HOP;
+        audio_ring_consume(&mic_ring, skip_hops * ANALYSIS_HOP);
+        capture_stats.windows_skipped += skip_hops;
+        ESP_LOGD(TAG_SCND, "Análise atrasada: %zu hops pulados.", skip_hops);
+    }
 
-        TickType_t end_ticks = xTaskGetTickCount();
-        float elapsed_ms = (float)(end_ticks - start_ticks) * portTICK_PERIOD_MS;
-        ESP_LOGD(TAG_TMIC, "Tempo de captura mic_task: %.2f ms", elapsed_ms); //21 ms a 48 kHz
+    // Espera até haver uma janela completa no ring
+    audio_ring_view_t view;
+    while (!audio_ring_peek(&mic_ring, BUFFER_SIZE, &view)) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    return true;
+}
 
-        // Cede CPU
-        vTaskDelay(pdMS_TO_TICKS(100));
+/**
+ * @brief Gate de energia sobre o nível acumulado na conversão.
+ * @return true se a janela é silêncio (segue só como resultado compacto, sem band-pass).
+ */
+static bool condition_gate(condition_state_t *st, const audio_level_t *level, audio_data_t *out)
+{
+#if GATE_ENABLED
+    bool was_open = st->gate.open;
+    out->silent = !energy_gate_process(&st->gate, level);
+    out->level_dbfs = st->gate.last_rms_dbfs;
+    if (out->silent) {
+        return true;
+    }
+    if (!was_open) {
+        // O band-pass parou no fechamento: recomeça do repouso em vez de um estado antigo
+#if DSP_PATH == DSP_PATH_FIXED
+        sos_q31_from_float(&st->bandpass_q31, &st->bandpass);
+#else
+        sos_reset(&st->bandpass);
+#endif
     }
+#else
+    (void)st;
+    (void)level;
+    (void)out;
+#endif
+    return false;
 }
 
-/** ----------------------------------------------------------------
- *  Tarefa: audio_task
- *    - Recebe blocos brutos de xRawQueue
- *    - Aplica filtros (ex.: Band-Pass)
- *    - Executa FFT e YIN
- *    - Envia para xResultQueue
- *  ---------------------------------------------------------------- */
-static void audio_task(void *pv)
+static bool condition_stage(void *ctx, void *frame, uint32_t frame_id)
 {
-    // Inicializa YIN
-    Yin yin;
-    esp_err_t ret_yin = yin_init(&yin, BUFFER_SIZE, SAMPLE_RATE,
-                                 YIN_THRESHOLD, 
-                                 YIN_THRESHOLD_ADAPTIVE,
-                                 0.02f, 0.1f, 0.01f);
-    if (ret_yin != ESP_OK) {
-        ESP_LOGE(TAG_TAUD, "Falha ao inicializar YIN.");
-        vTaskDelete(NULL);
+    condition_state_t *st = (condition_state_t *)ctx;
+    audio_data_t *out = (audio_data_t *)frame;
+
+    // condition_wait já garantiu a janela; só esta task consome o ring
+    audio_ring_view_t view;
+    if (!audio_ring_peek(&mic_ring, BUFFER_SIZE, &view)) {
+        return false;
+    }
+    uint32_t t_stage = TRACE_BEGIN();
+    out->frame_id = frame_id;
+    out->timestamp_us = esp_timer_get_time();
+    out->silent = false;
+    out->level_dbfs = 0.0f;
+#if GATE_ENABLED
+    // Nível acumulado na própria conversão (a janela não é relida)
+    audio_level_t level;
+    audio_level_reset(&level);
+    audio_level_t *level_acc = &level;
+#else
+    audio_level_t *level_acc = NULL;
+#endif
+
+#if DSP_PATH == DSP_PATH_FIXED
+    // O formato do INMP441 já é Q31: a view do ring é lida uma única vez
+    fx_i2s_to_q31(view.first, st->fx_buf, view.first_len, level_acc);
+    fx_i2s_to_q31(view.second, st->fx_buf + view.first_len, view.second_len, level_acc);
+    out->length = BUFFER_SIZE;
+    audio_ring_consume(&mic_ring, ANALYSIS_HOP);
+    ESP_LOGD(TAG_SCND, "Janela com %zu samples (Q31).", out->length);
+    TRACE_END(TRACE_STAGE_CONVERT, frame_id, t_stage);
+    if (condition_gate(st, level_acc, out)) {
+        return true;
     }
 
-    // Filtro Band-Pass
-    biquad_t bandpass_filter;
-    bandpass_init(&bandpass_filter, SAMPLE_RATE, LOW_FREQ, HIGH_FREQ);
+    // Janela Hann e band-pass em Q31
+    t_stage = TRACE_BEGIN();
+    fx_window_apply_q31(&st->window_q15, st->fx_buf);
+    TRACE_END(TRACE_STAGE_WINDOW, frame_id, t_stage);
+    t_stage = TRACE_BEGIN();
+    sos_q31_process(&st->bandpass_q31, st->fx_buf, st->fx_buf, BUFFER_SIZE);
 
-    smoothing_t smoothing;
-    smoothing_init(&smoothing);
+    // Q31 -> Q15 normalizado pelo bloco (o expoente acompanha o frame até a FFT)
+    out->exponent = fx_q31_to_q15_block(st->fx_buf, out->samples_q15, BUFFER_SIZE);
+    TRACE_END(TRACE_STAGE_BANDPASS, frame_id, t_stage);
 
-    while (1)
-    {
-        raw_block_t *raw;
-        if (xQueueReceive(xRawQueue, &raw, portMAX_DELAY) == pdTRUE)
-        {
-            TickType_t start_ticks = xTaskGetTickCount();
-            ESP_LOGI(TAG_TAUD, "Recebido bloco com %zu samples.", raw->length);
-
-            // Aplica janela (Hann por ex.)
-            apply_window(raw->samples, raw->length, 1);
-
-            // Aplica filtro band-pass in-place
-            biquad_process(&bandpass_filter, raw->samples, raw->samples, raw->length);
-
-            // FFT
-            float *breal  = heap_caps_malloc(FBUF_SIZE * sizeof(float), MALLOC_CAP_SPIRAM);
-            float *bimg   = heap_caps_malloc(FBUF_SIZE * sizeof(float), MALLOC_CAP_SPIRAM);
-            float *mag    = heap_caps_malloc(FBUF_SIZE * sizeof(float), MALLOC_CAP_SPIRAM);
-            
-            if (!breal || !bimg || !mag) {
-                ESP_LOGE(TAG_TAUD, "Falha ao alocar breal/bimg/mag.");
-                heap_caps_free(raw);
-                if(breal) heap_caps_free(breal);
-                if(bimg)  heap_caps_free(bimg);
-                if(mag)   heap_caps_free(mag);
-                continue;
-            }   
-
-            for (size_t i = 0; i < FBUF_SIZE; i++) {
-                breal[i] = raw->samples[i];
-                bimg[i]  = 0.0f;
-            }
+    // Amostras em float apenas para a saída
+    for (size_t i = 0; i < BUFFER_SIZE; i++) {
+        out->samples[i] = fx_q31_to_float(st->fx_buf[i]);
+    }
+#else
+    // Conversão + janela Hann numa passada: a view do ring é lida uma única vez, direto para o frame
+    window_and_convert(view.first, st->hann, out->samples, view.first_len, level_acc);
+    window_and_convert(view.second, st->hann + view.first_len, out->samples + view.first_len, view.second_len, level_acc);
+    out->length = BUFFER_SIZE;
+    audio_ring_consume(&mic_ring, ANALYSIS_HOP);
+    ESP_LOGD(TAG_SCND, "Janela com %zu samples.", out->length);
+    TRACE_END(TRACE_STAGE_CONVERT, frame_id, t_stage); // Inclui a janela (fundida)
+    if (condition_gate(st, level_acc, out)) {
+        return true;
+    }
 
-            fft(breal, bimg, FBUF_SIZE);
-            calculate_magnitude(breal, bimg, mag, FBUF_SIZE);
+    // Aplica filtro band-pass in-place
+    t_stage = TRACE_BEGIN();
+    sos_process(&st->bandpass, out->samples, out->samples, out->length);
+    TRACE_END(TRACE_STAGE_BANDPASS, frame_id, t_stage);
+#endif
+    return true;
+}
 
-            // Calcula todas as frequências dos bins
-            if (frequency(mag, breal, FBUF_SIZE, SAMPLE_RATE) != 0) {
-                ESP_LOGW(TAG_TAUD, "Erro ao calcular frequências (bins).");
-            }
+/** ----------------------------------------------------------------
+ *  Estágio: spectrum (entrada: condition)
+ *    - FFT e magnitude (em paralelo com pitch, no outro núcleo)
+ *  ---------------------------------------------------------------- */
+static bool spectrum_stage(void *ctx, void *frame, uint32_t frame_id)
+{
+    spectrum_state_t *st = (spectrum_state_t *)ctx;
+    audio_data_t *out = (audio_data_t *)frame;
+    if (out->silent) {
+        return true; // Silêncio: sem FFT (o emit não envia espectro)
+    }
+#if PITCH_ENGINE == PITCH_ENGINE_TUNER && PROCESSING == 0
+    return true; // Afinador com saída só de nota: ninguém lê o espectro
+#endif
 
-            // YIN
-            float freq_detected = 0.0f;
-            if (yin_detect_pitch(&yin, raw->samples, &freq_detected) != 0 || freq_detected < 0.0f) {
-                ESP_LOGW(TAG_TAUD, "YIN não detectou pitch válido.");
-                freq_detected = -1.0f;
-            }
+#if DSP_PATH == DSP_PATH_FIXED
+    // FFT em ponto flutuante de bloco (entrada real, parte imaginária zerada)
+    uint32_t t_stage = TRACE_BEGIN();
+    int exponent = out->exponent;
+    for (size_t i = 0; i < FBUF_SIZE; i++) {
+        st->fx_spec[2 * i]     = out->samples_q15[i];
+        st->fx_spec[2 * i + 1] = 0;
+    }
+    fx_fft_q15(&st->fft_q15, st->fx_spec, &exponent);
+    TRACE_END(TRACE_STAGE_FFT, frame_id, t_stage);
+    t_stage = TRACE_BEGIN();
+    fx_magnitude_q15(st->fx_spec, exponent, out->magnitude, FBUF_SIZE);
+    TRACE_END(TRACE_STAGE_MAGNITUDE, frame_id, t_stage);
+#else
+    // FFT (entrada real: RFFT_BINS bins)
+    uint32_t t_stage = TRACE_BEGIN();
+    rfft(out->samples, st->breal, st->bimg, FBUF_SIZE);
+    TRACE_END(TRACE_STAGE_FFT, frame_id, t_stage);
+    t_stage = TRACE_BEGIN();
+    calculate_magnitude_rfft(st->breal, st->bimg, out->magnitude, FBUF_SIZE);
+    TRACE_END(TRACE_STAGE_MAGNITUDE, frame_id, t_stage);
+#endif
+    return true;
+}
 
-            // Aloca estrutura de saída
-            audio_data_t *out = (audio_data_t *)heap_caps_malloc(sizeof(audio_data_t), MALLOC_CAP_SPIRAM);
-            if (!out) {
-                ESP_LOGE(TAG_TAUD, "Falha ao alocar audio_data_t.");
-                heap_caps_free(raw);
-                heap_caps_free(breal);
-                heap_caps_free(bimg);
-                heap_caps_free(mag); 
-                continue;
-            }
+/** ----------------------------------------------------------------
+ *  Estágio: pitch (entrada: condition)
+ *    - Decimação (caminho em float) e YIN, HPS ou banco do afinador (PITCH_ENGINE)
+ *  ---------------------------------------------------------------- */
+static bool pitch_stage(void *ctx, void *frame, uint32_t frame_id)
+{
+    pitch_state_t *st = (pitch_state_t *)ctx;
+    audio_data_t *out = (audio_data_t *)frame;
+
+    // Silêncio: sem YIN; a primeira janela silenciosa descarta o estado da nota anterior
+    if (out->silent) {
+        out->fund_frequency = -1.0f;
+        out->confidence = 0.0f;
+        if (!st->in_silence) {
+            pitch_engine_reset(&st->engines);
+            st->in_silence = true;
+        }
+        return true;
+    }
+    st->in_silence = false;
+
+#if YIN_PARALLEL_WORKERS > 1
+    // Laços diretos de d(tau) divididos com um worker no outro núcleo (Q15, YIN_DIFF_DIRECT, rastreamento; o backend FFT segue serial)
+    if (!st->executor_ready) {
+        st->executor_ready = true;
+        if (par_executor_init(&st->executor, YIN_PARALLEL_WORKERS) != ESP_OK ||
+            yin_set_executor(&st->engines.yin, &st->executor) != ESP_OK) {
+            ESP_LOGW(TAG_SPIT, "Executor paralelo indisponível; YIN segue serial.");
+        }
+    }
+#endif
 
-            float *clone_samples = heap_caps_malloc(raw->length * sizeof(float), MALLOC_CAP_SPIRAM);
-            if (!clone_samples) {
-                // Falha
-                heap_caps_free(out);
-                heap_caps_free(raw);
-                heap_caps_free(breal);
-                heap_caps_free(bimg);
-                heap_caps_free(mag);
-                continue;
-            }
+#if PITCH_ENGINE == PITCH_ENGINE_TUNER
+    // Afinador: banco de Goertzel nas cordas do instrumento (nota e cents saem do próprio banco)
+    const float *tuner_in = out->samples;
+#if DSP_PATH == DSP_PATH_FLOAT && YIN_DECIMATION > 1
+    uint32_t t_tuner = TRACE_BEGIN();
+    decimator_reset(&st->decimator);
+    decimator_process(&st->decimator, out->samples, out->length, st->yin_buf);
+    TRACE_END(TRACE_STAGE_DECIMATE, frame_id, t_tuner);
+    tuner_in = st->yin_buf;
+#endif
+    uint32_t t_bank = TRACE_BEGIN();
+    float f_tuner = -1.0f;
+    note_t tuned;
+    int tuner_ret = tuner_bank_process(&st->bank, tuner_in, &f_tuner, &tuned);
+    TRACE_END(TRACE_STAGE_TUNER, frame_id, t_bank);
+    if (tuner_ret != 0) {
+        strncpy(out->note, "Unknown", sizeof(out->note) - 1);
+        out->note[sizeof(out->note) - 1] = '\0';
+        out->midi = -1;
+        out->cents = 0.0f;
+        out->confidence = 0.0f;
+        out->fund_frequency = -1.0f;
+    } else {
+        snprintf(out->note, sizeof(out->note), "%s%d", tuned.note, tuned.octave);
+        out->midi = tuned.midi;
+        out->cents = tuned.cents;
+        out->confidence = tuner_bank_confidence(&st->bank);
+        out->fund_frequency = f_tuner;
+    }
+    return true;
+#endif
 
-            memcpy(clone_samples, raw->samples, raw->length*sizeof(float));
+#if PITCH_ENGINE == PITCH_ENGINE_HPS || PITCH_ENGINE == PITCH_ENGINE_HPS_YIN
+    // HPS nas magnitudes já calculadas pelo estágio spectrum
+    uint32_t t_hps = TRACE_BEGIN();
+    float f_hps = -1.0f;
+    hps_detect(&st->hps, out->magnitude, &f_hps);
+    TRACE_END(TRACE_STAGE_HPS, frame_id, t_hps);
+#if PITCH_ENGINE == PITCH_ENGINE_HPS
+    out->confidence = (f_hps > 0.0f) ? hps_confidence(&st->hps) : 0.0f;
+    out->fund_frequency = f_hps;
+    return true;
+#else
+    // Pré-estimador: o detector só busca até HPS_PRE_MARGIN períodos estimados (cobre a suboitava);
+    // sem estimativa volta à faixa completa
+    pitch_engine_set_search_range(&st->engines, (f_hps > 0.0f) ? f_hps / HPS_PRE_MARGIN : 0.0f, 0.0f);
+#endif
+#endif
 
-            out->samples    = clone_samples;
-            out->length     = raw->length;
-            out->frequency  = breal;  // cede “a posse” do breal
-            out->magnitude  = mag;    // cede “a posse” do mag
-            out->fund_frequency = freq_detected;// ou smoothing_update(&smoothing, freq_detected);
+#if PITCH_ENGINE == PITCH_ENGINE_YIN || PITCH_ENGINE == PITCH_ENGINE_HPS_YIN
+    float freq_detected = 0.0f;
+    int pitch_ret;
+#if DSP_PATH == DSP_PATH_FIXED
+    // Amostras Q15 (YIN com acumulador inteiro)
+    uint32_t t_stage = TRACE_BEGIN();
+    pitch_ret = pitch_engine_process_q15(&st->engines, out->samples_q15, &freq_detected);
+#elif YIN_DECIMATION > 1
+    // Janelas sobrepostas: cada uma é decimada do zero (as bordas da Hann escondem o transitório)
+    uint32_t t_stage = TRACE_BEGIN();
+    decimator_reset(&st->decimator);
+    decimator_process(&st->decimator, out->samples, out->length, st->yin_buf);
+    TRACE_END(TRACE_STAGE_DECIMATE, frame_id, t_stage);
+    t_stage = TRACE_BEGIN();
+    pitch_ret = pitch_engine_process(&st->engines, st->yin_buf, &freq_detected);
+#else
+    uint32_t t_stage = TRACE_BEGIN();
+    pitch_ret = pitch_engine_process(&st->engines, out->samples, &freq_detected);
+#endif
+    TRACE_END(TRACE_STAGE_YIN, frame_id, t_stage);
+    if (pitch_engine_active(&st->engines) == PITCH_DETECTOR_YIN) {
+        ESP_LOGD(TAG_SPIT, "YIN: %zu lags avaliados.", yin_taus_evaluated(&st->engines.yin));
+    }
 
-            // Determina a nota
-            note_t note;
-            if (get_note(out->fund_frequency, &note) != 0) {
-                strncpy(out->note, "Unknown", sizeof(out->note) - 1);
-                out->note[sizeof(out->note) - 1] = '\0';
-            } else {
-                snprintf(out->note, sizeof(out->note), "%s%d", note.note, note.octave);
-            }
+    if (pitch_ret != 0 || freq_detected < 0.0f) {
+        ESP_LOGD(TAG_SPIT, "%s não detectou pitch válido.", pitch_engine_name(&st->engines));
+        freq_detected = -1.0f;
+    }
+    out->confidence = (freq_detected > 0.0f) ? pitch_engine_confidence(&st->engines) : 0.0f;
+    out->fund_frequency = freq_detected;// ou smoothing_update(&st->smoothing, freq_detected);
+    return true;
+#endif
+}
 
-            // Envia para xResultQueue
-            if (xQueueSend(xResultQueue, &out, portMAX_DELAY) != pdTRUE) {
-                ESP_LOGE(TAG_TAUD, "Falha ao enviar para xResultQueue.");
-                heap_caps_free(out->samples);
-                heap_caps_free(out->frequency);
-                heap_caps_free(out->magnitude);
-                heap_caps_free(out);
-            }
+/** ----------------------------------------------------------------
+ *  Estágio: note (entradas: spectrum e pitch)
+ *    - Frequências dos bins e frequência fundamental -> nota
+ *  ---------------------------------------------------------------- */
+static bool note_stage(void *ctx, void *frame, uint32_t frame_id)
+{
+    (void)ctx;
+    audio_data_t *out = (audio_data_t *)frame;
+    if (out->silent) {
+        strncpy(out->note, "Silence", sizeof(out->note) - 1);
+        out->note[sizeof(out->note) - 1] = '\0';
+        out->midi = -1;
+        out->cents = 0.0f;
+        return true;
+    }
 
-            // Libera o bloco bruto
-            heap_caps_free(raw);
+    // Calcula todas as frequências dos bins
+    uint32_t t_stage = TRACE_BEGIN();
+    if (frequency_rfft(out->magnitude, out->frequency, FBUF_SIZE, SAMPLE_RATE) != 0) {
+        ESP_LOGW(TAG_SNOT, "Erro ao calcular frequências (bins).");
+    }
 
-            TickType_t end_ticks = xTaskGetTickCount();
-            float elapsed_ms = (float)(end_ticks - start_ticks) * portTICK_PERIOD_MS;
-            ESP_LOGI(TAG_TAUD, "Tempo process. audio_task: %.2f ms", elapsed_ms);
-        }
-        vTaskDelay(pdMS_TO_TICKS(1));
+#if PITCH_ENGINE == PITCH_ENGINE_TUNER
+    // O estágio pitch já preencheu nota e cents em relação à corda alvo
+    TRACE_END(TRACE_STAGE_NOTE, frame_id, t_stage);
+    return true;
+#else
+    // Determina a nota
+    note_t note;
+    if (get_note(out->fund_frequency, &note) != 0) {
+        strncpy(out->note, "Unknown", sizeof(out->note) - 1);
+        out->note[sizeof(out->note) - 1] = '\0';
+        out->midi = -1;
+        out->cents = 0.0f;
+    } else {
+        snprintf(out->note, sizeof(out->note), "%s%d", note.note, note.octave);
+        out->midi = note.midi;
+        out->cents = note.cents;
     }
+    TRACE_END(TRACE_STAGE_NOTE, frame_id, t_stage);
+    return true;
+#endif
 }
 
 /** ----------------------------------------------------------------
- *  Tarefa: comm_task
- *    - Recebe audio_data_t de xResultQueue
- *    - Imprime no formato esperado
- *    - Fun_Freq;Note;Samples;Magnitude\n 
+ *  Estágio: emit (entrada: note)
+ *    - PROCESSING 0/1: imprime no formato de texto (Fun_Freq;Note;Samples;Magnitude\n)
+ *    - PROCESSING 2: um frame binário (telemetry.h) por janela, numa única escrita
+ *    - O frame volta ao pool do grafo ao retornar
  *  ---------------------------------------------------------------- */
-static void comm_task(void *pv)
+static bool emit_stage(void *ctx, void *frame, uint32_t frame_id)
 {
-    while (1)
+    const audio_data_t *rcv = (const audio_data_t *)frame;
+    uint32_t t_emit = TRACE_BEGIN();
+
+    #if PROCESSING == 2
+    // Um fwrite por frame: o lock do stdout impede que um ESP_LOG de outra task
+    // caia no meio do frame, e o driver do console (UART ou USB-CDC) recebe tudo de uma vez
+    emit_state_t *st = (emit_state_t *)ctx;
+    // Silêncio: frame só com o cabeçalho (TELEM_FLAG_SILENCE)
+    telem_frame_t tf = {
+        .flags        = rcv->silent ? TELEM_FLAG_SILENCE : TELEMETRY_VECTORS,
+        .seq          = frame_id,
+        .timestamp_us = (uint32_t)rcv->timestamp_us,
+        .fundamental  = rcv->fund_frequency,
+        .cents        = rcv->cents,
+        .note         = (rcv->midi >= 0) ? (uint8_t)rcv->midi : TELEM_NOTE_NONE,
+        .confidence   = rcv->confidence,
+        .spectrum     = (float *)rcv->magnitude,
+        .spectrum_len = RFFT_BINS,
+        .samples      = (float *)rcv->samples,
+        .samples_len  = rcv->length,
+    };
+    size_t len = telem_encode(&tf, st->buf, st->capacity);
+    if (len > 0) {
+        fwrite(st->buf, 1, len, stdout);
+        fflush(stdout);
+    }
+    TRACE_END(TRACE_STAGE_EMIT, frame_id, t_emit);
+    #else
+    (void)ctx;
+    #if PROCESSING == 0
+    // 1) Enviar a frequência fundamental e a nota
+    printf("FUND_FREQ=%.2fHz NOTE=%s\n", rcv->fund_frequency, rcv->note);
+    #elif PROCESSING == 1
+    // 1) Enviar a frequência fundamental e a nota
+    printf("%.2f;%s;", rcv->fund_frequency, rcv->note);
+
+    // 2) Enviar as samples e a magnitude (silêncio: vetores vazios)
+    if (!rcv->silent) {
+        for (size_t i = 0; i < BUFFER_SIZE; i++) {
+            printf("%.2f", rcv->samples[i]);
+        }
+    }
+    printf(";");
+
+    for (size_t i = 0; !rcv->silent && i < RFFT_BINS; i++)
     {
-        audio_data_t *rcv;
-        if (xQueueReceive(xResultQueue, &rcv, portMAX_DELAY) == pdTRUE)
-        {
-            if (!rcv) {
-                ESP_LOGE(TAG_TCOM, "comm_task: Ponteiro NULL recebido.");
-                continue;
-            }
+        printf("%.2f", rcv->magnitude[i]);
+    }
+    printf("\n");
+    #endif
+    #if ENABLE_VERIFICATION == 1
+    //2) Enviar todas as frequências da FFT (não calculadas no silêncio)
+    if (!rcv->silent) {
+        printf("FREQS=");
+        for (size_t i = 0; i < RFFT_BINS; i++) {
+            printf("%.2f,", rcv->frequency[i]);
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+        printf("\n");
+        printf("MAGN=");
+        for (size_t i = 0; i < RFFT_BINS; i++) {
+            printf("%.2f,", rcv->magnitude[i]);
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+        printf("\n");
+    }
+    #endif
+    TRACE_END(TRACE_STAGE_EMIT, frame_id, t_emit);
+
+    vTaskDelay(pdMS_TO_TICKS(1));
+    #endif
+    return true;
+}
 
-            #if PROCESSING == 0
-            // 1) Enviar a frequência fundamental e a nota
-            printf("FUND_FREQ=%.2fHz NOTE=%s\n", rcv->fund_frequency, rcv->note);
-            #elif PROCESSING == 1
-            // 1) Enviar a frequência fundamental e a nota
-            printf("%.2f;%s;", rcv->fund_frequency, rcv->note);
+/** ----------------------------------------------------------------
+ *  Prepara o estado dos estágios (filtros, YIN, scratch) antes de criar o grafo
+ *  ---------------------------------------------------------------- */
+static esp_err_t pipeline_state_init(void)
+{
+#if TESTE != 0
+    capture_state.test_buf = heap_caps_malloc(ANALYSIS_HOP * sizeof(float), MALLOC_CAP_SPIRAM);
+    if (!capture_state.test_buf) {
+        ESP_LOGE(TAG, "Falha ao alocar buffer de teste.");
+        return ESP_ERR_NO_MEM;
+    }
+    capture_state.last_wake = xTaskGetTickCount();
+#endif
 
-            // 2) Enviar as samples e a magnitude
-            for (size_t i = 0; i < BUFFER_SIZE; i++) {
-                printf("%.2f", rcv->samples[i]);
-            }
-            printf(";");
+    // Filtro de entrada: passa-banda Butterworth em cascata SOS (+ notch da rede, se configurado)
+    if (sos_input_filter_init(&condition_state.bandpass, SAMPLE_RATE, LOW_FREQ, HIGH_FREQ) != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao projetar o filtro de entrada.");
+        return ESP_FAIL;
+    }
+#if GATE_ENABLED
+    if (energy_gate_init(&condition_state.gate, GATE_OPEN_DBFS, GATE_CLOSE_DBFS, GATE_PEAK_DBFS, GATE_HOLD_FRAMES) != ESP_OK) {
+        return ESP_FAIL;
+    }
+#endif
 
-            for (size_t i = 0; i < FBUF_SIZE; i++)
-            {
-                printf("%.2f", rcv->magnitude[FBUF_SIZE]);
-            }
-            printf("\n");
-            #endif
-            #if ENABLE_VERIFICATION == 1
-            //2) Enviar todas as frequências da FFT
-            printf("FREQS=");
-            for (size_t i = 0; i < FBUF_SIZE; i++) {
-                printf("%.2f,", rcv->frequency[i]);
-                vTaskDelay(pdMS_TO_TICKS(1));
-            }
-            printf("\n");
-            printf("MAGN=");
-            for (size_t i = 0; i < FBUF_SIZE; i++) {
-                printf("%.2f,", rcv->magnitude[i]);
-                vTaskDelay(pdMS_TO_TICKS(1));
+    // Inicializa os detectores de pitch (no caminho em float, na taxa decimada)
+#if DSP_PATH == DSP_PATH_FLOAT && YIN_DECIMATION > 1
+    pitch_engine_config_t pitch_cfg = PITCH_ENGINE_CONFIG_DEFAULT(YIN_BUFFER_SIZE, YIN_SAMPLE_RATE);
+#else
+    pitch_engine_config_t pitch_cfg = PITCH_ENGINE_CONFIG_DEFAULT(BUFFER_SIZE, SAMPLE_RATE);
+#endif
+    pitch_cfg.yin_mode = YIN_THRESHOLD_ADAPTIVE;
+#if DSP_PATH == DSP_PATH_FIXED
+    pitch_cfg.yin_diff = YIN_DIFF_DIRECT; // d(tau) inteiro em yin_detect_pitch_q15
+#endif
+    esp_err_t ret_yin = pitch_engine_init(&pitch_state.engines, &pitch_cfg, PITCH_DETECTOR);
+#if YIN_HIERARCHICAL
+    if (ret_yin == ESP_OK) {
+        ret_yin = yin_set_hierarchical(&pitch_state.engines.yin, YIN_COARSE_FACTOR, YIN_COARSE_CANDIDATES, YIN_REFINE_RADIUS);
+    }
+#elif YIN_EARLY_EXIT
+    if (ret_yin == ESP_OK) {
+        ret_yin = yin_set_early_exit(&pitch_state.engines.yin, true);
+    }
+#endif
+#if YIN_TRACKING
+    if (ret_yin == ESP_OK) {
+        ret_yin = yin_set_tracking(&pitch_state.engines.yin, true, YIN_TRACK_SEMITONES);
+    }
+#endif
+    if (ret_yin != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao inicializar os detectores de pitch.");
+        return ret_yin;
+    }
+    smoothing_init(&pitch_state.smoothing);
+#if PITCH_ENGINE == PITCH_ENGINE_HPS || PITCH_ENGINE == PITCH_ENGINE_HPS_YIN
+    if (hps_init(&pitch_state.hps, FBUF_SIZE, SAMPLE_RATE, HPS_HARMONICS, LOW_FREQ, HIGH_FREQ) != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao inicializar o HPS.");
+        return ESP_FAIL;
+    }
+#elif PITCH_ENGINE == PITCH_ENGINE_TUNER
+    // Mesma janela/taxa que o YIN veria
+    if (tuner_bank_init(&pitch_state.bank, tuner_instrument_find(TUNER_INSTRUMENT),
+                        pitch_cfg.buffer_size, pitch_cfg.sample_rate, TUNER_HARMONICS, TUNER_RANGE_CENTS) != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao inicializar o afinador (%s).", TUNER_INSTRUMENT);
+        return ESP_FAIL;
+    }
+#endif
+
+#if DSP_PATH == DSP_PATH_FIXED
+    // Caminho em ponto fixo: janela/filtro em Q31, FFT e YIN em Q15
+    sos_q31_from_float(&condition_state.bandpass_q31, &condition_state.bandpass);
+    condition_state.fx_buf = heap_caps_malloc(BUFFER_SIZE * sizeof(q31_t), MALLOC_CAP_SPIRAM);
+    spectrum_state.fx_spec = heap_caps_malloc(2 * FBUF_SIZE * sizeof(q15_t), MALLOC_CAP_SPIRAM);
+    if (!condition_state.fx_buf || !spectrum_state.fx_spec ||
+        fx_window_init(&condition_state.window_q15, BUFFER_SIZE, WINDOW_HANN) != ESP_OK ||
+        fx_fft_init(&spectrum_state.fft_q15, FBUF_SIZE) != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao alocar scratch do caminho em ponto fixo.");
+        return ESP_ERR_NO_MEM;
+    }
+#else
+    // Scratch da FFT alocado uma única vez
+    spectrum_state.breal = heap_caps_malloc(RFFT_BINS * sizeof(float), MALLOC_CAP_SPIRAM);
+    spectrum_state.bimg  = heap_caps_malloc(RFFT_BINS * sizeof(float), MALLOC_CAP_SPIRAM);
+    condition_state.hann = window_get(WINDOW_HANN, BUFFER_SIZE);
+    if (!spectrum_state.breal || !spectrum_state.bimg || !condition_state.hann) {
+        ESP_LOGE(TAG, "Falha ao alocar breal/bimg/janela.");
+        return ESP_ERR_NO_MEM;
+    }
+#if YIN_DECIMATION > 1
+    // Decimador half-band: o YIN vê a janela a YIN_SAMPLE_RATE, a FFT segue na taxa cheia
+    pitch_state.yin_buf = heap_caps_malloc(YIN_BUFFER_SIZE * sizeof(float), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!pitch_state.yin_buf ||
+        decimator_init(&pitch_state.decimator, YIN_DECIMATION, SAMPLE_RATE, HIGH_FREQ, DECIM_ATTEN_DB, BUFFER_SIZE) != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao inicializar o decimador do YIN.");
+        return ESP_ERR_NO_MEM;
+    }
+#endif
+#endif
+
+#if PROCESSING == 2
+    // Maior frame possível com os vetores configurados
+    telem_frame_t tf = {.flags = TELEMETRY_VECTORS, .spectrum_len = RFFT_BINS, .samples_len = BUFFER_SIZE};
+    emit_state.capacity = telem_frame_size(&tf);
+    emit_state.buf = heap_caps_malloc(emit_state.capacity, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!emit_state.buf) {
+        ESP_LOGE(TAG, "Falha ao alocar o buffer de telemetria.");
+        return ESP_ERR_NO_MEM;
+    }
+#endif
+    return ESP_OK;
+}
+
+/** ----------------------------------------------------------------
+ *  Tarefa: console_task
+ *    - Comandos de uma tecla pelo console (stdin não bloqueante):
+ *      p = próximo detector de pitch (YIN -> MPM -> ...), na próxima janela
+ *      j = trace Chrome JSON, c = CSV, s = resumo por estágio, r = limpa (TRACE_ENABLED)
+ *    - Pausa a gravação durante a exportação para não medir a própria UART
+ *  ---------------------------------------------------------------- */
+static void console_task(void *pv)
+{
+    while (1)
+    {
+        int cmd = getchar();
+        if (cmd == 'p') {
+            pitch_detector_t next = (pitch_detector_t)((pitch_engine_active(&pitch_state.engines) + 1) % PITCH_DETECTOR_COUNT);
+            pitch_engine_select(&pitch_state.engines, next);
+            ESP_LOGI(TAG_TCON, "Detector de pitch -> %s.", pitch_engine_ops(next)->name);
+        }
+#if TRACE_ENABLED
+        else if (cmd == 'j' || cmd == 'c' || cmd == 's') {
+            trace_set_enabled(false);
+            printf("TRACE_BEGIN\n");
+            if (cmd == 'j') {
+                trace_export_chrome(stdout);
+            } else if (cmd == 'c') {
+                trace_export_csv(stdout);
+            } else {
+                trace_print_summary(stdout);
             }
-            printf("\n");
-            #endif
-            
-
-            // Libera
-            heap_caps_free(rcv->samples);
-            heap_caps_free(rcv->frequency);
-            heap_caps_free(rcv->magnitude);
-            heap_caps_free(rcv);
-            vTaskDelay(pdMS_TO_TICKS(1));
+            printf("TRACE_END\n");
+            fflush(stdout);
+            trace_set_enabled(true);
+        } else if (cmd == 'r') {
+            trace_reset();
+            ESP_LOGI(TAG_TCON, "Trace limpo.");
         }
+#endif
+        vTaskDelay(pdMS_TO_TICKS(100));
     }
 }
 
@@ -402,6 +891,15 @@ void app_main(void)
     // 1) LED Timer (opcional)
     configure_led_timer();
 
+#if RUN_BENCHMARK == 1
+    // Modo benchmark: suíte de kernels com contador de ciclos, JSON no console (sem pipeline)
+    static bench_result_t bench_results[BENCH_MAX_RESULTS];
+    bench_config_t bench_cfg = BENCH_CONFIG_DEFAULT();
+    size_t bench_count = bench_run_suite(&bench_cfg, bench_results, BENCH_MAX_RESULTS);
+    bench_write_json(stdout, bench_results, bench_count);
+    return;
+#endif
+
     // 2) Inicializa I2S
     ESP_LOGI(TAG, "Inicializando I2S...");
     esp_err_t ret = i2s_init();
@@ -418,27 +916,92 @@ void app_main(void)
     printf("Teste com onda composta\n");
     #endif
 
-    // 3) Cria Filas
-    xRawQueue    = xQueueCreate(8, sizeof(raw_block_t *));
-    xResultQueue = xQueueCreate(8, sizeof(audio_data_t *));
-    if (!xRawQueue || !xResultQueue) {
-        ESP_LOGE(TAG, "Erro ao criar filas. Reiniciando...");
+    // 3) Cria ring, pool de frames e estado dos estágios (únicas alocações do pipeline)
+    if (audio_ring_init(&mic_ring, AUDIO_RING_FRAMES, MALLOC_CAP_SPIRAM) != ESP_OK ||
+        stage_graph_init(&pipeline, sizeof(audio_data_t), RESULT_QUEUE_DEPTH + POOL_TASK_SLACK, MALLOC_CAP_SPIRAM) != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao criar ring/pool de frames. Reiniciando...");
+        esp_restart();
+    }
+    if (pipeline_state_init() != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao preparar os estágios. Reiniciando...");
         esp_restart();
     }
+#if TRACE_ENABLED
+    if (trace_init(TRACE_CAPACITY) != ESP_OK) {
+        ESP_LOGW(TAG, "Trace indisponível; pipeline segue sem instrumentação.");
+    }
+#endif
 
-    // 4) Cria tasks
-    ESP_LOGI(TAG, "Criando mic_task...");
-    xTaskCreatePinnedToCore(mic_task,   "mic_task",   1 << 13,  NULL, 5, NULL, 0);
+    // 4) Declara o grafo: spectrum e pitch consomem condition e rodam em núcleos diferentes;
+    //    note espera os dois (com HPS, pitch consome spectrum). A captura (core 0) nunca espera a análise.
+    const stage_desc_t stages[STAGE_COUNT] = {
+        //                   nome         corpo            contexto          espera          entradas                                                núcleo prio stack
+        [STAGE_CAPTURE]   = {"capture",   capture_stage,   &capture_state,   NULL,           0,                                                      0,     5,   1 << 13},
+        [STAGE_CONDITION] = {"condition", condition_stage, &condition_state, condition_wait, 0,                                                      0,     4,   1 << 13},
+        [STAGE_SPECTRUM]  = {"spectrum",  spectrum_stage,  &spectrum_state,  NULL,           STAGE_INPUT(STAGE_CONDITION),                           0,     4,   1 << 13},
+        [STAGE_PITCH]     = {"pitch",     pitch_stage,     &pitch_state,     NULL,           PITCH_INPUTS,                                           1,     4,   1 << 14},
+        [STAGE_NOTE]      = {"note",      note_stage,      NULL,             NULL,           STAGE_INPUT(STAGE_SPECTRUM) | STAGE_INPUT(STAGE_PITCH), 1,     4,   1 << 12},
+        [STAGE_EMIT]      = {"emit",      emit_stage,      EMIT_CONTEXT,     NULL,           STAGE_INPUT(STAGE_NOTE),                                1,     3,   1 << 12},
+    };
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        if (stage_graph_add(&pipeline, &stages[i]) != i) {
+            ESP_LOGE(TAG, "Erro ao declarar o estágio %s. Reiniciando...", stages[i].name);
+            esp_restart();
+        }
+    }
 
-    ESP_LOGI(TAG, "Criando audio_task...");
-    xTaskCreatePinnedToCore(audio_task, "audio_task", 1 << 15, NULL, 4, NULL, 1);
+    // 5) Cria as tasks dos estágios
+    ESP_LOGI(TAG, "Iniciando grafo de estágios...");
+    if (stage_graph_start(&pipeline) != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao iniciar o grafo de estágios. Reiniciando...");
+        esp_restart();
+    }
+    condition_task_handle = stage_graph_task(&pipeline, STAGE_CONDITION);
 
-    ESP_LOGI(TAG, "Criando comm_task...");
-    xTaskCreatePinnedToCore(comm_task,  "comm_task",  1 << 12,  NULL, 3, NULL, 1);
+    ESP_LOGI(TAG, "Criando console_task...");
+    xTaskCreatePinnedToCore(console_task, "console", 1 << 12, NULL, 1, NULL, 0);
 
-    // 5) Loop de monitoramento
+    // 6) Loop de monitoramento (estatísticas por estágio na janela de 2 s)
+    uint32_t last_captured = 0;
     while (1) {
-        ESP_LOGI(TAG, "Memória heap livre: %ld bytes", esp_get_free_heap_size());
         vTaskDelay(pdMS_TO_TICKS(2000));
+        ESP_LOGI(TAG, "Memória heap livre: %" PRIu32 " bytes", esp_get_free_heap_size());
+        block_pool_stats_t frame_stats;
+        block_pool_get_stats(&pipeline.frames, &frame_stats);
+        ESP_LOGI(TAG, "Ring: %zu/%zu frames | Pool frames: uso %" PRIu32 "/%" PRIu32 " pico %" PRIu32 " esgotado %" PRIu32,
+                 audio_ring_available(&mic_ring), mic_ring.capacity,
+                 frame_stats.in_use, frame_stats.capacity, frame_stats.high_water, frame_stats.exhausted);
+
+        stage_stats_t emitted;
+        stage_graph_get_stats(&pipeline, STAGE_EMIT, &emitted);
+        uint32_t captured = capture_stats.frames_captured;
+        ESP_LOGI(TAG, "Captura: %.0f amostras/s | Análise: %.1f janelas/s (hop %d) | Perdas: overrun %" PRIu32 " frames, atraso %" PRIu32 " hops",
+                 (captured - last_captured) / 2.0f, emitted.frames / 2.0f, ANALYSIS_HOP,
+                 capture_stats.frames_overrun, capture_stats.windows_skipped);
+        last_captured = captured;
+
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            stage_stats_t st;
+            stage_graph_get_stats(&pipeline, i, &st);
+            ESP_LOGI(TAG, "Estágio %-9s: %5.1f%% CPU | %4" PRIu32 " frames | fila %" PRIu32 " (pico %" PRIu32 ") | sem frame %" PRIu32,
+                     stages[i].name, 100.0f * st.utilization, st.frames, st.queue_depth, st.queue_high_water, st.starved);
+        }
+        stage_graph_reset_stats(&pipeline);
+
+#if GATE_ENABLED
+        // Janelas em silêncio não pagam band-pass, FFT, YIN nem nota
+        energy_gate_stats_t gate;
+        energy_gate_get_stats(&condition_state.gate, &gate);
+        ESP_LOGI(TAG, "Gate: %.1f%% das janelas em silêncio (%" PRIu32 "/%" PRIu32 ") | %" PRIu32 " aberturas | nível %.1f dBFS",
+                 100.0f * gate.skip_ratio, gate.skipped, gate.frames, gate.opens, gate.last_rms_dbfs);
+        energy_gate_reset_stats(&condition_state.gate);
+#endif
+
+#if YIN_TRACKING
+        yin_tracking_stats_t track;
+        yin_get_tracking_stats(&pitch_state.engines.yin, &track);
+        ESP_LOGI(TAG, "YIN rastreado: %" PRIu32 "/%" PRIu32 " janelas | travas %" PRIu32 ", destravas %" PRIu32 " | %.1f lags por janela",
+                 track.tracked, track.frames, track.locks, track.unlocks, track.avg_taus);
+#endif
     }
 }